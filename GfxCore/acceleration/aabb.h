@@ -26,6 +26,7 @@
 #include <utility>
 #include "../math/vector.h"
 #include "../math/matrix.h"
+#include "../math/affine.h"
 #include "../primitives/ray.h"
 
 class AABB
@@ -159,6 +160,27 @@ public:
 		return 0.5f * GetSize() + GetMin();
 	}
 
+	bool IsEmpty() const
+	{
+		return ( min[ 0 ] > max[ 0 ] ) || ( min[ 1 ] > max[ 1 ] ) || ( min[ 2 ] > max[ 2 ] );
+	}
+
+	// Box enclosing the transformed box, from its center and the absolute linear part applied to the extents
+	AABB Transform( const AffineTransform& xform ) const
+	{
+		if ( IsEmpty() ) {
+			return AABB();
+		}
+
+		const vec3f center = xform.TransformPoint( 0.5f * ( min + max ) );
+		const vec3f extent = xform.TransformExtent( 0.5f * ( max - min ) );
+
+		AABB bounds;
+		bounds.min = center - extent;
+		bounds.max = center + extent;
+		return bounds;
+	}
+
 	void Serialize( Serializer* serializer );
 };
 
@@ -0,0 +1,431 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2020-2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "bvh.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+struct bvhBin_t
+{
+	AABB		bounds;
+	uint32_t	count;
+};
+
+struct bvhSplit_t
+{
+	uint32_t	axis;
+	uint32_t	bin;		// Primitives in bins [ 0, bin ] go left
+	float		cost;		// SAH cost relative to one primitive test, FLT_MAX when no plane separates the centroids
+};
+
+
+static float SurfaceArea( const AABB& bounds )
+{
+	if ( bounds.IsEmpty() ) {
+		return 0.0f;
+	}
+	const vec3f size = bounds.max - bounds.min;
+	return 2.0f * ( size[ 0 ] * size[ 1 ] + size[ 1 ] * size[ 2 ] + size[ 2 ] * size[ 0 ] );
+}
+
+
+static void Union( AABB& bounds, const AABB& other )
+{
+	bounds.Expand( other.min );
+	bounds.Expand( other.max );
+}
+
+
+static inline uint32_t BinIndex( const float centroid, const float minCentroid, const float binScale, const uint32_t binCount )
+{
+	const uint32_t bin = static_cast<uint32_t>( Max( 0.0f, ( centroid - minCentroid ) * binScale ) );
+	return Min( bin, binCount - 1 );
+}
+
+
+static bvhSplit_t FindSplit( const AABB& nodeBounds, const AABB& centroidBounds, const uint32_t* primIndices, const uint32_t primCount,
+	const AABB* primBounds, const vec3f* centroids, const bvhBuildSettings_t& settings )
+{
+	const uint32_t binCount = settings.binCount;
+	const float invArea = 1.0f / Max( SurfaceArea( nodeBounds ), FLT_MIN );
+
+	bvhSplit_t best = { 0, 0, FLT_MAX };
+
+	std::vector<bvhBin_t> bins( binCount );
+	std::vector<float> rightCost( binCount );
+
+	for ( uint32_t axis = 0; axis < 3; ++axis )
+	{
+		const float minCentroid = centroidBounds.min[ axis ];
+		const float extent = centroidBounds.max[ axis ] - minCentroid;
+		if ( extent <= 0.0f ) {
+			continue;
+		}
+		const float binScale = binCount / extent;
+
+		for ( uint32_t b = 0; b < binCount; ++b )
+		{
+			bins[ b ].bounds = AABB();
+			bins[ b ].count = 0;
+		}
+
+		for ( uint32_t i = 0; i < primCount; ++i )
+		{
+			const uint32_t primIx = primIndices[ i ];
+			bvhBin_t& bin = bins[ BinIndex( centroids[ primIx ][ axis ], minCentroid, binScale, binCount ) ];
+			Union( bin.bounds, primBounds[ primIx ] );
+			bin.count++;
+		}
+
+		// Sweep from the right to get the area weighted count of every right side, then from the left to score each plane
+		AABB rightBounds;
+		uint32_t rightCount = 0;
+		for ( uint32_t b = binCount - 1; b > 0; --b )
+		{
+			Union( rightBounds, bins[ b ].bounds );
+			rightCount += bins[ b ].count;
+			rightCost[ b ] = SurfaceArea( rightBounds ) * rightCount;
+		}
+
+		AABB leftBounds;
+		uint32_t leftCount = 0;
+		for ( uint32_t b = 0; b < ( binCount - 1 ); ++b )
+		{
+			Union( leftBounds, bins[ b ].bounds );
+			leftCount += bins[ b ].count;
+			if ( ( leftCount == 0 ) || ( leftCount == primCount ) ) {
+				continue;
+			}
+
+			const float cost = settings.traversalCost + ( SurfaceArea( leftBounds ) * leftCount + rightCost[ b + 1 ] ) * invArea;
+			if ( cost < best.cost )
+			{
+				best.axis = axis;
+				best.bin = b;
+				best.cost = cost;
+			}
+		}
+	}
+	return best;
+}
+
+
+static void SetNodeBounds( Bvh::node_t& node, const AABB& bounds )
+{
+	for ( uint32_t i = 0; i < 3; ++i )
+	{
+		node.min[ i ] = bounds.min[ i ];
+		node.max[ i ] = bounds.max[ i ];
+	}
+}
+
+
+Bvh::Bvh() : m_mapped( nullptr )
+{
+}
+
+
+void Bvh::Build( const AABB* primBounds, const uint32_t primCount, const bvhBuildSettings_t& settings )
+{
+	Clear();
+	if ( primCount == 0 ) {
+		return;
+	}
+
+	bvhBuildSettings_t buildSettings = settings;
+	buildSettings.maxLeafSize = Max( 1u, settings.maxLeafSize );
+	buildSettings.binCount = Max( 2u, settings.binCount );
+
+	std::vector<vec3f> centroids( primCount );
+	for ( uint32_t i = 0; i < primCount; ++i ) {
+		centroids[ i ] = 0.5f * ( primBounds[ i ].min + primBounds[ i ].max );
+	}
+
+	std::vector<uint32_t> primIndices( primCount );
+	std::iota( primIndices.begin(), primIndices.end(), 0u );
+
+	// A binary tree with one primitive per leaf has 2n - 1 nodes
+	std::vector<node_t> nodes;
+	nodes.reserve( 2 * primCount - 1 );
+
+	node_t root = {};
+	root.offset = 0;
+	root.primCount = primCount;
+	nodes.push_back( root );
+
+	struct pendingNode_t
+	{
+		uint32_t	nodeIx;
+		uint32_t	depth;
+	};
+
+	// Children are appended as a pair and the left one is split first, so subtrees stay mostly contiguous
+	std::vector<pendingNode_t> pending;
+	pending.push_back( { 0, 0 } );
+
+	while ( pending.empty() == false )
+	{
+		const pendingNode_t current = pending.back();
+		pending.pop_back();
+
+		const uint32_t first = nodes[ current.nodeIx ].offset;
+		const uint32_t count = nodes[ current.nodeIx ].primCount;
+		uint32_t* indices = primIndices.data() + first;
+
+		AABB bounds;
+		AABB centroidBounds;
+		for ( uint32_t i = 0; i < count; ++i )
+		{
+			Union( bounds, primBounds[ indices[ i ] ] );
+			centroidBounds.Expand( centroids[ indices[ i ] ] );
+		}
+		SetNodeBounds( nodes[ current.nodeIx ], bounds );
+
+		if ( ( count <= 1 ) || ( ( current.depth + 1 ) >= MaxDepth ) ) {
+			continue;
+		}
+
+		const bvhSplit_t split = FindSplit( bounds, centroidBounds, indices, count, primBounds, centroids.data(), buildSettings );
+		if ( ( count <= buildSettings.maxLeafSize ) && ( split.cost >= static_cast<float>( count ) ) ) {
+			continue;
+		}
+
+		uint32_t leftCount = count / 2;
+		if ( split.cost < FLT_MAX )
+		{
+			const uint32_t axis = split.axis;
+			const float minCentroid = centroidBounds.min[ axis ];
+			const float binScale = buildSettings.binCount / ( centroidBounds.max[ axis ] - minCentroid );
+
+			uint32_t* mid = std::partition( indices, indices + count, [&]( const uint32_t primIx ) {
+				return BinIndex( centroids[ primIx ][ axis ], minCentroid, binScale, buildSettings.binCount ) <= split.bin;
+			} );
+			leftCount = static_cast<uint32_t>( mid - indices );
+		}
+		// else every centroid coincides, any halving is as good as another
+
+		const uint32_t childIx = static_cast<uint32_t>( nodes.size() );
+
+		node_t child = {};
+		child.offset = first;
+		child.primCount = leftCount;
+		nodes.push_back( child );
+
+		child.offset = first + leftCount;
+		child.primCount = count - leftCount;
+		nodes.push_back( child );
+
+		node_t& node = nodes[ current.nodeIx ];
+		node.offset = childIx;
+		node.primCount = 0;
+
+		pending.push_back( { childIx + 1, current.depth + 1 } );
+		pending.push_back( { childIx, current.depth + 1 } );
+	}
+
+	// Pack into the flat image. The header fills the first node slot, so with a 64-byte aligned image
+	// every sibling pair, starting at an odd node index, occupies exactly one cache line.
+	const size_t nodeCount = nodes.size();
+	const size_t primOffset = sizeof( header_t ) + nodeCount * sizeof( node_t );
+	const size_t byteCount = primOffset + primCount * sizeof( uint32_t );
+
+	m_storage.resize( byteCount );
+
+	header_t header = {};
+	header.magic = Magic;
+	header.version = Version;
+	header.nodeCount = static_cast<uint32_t>( nodeCount );
+	header.primCount = primCount;
+	header.primOffset = static_cast<uint32_t>( primOffset );
+	header.byteCount = static_cast<uint32_t>( byteCount );
+
+	memcpy( m_storage.data(), &header, sizeof( header_t ) );
+	memcpy( m_storage.data() + sizeof( header_t ), nodes.data(), nodeCount * sizeof( node_t ) );
+	memcpy( m_storage.data() + primOffset, primIndices.data(), primCount * sizeof( uint32_t ) );
+}
+
+
+void Bvh::Clear()
+{
+	m_storage.clear();
+	m_storage.shrink_to_fit();
+	m_mapped = nullptr;
+}
+
+
+void Bvh::SetupRay( const Ray& ray, traversalRay_t& outRay )
+{
+	for ( uint32_t i = 0; i < 3; ++i )
+	{
+		// Keep the inverse finite so the slab test never multiplies zero by infinity
+		const float d = ray.d[ i ];
+		const float safeD = ( fabs( d ) < 1e-20f ) ? ( ( d < 0.0f ) ? -1e-20f : 1e-20f ) : d;
+		outRay.origin[ i ] = ray.o[ i ];
+		outRay.invDir[ i ] = 1.0f / safeD;
+	}
+}
+
+
+bool Bvh::Intersect( const Ray& ray, std::vector<uint32_t>& hitItems ) const
+{
+	const size_t startCount = hitItems.size();
+
+	float tMax = FLT_MAX;
+	Traverse( ray, 0.0f, tMax, [&]( const uint32_t* prims, const uint32_t count, float& ) {
+		hitItems.insert( hitItems.end(), prims, prims + count );
+		return false;
+	} );
+	return ( hitItems.size() > startCount );
+}
+
+
+bool Bvh::ValidateFlat( const void* data, const size_t byteCount, const bool validateNodes )
+{
+	if ( ( data == nullptr ) || ( byteCount < sizeof( header_t ) ) ) {
+		return false;
+	}
+	// Nodes are read in place
+	if ( ( reinterpret_cast<uintptr_t>( data ) % alignof( node_t ) ) != 0 ) {
+		return false;
+	}
+
+	const header_t* header = reinterpret_cast<const header_t*>( data );
+	if ( ( header->magic != Magic ) || ( header->version != Version ) ) {
+		return false;
+	}
+
+	const uint64_t primOffset = sizeof( header_t ) + uint64_t( header->nodeCount ) * sizeof( node_t );
+	const uint64_t imageSize = primOffset + uint64_t( header->primCount ) * sizeof( uint32_t );
+	if ( ( header->primOffset != primOffset ) || ( header->byteCount != imageSize ) || ( imageSize > byteCount ) ) {
+		return false;
+	}
+
+	if ( validateNodes == false ) {
+		return true;
+	}
+
+	// Traversal trusts every offset, so walk the whole image once. Children must come after their parent,
+	// which rules out cycles and lets depths be settled in one pass in index order.
+	const uint32_t nodeCount = header->nodeCount;
+	const uint32_t primCount = header->primCount;
+	const node_t* nodes = reinterpret_cast<const node_t*>( header + 1 );
+	const uint32_t* primIndices = reinterpret_cast<const uint32_t*>( reinterpret_cast<const uint8_t*>( data ) + primOffset );
+
+	std::vector<uint8_t> depths( nodeCount, 0 );
+	for ( uint32_t nodeIx = 0; nodeIx < nodeCount; ++nodeIx )
+	{
+		const node_t& node = nodes[ nodeIx ];
+		if ( node.primCount > 0 )
+		{
+			if ( ( uint64_t( node.offset ) + node.primCount ) > primCount ) {
+				return false;
+			}
+			continue;
+		}
+
+		if ( ( node.offset <= nodeIx ) || ( ( uint64_t( node.offset ) + 1 ) >= nodeCount ) ) {
+			return false;
+		}
+
+		// Each level pushes at most one entry on the traversal stack
+		const uint32_t childDepth = depths[ nodeIx ] + 1u;
+		if ( childDepth > MaxDepth ) {
+			return false;
+		}
+		depths[ node.offset ] = static_cast<uint8_t>( Max<uint32_t>( depths[ node.offset ], childDepth ) );
+		depths[ node.offset + 1 ] = static_cast<uint8_t>( Max<uint32_t>( depths[ node.offset + 1 ], childDepth ) );
+	}
+
+	for ( uint32_t i = 0; i < primCount; ++i )
+	{
+		if ( primIndices[ i ] >= primCount ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+const uint8_t* Bvh::GetFlatData() const
+{
+	return reinterpret_cast<const uint8_t*>( Header() );
+}
+
+
+size_t Bvh::GetFlatSize() const
+{
+	const header_t* header = Header();
+	return ( header != nullptr ) ? header->byteCount : 0;
+}
+
+
+bool Bvh::MapFlat( const void* data, const size_t byteCount, const bool validateNodes )
+{
+	if ( ValidateFlat( data, byteCount, validateNodes ) == false ) {
+		return false;
+	}
+	Clear();
+	m_mapped = reinterpret_cast<const uint8_t*>( data );
+	return true;
+}
+
+
+bool Bvh::LoadFlat( const void* data, const size_t byteCount )
+{
+	if ( ValidateFlat( data, byteCount, true ) == false ) {
+		return false;
+	}
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>( data );
+	const uint32_t imageSize = reinterpret_cast<const header_t*>( data )->byteCount;
+
+	Clear();
+	m_storage.assign( bytes, bytes + imageSize );
+	return true;
+}
+
+
+AABB Bvh::GetAABB() const
+{
+	const header_t* header = Header();
+	if ( ( header == nullptr ) || ( header->nodeCount == 0 ) ) {
+		return AABB();
+	}
+	const node_t& root = Nodes()[ 0 ];
+	return AABB( vec3f( root.min[ 0 ], root.min[ 1 ], root.min[ 2 ] ), vec3f( root.max[ 0 ], root.max[ 1 ], root.max[ 2 ] ) );
+}
+
+
+uint32_t Bvh::GetNodeCount() const
+{
+	const header_t* header = Header();
+	return ( header != nullptr ) ? header->nodeCount : 0;
+}
+
+
+uint32_t Bvh::GetLeafCount() const
+{
+	const uint32_t nodeCount = GetNodeCount();
+	const node_t* nodes = ( nodeCount > 0 ) ? Nodes() : nullptr;
+	return static_cast<uint32_t>( std::count_if( nodes, nodes + nodeCount, []( const node_t& node ) { return node.primCount > 0; } ) );
+}
@@ -0,0 +1,271 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2020-2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <assert.h>
+#include "aabb.h"
+#include "../primitives/ray.h"
+#include "../core/alignedAllocator.h"
+
+class Serializer;
+
+struct bvhBuildSettings_t
+{
+	uint32_t	maxLeafSize;	// Nodes holding more primitives are always split
+	uint32_t	binCount;		// Centroid bins per axis, the SAH is evaluated at every bin boundary
+	float		traversalCost;	// Cost of visiting a node relative to one primitive test
+
+	bvhBuildSettings_t() :
+		maxLeafSize( 4 ),
+		binCount( 16 ),
+		traversalCost( 1.0f )
+	{}
+};
+
+/* === Bvh - Bounding volume hierarchy over primitive bounds, built with a binned surface area heuristic === */
+// Items are indices into the bounds array passed to Build(). Interior nodes always have two children.
+// A node stays a leaf once it fits in maxLeafSize and splitting would not lower the SAH cost.
+//
+// The tree lives in one flat image: a header, the node array, then the primitive index array.
+// Siblings are stored next to each other so an interior node only keeps its first child, and every pair
+// shares one 64-byte cache line. The same bytes are serialized and can be mapped in place with MapFlat().
+class Bvh
+{
+private:
+	static const uint32_t Version = 1;
+	static const uint32_t Magic = 0x48564221; // "!BVH"
+public:
+	static const uint32_t MaxDepth = 64;	// Deeper nodes are kept as leaves, bounds the traversal stack
+
+	struct node_t
+	{
+		float		min[ 3 ];
+		uint32_t	offset;			// Left child for interior nodes, the right child follows it. First primitive index for leaves.
+		float		max[ 3 ];
+		uint32_t	primCount;		// Zero for interior nodes
+	};
+
+	struct header_t
+	{
+		uint32_t	magic;
+		uint32_t	version;
+		uint32_t	nodeCount;
+		uint32_t	primCount;
+		uint32_t	primOffset;		// Byte offset of the primitive index array
+		uint32_t	byteCount;		// Size of the whole image
+		uint32_t	reserved[ 2 ];
+	};
+
+	static_assert( sizeof( node_t ) == 32, "Two nodes must fill a cache line" );
+	static_assert( sizeof( header_t ) == sizeof( node_t ), "Header takes one node slot so sibling pairs stay line aligned" );
+
+	Bvh();
+
+	void						Build( const AABB* primBounds, const uint32_t primCount, const bvhBuildSettings_t& settings = bvhBuildSettings_t() );
+	void						Clear();
+
+	// Permutes prims into leaf order so each leaf reads a contiguous run, primitive indices become the identity afterwards
+	template<typename T>
+	void						ReorderPrimitives( std::vector<T>& prims );
+
+	// Appends the primitives of every leaf whose bounds the ray passes, nearest leaves first. Returns false if nothing was added.
+	bool						Intersect( const Ray& ray, std::vector<uint32_t>& hitItems ) const;
+
+	// Visits leaves overlapping [tMin, tMax] along the ray, nearest child first, without allocating.
+	// leafFunc( const uint32_t* prims, uint32_t count, float& tMax ) may shrink tMax to cull farther nodes and returns true to stop.
+	template<typename LeafFunc>
+	void						Traverse( const Ray& ray, const float tMin, float& tMax, LeafFunc&& leafFunc ) const;
+
+	// Flat image access. Mapped memory is not copied, it must stay alive and unchanged while the tree uses it.
+	// Loading and mapping check every node and index, mapping can skip that for trusted images to avoid touching every page.
+	const uint8_t*				GetFlatData() const;
+	size_t						GetFlatSize() const;
+	bool						MapFlat( const void* data, const size_t byteCount, const bool validateNodes = true );
+	bool						LoadFlat( const void* data, const size_t byteCount );
+	void						Serialize( Serializer* serializer );
+
+	AABB						GetAABB() const;
+	uint32_t					GetNodeCount() const;
+	uint32_t					GetLeafCount() const;
+
+private:
+	struct traversalRay_t
+	{
+		float		origin[ 3 ];
+		float		invDir[ 3 ];
+	};
+
+	static bool					ValidateFlat( const void* data, const size_t byteCount, const bool validateNodes );
+	static void					SetupRay( const Ray& ray, traversalRay_t& outRay );
+	static inline bool			IntersectBounds( const node_t& node, const traversalRay_t& ray, const float tMin, const float tMax, float& outEntry );
+
+	inline const header_t*		Header() const;
+	inline const node_t*		Nodes() const;
+	inline const uint32_t*		PrimIndices() const;
+
+	std::vector<uint8_t, AlignedAllocator<uint8_t, 64>>	m_storage;
+	const uint8_t*				m_mapped;
+};
+
+
+inline const Bvh::header_t* Bvh::Header() const
+{
+	const uint8_t* data = ( m_mapped != nullptr ) ? m_mapped : m_storage.data();
+	return ( ( m_mapped != nullptr ) || ( m_storage.empty() == false ) ) ? reinterpret_cast<const header_t*>( data ) : nullptr;
+}
+
+
+inline const Bvh::node_t* Bvh::Nodes() const
+{
+	return reinterpret_cast<const node_t*>( Header() + 1 );
+}
+
+
+inline const uint32_t* Bvh::PrimIndices() const
+{
+	const header_t* header = Header();
+	return reinterpret_cast<const uint32_t*>( reinterpret_cast<const uint8_t*>( header ) + header->primOffset );
+}
+
+
+inline bool Bvh::IntersectBounds( const node_t& node, const traversalRay_t& ray, const float tMin, const float tMax, float& outEntry )
+{
+	float tNear = tMin;
+	float tFar = tMax;
+	for ( uint32_t i = 0; i < 3; ++i )
+	{
+		const float t0 = ( node.min[ i ] - ray.origin[ i ] ) * ray.invDir[ i ];
+		const float t1 = ( node.max[ i ] - ray.origin[ i ] ) * ray.invDir[ i ];
+		tNear = Max( tNear, Min( t0, t1 ) );
+		tFar = Min( tFar, Max( t0, t1 ) );
+	}
+	outEntry = tNear;
+	return ( tNear <= tFar );
+}
+
+
+template<typename T>
+void Bvh::ReorderPrimitives( std::vector<T>& prims )
+{
+	const header_t* header = Header();
+	if ( ( header == nullptr ) || ( m_mapped != nullptr ) ) {
+		return;
+	}
+	assert( prims.size() == header->primCount );
+
+	uint32_t* primIndices = reinterpret_cast<uint32_t*>( m_storage.data() + header->primOffset );
+
+	std::vector<T> sorted;
+	sorted.reserve( prims.size() );
+	for ( uint32_t i = 0; i < header->primCount; ++i )
+	{
+		sorted.push_back( std::move( prims[ primIndices[ i ] ] ) );
+		primIndices[ i ] = i;
+	}
+	prims.swap( sorted );
+}
+
+
+template<typename LeafFunc>
+void Bvh::Traverse( const Ray& ray, const float tMin, float& tMax, LeafFunc&& leafFunc ) const
+{
+	const header_t* header = Header();
+	if ( ( header == nullptr ) || ( header->nodeCount == 0 ) ) {
+		return;
+	}
+	const node_t* nodes = Nodes();
+	const uint32_t* primIndices = PrimIndices();
+
+	traversalRay_t traversalRay;
+	SetupRay( ray, traversalRay );
+
+	float tEntry;
+	if ( IntersectBounds( nodes[ 0 ], traversalRay, tMin, tMax, tEntry ) == false ) {
+		return;
+	}
+
+	struct stackEntry_t
+	{
+		uint32_t	nodeIx;
+		float		tEntry;
+	};
+
+	// Each level pushes at most one sibling, so the build depth limit bounds the stack
+	stackEntry_t stack[ MaxDepth ];
+	uint32_t stackSize = 0;
+	uint32_t nodeIx = 0;
+
+	while ( true )
+	{
+		const node_t& node = nodes[ nodeIx ];
+		if ( node.primCount > 0 )
+		{
+			if ( leafFunc( primIndices + node.offset, node.primCount, tMax ) ) {
+				return;
+			}
+		}
+		else
+		{
+			float tLeft;
+			float tRight;
+			const bool hitLeft = IntersectBounds( nodes[ node.offset ], traversalRay, tMin, tMax, tLeft );
+			const bool hitRight = IntersectBounds( nodes[ node.offset + 1 ], traversalRay, tMin, tMax, tRight );
+
+			if ( hitLeft && hitRight )
+			{
+				// Descend into the nearer child, come back for the other one
+				// Validated and built trees never get this deep, an unchecked mapped image stops here instead of overrunning
+				if ( stackSize >= MaxDepth )
+				{
+					assert( 0 );
+					return;
+				}
+
+				const bool leftFirst = ( tLeft <= tRight );
+				stack[ stackSize ].nodeIx = leftFirst ? ( node.offset + 1 ) : node.offset;
+				stack[ stackSize ].tEntry = leftFirst ? tRight : tLeft;
+				++stackSize;
+				nodeIx = leftFirst ? node.offset : ( node.offset + 1 );
+				continue;
+			}
+			else if ( hitLeft || hitRight )
+			{
+				nodeIx = hitLeft ? node.offset : ( node.offset + 1 );
+				continue;
+			}
+		}
+
+		// Pop the next pending node, skipping any that now start beyond tMax
+		do
+		{
+			if ( stackSize == 0 ) {
+				return;
+			}
+			--stackSize;
+		} while ( stack[ stackSize ].tEntry > tMax );
+		nodeIx = stack[ stackSize ].nodeIx;
+	}
+}
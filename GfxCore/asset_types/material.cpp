@@ -50,6 +50,23 @@ hdl_t Material::GetTexture( const uint32_t slot ) const
 }
 
 
+bool Material::SetTextureRemap( const uint32_t slot, const textureRemap_t& remap )
+{
+	if ( slot >= MaxMaterialTextures ) {
+		return false;
+	}
+	textureRemaps[ slot ] = remap;
+	return true;
+}
+
+
+const textureRemap_t& Material::GetTextureRemap( const uint32_t slot ) const
+{
+	assert( slot < MaxMaterialTextures );
+	return textureRemaps[ Min( slot, MaxMaterialTextures - 1 ) ];
+}
+
+
 uint32_t Material::TextureCount() const
 {
 	uint32_t count = 0;
@@ -159,7 +176,9 @@ float SmithGGXCorrelated( float NoV, float NoL, float roughness )
 
 vec3f Schlick( float u, vec3f f0 )
 {
-	return f0 + ( vec3f( 1.0f ) - f0 ) * pow( 1.0f - u, 5.0f );
+	const float m = 1.0f - u;
+	const float m2 = m * m;
+	return f0 + ( vec3f( 1.0f ) - f0 ) * ( m2 * m2 * m );
 }
 
 
@@ -126,10 +126,20 @@ struct materialParms_t
 	float		illum;
 };
 
+// Where a slot's texture lives after bake-time packing. Shaders sample frac( uv ) * scale + bias in the given array layer.
+struct textureRemap_t
+{
+	textureRemap_t() : scale( 1.0f, 1.0f ), bias( 0.0f, 0.0f ), layer( 0 ) {}
+
+	vec2f		scale;
+	vec2f		bias;
+	uint32_t	layer;
+};
+
 class Material
 {
 public:
-	static const uint32_t Version = 1;
+	static const uint32_t Version = 2;
 	static const uint32_t MaxMaterialTextures = 8;
 	static const uint32_t MaxMaterialShaders = DRAWPASS_COUNT;
 
@@ -142,6 +152,7 @@ private:
 	uint16_t				shaderBitSet;
 
 	hdl_t					textures[ MaxMaterialTextures ];
+	textureRemap_t			textureRemaps[ MaxMaterialTextures ];
 	hdl_t					shaders[ MaxMaterialShaders ];
 
 public:
@@ -262,6 +273,8 @@ public:
 
 	bool		AddTexture( const uint32_t slot, const hdl_t hdl );
 	hdl_t		GetTexture( const uint32_t slot ) const;
+	bool		SetTextureRemap( const uint32_t slot, const textureRemap_t& remap );
+	const textureRemap_t& GetTextureRemap( const uint32_t slot ) const;
 	uint32_t	TextureCount() const;
 	bool		AddShader( const drawPass_t pass, const hdl_t hdl );
 	hdl_t		GetShader( const drawPass_t pass ) const;
@@ -82,6 +82,28 @@ void Image::Create( const imageInfo_t& _info, uint8_t* pixelBytes, const uint32_
 		{
 			cpuImage = new ImageBuffer<rgba16_t>( bufferInfo );
 		} break;
+		case IMAGE_FMT_BC1:
+		case IMAGE_FMT_BC1_UNORM:
+		{
+			bufferInfo.blockSize = BcBlockDim;
+			cpuImage = new ImageBuffer<bc1Block_t>( bufferInfo );
+		} break;
+		case IMAGE_FMT_BC3:
+		case IMAGE_FMT_BC3_UNORM:
+		{
+			bufferInfo.blockSize = BcBlockDim;
+			cpuImage = new ImageBuffer<bc3Block_t>( bufferInfo );
+		} break;
+		case IMAGE_FMT_BC4:
+		{
+			bufferInfo.blockSize = BcBlockDim;
+			cpuImage = new ImageBuffer<bc4Block_t>( bufferInfo );
+		} break;
+		case IMAGE_FMT_BC5:
+		{
+			bufferInfo.blockSize = BcBlockDim;
+			cpuImage = new ImageBuffer<bc5Block_t>( bufferInfo );
+		} break;
 		default: assert( 0 );
 	}
 }
@@ -136,11 +158,222 @@ void Image::Serialize( Serializer* s )
 }
 
 
+static inline bool IsRgba8( const imageFmt_t fmt )
+{
+	return ( fmt == IMAGE_FMT_RGBA_8 ) || ( fmt == IMAGE_FMT_RGBA_8_UNORM );
+}
+
+
+// Block formats can't be blitted on the GPU so the chain is built here. Box filter in stored space.
+void GenerateMipChain( ImageBufferInterface& image )
+{
+	const uint32_t mipCount = image.GetMipCount();
+	const uint32_t layers = image.GetLayers();
+
+	for ( uint32_t mip = 1; mip < mipCount; ++mip )
+	{
+		for ( uint32_t layer = 0; layer < layers; ++layer )
+		{
+			const slice_t src = image.GetSlice( layer, mip - 1 );
+			const slice_t dst = image.GetSlice( layer, mip );
+
+			const rgba8_t* srcTexels = reinterpret_cast<const rgba8_t*>( src.ptr );
+			rgba8_t* dstTexels = reinterpret_cast<rgba8_t*>( dst.ptr );
+
+			for ( uint32_t y = 0; y < dst.height; ++y )
+			{
+				const uint32_t y0 = Min( 2 * y, src.height - 1 ) * src.width;
+				const uint32_t y1 = Min( 2 * y + 1, src.height - 1 ) * src.width;
+
+				for ( uint32_t x = 0; x < dst.width; ++x )
+				{
+					const uint32_t x0 = Min( 2 * x, src.width - 1 );
+					const uint32_t x1 = Min( 2 * x + 1, src.width - 1 );
+
+					rgba8_t& texel = dstTexels[ y * dst.width + x ];
+					for ( uint32_t c = 0; c < 4; ++c )
+					{
+						const uint32_t sum = srcTexels[ y0 + x0 ].vec[ c ] + srcTexels[ y0 + x1 ].vec[ c ] +
+											 srcTexels[ y1 + x0 ].vec[ c ] + srcTexels[ y1 + x1 ].vec[ c ];
+						texel.vec[ c ] = static_cast<uint8_t>( ( sum + 2 ) / 4 );
+					}
+				}
+			}
+		}
+	}
+}
+
+
+imageFmt_t SelectCompressedFormat( const Image& image )
+{
+	if ( ( image.cpuImage == nullptr ) || ( IsRgba8( image.info.fmt ) == false ) ) {
+		return image.info.fmt;
+	}
+
+	const bool isSrgb = ( image.info.fmt == IMAGE_FMT_RGBA_8 );
+
+	if ( image.usage == IMAGE_USAGE_NORMAL ) {
+		return IMAGE_FMT_BC5; // Shaders rebuild Z from XY
+	}
+
+	bool isOpaque = true;
+	bool isGrayscale = true;
+
+	const uint32_t layers = image.cpuImage->GetLayers();
+	for ( uint32_t layer = 0; layer < layers; ++layer )
+	{
+		const slice_t slice = image.cpuImage->GetSlice( layer, 0 );
+		const rgba8_t* texels = reinterpret_cast<const rgba8_t*>( slice.ptr );
+
+		const uint32_t texelCount = slice.width * slice.height;
+		for ( uint32_t i = 0; i < texelCount; ++i )
+		{
+			const rgba8_t& texel = texels[ i ];
+			isOpaque = isOpaque && ( texel.vec[ RGBA_A ] == 255 );
+			isGrayscale = isGrayscale && ( texel.vec[ RGBA_R ] == texel.vec[ RGBA_G ] ) && ( texel.vec[ RGBA_G ] == texel.vec[ RGBA_B ] );
+		}
+	}
+
+	if ( image.usage == IMAGE_USAGE_MASK ) {
+		return isGrayscale ? IMAGE_FMT_BC4 : IMAGE_FMT_BC1_UNORM;
+	}
+
+	if ( isOpaque ) {
+		return isSrgb ? IMAGE_FMT_BC1 : IMAGE_FMT_BC1_UNORM;
+	}
+	return isSrgb ? IMAGE_FMT_BC3 : IMAGE_FMT_BC3_UNORM;
+}
+
+
+bool CompressImage( Image& image, const imageFmt_t fmt, const bcQuality_t quality )
+{
+	if ( ( image.cpuImage == nullptr ) || ( IsRgba8( image.info.fmt ) == false ) || ( IsBlockCompressed( fmt ) == false ) ) {
+		return false;
+	}
+
+	ImageBufferInterface* srcImage = image.cpuImage;
+	GenerateMipChain( *srcImage );
+
+	imageInfo_t info = image.info;
+	info.fmt = fmt;
+
+	const samplerState_t sampler = image.sampler;
+
+	image.cpuImage = nullptr;
+	image.Create( info );
+	image.sampler = sampler;
+	image.generateMips = false;
+
+	const bcFormat_t blockFmt = BlockFormat( fmt );
+	const uint32_t mipCount = Min( srcImage->GetMipCount(), image.cpuImage->GetMipCount() );
+	const uint32_t layers = Min( srcImage->GetLayers(), image.cpuImage->GetLayers() );
+
+	for ( uint32_t mip = 0; mip < mipCount; ++mip )
+	{
+		for ( uint32_t layer = 0; layer < layers; ++layer )
+		{
+			const slice_t src = srcImage->GetSlice( layer, mip );
+			const slice_t dst = image.cpuImage->GetSlice( layer, mip );
+			EncodeSurface( reinterpret_cast<const rgba8_t*>( src.ptr ), src.width, src.height, blockFmt, quality, dst.ptr );
+		}
+	}
+
+	delete srcImage;
+	return true;
+}
+
+
+bool DecompressImage( Image& image )
+{
+	if ( ( image.cpuImage == nullptr ) || ( IsBlockCompressed( image.info.fmt ) == false ) ) {
+		return false;
+	}
+
+	ImageBufferInterface* srcImage = image.cpuImage;
+	const bcFormat_t blockFmt = BlockFormat( image.info.fmt );
+
+	imageInfo_t info = image.info;
+	info.fmt = ( ( info.fmt == IMAGE_FMT_BC1 ) || ( info.fmt == IMAGE_FMT_BC3 ) ) ? IMAGE_FMT_RGBA_8 : IMAGE_FMT_RGBA_8_UNORM;
+
+	const samplerState_t sampler = image.sampler;
+	const bool generateMips = image.generateMips;
+
+	image.cpuImage = nullptr;
+	image.Create( info );
+	image.sampler = sampler;
+	image.generateMips = generateMips;
+
+	const uint32_t mipCount = Min( srcImage->GetMipCount(), image.cpuImage->GetMipCount() );
+	const uint32_t layers = Min( srcImage->GetLayers(), image.cpuImage->GetLayers() );
+
+	for ( uint32_t mip = 0; mip < mipCount; ++mip )
+	{
+		for ( uint32_t layer = 0; layer < layers; ++layer )
+		{
+			const slice_t src = srcImage->GetSlice( layer, mip );
+			const slice_t dst = image.cpuImage->GetSlice( layer, mip );
+			DecodeSurface( src.ptr, dst.width, dst.height, blockFmt, reinterpret_cast<rgba8_t*>( dst.ptr ) );
+		}
+	}
+
+	delete srcImage;
+	return true;
+}
+
+
+template<typename T>
+static bool ResampleCpuImage( Image& image, const uint32_t width, const uint32_t height, const resampleSettings_t& settings )
+{
+	ImageBuffer<T>* resized = new ImageBuffer<T>();
+	if ( ResampleImage( *static_cast<const ImageBuffer<T>*>( image.cpuImage ), width, height, settings, *resized ) == false )
+	{
+		delete resized;
+		return false;
+	}
+
+	delete image.cpuImage;
+	image.cpuImage = resized;
+
+	image.info.width = width;
+	image.info.height = height;
+	image.info.mipLevels = resized->GetMipCount();
+	image.subResourceView.mipLevels = image.info.mipLevels;
+	return true;
+}
+
+
+bool ResampleImage( Image& image, const uint32_t width, const uint32_t height, const resampleFilter_t filter )
+{
+	if ( image.cpuImage == nullptr ) {
+		return false;
+	}
+
+	resampleSettings_t settings;
+	settings.filter = filter;
+	settings.srgb = ( image.info.fmt == IMAGE_FMT_RGBA_8 ) || ( image.info.fmt == IMAGE_FMT_RGB_8 );
+	settings.alphaWeighted = ( image.usage == IMAGE_USAGE_COLOR );
+
+	switch ( image.info.fmt )
+	{
+		case IMAGE_FMT_R_8:				return ResampleCpuImage<uint8_t>( image, width, height, settings );
+		case IMAGE_FMT_R_16:			return ResampleCpuImage<uint16_t>( image, width, height, settings );
+		case IMAGE_FMT_R_32:			return ResampleCpuImage<float>( image, width, height, settings );
+		case IMAGE_FMT_RGB_8:			return ResampleCpuImage<rgb8_t>( image, width, height, settings );
+		case IMAGE_FMT_RGBA_8:
+		case IMAGE_FMT_RGBA_8_UNORM:	return ResampleCpuImage<rgba8_t>( image, width, height, settings );
+		case IMAGE_FMT_RGB_16:			return ResampleCpuImage<rgb16_t>( image, width, height, settings );
+		case IMAGE_FMT_RGBA_16:			return ResampleCpuImage<rgba16_t>( image, width, height, settings );
+		default:						return false;
+	}
+}
+
+
 bool ImageLoader::Load( Asset<Image>& imageAsset )
 {
 	Image& image = imageAsset.Get();
 
 	image.sampler = m_sampler;
+	image.usage = m_usage;
 
 	bakedAssetInfo_t info = {};
 	
@@ -209,6 +442,12 @@ void ImageLoader::LoadAsLinear( const bool isLinear )
 }
 
 
+void ImageLoader::SetUsage( const imageUsage_t usage )
+{
+	m_usage = usage;
+}
+
+
 bool BakedImageLoader::Load( Asset<Image>& imageAsset )
 {
 	Image& image = imageAsset.Get();
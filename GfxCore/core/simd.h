@@ -0,0 +1,165 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+
+// Define GFX_FORCE_SCALAR to compile out every SIMD path for reference comparisons
+#if !defined( GFX_FORCE_SCALAR ) && ( defined( _M_X64 ) || defined( _M_IX86 ) || defined( __x86_64__ ) || defined( __i386__ ) )
+#define GFX_SIMD_SSE 1
+#endif
+
+#if defined( GFX_SIMD_SSE )
+#include <immintrin.h>
+#if defined( _MSC_VER )
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// MSVC exposes all intrinsics unconditionally, GCC/Clang need per-function targets
+#if defined( GFX_SIMD_SSE ) && !defined( _MSC_VER )
+#define GFX_TARGET_SSE41 __attribute__( ( target( "sse4.1" ) ) )
+#define GFX_TARGET_F16C __attribute__( ( target( "avx,f16c" ) ) )
+#define GFX_TARGET_AVX2 __attribute__( ( target( "avx2,fma" ) ) )
+#else
+#define GFX_TARGET_SSE41
+#define GFX_TARGET_F16C
+#define GFX_TARGET_AVX2
+#endif
+
+// Set when the whole build already targets AVX/FMA ( /arch:AVX2 or -mavx2 -mfma ), inline math uses these without dispatch
+#if defined( GFX_SIMD_SSE ) && defined( __AVX__ )
+#define GFX_SIMD_AVX 1
+#endif
+
+#if defined( GFX_SIMD_SSE ) && ( defined( __FMA__ ) || ( defined( _MSC_VER ) && defined( __AVX2__ ) ) )
+#define GFX_SIMD_FMA 1
+#endif
+
+// Lets SIMD-backed functions stay constexpr: constant evaluation takes a scalar branch, runtime takes the intrinsics.
+// Without the builtin ( MSVC before 19.25, GCC before 9 ) those functions are runtime-only.
+#if defined( __has_builtin )
+#if __has_builtin( __builtin_is_constant_evaluated )
+#define GFX_HAS_CONSTANT_EVALUATED 1
+#endif
+#elif defined( _MSC_VER ) && ( _MSC_VER >= 1925 )
+#define GFX_HAS_CONSTANT_EVALUATED 1
+#elif defined( __GNUC__ ) && ( __GNUC__ >= 9 )
+#define GFX_HAS_CONSTANT_EVALUATED 1
+#endif
+
+#if defined( GFX_HAS_CONSTANT_EVALUATED )
+#define GFX_CONSTEXPR constexpr
+
+constexpr inline bool IsConstantEvaluated()
+{
+	return __builtin_is_constant_evaluated();
+}
+#else
+#define GFX_CONSTEXPR
+
+inline bool IsConstantEvaluated()
+{
+	return false;
+}
+#endif
+
+
+struct cpuFeatures_t
+{
+	bool	sse41;
+	bool	avx;
+	bool	avx2;
+	bool	fma;
+	bool	f16c;
+};
+
+
+inline cpuFeatures_t QueryCpuFeatures()
+{
+	cpuFeatures_t features {};
+#if defined( GFX_SIMD_SSE )
+	uint32_t regs[ 4 ] = {};	// eax, ebx, ecx, edx
+	uint32_t maxLeaf = 0;
+
+#if defined( _MSC_VER )
+	int info[ 4 ];
+	__cpuid( info, 0 );
+	maxLeaf = static_cast<uint32_t>( info[ 0 ] );
+	__cpuid( info, 1 );
+	for ( uint32_t i = 0; i < 4; ++i ) {
+		regs[ i ] = static_cast<uint32_t>( info[ i ] );
+	}
+#else
+	uint32_t unused;
+	__get_cpuid( 0, &maxLeaf, &unused, &unused, &unused );
+	__get_cpuid( 1, &regs[ 0 ], &regs[ 1 ], &regs[ 2 ], &regs[ 3 ] );
+#endif
+
+	features.sse41 = ( regs[ 2 ] & ( 1 << 19 ) ) != 0;
+
+	// AVX state must also be enabled by the OS
+	const bool osxsave = ( regs[ 2 ] & ( 1 << 27 ) ) != 0;
+	bool osAvx = false;
+	if ( osxsave )
+	{
+#if defined( _MSC_VER )
+		const uint64_t xcr0 = _xgetbv( 0 );
+#else
+		uint32_t xcrLo, xcrHi;
+		__asm__ volatile( "xgetbv" : "=a"( xcrLo ), "=d"( xcrHi ) : "c"( 0 ) );
+		const uint64_t xcr0 = ( static_cast<uint64_t>( xcrHi ) << 32 ) | xcrLo;
+#endif
+		osAvx = ( xcr0 & 0x6 ) == 0x6;
+	}
+
+	features.avx = osAvx && ( ( regs[ 2 ] & ( 1 << 28 ) ) != 0 );
+	features.fma = features.avx && ( ( regs[ 2 ] & ( 1 << 12 ) ) != 0 );
+	features.f16c = features.avx && ( ( regs[ 2 ] & ( 1 << 29 ) ) != 0 );
+
+	if ( maxLeaf >= 7 )
+	{
+#if defined( _MSC_VER )
+		__cpuidex( info, 7, 0 );
+		const uint32_t ebx = static_cast<uint32_t>( info[ 1 ] );
+#else
+		uint32_t eax, ebx, ecx, edx;
+		__get_cpuid_count( 7, 0, &eax, &ebx, &ecx, &edx );
+#endif
+		features.avx2 = features.avx && ( ( ebx & ( 1 << 5 ) ) != 0 );
+	}
+#endif
+	return features;
+}
+
+
+// Queried once, safe to call from any thread after static init
+inline const cpuFeatures_t& GetCpuFeatures()
+{
+	static const cpuFeatures_t features = QueryCpuFeatures();
+	return features;
+}
@@ -26,117 +26,87 @@
 #include "../core/common.h"
 #include "../math/vector.h"
 #include "../math/matrix.h"
+#include "../math/fastmath.h"
 #include "../image/color.h"
 #include "../image/bitmap.h"
 #include "../image/image.h"
-
-union packFp16_t
-{
-	struct fp16_t
-	{
-		uint16_t	mantissa	: 10;
-		uint16_t	exp			: 5;
-		uint16_t	sign		: 1;
-	} fp;
-	uint16_t    u;
-};
-
-union packFp32_t
-{
-	struct fp32_t
-	{
-		uint32_t	mantissa	: 23;
-		uint32_t	exp			: 8;
-		uint32_t	sign		: 1;
-	} fp;
-	uint32_t    u;
-	float       f;
-};
+#include "../image/tonemap.h"
+#include "../math/half.h"
 
 
-inline uint16_t PackFloat32( const float unpacked )
+// The precision policy at runtime, the constexpr series during constant evaluation
+GFX_CONSTEXPR inline float RotationSin( const float theta )
 {
-	packFp32_t full;
-	packFp16_t half;
-
-	full.f = unpacked;
-
-	half.fp.sign = full.fp.sign;
-	if ( full.fp.exp > 0x70 ) {
-		half.fp.exp = ( full.fp.exp - 0x70 ); // Implicitly clamps to INF
-	} else {
-		half.fp.exp = 0; // Flush denormals
-	}
-	half.fp.mantissa = full.fp.mantissa >> 13; // Don't round up
-	
-	return half.u;
+	return IsConstantEvaluated() ? ConstSin( theta ) : mathDefault_t::Sin( theta );
 }
 
 
-inline float UnpackFloat32( const uint16_t packed )
+GFX_CONSTEXPR inline float RotationCos( const float theta )
 {
-	packFp32_t full;
-	packFp16_t half;
-
-	half.u = packed;
+	return IsConstantEvaluated() ? ConstCos( theta ) : mathDefault_t::Cos( theta );
+}
 
-	full.u = 0;
 
-	if ( full.fp.exp > 0x0F ) {
-		full.fp.exp = 0xFF; // INF
+GFX_CONSTEXPR inline void RotationSinCos( const vec3f& theta, vec3f& outSin, vec3f& outCos )
+{
+	if ( IsConstantEvaluated() )
+	{
+		for ( size_t i = 0; i < 3; ++i )
+		{
+			outSin[ i ] = ConstSin( theta[ i ] );
+			outCos[ i ] = ConstCos( theta[ i ] );
+		}
 	}
-	else if ( full.fp.exp > 0 )
+	else
 	{
-		full.fp.sign = half.fp.sign;
-		full.fp.exp = half.fp.exp + 0x70;
-		full.fp.mantissa = uint32_t( half.fp.mantissa ) << 13;
+		mathDefault_t::SinCos( theta, outSin, outCos );
 	}
 }
 
 
-inline mat4x4f ComputeRotationX( const float degrees )
+GFX_CONSTEXPR inline mat4x4f ComputeRotationX( const float degrees )
 {
 	const float theta = Radians( degrees );
-	return CreateMatrix4x4( 1.0f,	0.0f,			0.0f,			0.0f,
-							0.0f,	cos( theta ),	-sin( theta ),	0.0f,
-							0.0f,	sin( theta ),	cos( theta ),	0.0f,
-							0.0f,	0.0f,			0.0f,			1.0f );
+	return CreateMatrix4x4( 1.0f,	0.0f,					0.0f,					0.0f,
+							0.0f,	RotationCos( theta ),	-RotationSin( theta ),	0.0f,
+							0.0f,	RotationSin( theta ),	RotationCos( theta ),	0.0f,
+							0.0f,	0.0f,					0.0f,					1.0f );
 }
 
 
-inline mat4x4f ComputeRotationY( const float degrees )
+GFX_CONSTEXPR inline mat4x4f ComputeRotationY( const float degrees )
 {
 	const float theta = Radians( degrees );
-	return CreateMatrix4x4( cos( theta ),	0.0f,	sin( theta ),	0.0f,
-							0.0f,			1.0f,	0.0f,			0.0f,
-							-sin( theta ),	0.0f,	cos( theta ),	0.0f,
-							0.0f,			0.0f,	0.0f,			1.0f );
+	return CreateMatrix4x4( RotationCos( theta ),	0.0f,	RotationSin( theta ),	0.0f,
+							0.0f,					1.0f,	0.0f,					0.0f,
+							-RotationSin( theta ),	0.0f,	RotationCos( theta ),	0.0f,
+							0.0f,					0.0f,	0.0f,					1.0f );
 }
 
 
-inline mat4x4f ComputeRotationZ( const float degrees )
+GFX_CONSTEXPR inline mat4x4f ComputeRotationZ( const float degrees )
 {
 	const float theta = Radians( degrees );
-	return CreateMatrix4x4( cos( theta ),	-sin( theta ),	0.0f, 0.0f,
-							sin( theta ),	cos( theta ),	0.0f, 0.0f,
-							0.0f,			0.0f,			1.0f, 0.0f,
-							0.0f,			0.0f,			0.0f, 1.0f );
+	return CreateMatrix4x4( RotationCos( theta ),	-RotationSin( theta ),	0.0f, 0.0f,
+							RotationSin( theta ),	RotationCos( theta ),	0.0f, 0.0f,
+							0.0f,					0.0f,					1.0f, 0.0f,
+							0.0f,					0.0f,					0.0f, 1.0f );
 }
 
 
-inline mat4x4f ComputeRotationZYX( const float xDegrees, const float yDegrees, const float zDegrees )
+GFX_CONSTEXPR inline mat4x4f ComputeRotationZYX( const float xDegrees, const float yDegrees, const float zDegrees )
 {
-	const float alpha = Radians( xDegrees );
-	const float beta = Radians( yDegrees );
-	const float gamma = Radians( zDegrees );
+	vec3f sinAngles;
+	vec3f cosAngles;
+	RotationSinCos( vec3f( Radians( xDegrees ), Radians( yDegrees ), Radians( zDegrees ) ), sinAngles, cosAngles );
 
-	const float cosAlpha = cos( alpha );
-	const float cosBeta = cos( beta );
-	const float cosGamma = cos( gamma );
+	const float cosAlpha = cosAngles[ 0 ];
+	const float cosBeta = cosAngles[ 1 ];
+	const float cosGamma = cosAngles[ 2 ];
 
-	const float sinAlpha = sin( alpha );
-	const float sinBeta = sin( beta );
-	const float sinGamma = sin( gamma );
+	const float sinAlpha = sinAngles[ 0 ];
+	const float sinBeta = sinAngles[ 1 ];
+	const float sinGamma = sinAngles[ 2 ];
 
 	return CreateMatrix4x4( cosBeta * cosGamma,		sinAlpha * sinBeta * cosGamma - cosAlpha * sinGamma,	cosAlpha * sinBeta * cosGamma + sinAlpha * sinGamma,	0.0f,
 							cosBeta * sinGamma,		sinAlpha * sinBeta * sinGamma + cosAlpha * cosGamma,	cosAlpha * sinBeta * sinGamma - sinAlpha * cosGamma,	0.0f,
@@ -145,7 +115,7 @@ inline mat4x4f ComputeRotationZYX( const float xDegrees, const float yDegrees, c
 }
 
 
-inline void SetTranslation( mat4x4f& inoutMatrix, const vec3f& translation )
+constexpr inline void SetTranslation( mat4x4f& inoutMatrix, const vec3f& translation )
 {
 	inoutMatrix[ 0 ][ 3 ] = translation[ 0 ];
 	inoutMatrix[ 1 ][ 3 ] = translation[ 1 ];
@@ -154,7 +124,7 @@ inline void SetTranslation( mat4x4f& inoutMatrix, const vec3f& translation )
 }
 
 
-inline mat4x4f ComputeScale( const vec3f& scale )
+constexpr inline mat4x4f ComputeScale( const vec3f& scale )
 {
 	mat4x4f mat;
 	mat[ 0 ][ 0 ] = scale[ 0 ];
@@ -172,51 +142,59 @@ static inline void BitmapToImage( const Bitmap& bitmap, ImageBuffer<Color>& imag
 	const uint32_t srcWidth = bitmap.GetWidth();
 	const uint32_t srcHeight = bitmap.GetHeight();
 
-	const int32_t dstWidth = static_cast<int32_t>( std::min( srcWidth, image.GetWidth() ) );
-	const int32_t dstHeight = static_cast<int32_t>( std::min( srcHeight, image.GetHeight() ) );
+	const uint32_t dstWidth = std::min( srcWidth, image.GetWidth() );
+	const uint32_t dstHeight = std::min( srcHeight, image.GetHeight() );
+
+	const rgba8_t* src = bitmap.GetPixels();
+	Color* dst = reinterpret_cast<Color*>( image.GetSlice( 0, 0 ).ptr );
 
-	for ( int32_t y = 0; y < dstHeight; ++y )
+	for ( uint32_t y = 0; y < dstHeight; ++y )
 	{
-		for ( int32_t x = 0; x < dstWidth; ++x )
-		{
-			const uint32_t r8g8b8a8 = bitmap.GetPixel( x, y );
-			image.SetPixel( x, y, Color( r8g8b8a8 ) );
+		for ( uint32_t x = 0; x < dstWidth; ++x ) {
+			dst[ y * image.GetWidth() + x ] = Color( src[ y * srcWidth + x ] );
 		}
 	}
 }
 
 
+// Bitmaps store the same rgba8_t layout, so this is a row copy. Wrap the buffer with Bitmap( image ) to skip it entirely.
 static inline void ImageToBitmap( const ImageBuffer<rgba8_t>& image, Bitmap& bitmap )
 {
-	bitmap.ClearImage( Color::Black );
+	const uint32_t width = std::min( image.GetWidth(), bitmap.GetWidth() );
+	const uint32_t height = std::min( image.GetHeight(), bitmap.GetHeight() );
 
-	const int32_t width = static_cast<int32_t>( std::min( image.GetWidth(), bitmap.GetWidth() ) );
-	const int32_t height = static_cast<int32_t>( std::min( image.GetHeight(), bitmap.GetHeight() ) );
+	const rgba8_t* src = reinterpret_cast<const rgba8_t*>( image.GetSlice( 0, 0 ).ptr );
+	rgba8_t* dst = bitmap.GetPixels();
+	if ( src == dst ) {
+		return;
+	}
 
-	for ( int32_t y = 0; y < height; ++y )
-	{
-		for ( int32_t x = 0; x < width; ++x )
-		{
-			rgba8_t color = image.GetPixel( x, y );
-			bitmap.SetPixel( x, y, color.hex );
-		}
+	if ( ( width < bitmap.GetWidth() ) || ( height < bitmap.GetHeight() ) ) {
+		bitmap.ClearImage( Color::Black );
+	}
+
+	for ( uint32_t y = 0; y < height; ++y ) {
+		memcpy( dst + y * bitmap.GetWidth(), src + y * image.GetWidth(), width * sizeof( rgba8_t ) );
 	}
 }
 
 
 static inline void ImageToBitmap( const ImageBuffer<Color>& image, Bitmap& bitmap )
 {
-	bitmap.ClearImage( Color::Black );
+	const uint32_t width = std::min( image.GetWidth(), bitmap.GetWidth() );
+	const uint32_t height = std::min( image.GetHeight(), bitmap.GetHeight() );
+
+	if ( ( width < bitmap.GetWidth() ) || ( height < bitmap.GetHeight() ) ) {
+		bitmap.ClearImage( Color::Black );
+	}
 
-	const int32_t width = static_cast<int32_t>( std::min( image.GetWidth(), bitmap.GetWidth() ) );
-	const int32_t height = static_cast<int32_t>( std::min( image.GetHeight(), bitmap.GetHeight() ) );
+	const Color* src = reinterpret_cast<const Color*>( image.GetSlice( 0, 0 ).ptr );
+	rgba8_t* dst = bitmap.GetPixels();
 
-	for ( int32_t y = 0; y < height; ++y )
+	for ( uint32_t y = 0; y < height; ++y )
 	{
-		for ( int32_t x = 0; x < width; ++x )
-		{
-			Color color = image.GetPixel( x, y );
-			bitmap.SetPixel( x, y, color.AsHex() );
+		for ( uint32_t x = 0; x < width; ++x ) {
+			dst[ y * bitmap.GetWidth() + x ] = src[ y * image.GetWidth() + x ].AsRgba8();
 		}
 	}
 }
@@ -232,17 +210,9 @@ static inline void ImageToBitmap( const ImageBuffer<float>& image, Bitmap& bitma
 	const int32_t width = std::min( srcWidth, static_cast<int32_t>( bitmap.GetWidth() ) );
 	const int32_t height = std::min( srcHeight, static_cast<int32_t>( bitmap.GetHeight() ) );
 
-	float minZ = FLT_MAX;
-	float maxZ = -FLT_MAX;
-	for ( int32_t y = 0; y < srcHeight; ++y )
-	{
-		for ( int32_t x = 0; x < srcWidth; ++x )
-		{
-			const float zValue = image.GetPixel( x, y );
-			minZ = std::min( minZ, zValue );
-			maxZ = std::max( maxZ, zValue );
-		}
-	}
+	float minZ;
+	float maxZ;
+	ComputeMinMax( image, minZ, maxZ );
 
 	for ( int32_t y = 0; y < height; ++y )
 	{
@@ -258,6 +228,38 @@ static inline void ImageToBitmap( const ImageBuffer<float>& image, Bitmap& bitma
 }
 
 
+static inline void ImageConvert( const ImageBuffer<rgba16_t>& from, ImageBuffer<Color>& to )
+{
+	imageBufferInfo_t info {};
+	info.width = from.GetWidth();
+	info.height = from.GetHeight();
+	info.layers = from.GetLayers();
+	info.mipCount = from.GetMipCount();
+	info.bpp = sizeof( Color );
+
+	to.Init( info, from.GetName() );
+
+	const uint32_t elementCount = from.GetByteCount() / sizeof( uint16_t );
+	UnpackFloat32( reinterpret_cast<const uint16_t*>( from.Ptr() ), reinterpret_cast<float*>( to.Ptr() ), elementCount );
+}
+
+
+static inline void ImageConvert( const ImageBuffer<Color>& from, ImageBuffer<rgba16_t>& to )
+{
+	imageBufferInfo_t info {};
+	info.width = from.GetWidth();
+	info.height = from.GetHeight();
+	info.layers = from.GetLayers();
+	info.mipCount = from.GetMipCount();
+	info.bpp = sizeof( rgba16_t );
+
+	to.Init( info, from.GetName() );
+
+	const uint32_t elementCount = from.GetByteCount() / sizeof( float );
+	PackFloat32( reinterpret_cast<const float*>( from.Ptr() ), reinterpret_cast<uint16_t*>( to.Ptr() ), elementCount );
+}
+
+
 static inline Color Vec3ToColor( const vec3f& v )
 {
 	return Color( static_cast<float>( v[ 0 ] ), static_cast<float>( v[ 1 ] ), static_cast<float>( v[ 2 ] ), 1.0f );
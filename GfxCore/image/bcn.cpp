@@ -0,0 +1,620 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "bcn.h"
+#include <cfloat>
+#include <utility>
+#include "../core/parallel.h"
+
+struct colorBlock_t
+{
+	float	rgb[ BcBlockTexels ][ 3 ];
+};
+
+
+static inline uint16_t PackRgb565( const float rgb[ 3 ] )
+{
+	const uint32_t r = static_cast<uint32_t>( Clamp( rgb[ 0 ], 0.0f, 255.0f ) * ( 31.0f / 255.0f ) + 0.5f );
+	const uint32_t g = static_cast<uint32_t>( Clamp( rgb[ 1 ], 0.0f, 255.0f ) * ( 63.0f / 255.0f ) + 0.5f );
+	const uint32_t b = static_cast<uint32_t>( Clamp( rgb[ 2 ], 0.0f, 255.0f ) * ( 31.0f / 255.0f ) + 0.5f );
+	return static_cast<uint16_t>( ( r << 11 ) | ( g << 5 ) | b );
+}
+
+
+static inline void UnpackRgb565( const uint16_t color, int32_t rgb[ 3 ] )
+{
+	const int32_t r = ( color >> 11 ) & 0x1F;
+	const int32_t g = ( color >> 5 ) & 0x3F;
+	const int32_t b = color & 0x1F;
+	rgb[ 0 ] = ( r << 3 ) | ( r >> 2 );
+	rgb[ 1 ] = ( g << 2 ) | ( g >> 4 );
+	rgb[ 2 ] = ( b << 3 ) | ( b >> 2 );
+}
+
+
+// Four colors when color0 > color1, otherwise three colors and transparent black. BC3 is always four colors.
+static bool ColorPalette( const uint16_t color0, const uint16_t color1, const bool forceFourColor, int32_t palette[ 4 ][ 3 ] )
+{
+	UnpackRgb565( color0, palette[ 0 ] );
+	UnpackRgb565( color1, palette[ 1 ] );
+
+	const bool fourColor = forceFourColor || ( color0 > color1 );
+	for ( uint32_t c = 0; c < 3; ++c )
+	{
+		if ( fourColor )
+		{
+			palette[ 2 ][ c ] = ( 2 * palette[ 0 ][ c ] + palette[ 1 ][ c ] ) / 3;
+			palette[ 3 ][ c ] = ( palette[ 0 ][ c ] + 2 * palette[ 1 ][ c ] ) / 3;
+		}
+		else
+		{
+			palette[ 2 ][ c ] = ( palette[ 0 ][ c ] + palette[ 1 ][ c ] ) / 2;
+			palette[ 3 ][ c ] = 0;
+		}
+	}
+	return fourColor;
+}
+
+
+// Picks the nearest four-color palette entry per texel, returns the summed squared error
+static float FitColorIndices( const colorBlock_t& colors, const uint16_t color0, const uint16_t color1, uint32_t& indices )
+{
+	int32_t palette[ 4 ][ 3 ];
+	ColorPalette( color0, color1, true, palette );
+
+	float error = 0.0f;
+	indices = 0;
+	for ( uint32_t i = 0; i < BcBlockTexels; ++i )
+	{
+		float bestDist = FLT_MAX;
+		uint32_t best = 0;
+		for ( uint32_t p = 0; p < 4; ++p )
+		{
+			const float dr = colors.rgb[ i ][ 0 ] - palette[ p ][ 0 ];
+			const float dg = colors.rgb[ i ][ 1 ] - palette[ p ][ 1 ];
+			const float db = colors.rgb[ i ][ 2 ] - palette[ p ][ 2 ];
+			const float dist = dr * dr + dg * dg + db * db;
+			if ( dist < bestDist )
+			{
+				bestDist = dist;
+				best = p;
+			}
+		}
+		indices |= best << ( 2 * i );
+		error += bestDist;
+	}
+	return error;
+}
+
+
+static void QuantizeEndpoints( const float endpoint0[ 3 ], const float endpoint1[ 3 ], uint16_t& color0, uint16_t& color1 )
+{
+	color0 = PackRgb565( endpoint0 );
+	color1 = PackRgb565( endpoint1 );
+
+	// Keep four-color mode, the palette order follows the swap since indices are fit afterwards
+	if ( color0 < color1 ) {
+		std::swap( color0, color1 );
+	}
+}
+
+
+// Least-squares endpoints for a fixed set of indices
+static bool RefineEndpoints( const colorBlock_t& colors, const uint32_t indices, float endpoint0[ 3 ], float endpoint1[ 3 ] )
+{
+	static const float weights[ 4 ] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+	float aa = 0.0f;
+	float bb = 0.0f;
+	float ab = 0.0f;
+	float ax[ 3 ] = { 0.0f, 0.0f, 0.0f };
+	float bx[ 3 ] = { 0.0f, 0.0f, 0.0f };
+
+	for ( uint32_t i = 0; i < BcBlockTexels; ++i )
+	{
+		const float a = weights[ ( indices >> ( 2 * i ) ) & 0x3 ];
+		const float b = 1.0f - a;
+
+		aa += a * a;
+		bb += b * b;
+		ab += a * b;
+		for ( uint32_t c = 0; c < 3; ++c )
+		{
+			ax[ c ] += a * colors.rgb[ i ][ c ];
+			bx[ c ] += b * colors.rgb[ i ][ c ];
+		}
+	}
+
+	const float det = aa * bb - ab * ab;
+	if ( fabs( det ) < 1e-6f ) {
+		return false;
+	}
+
+	const float invDet = 1.0f / det;
+	for ( uint32_t c = 0; c < 3; ++c )
+	{
+		endpoint0[ c ] = ( ax[ c ] * bb - bx[ c ] * ab ) * invDet;
+		endpoint1[ c ] = ( bx[ c ] * aa - ax[ c ] * ab ) * invDet;
+	}
+	return true;
+}
+
+
+static void EncodeColorBlock( const rgba8_t texels[ BcBlockTexels ], const bcQuality_t quality, bc1Block_t& block )
+{
+	colorBlock_t colors;
+	float mean[ 3 ] = { 0.0f, 0.0f, 0.0f };
+	float minColor[ 3 ] = { 255.0f, 255.0f, 255.0f };
+	float maxColor[ 3 ] = { 0.0f, 0.0f, 0.0f };
+
+	for ( uint32_t i = 0; i < BcBlockTexels; ++i )
+	{
+		for ( uint32_t c = 0; c < 3; ++c )
+		{
+			const float value = texels[ i ].vec[ RGBA_R + c ];
+			colors.rgb[ i ][ c ] = value;
+			mean[ c ] += value;
+			minColor[ c ] = Min( minColor[ c ], value );
+			maxColor[ c ] = Max( maxColor[ c ], value );
+		}
+	}
+
+	for ( uint32_t c = 0; c < 3; ++c ) {
+		mean[ c ] /= BcBlockTexels;
+	}
+
+	float cov[ 3 ][ 3 ] = {};
+	for ( uint32_t i = 0; i < BcBlockTexels; ++i )
+	{
+		const float d[ 3 ] = { colors.rgb[ i ][ 0 ] - mean[ 0 ], colors.rgb[ i ][ 1 ] - mean[ 1 ], colors.rgb[ i ][ 2 ] - mean[ 2 ] };
+		for ( uint32_t r = 0; r < 3; ++r )
+		{
+			for ( uint32_t c = 0; c < 3; ++c ) {
+				cov[ r ][ c ] += d[ r ] * d[ c ];
+			}
+		}
+	}
+
+	// Start from the box diagonal, oriented by how the other channels vary with the widest one
+	float axis[ 3 ] = { maxColor[ 0 ] - minColor[ 0 ], maxColor[ 1 ] - minColor[ 1 ], maxColor[ 2 ] - minColor[ 2 ] };
+	uint32_t widest = 0;
+	for ( uint32_t c = 1; c < 3; ++c ) {
+		widest = ( axis[ c ] > axis[ widest ] ) ? c : widest;
+	}
+	for ( uint32_t c = 0; c < 3; ++c )
+	{
+		if ( ( c != widest ) && ( cov[ widest ][ c ] < 0.0f ) ) {
+			axis[ c ] = -axis[ c ];
+		}
+	}
+
+	if ( quality != BC_QUALITY_FAST )
+	{
+		// Power iteration, converges on the principal axis in a few steps from a good start
+		for ( uint32_t iter = 0; iter < 4; ++iter )
+		{
+			float next[ 3 ];
+			for ( uint32_t r = 0; r < 3; ++r ) {
+				next[ r ] = cov[ r ][ 0 ] * axis[ 0 ] + cov[ r ][ 1 ] * axis[ 1 ] + cov[ r ][ 2 ] * axis[ 2 ];
+			}
+			const float scale = Max( fabs( next[ 0 ] ), Max( fabs( next[ 1 ] ), fabs( next[ 2 ] ) ) );
+			if ( scale < 1e-6f ) {
+				break;
+			}
+			for ( uint32_t c = 0; c < 3; ++c ) {
+				axis[ c ] = next[ c ] / scale;
+			}
+		}
+	}
+
+	float endpoint0[ 3 ] = { mean[ 0 ], mean[ 1 ], mean[ 2 ] };
+	float endpoint1[ 3 ] = { mean[ 0 ], mean[ 1 ], mean[ 2 ] };
+
+	const float axisLengthSq = axis[ 0 ] * axis[ 0 ] + axis[ 1 ] * axis[ 1 ] + axis[ 2 ] * axis[ 2 ];
+	if ( axisLengthSq > 1e-6f )
+	{
+		float tMin = FLT_MAX;
+		float tMax = -FLT_MAX;
+		for ( uint32_t i = 0; i < BcBlockTexels; ++i )
+		{
+			float t = 0.0f;
+			for ( uint32_t c = 0; c < 3; ++c ) {
+				t += ( colors.rgb[ i ][ c ] - mean[ c ] ) * axis[ c ];
+			}
+			t /= axisLengthSq;
+			tMin = Min( tMin, t );
+			tMax = Max( tMax, t );
+		}
+
+		// Extremes overshoot, pull the ends in so the interpolated colors land on the data
+		const float inset = ( tMax - tMin ) / 16.0f;
+		for ( uint32_t c = 0; c < 3; ++c )
+		{
+			endpoint0[ c ] = mean[ c ] + ( tMax - inset ) * axis[ c ];
+			endpoint1[ c ] = mean[ c ] + ( tMin + inset ) * axis[ c ];
+		}
+	}
+
+	uint16_t color0;
+	uint16_t color1;
+	QuantizeEndpoints( endpoint0, endpoint1, color0, color1 );
+
+	uint32_t indices;
+	float error = FitColorIndices( colors, color0, color1, indices );
+
+	if ( quality == BC_QUALITY_HIGH )
+	{
+		for ( uint32_t iter = 0; ( iter < 2 ) && ( error > 0.0f ); ++iter )
+		{
+			if ( RefineEndpoints( colors, indices, endpoint0, endpoint1 ) == false ) {
+				break;
+			}
+
+			uint16_t refined0;
+			uint16_t refined1;
+			QuantizeEndpoints( endpoint0, endpoint1, refined0, refined1 );
+
+			uint32_t refinedIndices;
+			const float refinedError = FitColorIndices( colors, refined0, refined1, refinedIndices );
+			if ( refinedError >= error ) {
+				break;
+			}
+
+			color0 = refined0;
+			color1 = refined1;
+			indices = refinedIndices;
+			error = refinedError;
+		}
+	}
+
+	block.color0 = color0;
+	block.color1 = color1;
+	block.indices = indices;
+}
+
+
+static void DecodeColorBlock( const bc1Block_t& block, const bool forceFourColor, rgba8_t texels[ BcBlockTexels ] )
+{
+	int32_t palette[ 4 ][ 3 ];
+	const bool fourColor = ColorPalette( block.color0, block.color1, forceFourColor, palette );
+
+	for ( uint32_t i = 0; i < BcBlockTexels; ++i )
+	{
+		const uint32_t index = ( block.indices >> ( 2 * i ) ) & 0x3;
+		texels[ i ].vec[ RGBA_R ] = static_cast<uint8_t>( palette[ index ][ 0 ] );
+		texels[ i ].vec[ RGBA_G ] = static_cast<uint8_t>( palette[ index ][ 1 ] );
+		texels[ i ].vec[ RGBA_B ] = static_cast<uint8_t>( palette[ index ][ 2 ] );
+		texels[ i ].vec[ RGBA_A ] = ( !fourColor && ( index == 3 ) ) ? 0 : 255;
+	}
+}
+
+
+// Eight values when value0 > value1, otherwise six values plus exact 0 and 255
+static void Bc4Palette( const uint8_t value0, const uint8_t value1, int32_t palette[ 8 ] )
+{
+	palette[ 0 ] = value0;
+	palette[ 1 ] = value1;
+
+	if ( value0 > value1 )
+	{
+		for ( int32_t k = 1; k < 7; ++k ) {
+			palette[ k + 1 ] = ( ( 7 - k ) * value0 + k * value1 + 3 ) / 7;
+		}
+	}
+	else
+	{
+		for ( int32_t k = 1; k < 5; ++k ) {
+			palette[ k + 1 ] = ( ( 5 - k ) * value0 + k * value1 + 2 ) / 5;
+		}
+		palette[ 6 ] = 0;
+		palette[ 7 ] = 255;
+	}
+}
+
+
+static uint32_t FitBc4Indices( const uint8_t values[ BcBlockTexels ], const uint8_t value0, const uint8_t value1, uint64_t& indices )
+{
+	int32_t palette[ 8 ];
+	Bc4Palette( value0, value1, palette );
+
+	uint32_t error = 0;
+	indices = 0;
+	for ( uint32_t i = 0; i < BcBlockTexels; ++i )
+	{
+		int32_t bestDist = INT32_MAX;
+		uint64_t best = 0;
+		for ( uint32_t p = 0; p < 8; ++p )
+		{
+			const int32_t d = values[ i ] - palette[ p ];
+			if ( d * d < bestDist )
+			{
+				bestDist = d * d;
+				best = p;
+			}
+		}
+		indices |= best << ( 3 * i );
+		error += bestDist;
+	}
+	return error;
+}
+
+
+void EncodeBC4( const uint8_t values[ BcBlockTexels ], const bcQuality_t quality, bc4Block_t& block )
+{
+	uint8_t minValue = 255;
+	uint8_t maxValue = 0;
+	uint8_t minInner = 255;
+	uint8_t maxInner = 0;
+
+	for ( uint32_t i = 0; i < BcBlockTexels; ++i )
+	{
+		minValue = Min( minValue, values[ i ] );
+		maxValue = Max( maxValue, values[ i ] );
+		if ( ( values[ i ] != 0 ) && ( values[ i ] != 255 ) )
+		{
+			minInner = Min( minInner, values[ i ] );
+			maxInner = Max( maxInner, values[ i ] );
+		}
+	}
+
+	uint8_t value0 = maxValue;
+	uint8_t value1 = minValue;
+	uint64_t indices = 0;
+	uint32_t error = ( minValue == maxValue ) ? 0 : FitBc4Indices( values, value0, value1, indices );
+
+	if ( ( error > 0 ) && ( quality == BC_QUALITY_HIGH ) )
+	{
+		// Insetting the ends moves more of the interpolants onto the data
+		for ( uint8_t inset0 = 0; inset0 < 4; ++inset0 )
+		{
+			for ( uint8_t inset1 = 0; inset1 < 4; ++inset1 )
+			{
+				const int32_t v0 = maxValue - inset0;
+				const int32_t v1 = minValue + inset1;
+				if ( ( ( inset0 | inset1 ) == 0 ) || ( v0 <= v1 ) ) {
+					continue;
+				}
+
+				uint64_t insetIndices;
+				const uint32_t insetError = FitBc4Indices( values, uint8_t( v0 ), uint8_t( v1 ), insetIndices );
+				if ( insetError < error )
+				{
+					value0 = uint8_t( v0 );
+					value1 = uint8_t( v1 );
+					indices = insetIndices;
+					error = insetError;
+				}
+			}
+		}
+	}
+
+	// Six value mode keeps exact 0 and 255, which suits masks with hard edges
+	const bool hasExtremes = ( minValue == 0 ) || ( maxValue == 255 );
+	if ( ( error > 0 ) && ( ( quality == BC_QUALITY_HIGH ) || ( ( quality == BC_QUALITY_NORMAL ) && hasExtremes ) ) )
+	{
+		const uint8_t v0 = ( minInner <= maxInner ) ? minInner : 0;
+		const uint8_t v1 = ( minInner <= maxInner ) ? maxInner : 255;
+
+		uint64_t sixIndices;
+		const uint32_t sixError = FitBc4Indices( values, v0, v1, sixIndices );
+		if ( sixError < error )
+		{
+			value0 = v0;
+			value1 = v1;
+			indices = sixIndices;
+			error = sixError;
+		}
+	}
+
+	block.value0 = value0;
+	block.value1 = value1;
+	for ( uint32_t b = 0; b < 6; ++b ) {
+		block.indices[ b ] = static_cast<uint8_t>( indices >> ( 8 * b ) );
+	}
+}
+
+
+void DecodeBC4( const bc4Block_t& block, uint8_t values[ BcBlockTexels ] )
+{
+	int32_t palette[ 8 ];
+	Bc4Palette( block.value0, block.value1, palette );
+
+	uint64_t indices = 0;
+	for ( uint32_t b = 0; b < 6; ++b ) {
+		indices |= uint64_t( block.indices[ b ] ) << ( 8 * b );
+	}
+
+	for ( uint32_t i = 0; i < BcBlockTexels; ++i ) {
+		values[ i ] = static_cast<uint8_t>( palette[ ( indices >> ( 3 * i ) ) & 0x7 ] );
+	}
+}
+
+
+void EncodeBC1( const rgba8_t texels[ BcBlockTexels ], const bcQuality_t quality, bc1Block_t& block )
+{
+	EncodeColorBlock( texels, quality, block );
+}
+
+
+void EncodeBC3( const rgba8_t texels[ BcBlockTexels ], const bcQuality_t quality, bc3Block_t& block )
+{
+	uint8_t alpha[ BcBlockTexels ];
+	for ( uint32_t i = 0; i < BcBlockTexels; ++i ) {
+		alpha[ i ] = texels[ i ].vec[ RGBA_A ];
+	}
+
+	EncodeBC4( alpha, quality, block.alpha );
+	EncodeColorBlock( texels, quality, block.color );
+}
+
+
+void EncodeBC5( const rgba8_t texels[ BcBlockTexels ], const bcQuality_t quality, bc5Block_t& block )
+{
+	uint8_t red[ BcBlockTexels ];
+	uint8_t green[ BcBlockTexels ];
+	for ( uint32_t i = 0; i < BcBlockTexels; ++i )
+	{
+		red[ i ] = texels[ i ].vec[ RGBA_R ];
+		green[ i ] = texels[ i ].vec[ RGBA_G ];
+	}
+
+	EncodeBC4( red, quality, block.red );
+	EncodeBC4( green, quality, block.green );
+}
+
+
+void DecodeBC1( const bc1Block_t& block, rgba8_t texels[ BcBlockTexels ] )
+{
+	DecodeColorBlock( block, false, texels );
+}
+
+
+void DecodeBC3( const bc3Block_t& block, rgba8_t texels[ BcBlockTexels ] )
+{
+	uint8_t alpha[ BcBlockTexels ];
+	DecodeBC4( block.alpha, alpha );
+	DecodeColorBlock( block.color, true, texels );
+
+	for ( uint32_t i = 0; i < BcBlockTexels; ++i ) {
+		texels[ i ].vec[ RGBA_A ] = alpha[ i ];
+	}
+}
+
+
+void DecodeBC5( const bc5Block_t& block, rgba8_t texels[ BcBlockTexels ] )
+{
+	uint8_t red[ BcBlockTexels ];
+	uint8_t green[ BcBlockTexels ];
+	DecodeBC4( block.red, red );
+	DecodeBC4( block.green, green );
+
+	for ( uint32_t i = 0; i < BcBlockTexels; ++i )
+	{
+		texels[ i ].vec[ RGBA_R ] = red[ i ];
+		texels[ i ].vec[ RGBA_G ] = green[ i ];
+		texels[ i ].vec[ RGBA_B ] = 0;
+		texels[ i ].vec[ RGBA_A ] = 255;
+	}
+}
+
+
+static void EncodeBlock( const rgba8_t tile[ BcBlockTexels ], const bcFormat_t fmt, const bcQuality_t quality, uint8_t* block )
+{
+	switch ( fmt )
+	{
+		case BC_FORMAT_BC1: EncodeBC1( tile, quality, *reinterpret_cast<bc1Block_t*>( block ) ); break;
+		case BC_FORMAT_BC3: EncodeBC3( tile, quality, *reinterpret_cast<bc3Block_t*>( block ) ); break;
+		case BC_FORMAT_BC5: EncodeBC5( tile, quality, *reinterpret_cast<bc5Block_t*>( block ) ); break;
+		case BC_FORMAT_BC4:
+		{
+			uint8_t values[ BcBlockTexels ];
+			for ( uint32_t i = 0; i < BcBlockTexels; ++i ) {
+				values[ i ] = tile[ i ].vec[ RGBA_R ];
+			}
+			EncodeBC4( values, quality, *reinterpret_cast<bc4Block_t*>( block ) );
+		} break;
+		default: assert( 0 );
+	}
+}
+
+
+static void DecodeBlock( const uint8_t* block, const bcFormat_t fmt, rgba8_t tile[ BcBlockTexels ] )
+{
+	switch ( fmt )
+	{
+		case BC_FORMAT_BC1: DecodeBC1( *reinterpret_cast<const bc1Block_t*>( block ), tile ); break;
+		case BC_FORMAT_BC3: DecodeBC3( *reinterpret_cast<const bc3Block_t*>( block ), tile ); break;
+		case BC_FORMAT_BC5: DecodeBC5( *reinterpret_cast<const bc5Block_t*>( block ), tile ); break;
+		case BC_FORMAT_BC4:
+		{
+			uint8_t values[ BcBlockTexels ];
+			DecodeBC4( *reinterpret_cast<const bc4Block_t*>( block ), values );
+			for ( uint32_t i = 0; i < BcBlockTexels; ++i )
+			{
+				tile[ i ].hex = 0;
+				tile[ i ].vec[ RGBA_R ] = values[ i ];
+				tile[ i ].vec[ RGBA_A ] = 255;
+			}
+		} break;
+		default: assert( 0 );
+	}
+}
+
+
+void EncodeSurface( const rgba8_t* texels, const uint32_t width, const uint32_t height, const bcFormat_t fmt, const bcQuality_t quality, uint8_t* blocks )
+{
+	const uint32_t blocksX = BcBlockCount( width );
+	const uint32_t blocksY = BcBlockCount( height );
+	const uint32_t blockBytes = BcBlockBytes( fmt );
+
+	ParallelFor( blocksY, 4, [&]( const uint32_t begin, const uint32_t end )
+	{
+		rgba8_t tile[ BcBlockTexels ];
+		for ( uint32_t by = begin; by < end; ++by )
+		{
+			for ( uint32_t bx = 0; bx < blocksX; ++bx )
+			{
+				for ( uint32_t y = 0; y < BcBlockDim; ++y )
+				{
+					const uint32_t sy = Min( by * BcBlockDim + y, height - 1 );
+					for ( uint32_t x = 0; x < BcBlockDim; ++x )
+					{
+						const uint32_t sx = Min( bx * BcBlockDim + x, width - 1 );
+						tile[ y * BcBlockDim + x ] = texels[ sy * width + sx ];
+					}
+				}
+				EncodeBlock( tile, fmt, quality, blocks + ( by * blocksX + bx ) * blockBytes );
+			}
+		}
+	} );
+}
+
+
+void DecodeSurface( const uint8_t* blocks, const uint32_t width, const uint32_t height, const bcFormat_t fmt, rgba8_t* texels )
+{
+	const uint32_t blocksX = BcBlockCount( width );
+	const uint32_t blocksY = BcBlockCount( height );
+	const uint32_t blockBytes = BcBlockBytes( fmt );
+
+	ParallelFor( blocksY, 16, [&]( const uint32_t begin, const uint32_t end )
+	{
+		rgba8_t tile[ BcBlockTexels ];
+		for ( uint32_t by = begin; by < end; ++by )
+		{
+			for ( uint32_t bx = 0; bx < blocksX; ++bx )
+			{
+				DecodeBlock( blocks + ( by * blocksX + bx ) * blockBytes, fmt, tile );
+
+				const uint32_t rows = Min( BcBlockDim, height - by * BcBlockDim );
+				const uint32_t cols = Min( BcBlockDim, width - bx * BcBlockDim );
+				for ( uint32_t y = 0; y < rows; ++y )
+				{
+					for ( uint32_t x = 0; x < cols; ++x ) {
+						texels[ ( by * BcBlockDim + y ) * width + bx * BcBlockDim + x ] = tile[ y * BcBlockDim + x ];
+					}
+				}
+			}
+		}
+	} );
+}
@@ -0,0 +1,108 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include "color.h"
+
+// Block compression (BC1/3/4/5). Blocks cover 4x4 texels, images are stored as rows of blocks.
+// Channels are read in memory order (RGBA_R first), the same order the GPU sees.
+
+static const uint32_t BcBlockDim = 4;
+static const uint32_t BcBlockTexels = BcBlockDim * BcBlockDim;
+
+enum bcFormat_t : uint8_t
+{
+	BC_FORMAT_BC1,	// RGB, 8 bytes
+	BC_FORMAT_BC3,	// RGBA, 16 bytes
+	BC_FORMAT_BC4,	// R, 8 bytes
+	BC_FORMAT_BC5,	// RG, 16 bytes
+};
+
+enum bcQuality_t : uint8_t
+{
+	BC_QUALITY_FAST,	// Bounding box endpoints
+	BC_QUALITY_NORMAL,	// Principal axis endpoints
+	BC_QUALITY_HIGH,	// Principal axis with least-squares refinement
+};
+
+struct bc1Block_t
+{
+	uint16_t	color0;
+	uint16_t	color1;
+	uint32_t	indices;	// 2 bits per texel
+};
+
+struct bc4Block_t
+{
+	uint8_t		value0;
+	uint8_t		value1;
+	uint8_t		indices[ 6 ];	// 3 bits per texel
+};
+
+struct bc3Block_t
+{
+	bc4Block_t	alpha;
+	bc1Block_t	color;
+};
+
+struct bc5Block_t
+{
+	bc4Block_t	red;
+	bc4Block_t	green;
+};
+
+static_assert( sizeof( bc1Block_t ) == 8, "Unexpected BC1 block size" );
+static_assert( sizeof( bc3Block_t ) == 16, "Unexpected BC3 block size" );
+static_assert( sizeof( bc4Block_t ) == 8, "Unexpected BC4 block size" );
+static_assert( sizeof( bc5Block_t ) == 16, "Unexpected BC5 block size" );
+
+
+inline uint32_t BcBlockCount( const uint32_t texels )
+{
+	return ( texels + BcBlockDim - 1 ) / BcBlockDim;
+}
+
+
+inline uint32_t BcBlockBytes( const bcFormat_t fmt )
+{
+	return ( ( fmt == BC_FORMAT_BC1 ) || ( fmt == BC_FORMAT_BC4 ) ) ? 8 : 16;
+}
+
+
+void EncodeBC1( const rgba8_t texels[ BcBlockTexels ], const bcQuality_t quality, bc1Block_t& block );
+void EncodeBC3( const rgba8_t texels[ BcBlockTexels ], const bcQuality_t quality, bc3Block_t& block );
+void EncodeBC4( const uint8_t values[ BcBlockTexels ], const bcQuality_t quality, bc4Block_t& block );
+void EncodeBC5( const rgba8_t texels[ BcBlockTexels ], const bcQuality_t quality, bc5Block_t& block );
+
+// Decoders follow GPU conventions, missing channels read as 0 and alpha as 255
+void DecodeBC1( const bc1Block_t& block, rgba8_t texels[ BcBlockTexels ] );
+void DecodeBC3( const bc3Block_t& block, rgba8_t texels[ BcBlockTexels ] );
+void DecodeBC4( const bc4Block_t& block, uint8_t values[ BcBlockTexels ] );
+void DecodeBC5( const bc5Block_t& block, rgba8_t texels[ BcBlockTexels ] );
+
+// Whole surfaces, split across threads by block row. Partial edge blocks replicate the last row/column.
+void EncodeSurface( const rgba8_t* texels, const uint32_t width, const uint32_t height, const bcFormat_t fmt, const bcQuality_t quality, uint8_t* blocks );
+void DecodeSurface( const uint8_t* blocks, const uint32_t width, const uint32_t height, const bcFormat_t fmt, rgba8_t* texels );
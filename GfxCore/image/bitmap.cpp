@@ -23,19 +23,121 @@
 
 #include"bitmap.h"
 
-Bitmap::Bitmap( const std::string& filename )
+#include <fstream>
+#include <vector>
+
+#include "../core/parallel.h"
+#include "../core/simd.h"
+
+static const uint32_t BitmapHeaderBytes = 54;
+static const uint32_t BitmapRowGrain = 64;
+
+
+template<typename T>
+static inline T ReadLE( const uint8_t* bytes )
 {
-	Load( filename );
+	T value;
+	memcpy( &value, bytes, sizeof( T ) );
+	return value;
 }
 
 
-Bitmap::~Bitmap()
+template<typename T>
+static inline void WriteLE( uint8_t* bytes, const T value )
+{
+	memcpy( bytes, &value, sizeof( T ) );
+}
+
+
+// Stored texels keep A, B, G, R in bytes 0-3 ( see rgba8_t ), BMP rows are B, G, R[, A].
+// For 32-bit rows that is a byte rotate of each texel. Unless the file declares an alpha mask the 4th byte
+// is reserved and usually 0, so opaque rows force alpha to 0xFF.
+static void SwizzleBgraRow( const uint8_t* src, rgba8_t* dst, const uint32_t width, const bool opaque )
 {
-	if ( mapdata == nullptr )
+	const uint32_t alphaBits = opaque ? 0xFF : 0x00;
+
+	uint32_t x = 0;
+#if defined( GFX_SIMD_SSE )
+	const __m128i alpha = _mm_set1_epi32( alphaBits );
+	for ( ; ( x + 4 ) <= width; x += 4 )
 	{
-		delete[] mapdata;
+		const __m128i bgra = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + 4 * x ) );
+		const __m128i abgr = _mm_or_si128( _mm_slli_epi32( bgra, 8 ), _mm_srli_epi32( bgra, 24 ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x ), _mm_or_si128( abgr, alpha ) );
 	}
-	pixelCnt = 0;
+#endif
+	for ( ; x < width; ++x )
+	{
+		const uint32_t bgra = ReadLE<uint32_t>( src + 4 * x );
+		dst[ x ].hex = ( bgra << 8 ) | ( bgra >> 24 ) | alphaBits;
+	}
+}
+
+
+#if defined( GFX_SIMD_SSE )
+GFX_TARGET_SSE41 static uint32_t SwizzleBgrRowSse41( const uint8_t* src, rgba8_t* dst, const uint32_t width )
+{
+	// 12 source bytes make 4 texels, the 16 byte load reads one texel ahead so the last group is left to the scalar loop
+	const __m128i shuffle = _mm_setr_epi8( -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11 );
+	const __m128i alpha = _mm_set1_epi32( 0xFF );
+
+	uint32_t x = 0;
+	for ( ; ( x + 5 ) <= width; x += 4 )
+	{
+		const __m128i bgr = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + 3 * x ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x ), _mm_or_si128( _mm_shuffle_epi8( bgr, shuffle ), alpha ) );
+	}
+	return x;
+}
+#endif
+
+
+static void SwizzleBgrRow( const uint8_t* src, rgba8_t* dst, const uint32_t width )
+{
+	uint32_t x = 0;
+#if defined( GFX_SIMD_SSE )
+	if ( GetCpuFeatures().sse41 ) {
+		x = SwizzleBgrRowSse41( src, dst, width );
+	}
+#endif
+	for ( ; x < width; ++x )
+	{
+		dst[ x ].a = 0xFF;
+		dst[ x ].b = src[ 3 * x ];
+		dst[ x ].g = src[ 3 * x + 1 ];
+		dst[ x ].r = src[ 3 * x + 2 ];
+	}
+}
+
+
+static void UnswizzleBgraRow( const rgba8_t* src, uint8_t* dst, const uint32_t width )
+{
+	uint32_t x = 0;
+#if defined( GFX_SIMD_SSE )
+	for ( ; ( x + 4 ) <= width; x += 4 )
+	{
+		const __m128i abgr = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + 4 * x ), _mm_or_si128( _mm_srli_epi32( abgr, 8 ), _mm_slli_epi32( abgr, 24 ) ) );
+	}
+#endif
+	for ( ; x < width; ++x )
+	{
+		const uint32_t abgr = src[ x ].hex;
+		WriteLE<uint32_t>( dst + 4 * x, ( abgr >> 8 ) | ( abgr << 24 ) );
+	}
+}
+
+
+Bitmap::Bitmap( const std::string& filename ) : mapdata( nullptr ), pixelCnt( 0 ), ownsData( false )
+{
+	InitHeader( 0, 0 );
+	Load( filename );
+}
+
+
+Bitmap::~Bitmap()
+{
+	Release();
 	memset( &h, 0, sizeof( headerInfo_t ) );
 }
 
@@ -45,33 +147,72 @@ Bitmap::Bitmap( const Bitmap& bitmap )
 	h = bitmap.h;
 
 	pixelCnt = bitmap.pixelCnt;
+	ownsData = true;
+	mapdata = new rgba8_t[ pixelCnt ];
 
-	if( mapdata == nullptr )
-	{
-		delete[] mapdata;
-	}
+	memcpy( mapdata, bitmap.mapdata, pixelCnt * sizeof( rgba8_t ) );
+}
+
+
+Bitmap::Bitmap( const uint32_t width, const uint32_t height, const uint32_t color )
+{
+	InitHeader( width, height );
+
+	pixelCnt = ( width * height );
+	ownsData = true;
 	mapdata = new rgba8_t[ pixelCnt ];
 
-	for ( uint32_t i = 0; i < pixelCnt; ++i )
+	const rgba8_t fill = rgba8_t( Color( color ).AsRgba8() );
+	for ( size_t i = 0; i < pixelCnt; ++i )
 	{
-		mapdata[ i ] = bitmap.mapdata[ i ];
+		mapdata[ i ] = fill;
 	}
 }
 
 
-Bitmap::Bitmap( const uint32_t width, const uint32_t height, const uint32_t color )
+Bitmap::Bitmap( rgba8_t* pixels, const uint32_t width, const uint32_t height )
 {
+	InitHeader( width, height );
+
 	pixelCnt = ( width * height );
+	ownsData = false;
+	mapdata = pixels;
+}
+
+
+Bitmap::Bitmap( ImageBuffer<rgba8_t>& image ) : Bitmap( reinterpret_cast<rgba8_t*>( image.GetSlice( 0, 0 ).ptr ), image.GetWidth(), image.GetHeight() )
+{
+}
+
 
+Bitmap& Bitmap::operator=( const Bitmap& bitmap )
+{
+	if ( this == &bitmap ) {
+		return *this;
+	}
+
+	// Always takes an owned copy, a view being assigned to stops referencing its external pixels
+	Release();
+	h = bitmap.h;
+
+	pixelCnt = bitmap.pixelCnt;
+	ownsData = true;
 	mapdata = new rgba8_t[ pixelCnt ];
 
+	memcpy( mapdata, bitmap.mapdata, pixelCnt * sizeof( rgba8_t ) );
+	return *this;
+}
+
+
+void Bitmap::InitHeader( const uint32_t width, const uint32_t height )
+{
 	h.magicNum[ 0 ]	= 'B';
 	h.magicNum[ 1 ]	= 'M';
 
-	h.size			= ( pixelCnt * 4 );
+	h.size			= BitmapHeaderBytes + ( width * height * 4 );
 	h.reserve1		= 0;
 	h.reserve2		= 0;
-	h.offset		= 54;
+	h.offset		= BitmapHeaderBytes;
 
 	h.hSize			= 40;
 	h.width			= width;
@@ -79,198 +220,179 @@ Bitmap::Bitmap( const uint32_t width, const uint32_t height, const uint32_t colo
 	h.cPlanes		= 1;
 	h.bpPixels		= 32;
 	h.compression	= 0;
-	h.imageSize		= ( h.bpPixels * pixelCnt );
+	h.imageSize		= ( width * height * 4 );
 	h.hRes			= 0;
 	h.vRes			= 0;
 	h.colors		= 0;
 	h.iColors		= 0;
-
-	for ( size_t i = 0; i < pixelCnt; ++i )
-	{
-		mapdata[ i ] = rgba8_t( Color( color ).AsRgba8() );
-	}
 }
 
 
-Bitmap& Bitmap::operator=( const Bitmap& bitmap )
+void Bitmap::Release()
 {
-	assert(0);
-	return *this;
-}
-
-
-template<int ByteCnt>
-void Bitmap::WriteInt( uint32_t value )
-{
-	assert( ByteCnt <= 4 );
-
-	uint32_t temp = value;
-	uint8_t bin[ ByteCnt ];
-	
-	for ( int32_t i = 0; i < ByteCnt; ++i )
+	if ( ownsData && ( mapdata != nullptr ) )
 	{
-		bin[ i ] = static_cast<uint8_t>( temp & 0xFF );
-		temp >>= 8;
+		delete[] mapdata;
 	}
-
-	outstream.write( reinterpret_cast<char*>( bin ), ByteCnt );
+	mapdata = nullptr;
+	pixelCnt = 0;
+	ownsData = false;
 }
 
 
-template<int ByteCnt>
-uint32_t Bitmap::ReadInt()
+bool Bitmap::Load( const std::string& filename )
 {
-	assert( ByteCnt <= 4 );
-
-	uint8_t bin[ ByteCnt ];
-
-	instream.read( reinterpret_cast<char*>( bin ), ByteCnt );
+	std::ifstream instream( filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate );
 
-	const int cbyte = 8;
-	uint32_t numeral = 0;
-
-	for ( uint32_t i = 1; i <= ByteCnt; ++i )
+	if( instream.fail() )
 	{
-		uint32_t temp = static_cast<uint32_t>( bin[ ByteCnt - i ] );
-		temp &= 0x000000FF;
-		temp <<= ( ByteCnt - i ) * cbyte;
-		numeral |= temp;
+		return false;
 	}
 
-	return numeral;
-}
-
+	// One read for the whole file, rows are decoded straight out of memory
+	const std::streamoff fileBytes = instream.tellg();
+	if ( fileBytes < BitmapHeaderBytes )
+	{
+		return false;
+	}
 
-bool Bitmap::Load( const std::string& filename )
-{
-	instream.open( filename.c_str(), std::ios::in | std::ios::binary );
+	std::vector<uint8_t> file( static_cast<size_t>( fileBytes ) );
+	instream.seekg( 0, std::ios_base::beg );
+	instream.read( reinterpret_cast<char*>( file.data() ), fileBytes );
+	instream.close();
 
-	if( instream.fail() )
+	const uint8_t* bytes = file.data();
+	if ( ( bytes[ 0 ] != 'B' ) || ( bytes[ 1 ] != 'M' ) )
 	{
 		return false;
 	}
 
-	instream.read( reinterpret_cast<char*>( h.magicNum ), 2 );
+	const uint32_t offset		= ReadLE<uint32_t>( bytes + 10 );
+	const int32_t width			= ReadLE<int32_t>( bytes + 18 );
+	const int32_t height		= ReadLE<int32_t>( bytes + 22 );
+	const uint16_t bitDepth		= ReadLE<uint16_t>( bytes + 28 );
+	const uint32_t infoBytes	= ReadLE<uint32_t>( bytes + 14 );
+	const uint32_t compression	= ReadLE<uint32_t>( bytes + 30 );
 
-	h.size			= ReadInt<4>();
-	h.reserve1		= ReadInt<2>();
-	h.reserve2		= ReadInt<2>();
-	h.offset		= ReadInt<4>();
+	// Uncompressed, or 32-bit with the default BGRA bit fields
+	const bool supported = ( ( bitDepth == 24 ) || ( bitDepth == 32 ) ) && ( ( compression == 0 ) || ( ( compression == 3 ) && ( bitDepth == 32 ) ) );
+	if ( ( supported == false ) || ( width <= 0 ) || ( height == 0 ) )
+	{
+		return false;
+	}
 
-	h.hSize			= ReadInt<4>();
-	h.width			= ReadInt<4>();
-	h.height		= ReadInt<4>();
-	h.cPlanes		= ReadInt<2>();
-	h.bpPixels		= ReadInt<2>();
-	h.compression	= ReadInt<4>();
-	h.imageSize		= ReadInt<4>();
-	h.hRes			= ReadInt<4>();
-	h.vRes			= ReadInt<4>();
-	h.colors		= ReadInt<4>();
-	h.iColors		= ReadInt<4>();
+	// BI_RGB leaves the 4th byte reserved. Alpha is only read when BI_BITFIELDS declares a mask for it,
+	// which needs a V3 or later info header, the R, G, B masks directly follow the 40 byte header in every version.
+	bool opaque = true;
+	if ( compression == 3 )
+	{
+		const bool hasAlphaMask = ( infoBytes >= 56 );
+		if ( fileBytes < ( BitmapHeaderBytes + ( hasAlphaMask ? 16 : 12 ) ) )
+		{
+			return false;
+		}
 
-	uint32_t padding = 0;
+		const uint32_t redMask		= ReadLE<uint32_t>( bytes + 54 );
+		const uint32_t greenMask	= ReadLE<uint32_t>( bytes + 58 );
+		const uint32_t blueMask		= ReadLE<uint32_t>( bytes + 62 );
+		const uint32_t alphaMask	= hasAlphaMask ? ReadLE<uint32_t>( bytes + 66 ) : 0;
 
-	if ( ( h.width % 4 ) != 0 )
-	{
-		padding = 4 - ( h.width % 4 );
+		if ( ( redMask != 0x00FF0000 ) || ( greenMask != 0x0000FF00 ) || ( blueMask != 0x000000FF ) )
+		{
+			return false;
+		}
+		if ( ( alphaMask != 0 ) && ( alphaMask != 0xFF000000 ) )
+		{
+			return false;
+		}
+		opaque = ( alphaMask == 0 );
 	}
 
-	const uint32_t srcSize = h.imageSize;
-	const uint16_t srcBitDepth = h.bpPixels;
+	// Negative height marks a top-down image
+	const bool topDown = ( height < 0 );
+	const uint32_t rows = static_cast<uint32_t>( topDown ? -height : height );
+	const uint32_t pixelBytes = ( bitDepth >> 3 );
+	const uint32_t lineBytes = ( pixelBytes * width + 3 ) & ~3u;
 
-	// Convert to supported format
+	if ( ( offset + static_cast<uint64_t>( lineBytes ) * rows ) > static_cast<uint64_t>( fileBytes ) )
 	{
-		h.bpPixels = 32;
-		h.compression = 0;
-		h.imageSize = 4 * ( h.width + padding ) * h.height;
+		return false;
 	}
 
-	instream.seekg( h.offset, std::ios_base::beg );
+	Release();
+	InitHeader( static_cast<uint32_t>( width ), rows );
 
-	pixelCnt = ( h.width + padding ) * h.height;
+	pixelCnt = h.width * h.height;
+	ownsData = true;
 	mapdata = new rgba8_t[ pixelCnt ];
 
-	const int32_t pixelBytes = ( srcBitDepth >> 3 );
-	const int32_t lineBytes = ( pixelBytes * h.width );
-	uint8_t* buffer = new uint8_t[ lineBytes ];
-
-	for ( int32_t row = ( h.height - 1 ); row >= 0; row-- )
+	const uint8_t* pixels = bytes + offset;
+	ParallelFor( rows, BitmapRowGrain, [&]( const uint32_t begin, const uint32_t end )
 	{
-		instream.read( reinterpret_cast<char*>( buffer ), lineBytes );
-
-		for ( uint32_t pixNum = 0; pixNum < ( h.width * pixelBytes ); pixNum += pixelBytes )
+		for ( uint32_t row = begin; row < end; ++row )
 		{
-			rgba8_t pixel;
-			//parse raw data width/24bits
-			pixel.b	= buffer[ pixNum ];
-			pixel.g	= buffer[ pixNum + 1 ];
-			pixel.r	= buffer[ pixNum + 2 ];
-			pixel.a	= (uint8_t) 0xFF;
-
-			mapdata[ row * h.width + ( pixNum / pixelBytes ) ] = rgba8_t( pixel );
+			const uint32_t dstRow = topDown ? row : ( rows - 1 - row );
+			const uint8_t* src = pixels + static_cast<size_t>( row ) * lineBytes;
+			rgba8_t* dst = mapdata + static_cast<size_t>( dstRow ) * h.width;
+
+			if ( pixelBytes == 4 ) {
+				SwizzleBgraRow( src, dst, h.width, opaque );
+			} else {
+				SwizzleBgrRow( src, dst, h.width );
+			}
 		}
-
-		instream.seekg( padding + instream.tellg(), std::ios_base::beg );
-	}
-
-	delete[] buffer;
-	buffer = nullptr;
-
-	instream.close();
+	} );
 
 	return true;
 }
 
 
-void Bitmap::Write( const std::string& filename )
+bool Bitmap::Write( const std::string& filename ) const
 {
-	outstream.open( filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
-
-	outstream.write( reinterpret_cast<char*>( h.magicNum ), 2 );
-
-	WriteInt<4>( h.size );
-	WriteInt<2>( h.reserve1 );
-	WriteInt<2>( h.reserve2 );
-	WriteInt<4>( h.offset );
-
-	WriteInt<4>( h.hSize );
-	WriteInt<4>( h.width );
-	WriteInt<4>( h.height );
-	WriteInt<2>( h.cPlanes );
-	WriteInt<2>( h.bpPixels );
-	WriteInt<4>( h.compression );
-	WriteInt<4>( h.imageSize );
-	WriteInt<4>( h.hRes );
-	WriteInt<4>( h.vRes );
-	WriteInt<4>( h.colors );
-	WriteInt<4>( h.iColors );
-
-	outstream.seekp( h.offset, std::ios_base::beg );
-
-	int padding = 0;
-	if ( ( h.width % 4 ) != 0 )
+	// 32-bit rows never need padding
+	const size_t imageBytes = static_cast<size_t>( h.width ) * h.height * 4;
+	std::vector<uint8_t> file( BitmapHeaderBytes + imageBytes );
+	uint8_t* bytes = file.data();
+
+	bytes[ 0 ] = 'B';
+	bytes[ 1 ] = 'M';
+	WriteLE<uint32_t>( bytes + 2, static_cast<uint32_t>( file.size() ) );
+	WriteLE<uint16_t>( bytes + 6, 0 );
+	WriteLE<uint16_t>( bytes + 8, 0 );
+	WriteLE<uint32_t>( bytes + 10, BitmapHeaderBytes );
+
+	WriteLE<uint32_t>( bytes + 14, 40 );
+	WriteLE<uint32_t>( bytes + 18, h.width );
+	WriteLE<uint32_t>( bytes + 22, h.height );
+	WriteLE<uint16_t>( bytes + 26, 1 );
+	WriteLE<uint16_t>( bytes + 28, 32 );
+	WriteLE<uint32_t>( bytes + 30, 0 );
+	WriteLE<uint32_t>( bytes + 34, static_cast<uint32_t>( imageBytes ) );
+	WriteLE<uint32_t>( bytes + 38, h.hRes );
+	WriteLE<uint32_t>( bytes + 42, h.vRes );
+	WriteLE<uint32_t>( bytes + 46, 0 );
+	WriteLE<uint32_t>( bytes + 50, 0 );
+
+	uint8_t* pixels = bytes + BitmapHeaderBytes;
+	const uint32_t rows = h.height;
+	ParallelFor( rows, BitmapRowGrain, [&]( const uint32_t begin, const uint32_t end )
 	{
-		padding = 4 - ( h.width % 4 );
-	}
-
-	const uint8_t pad[ 4 ] = { '\0','\0', '\0','\0' };
-
-	for ( int32_t row = ( h.height - 1 ); row >= 0; row-- )
-	{
-		const int32_t rowOffset = ( row * h.width );
-		for ( uint32_t colIx = 0; colIx < h.width; colIx++ )
+		for ( uint32_t row = begin; row < end; ++row )
 		{
-			rgba8_t pixel;
-			CopyToPixel( mapdata[ colIx + rowOffset ], pixel, BITMAP_ARGB );
-			WriteInt<4>( pixel.hex );
-			// xARGB
+			const rgba8_t* src = mapdata + static_cast<size_t>( rows - 1 - row ) * h.width;
+			UnswizzleBgraRow( src, pixels + static_cast<size_t>( row ) * h.width * 4, h.width );
 		}
+	} );
 
-		outstream.write( reinterpret_cast<const char*>( pad ), padding );
+	std::ofstream outstream( filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+	if ( outstream.fail() )
+	{
+		return false;
 	}
-
+	outstream.write( reinterpret_cast<const char*>( bytes ), file.size() );
 	outstream.close();
+
+	return true;
 }
 
 
@@ -292,6 +414,12 @@ uint32_t Bitmap::GetHeight() const
 }
 
 
+bool Bitmap::IsView() const
+{
+	return ( ownsData == false ) && ( mapdata != nullptr );
+}
+
+
 void Bitmap::ClearImage( const uint32_t color )
 {
 	for ( uint32_t i = 0; i < pixelCnt; ++i )
@@ -313,6 +441,18 @@ void Bitmap::GetBuffer( uint32_t buffer[] ) const
 }
 
 
+rgba8_t* Bitmap::GetPixels()
+{
+	return mapdata;
+}
+
+
+const rgba8_t* Bitmap::GetPixels() const
+{
+	return mapdata;
+}
+
+
 bool Bitmap::SetPixel( const int32_t x, const int32_t y, const uint32_t color )
 {
 	if ( ( x >= static_cast<int32_t>( h.width ) ) || ( x < 0 ) || ( y >= static_cast<int32_t>( h.height ) ) || ( y < 0 ) )
@@ -23,11 +23,11 @@
 
 #pragma once
 
-#include <iostream>
-#include <fstream>
+#include <string>
 #include <assert.h>
 
 #include "color.h"
+#include "image.h"
 
 enum BitmapFormat : uint32_t
 {
@@ -46,21 +46,29 @@ public:
 	Bitmap( const std::string& filename );
 	Bitmap( const Bitmap& bitmap );
 	Bitmap( const uint32_t width, const uint32_t height, const uint32_t color = ~0x00 );
+
+	// Views wrap caller-owned pixels without copying, the memory must outlive the bitmap.
+	// Pixels use the same rgba8_t layout as Color::AsRgba8().
+	Bitmap( rgba8_t* pixels, const uint32_t width, const uint32_t height );
+	Bitmap( ImageBuffer<rgba8_t>& image );
 	~Bitmap();
 
 	Bitmap& operator=( const Bitmap& bitmap );
 	static void CopyToPixel( const rgba8_t& rgba, rgba8_t& pixel, BitmapFormat format );
 
 	bool Load( const std::string& filename );
-	void Write( const std::string& filename );
+	bool Write( const std::string& filename ) const;
 
 	uint32_t GetSize() const;
 	uint32_t GetWidth() const;
 	uint32_t GetHeight() const;
+	bool IsView() const;
 
 	void ClearImage( const uint32_t color = 0xFF );
 
 	void GetBuffer( uint32_t buffer[] ) const;
+	rgba8_t* GetPixels();
+	const rgba8_t* GetPixels() const;
 
 	uint32_t GetPixel( const int32_t x, const int32_t y ) const;
 	bool SetPixel( const int32_t x, const int32_t y, const uint32_t color );
@@ -89,13 +97,8 @@ private:
 
 	rgba8_t* mapdata;
 	uint32_t pixelCnt;
+	bool ownsData;
 
-	std::ifstream instream;
-	std::ofstream outstream;
-
-	template<int ByteCnt>
-	uint32_t ReadInt();
-
-	template<int ByteCnt>
-	void WriteInt( const uint32_t value );
+	void InitHeader( const uint32_t width, const uint32_t height );
+	void Release();
 };
\ No newline at end of file
@@ -0,0 +1,207 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#include "blend.h"
+
+#include "../core/parallel.h"
+
+static const uint32_t SpanGrainSize = 32768;
+
+typedef void ( *colorSpanKernel_t )( const Color* src, const uint32_t srcStep, Color* dst, const uint32_t count );
+typedef void ( *rgba8SpanKernel_t )( const rgba8_t* src, rgba8_t* dst, const uint32_t count );
+
+
+#if defined( GFX_SIMD_SSE )
+// rgba8_t keeps alpha in byte 0 and red in byte 3, the kernels want r, g, b, a lanes
+static inline blendLane_t LoadRgba8( const rgba8_t& texel )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i wide = _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128( static_cast<int32_t>( texel.hex ) ), zero ), zero );
+	const __m128 value = _mm_mul_ps( _mm_cvtepi32_ps( wide ), _mm_set1_ps( 1.0f / 255.0f ) );
+	return _mm_shuffle_ps( value, value, _MM_SHUFFLE( 0, 1, 2, 3 ) );
+}
+
+
+static inline void StoreRgba8( const blendLane_t& value, rgba8_t& texel )
+{
+	const __m128 scaled = _mm_add_ps( _mm_mul_ps( value, _mm_set1_ps( 255.0f ) ), _mm_set1_ps( 0.5f ) );
+	const __m128 clamped = _mm_min_ps( _mm_max_ps( scaled, _mm_setzero_ps() ), _mm_set1_ps( 255.0f ) );
+	const __m128i bytes = _mm_cvttps_epi32( _mm_shuffle_ps( clamped, clamped, _MM_SHUFFLE( 0, 1, 2, 3 ) ) );
+	const __m128i packed = _mm_packus_epi16( _mm_packs_epi32( bytes, bytes ), _mm_setzero_si128() );
+	texel.hex = static_cast<uint32_t>( _mm_cvtsi128_si32( packed ) );
+}
+#else
+static inline blendLane_t LoadRgba8( const rgba8_t& texel )
+{
+	return blendLane_t{ { texel.r / 255.0f, texel.g / 255.0f, texel.b / 255.0f, texel.a / 255.0f } };
+}
+
+
+static inline void StoreRgba8( const blendLane_t& value, rgba8_t& texel )
+{
+	texel.r = static_cast<uint8_t>( Clamp( value.v[ 0 ] * 255.0f + 0.5f, 0.0f, 255.0f ) );
+	texel.g = static_cast<uint8_t>( Clamp( value.v[ 1 ] * 255.0f + 0.5f, 0.0f, 255.0f ) );
+	texel.b = static_cast<uint8_t>( Clamp( value.v[ 2 ] * 255.0f + 0.5f, 0.0f, 255.0f ) );
+	texel.a = static_cast<uint8_t>( Clamp( value.v[ 3 ] * 255.0f + 0.5f, 0.0f, 255.0f ) );
+}
+#endif
+
+
+template<blendMode_t Mode>
+struct colorSpan_t
+{
+	static void Run( const Color* src, const uint32_t srcStep, Color* dst, const uint32_t count )
+	{
+		const float* s = reinterpret_cast<const float*>( src );
+		float* d = reinterpret_cast<float*>( dst );
+		for ( uint32_t i = 0; i < count; ++i ) {
+			BlendStore( blendKernel_t<Mode>::Apply( BlendLoad( s + 4 * i * srcStep ), BlendLoad( d + 4 * i ) ), d + 4 * i );
+		}
+	}
+};
+
+
+template<blendMode_t Mode>
+struct rgba8Span_t
+{
+	static void Run( const rgba8_t* src, rgba8_t* dst, const uint32_t count )
+	{
+		for ( uint32_t i = 0; i < count; ++i ) {
+			StoreRgba8( blendKernel_t<Mode>::Apply( LoadRgba8( src[ i ] ), LoadRgba8( dst[ i ] ) ), dst[ i ] );
+		}
+	}
+};
+
+
+template<template<blendMode_t> class Kernel, typename Fn>
+static Fn SelectSpanKernel( const blendMode_t mode )
+{
+	switch ( mode )
+	{
+		case blendMode_t::SRCALPHA:		return &Kernel<blendMode_t::SRCALPHA>::Run;
+		case blendMode_t::DESTALPHA:	return &Kernel<blendMode_t::DESTALPHA>::Run;
+		case blendMode_t::INVSRCALPHA:	return &Kernel<blendMode_t::INVSRCALPHA>::Run;
+		case blendMode_t::INVDESTALPHA:	return &Kernel<blendMode_t::INVDESTALPHA>::Run;
+		case blendMode_t::DESTCOLOR:	return &Kernel<blendMode_t::DESTCOLOR>::Run;
+		case blendMode_t::INVSRCCOLOR:	return &Kernel<blendMode_t::INVSRCCOLOR>::Run;
+		case blendMode_t::INVDESTCOLOR:	return &Kernel<blendMode_t::INVDESTCOLOR>::Run;
+		case blendMode_t::ZERO:			return &Kernel<blendMode_t::ZERO>::Run;
+		case blendMode_t::ONE:			return &Kernel<blendMode_t::ONE>::Run;
+		case blendMode_t::ADD:			return &Kernel<blendMode_t::ADD>::Run;
+		case blendMode_t::SUBTRACT:		return &Kernel<blendMode_t::SUBTRACT>::Run;
+		case blendMode_t::REVSUBTRACT:	return &Kernel<blendMode_t::REVSUBTRACT>::Run;
+		case blendMode_t::MIN:			return &Kernel<blendMode_t::MIN>::Run;
+		case blendMode_t::MAX:			return &Kernel<blendMode_t::MAX>::Run;
+		case blendMode_t::XOR:			return &Kernel<blendMode_t::XOR>::Run;
+		default:						return &Kernel<blendMode_t::SRCCOLOR>::Run;
+	}
+}
+
+
+void BlendSpan( const Color* src, Color* dst, const uint32_t count, const blendMode_t mode )
+{
+	const colorSpanKernel_t kernel = SelectSpanKernel<colorSpan_t, colorSpanKernel_t>( mode );
+	ParallelFor( count, SpanGrainSize, [&]( const uint32_t begin, const uint32_t end ) {
+		kernel( src + begin, 1, dst + begin, end - begin );
+	} );
+}
+
+
+void BlendSpan( const Color& src, Color* dst, const uint32_t count, const blendMode_t mode )
+{
+	const colorSpanKernel_t kernel = SelectSpanKernel<colorSpan_t, colorSpanKernel_t>( mode );
+	ParallelFor( count, SpanGrainSize, [&]( const uint32_t begin, const uint32_t end ) {
+		kernel( &src, 0, dst + begin, end - begin );
+	} );
+}
+
+
+void BlendSpan( const rgba8_t* src, rgba8_t* dst, const uint32_t count, const blendMode_t mode )
+{
+	const rgba8SpanKernel_t kernel = SelectSpanKernel<rgba8Span_t, rgba8SpanKernel_t>( mode );
+	ParallelFor( count, SpanGrainSize, [&]( const uint32_t begin, const uint32_t end ) {
+		kernel( src + begin, dst + begin, end - begin );
+	} );
+}
+
+
+// Exact round( x / 255 ) for x in [ 0, 255 * 255 ]
+static inline uint32_t DivideBy255( const uint32_t x )
+{
+	const uint32_t t = x + 128;
+	return ( t + ( t >> 8 ) ) >> 8;
+}
+
+
+template<uint32_t AlphaChannel>
+static void CompositePremultipliedKernel( const rgba8_t* src, rgba8_t* dst, const uint32_t count )
+{
+	uint32_t i = 0;
+#if defined( GFX_SIMD_SSE )
+	// Four texels at a time, widened to 16 bits so the products fit
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi16( 255 );
+	const __m128i bias = _mm_set1_epi16( 128 );
+
+	auto over = [&]( const __m128i s, const __m128i d ) -> __m128i
+	{
+		const __m128i alpha = _mm_shufflehi_epi16( _mm_shufflelo_epi16( s, _MM_SHUFFLE( AlphaChannel, AlphaChannel, AlphaChannel, AlphaChannel ) ), _MM_SHUFFLE( AlphaChannel, AlphaChannel, AlphaChannel, AlphaChannel ) );
+		const __m128i t = _mm_add_epi16( _mm_mullo_epi16( d, _mm_sub_epi16( full, alpha ) ), bias );
+		return _mm_srli_epi16( _mm_add_epi16( t, _mm_srli_epi16( t, 8 ) ), 8 );
+	};
+
+	for ( ; ( i + 4 ) <= count; i += 4 )
+	{
+		const __m128i s = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+		const __m128i d = _mm_loadu_si128( reinterpret_cast<const __m128i*>( dst + i ) );
+
+		const __m128i lo = over( _mm_unpacklo_epi8( s, zero ), _mm_unpacklo_epi8( d, zero ) );
+		const __m128i hi = over( _mm_unpackhi_epi8( s, zero ), _mm_unpackhi_epi8( d, zero ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_adds_epu8( s, _mm_packus_epi16( lo, hi ) ) );
+	}
+#endif
+	for ( ; i < count; ++i )
+	{
+		const uint32_t invAlpha = 255 - src[ i ].vec[ AlphaChannel ];
+		for ( uint32_t c = 0; c < 4; ++c ) {
+			dst[ i ].vec[ c ] = static_cast<uint8_t>( Min( 255u, src[ i ].vec[ c ] + DivideBy255( dst[ i ].vec[ c ] * invAlpha ) ) );
+		}
+	}
+}
+
+
+void CompositePremultipliedSpan( const rgba8_t* src, rgba8_t* dst, const uint32_t count, const uint32_t alphaChannel )
+{
+	ParallelFor( count, SpanGrainSize, [&]( const uint32_t begin, const uint32_t end )
+	{
+		switch ( alphaChannel )
+		{
+			case 1:		CompositePremultipliedKernel<1>( src + begin, dst + begin, end - begin ); break;
+			case 2:		CompositePremultipliedKernel<2>( src + begin, dst + begin, end - begin ); break;
+			case 3:		CompositePremultipliedKernel<3>( src + begin, dst + begin, end - begin ); break;
+			default:	CompositePremultipliedKernel<0>( src + begin, dst + begin, end - begin ); break;
+		}
+	} );
+}
@@ -0,0 +1,171 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include "color.h"
+#include "../core/simd.h"
+
+/* === Blend Kernels - One compile time kernel per blendMode_t === */
+// Kernels take ( src, dest ) as RGBA floats with alpha in the last lane and match BlendColor() exactly.
+// BlendColor() itself only dispatches into these, the span functions pick the kernel once per span.
+
+#if defined( GFX_SIMD_SSE )
+typedef __m128 blendLane_t;
+
+inline blendLane_t BlendLoad( const float* v ) { return _mm_loadu_ps( v ); }
+inline void BlendStore( const blendLane_t& x, float* v ) { _mm_storeu_ps( v, x ); }
+inline blendLane_t BlendSet( const float s ) { return _mm_set1_ps( s ); }
+inline blendLane_t BlendAdd( const blendLane_t& a, const blendLane_t& b ) { return _mm_add_ps( a, b ); }
+inline blendLane_t BlendSub( const blendLane_t& a, const blendLane_t& b ) { return _mm_sub_ps( a, b ); }
+inline blendLane_t BlendMul( const blendLane_t& a, const blendLane_t& b ) { return _mm_mul_ps( a, b ); }
+inline blendLane_t BlendMin( const blendLane_t& a, const blendLane_t& b ) { return _mm_min_ps( a, b ); }
+inline blendLane_t BlendMax( const blendLane_t& a, const blendLane_t& b ) { return _mm_max_ps( a, b ); }
+inline blendLane_t BlendAlpha( const blendLane_t& a ) { return _mm_shuffle_ps( a, a, _MM_SHUFFLE( 3, 3, 3, 3 ) ); }
+
+// Same truncation as Color::AsHex()
+inline blendLane_t BlendXorUnorm8( const blendLane_t& a, const blendLane_t& b )
+{
+	const __m128 scale = _mm_set1_ps( 255.0f );
+	const __m128i qa = _mm_cvttps_epi32( _mm_mul_ps( BlendMin( BlendMax( a, BlendSet( 0.0f ) ), BlendSet( 1.0f ) ), scale ) );
+	const __m128i qb = _mm_cvttps_epi32( _mm_mul_ps( BlendMin( BlendMax( b, BlendSet( 0.0f ) ), BlendSet( 1.0f ) ), scale ) );
+	return _mm_mul_ps( _mm_cvtepi32_ps( _mm_xor_si128( qa, qb ) ), _mm_set1_ps( 1.0f / 255.0f ) );
+}
+#else
+struct blendLane_t
+{
+	float v[ 4 ];
+};
+
+inline blendLane_t BlendLoad( const float* v ) { return blendLane_t{ { v[ 0 ], v[ 1 ], v[ 2 ], v[ 3 ] } }; }
+inline void BlendStore( const blendLane_t& x, float* v ) { for ( uint32_t i = 0; i < 4; ++i ) { v[ i ] = x.v[ i ]; } }
+inline blendLane_t BlendSet( const float s ) { return blendLane_t{ { s, s, s, s } }; }
+inline blendLane_t BlendAdd( const blendLane_t& a, const blendLane_t& b ) { return blendLane_t{ { a.v[ 0 ] + b.v[ 0 ], a.v[ 1 ] + b.v[ 1 ], a.v[ 2 ] + b.v[ 2 ], a.v[ 3 ] + b.v[ 3 ] } }; }
+inline blendLane_t BlendSub( const blendLane_t& a, const blendLane_t& b ) { return blendLane_t{ { a.v[ 0 ] - b.v[ 0 ], a.v[ 1 ] - b.v[ 1 ], a.v[ 2 ] - b.v[ 2 ], a.v[ 3 ] - b.v[ 3 ] } }; }
+inline blendLane_t BlendMul( const blendLane_t& a, const blendLane_t& b ) { return blendLane_t{ { a.v[ 0 ] * b.v[ 0 ], a.v[ 1 ] * b.v[ 1 ], a.v[ 2 ] * b.v[ 2 ], a.v[ 3 ] * b.v[ 3 ] } }; }
+inline blendLane_t BlendMin( const blendLane_t& a, const blendLane_t& b ) { return blendLane_t{ { Min( a.v[ 0 ], b.v[ 0 ] ), Min( a.v[ 1 ], b.v[ 1 ] ), Min( a.v[ 2 ], b.v[ 2 ] ), Min( a.v[ 3 ], b.v[ 3 ] ) } }; }
+inline blendLane_t BlendMax( const blendLane_t& a, const blendLane_t& b ) { return blendLane_t{ { Max( a.v[ 0 ], b.v[ 0 ] ), Max( a.v[ 1 ], b.v[ 1 ] ), Max( a.v[ 2 ], b.v[ 2 ] ), Max( a.v[ 3 ], b.v[ 3 ] ) } }; }
+inline blendLane_t BlendAlpha( const blendLane_t& a ) { return BlendSet( a.v[ 3 ] ); }
+
+inline blendLane_t BlendXorUnorm8( const blendLane_t& a, const blendLane_t& b )
+{
+	blendLane_t out;
+	for ( uint32_t i = 0; i < 4; ++i )
+	{
+		const uint32_t qa = static_cast<uint32_t>( 255.0f * Min( 1.0f, Max( 0.0f, a.v[ i ] ) ) );
+		const uint32_t qb = static_cast<uint32_t>( 255.0f * Min( 1.0f, Max( 0.0f, b.v[ i ] ) ) );
+		out.v[ i ] = static_cast<float>( qa ^ qb ) / 255.0f;
+	}
+	return out;
+}
+#endif
+
+// Lerp() saturates its weight, so do the kernels
+inline blendLane_t BlendLerp( const blendLane_t& dest, const blendLane_t& src, const blendLane_t& t )
+{
+	const blendLane_t weight = BlendMin( BlendMax( t, BlendSet( 0.0f ) ), BlendSet( 1.0f ) );
+	return BlendAdd( BlendMul( BlendSub( BlendSet( 1.0f ), weight ), dest ), BlendMul( weight, src ) );
+}
+
+inline blendLane_t BlendInverse( const blendLane_t& x )
+{
+	return BlendSub( BlendSet( 1.0f ), BlendMin( BlendMax( x, BlendSet( 0.0f ) ), BlendSet( 1.0f ) ) );
+}
+
+
+template<blendMode_t Mode> struct blendKernel_t;
+
+template<> struct blendKernel_t<blendMode_t::SRCALPHA> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return BlendLerp( d, s, BlendAlpha( s ) ); }
+};
+template<> struct blendKernel_t<blendMode_t::DESTALPHA> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return BlendLerp( d, s, BlendAlpha( d ) ); }
+};
+template<> struct blendKernel_t<blendMode_t::INVSRCALPHA> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return BlendLerp( d, s, BlendSub( BlendSet( 1.0f ), BlendAlpha( s ) ) ); }
+};
+template<> struct blendKernel_t<blendMode_t::INVDESTALPHA> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return BlendLerp( d, s, BlendSub( BlendSet( 1.0f ), BlendAlpha( d ) ) ); }
+};
+template<> struct blendKernel_t<blendMode_t::SRCCOLOR> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return s; }
+};
+template<> struct blendKernel_t<blendMode_t::DESTCOLOR> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return d; }
+};
+template<> struct blendKernel_t<blendMode_t::INVSRCCOLOR> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return BlendInverse( s ); }
+};
+template<> struct blendKernel_t<blendMode_t::INVDESTCOLOR> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return BlendInverse( d ); }
+};
+template<> struct blendKernel_t<blendMode_t::ZERO> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return BlendSet( 0.0f ); }
+};
+template<> struct blendKernel_t<blendMode_t::ONE> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return BlendSet( 1.0f ); }
+};
+template<> struct blendKernel_t<blendMode_t::ADD> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return BlendAdd( s, d ); }
+};
+template<> struct blendKernel_t<blendMode_t::SUBTRACT> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return BlendSub( s, d ); }
+};
+template<> struct blendKernel_t<blendMode_t::REVSUBTRACT> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return BlendSub( d, s ); }
+};
+template<> struct blendKernel_t<blendMode_t::MIN> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return BlendMin( s, d ); }
+};
+template<> struct blendKernel_t<blendMode_t::MAX> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return BlendMax( s, d ); }
+};
+template<> struct blendKernel_t<blendMode_t::XOR> {
+	static inline blendLane_t Apply( const blendLane_t& s, const blendLane_t& d ) { return BlendXorUnorm8( s, d ); }
+};
+
+
+template<blendMode_t Mode>
+inline Color BlendColor( const Color& src, const Color& dest )
+{
+	// Color is four packed floats, see the static_assert next to it
+	Color out;
+	BlendStore( blendKernel_t<Mode>::Apply( BlendLoad( reinterpret_cast<const float*>( &src ) ), BlendLoad( reinterpret_cast<const float*>( &dest ) ) ), reinterpret_cast<float*>( &out ) );
+	return out;
+}
+
+
+// dst[ i ] = BlendColor( src[ i ], dst[ i ], mode )
+void BlendSpan( const Color* src, Color* dst, const uint32_t count, const blendMode_t mode );
+
+// Constant source, e.g. a fill color over a row
+void BlendSpan( const Color& src, Color* dst, const uint32_t count, const blendMode_t mode );
+
+// Texels in the Color::AsRgba8() layout, converted through float and rounded back to 8 bits
+void BlendSpan( const rgba8_t* src, rgba8_t* dst, const uint32_t count, const blendMode_t mode );
+
+// Fixed point premultiplied "over", dst = src + dst * ( 255 - srcAlpha ) / 255 on every channel.
+// alphaChannel is the byte holding alpha, 0 for the Color::AsRgba8() layout, 3 for RGBA byte order.
+void CompositePremultipliedSpan( const rgba8_t* src, rgba8_t* dst, const uint32_t count, const uint32_t alphaChannel = 0 );
@@ -22,6 +22,7 @@
 */
 
 #include "color.h"
+#include "blend.h"
 #include "../core/util.h"
 
 
@@ -48,10 +49,12 @@ rgba16_t Color::AsRgba16() const
 
 Color SrgbTolinear( const Color& color, const float gamma )
 {
+	const vec3f linear = mathDefault_t::Pow( vec3f( color[ 0 ], color[ 1 ], color[ 2 ] ), gamma );
+
 	Color outColor;
 	for ( int32_t i = 0; i < 3; ++i )
 	{
-		outColor[ i ] = Saturate( pow( color[ i ], gamma ) );
+		outColor[ i ] = Saturate( linear[ i ] );
 	}
 	outColor[ 3 ] = 1.0f;
 
@@ -61,10 +64,12 @@ Color SrgbTolinear( const Color& color, const float gamma )
 
 Color LinearToSrgb( const Color& color, const float gamma )
 {
+	const vec3f srgb = mathDefault_t::Pow( vec3f( color[ 0 ], color[ 1 ], color[ 2 ] ), 1.0f / gamma );
+
 	Color outColor;
 	for ( int32_t i = 0; i < 3; ++i )
 	{
-		outColor[ i ] = Saturate( pow( color[ i ], 1.0f / gamma ) );
+		outColor[ i ] = Saturate( srgb[ i ] );
 	}
 	outColor[ 3 ] = 1.0f;
 
@@ -77,79 +82,21 @@ Color BlendColor( const Color& src, const Color& dest, const blendMode_t blendMo
 	switch ( blendMode )
 	{
 		default:
-		case blendMode_t::SRCCOLOR:
-		{
-			return src;
-		}
-		case blendMode_t::DESTCOLOR:
-		{
-			return dest;
-		}
-		case blendMode_t::SRCALPHA:
-		{
-			return Lerp( dest, src, src.a() );
-		}
-		case blendMode_t::DESTALPHA:
-		{
-			return Lerp( dest, src, dest.a() );
-		}
-		case blendMode_t::INVSRCALPHA:
-		{
-			return Lerp( dest, src, 1.0f - src.a() );
-		}
-		case blendMode_t::INVDESTALPHA:
-		{
-			return Lerp( dest, src, 1.0f - dest.a() );
-		}
-		case blendMode_t::INVSRCCOLOR:
-		{
-			return src.Inverse();
-		}
-		case blendMode_t::INVDESTCOLOR:
-		{
-			return dest.Inverse();
-		}
-		case blendMode_t::ADD:
-		{
-			return ( src + dest );
-		}
-		case blendMode_t::SUBTRACT:
-		{
-			return ( src - dest );
-		}
-		case blendMode_t::REVSUBTRACT:
-		{
-			return ( dest - src );
-		}
-		case blendMode_t::MIN:
-		{
-			Color out;
-			for ( int32_t i = 0; i < 4; ++i )
-			{
-				out[ i ] = std::min( src[ i ], dest[ i ] );
-			}
-			return out;
-		}
-		case blendMode_t::XOR:
-		{
-			return Color( src.AsHex() ^ dest.AsHex() );
-		}
-		case blendMode_t::MAX:
-		{
-			Color out;
-			for ( int32_t i = 0; i < 4; ++i )
-			{
-				out[ i ] = std::max( src[ i ], dest[ i ] );
-			}
-			return out;
-		}
-		case blendMode_t::ZERO:
-		{
-			return Color( 0.0f );
-		}
-		case blendMode_t::ONE:
-		{
-			return Color( 1.0f );
-		}
+		case blendMode_t::SRCCOLOR:		return BlendColor<blendMode_t::SRCCOLOR>( src, dest );
+		case blendMode_t::DESTCOLOR:	return BlendColor<blendMode_t::DESTCOLOR>( src, dest );
+		case blendMode_t::SRCALPHA:		return BlendColor<blendMode_t::SRCALPHA>( src, dest );
+		case blendMode_t::DESTALPHA:	return BlendColor<blendMode_t::DESTALPHA>( src, dest );
+		case blendMode_t::INVSRCALPHA:	return BlendColor<blendMode_t::INVSRCALPHA>( src, dest );
+		case blendMode_t::INVDESTALPHA:	return BlendColor<blendMode_t::INVDESTALPHA>( src, dest );
+		case blendMode_t::INVSRCCOLOR:	return BlendColor<blendMode_t::INVSRCCOLOR>( src, dest );
+		case blendMode_t::INVDESTCOLOR:	return BlendColor<blendMode_t::INVDESTCOLOR>( src, dest );
+		case blendMode_t::ADD:			return BlendColor<blendMode_t::ADD>( src, dest );
+		case blendMode_t::SUBTRACT:		return BlendColor<blendMode_t::SUBTRACT>( src, dest );
+		case blendMode_t::REVSUBTRACT:	return BlendColor<blendMode_t::REVSUBTRACT>( src, dest );
+		case blendMode_t::MIN:			return BlendColor<blendMode_t::MIN>( src, dest );
+		case blendMode_t::XOR:			return BlendColor<blendMode_t::XOR>( src, dest );
+		case blendMode_t::MAX:			return BlendColor<blendMode_t::MAX>( src, dest );
+		case blendMode_t::ZERO:			return BlendColor<blendMode_t::ZERO>( src, dest );
+		case blendMode_t::ONE:			return BlendColor<blendMode_t::ONE>( src, dest );
 	}
 }
@@ -26,7 +26,9 @@
 #include <assert.h>
 #include <cstdint>
 #include <algorithm>
+#include <utility>
 #include "../core/common.h"
+#include "imageAllocator.h"
 
 void WrapUV( float& u, float& v );
 void WrapUV( float& u, float& v, float& w );
@@ -72,9 +74,11 @@ struct imageBufferInfo_t
 	uint32_t		height;				// Height of image (highest mip)
 	uint32_t		layers;				// Depth for 3D volumes, sides for cubemaps, 1 normally
 	uint32_t		mipCount;			// Number of MIP levels, 1 normally
-	uint32_t		bpp;				// Bytes per pixel
+	uint32_t		bpp;				// Bytes per pixel, or per block when blockSize > 1
+	uint32_t		blockSize;			// Texel width/height of a compressed block, 0 or 1 when uncompressed
 	void*			data;				// Initialization data
 	uint32_t		dataByteCount;
+	ImageAllocator*	allocator;			// Storage for slices and pixels, nullptr keeps the current one or uses the heap
 };
 
 // References a MxN image within a buffer
@@ -91,31 +95,115 @@ struct slice_t
 class ImageBufferInterface
 {
 private:
-	static const uint32_t Version = 5;
+	static const uint32_t Version = 6;
 	uint32_t		width;				// Width of image (highest mip)
 	uint32_t		height;				// Height of image (highest mip)
 	uint32_t		length;				// Number of elements in buffer
 	uint32_t		layers;				// Depth for 3D volumes, sides for cubemaps, 1 normally
 	uint32_t		mipCount;			// Number of mips in buffer, 1 normally
-	uint32_t		bpp;				// Bytes per pixel
+	uint32_t		bpp;				// Bytes per pixel, or per block when blockSize > 1
+	uint32_t		blockSize;			// Texel width/height of a compressed block, 1 normally
 	uint32_t		byteCount;			// Bytes of buffer
 	uint32_t		sliceCount;			// Number of MxN image slices
 	slice_t*		slices = nullptr;	// Buffer needs to be continuous data, this helps index into that pool in a structured way
-	uint8_t*		buffer = nullptr;
+	uint8_t*		buffer = nullptr;	// Shares one allocation with slices
+	ImageAllocator*	allocator = nullptr;
 	const char*		name;
 
-protected:
-	void _Init( const imageBufferInfo_t& _info, const char* _name = "" )
+	static const size_t BufferAlignment = 64;
+
+	inline size_t SliceTableBytes() const
 	{
-		if ( buffer != nullptr )
-		{
-			delete[] buffer;
-			buffer = nullptr;
+		return ( ( sliceCount * sizeof( slice_t ) + BufferAlignment - 1 ) / BufferAlignment ) * BufferAlignment;
+	}
+
+	inline uint32_t SliceByteCount( const uint32_t mipWidth, const uint32_t mipHeight ) const
+	{
+		const uint32_t blocksX = ( mipWidth + blockSize - 1 ) / blockSize;
+		const uint32_t blocksY = ( mipHeight + blockSize - 1 ) / blockSize;
+		return blocksX * blocksY * bpp;
+	}
+
+	void Allocate()
+	{
+		if ( allocator == nullptr ) {
+			allocator = DefaultImageAllocator();
+		}
+
+		uint8_t* storage = reinterpret_cast<uint8_t*>( allocator->Alloc( SliceTableBytes() + byteCount, BufferAlignment ) );
+		slices = reinterpret_cast<slice_t*>( storage );
+		buffer = storage + SliceTableBytes();
+	}
+
+	void Release()
+	{
+		if ( slices != nullptr ) {
+			allocator->Free( slices, SliceTableBytes() + byteCount );
+		}
+		slices = nullptr;
+		buffer = nullptr;
+	}
+
+	void CopyFrom( const ImageBufferInterface& _image )
+	{
+		width = _image.width;
+		height = _image.height;
+		length = _image.length;
+		layers = _image.layers;
+		mipCount = _image.mipCount;
+		bpp = _image.bpp;
+		blockSize = _image.blockSize;
+		name = _image.name;
+		byteCount = _image.byteCount;
+		sliceCount = _image.sliceCount;
+		allocator = _image.allocator;
+
+		if ( _image.slices == nullptr ) {
+			return;
 		}
-		if ( slices != nullptr )
+
+		Allocate();
+
+		memcpy( buffer, _image.buffer, byteCount );
+		memcpy( slices, _image.slices, sliceCount * sizeof( slice_t ) );
+
+		// Copied slices still point into the source
+		for ( uint32_t sliceIndex = 0; sliceIndex < sliceCount; ++sliceIndex )
 		{
-			delete[] slices;
-			slices = nullptr;
+			slice_t& slice = slices[ sliceIndex ];
+			slice.ptr = buffer + slice.offset;
+			slice.end = slice.ptr + slice.size;
+		}
+	}
+
+	void MoveFrom( ImageBufferInterface& _image )
+	{
+		width = _image.width;
+		height = _image.height;
+		length = _image.length;
+		layers = _image.layers;
+		mipCount = _image.mipCount;
+		bpp = _image.bpp;
+		blockSize = _image.blockSize;
+		name = _image.name;
+		byteCount = _image.byteCount;
+		sliceCount = _image.sliceCount;
+		allocator = _image.allocator;
+		slices = _image.slices;
+		buffer = _image.buffer;
+
+		_image.slices = nullptr;
+		_image.buffer = nullptr;
+		_image.Destroy();
+	}
+
+protected:
+	void _Init( const imageBufferInfo_t& _info, const char* _name = "" )
+	{
+		Release();
+
+		if ( _info.allocator != nullptr ) {
+			allocator = _info.allocator;
 		}
 
 		const bool clearbuffers = true;
@@ -127,20 +215,32 @@ protected:
 		layers = _info.layers;
 		mipCount = _info.mipCount;
 		bpp = _info.bpp;
+		blockSize = ( _info.blockSize > 1 ) ? _info.blockSize : 1;
 		length = width * height * layers;
 		sliceCount = layers * mipCount;
 
-		// 1. Compute partitions
-		slices = new slice_t[ sliceCount ];
-		if( clearbuffers ) {
-			memset( slices, 0, sliceCount * sizeof( slice_t ) );
-		}
-
 		uint32_t mipWidth = width;
 		uint32_t mipHeight = height;
 
+		// 1. Size buffer
 		byteCount = 0;
 		for ( uint32_t mip = 0; mip < mipCount; ++mip )
+		{
+			MipDimensions( mip, width, height, &mipWidth, &mipHeight );
+			byteCount += layers * SliceByteCount( mipWidth, mipHeight );
+		}
+
+		// 2. Allocate, one allocation for both the slice table and pixels
+		Allocate();
+		if ( clearbuffers )
+		{
+			memset( slices, 0, sliceCount * sizeof( slice_t ) );
+			memset( buffer, 0, byteCount );
+		}
+
+		// 3. Compute partitions
+		uint32_t offset = 0;
+		for ( uint32_t mip = 0; mip < mipCount; ++mip )
 		{
 			MipDimensions( mip, width, height, &mipWidth, &mipHeight );
 
@@ -148,29 +248,17 @@ protected:
 			for( uint32_t layerId = 0; layerId < layers; ++layerId )
 			{
 				slice_t& slice = slices[ layerId + mipOffset ];
-				const uint32_t size = mipWidth * mipHeight * bpp;
+				const uint32_t size = SliceByteCount( mipWidth, mipHeight );
 
 				slice.width = mipWidth;
 				slice.height = mipHeight;
-				slice.offset = byteCount;	
+				slice.offset = offset;
 				slice.size = size;
+				slice.ptr = buffer + offset;
+				slice.end = slice.ptr + size;
 
-				byteCount += size;
-			}		
-		}
-
-		// 2. Allocate
-		buffer = new uint8_t[ byteCount ];
-		if ( clearbuffers ) {
-			memset( buffer, 0, byteCount );
-		}
-
-		// 3. Create convenience pointers
-		for ( uint32_t sliceIndex = 0; sliceIndex < sliceCount; ++sliceIndex )
-		{
-			slice_t& slice = slices[ sliceIndex ];
-			slice.ptr = buffer + slice.offset;
-			slice.end = slice.ptr + slice.size;
+				offset += size;
+			}
 		}
 	}
 
@@ -183,31 +271,44 @@ public:
 		layers = 1;
 		mipCount = 1;
 		bpp = 0;
+		blockSize = 1;
 		sliceCount = 0;
 		byteCount = 0;
 		
 		name = "";
 		buffer = nullptr;
 		slices = nullptr;
+		allocator = nullptr;
 	}
 
 	ImageBufferInterface( const ImageBufferInterface* _image )
 	{
-		width = _image->width;
-		height = _image->height;
-		length = _image->length;
-		layers = _image->layers;
-		mipCount = _image->mipCount;
-		bpp = _image->bpp;
-		name = _image->name;
-		byteCount = _image->byteCount;
-		sliceCount = _image->sliceCount;
+		CopyFrom( *_image );
+	}
 
-		buffer = new uint8_t[ byteCount ];
-		slices = new slice_t[ sliceCount ];
+	ImageBufferInterface( ImageBufferInterface&& _image ) noexcept
+	{
+		MoveFrom( _image );
+	}
+
+	ImageBufferInterface& operator=( const ImageBufferInterface& _image )
+	{
+		if ( this != &_image )
+		{
+			Destroy();
+			CopyFrom( _image );
+		}
+		return *this;
+	}
 
-		memcpy( buffer, _image->buffer, byteCount );
-		memcpy( slices, _image->slices, sliceCount * sizeof( slice_t ) );
+	ImageBufferInterface& operator=( ImageBufferInterface&& _image ) noexcept
+	{
+		if ( this != &_image )
+		{
+			Destroy();
+			MoveFrom( _image );
+		}
+		return *this;
 	}
 
 	// Child classes don't manage any data so not virtual
@@ -243,20 +344,17 @@ public:
 
 	void Destroy()
 	{
+		Release();
+
 		width = 0;
 		height = 0;
 		length = 0;
 		layers = 1;
 		mipCount = 1;
+		blockSize = 1;
 		byteCount = 0;
+		sliceCount = 0;
 		name = "";
-
-		if ( buffer == nullptr ) {
-			delete[] buffer;
-		}
-		if ( slices == nullptr ) {
-			delete[] slices;
-		}
 	}
 
 	void Clear()
@@ -311,6 +409,11 @@ public:
 		return bpp;
 	}
 
+	inline uint32_t GetBlockSize() const
+	{
+		return blockSize;
+	}
+
 	inline uint32_t GetPixelCount() const
 	{
 		return length;
@@ -417,6 +520,22 @@ public:
 	{
 	}
 
+	ImageBuffer( ImageBuffer&& _image ) noexcept : ImageBufferInterface( std::move( _image ) )
+	{
+	}
+
+	ImageBuffer& operator=( const ImageBuffer& _image )
+	{
+		ImageBufferInterface::operator=( _image );
+		return *this;
+	}
+
+	ImageBuffer& operator=( ImageBuffer&& _image ) noexcept
+	{
+		ImageBufferInterface::operator=( std::move( _image ) );
+		return *this;
+	}
+
 	~ImageBuffer()
 	{
 		Destroy();
@@ -507,8 +626,9 @@ public:
 
 	void Clear( const T& fill )
 	{
-		const uint32_t pixelCount = GetPixelCount();
-		for ( uint32_t i = 0; i < pixelCount; ++i ) {
+		// Element count rather than pixel count, T is a whole block for compressed images
+		const uint32_t elementCount = GetByteCount() / sizeof( T );
+		for ( uint32_t i = 0; i < elementCount; ++i ) {
 			RawBuffer()[ i ] = fill;
 		}
 	}
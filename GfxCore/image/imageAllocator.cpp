@@ -0,0 +1,189 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "imageAllocator.h"
+#include <assert.h>
+#include <cstdlib>
+#if defined( _MSC_VER )
+#include <malloc.h>
+#endif
+
+void* HeapImageAllocator::Alloc( const size_t byteCount, const size_t alignment )
+{
+#if defined( _MSC_VER )
+	return _aligned_malloc( byteCount, alignment );
+#else
+	// aligned_alloc wants a multiple of the alignment
+	const size_t alignedCount = ( ( byteCount + alignment - 1 ) / alignment ) * alignment;
+	return aligned_alloc( alignment, ( alignedCount > 0 ) ? alignedCount : alignment );
+#endif
+}
+
+
+void HeapImageAllocator::Free( void* ptr, const size_t byteCount )
+{
+#if defined( _MSC_VER )
+	_aligned_free( ptr );
+#else
+	free( ptr );
+#endif
+}
+
+
+PoolImageAllocator::PoolImageAllocator()
+{
+	for ( uint32_t i = 0; i < ClassCount; ++i ) {
+		m_freeLists[ i ] = nullptr;
+	}
+}
+
+
+PoolImageAllocator::~PoolImageAllocator()
+{
+	for ( uint8_t* chunk : m_chunks ) {
+		m_heap.Free( chunk, ChunkSize );
+	}
+}
+
+
+uint32_t PoolImageAllocator::SizeClass( const size_t byteCount )
+{
+	uint32_t sizeClass = 0;
+	while ( ( size_t( 1 ) << ( sizeClass + MinClassShift ) ) < byteCount ) {
+		++sizeClass;
+	}
+	return sizeClass;
+}
+
+
+void* PoolImageAllocator::Alloc( const size_t byteCount, const size_t alignment )
+{
+	// Blocks sit at multiples of their size from a page aligned chunk
+	assert( alignment <= ( size_t( 1 ) << MinClassShift ) );
+
+	if ( byteCount > ( size_t( 1 ) << MaxClassShift ) ) {
+		return m_heap.Alloc( byteCount, alignment );
+	}
+
+	const uint32_t sizeClass = SizeClass( byteCount );
+	const size_t blockSize = size_t( 1 ) << ( sizeClass + MinClassShift );
+
+	std::lock_guard<std::mutex> lock( m_lock );
+
+	if ( m_freeLists[ sizeClass ] == nullptr )
+	{
+		uint8_t* chunk = reinterpret_cast<uint8_t*>( m_heap.Alloc( ChunkSize, 4096 ) );
+		if ( chunk == nullptr ) {
+			return nullptr;
+		}
+		m_chunks.push_back( chunk );
+
+		for ( size_t offset = ChunkSize; offset >= blockSize; offset -= blockSize )
+		{
+			freeBlock_t* block = reinterpret_cast<freeBlock_t*>( chunk + offset - blockSize );
+			block->next = m_freeLists[ sizeClass ];
+			m_freeLists[ sizeClass ] = block;
+		}
+	}
+
+	freeBlock_t* block = m_freeLists[ sizeClass ];
+	m_freeLists[ sizeClass ] = block->next;
+	return block;
+}
+
+
+void PoolImageAllocator::Free( void* ptr, const size_t byteCount )
+{
+	if ( ptr == nullptr ) {
+		return;
+	}
+
+	if ( byteCount > ( size_t( 1 ) << MaxClassShift ) )
+	{
+		m_heap.Free( ptr, byteCount );
+		return;
+	}
+
+	const uint32_t sizeClass = SizeClass( byteCount );
+
+	std::lock_guard<std::mutex> lock( m_lock );
+
+	freeBlock_t* block = reinterpret_cast<freeBlock_t*>( ptr );
+	block->next = m_freeLists[ sizeClass ];
+	m_freeLists[ sizeClass ] = block;
+}
+
+
+ArenaImageAllocator::ArenaImageAllocator( const size_t capacity )
+{
+	m_base = reinterpret_cast<uint8_t*>( m_heap.Alloc( capacity, 4096 ) );
+	m_capacity = ( m_base != nullptr ) ? capacity : 0;
+	m_offset = 0;
+}
+
+
+ArenaImageAllocator::~ArenaImageAllocator()
+{
+	m_heap.Free( m_base, m_capacity );
+}
+
+
+void* ArenaImageAllocator::Alloc( const size_t byteCount, const size_t alignment )
+{
+	{
+		std::lock_guard<std::mutex> lock( m_lock );
+
+		const size_t alignedOffset = ( ( m_offset + alignment - 1 ) / alignment ) * alignment;
+		if ( ( alignedOffset + byteCount ) <= m_capacity )
+		{
+			m_offset = alignedOffset + byteCount;
+			return m_base + alignedOffset;
+		}
+	}
+	return m_heap.Alloc( byteCount, alignment );
+}
+
+
+void ArenaImageAllocator::Free( void* ptr, const size_t byteCount )
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>( ptr );
+	if ( ( bytes >= m_base ) && ( bytes < ( m_base + m_capacity ) ) ) {
+		return;
+	}
+	m_heap.Free( ptr, byteCount );
+}
+
+
+void ArenaImageAllocator::Reset()
+{
+	std::lock_guard<std::mutex> lock( m_lock );
+	m_offset = 0;
+}
+
+
+ImageAllocator* DefaultImageAllocator()
+{
+	static HeapImageAllocator heap;
+	return &heap;
+}
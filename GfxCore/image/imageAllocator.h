@@ -0,0 +1,116 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Backing storage for image buffers. Each image takes one allocation holding its slice table and pixels.
+// An allocator must outlive every image that uses it.
+class ImageAllocator
+{
+public:
+	virtual ~ImageAllocator() {}
+	virtual void*	Alloc( const size_t byteCount, const size_t alignment ) = 0;
+	virtual void	Free( void* ptr, const size_t byteCount ) = 0;
+};
+
+
+class HeapImageAllocator : public ImageAllocator
+{
+public:
+	void*	Alloc( const size_t byteCount, const size_t alignment ) override;
+	void	Free( void* ptr, const size_t byteCount ) override;
+};
+
+
+// Power-of-two size classes carved from shared chunks, freed blocks are recycled per class.
+// Requests above the largest class go to the heap. Memory returns to the system when the pool is destroyed.
+class PoolImageAllocator : public ImageAllocator
+{
+private:
+	static const uint32_t MinClassShift = 8;	// 256B
+	static const uint32_t MaxClassShift = 18;	// 256KB
+	static const uint32_t ClassCount = MaxClassShift - MinClassShift + 1;
+	static const size_t ChunkSize = 1024 * 1024;
+
+	struct freeBlock_t
+	{
+		freeBlock_t* next;
+	};
+
+	std::mutex					m_lock;
+	freeBlock_t*				m_freeLists[ ClassCount ];
+	std::vector<uint8_t*>		m_chunks;
+	HeapImageAllocator			m_heap;
+
+	static uint32_t				SizeClass( const size_t byteCount );
+
+public:
+	PoolImageAllocator();
+	~PoolImageAllocator();
+
+	PoolImageAllocator( const PoolImageAllocator& ) = delete;
+	PoolImageAllocator& operator=( const PoolImageAllocator& ) = delete;
+
+	void*	Alloc( const size_t byteCount, const size_t alignment ) override;
+	void	Free( void* ptr, const size_t byteCount ) override;
+};
+
+
+// Linear allocator over one aligned block. Free() is a no-op inside the arena, Reset() releases everything at once.
+// Falls back to the heap when full.
+class ArenaImageAllocator : public ImageAllocator
+{
+private:
+	std::mutex					m_lock;
+	uint8_t*					m_base;
+	size_t						m_capacity;
+	size_t						m_offset;
+	HeapImageAllocator			m_heap;
+
+public:
+	ArenaImageAllocator( const size_t capacity );
+	~ArenaImageAllocator();
+
+	ArenaImageAllocator( const ArenaImageAllocator& ) = delete;
+	ArenaImageAllocator& operator=( const ArenaImageAllocator& ) = delete;
+
+	void*	Alloc( const size_t byteCount, const size_t alignment ) override;
+	void	Free( void* ptr, const size_t byteCount ) override;
+
+	// Only valid once every image allocated from the arena is destroyed
+	void	Reset();
+
+	inline size_t BytesUsed() const
+	{
+		return m_offset;
+	}
+};
+
+
+ImageAllocator* DefaultImageAllocator();
@@ -0,0 +1,518 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#include "imageFilter.h"
+
+#include <cmath>
+
+#include "texelConvert.h"
+#include "../core/parallel.h"
+#include "../core/simd.h"
+
+static const uint32_t RowGrainSize = 16;
+static const uint32_t TileSize = 64;
+static const uint32_t StripFloats = 256;
+static const uint32_t GaussianDirectMaxRadius = 8;
+static const uint32_t GaussianBoxPasses = 3;
+
+
+// Maps a texel coordinate outside [0, size) to the one it reads, or -1 when it reads zero
+static inline int32_t EdgeIndex( const int32_t i, const int32_t size, const filterEdge_t edge )
+{
+	if ( ( i >= 0 ) && ( i < size ) ) {
+		return i;
+	}
+
+	switch ( edge )
+	{
+		case FILTER_EDGE_WRAP: return ( ( i % size ) + size ) % size;
+		case FILTER_EDGE_MIRROR:
+		{
+			const int32_t period = 2 * size;
+			const int32_t m = ( ( i % period ) + period ) % period;
+			return ( m < size ) ? m : ( period - 1 - m );
+		}
+		case FILTER_EDGE_ZERO: return -1;
+		default: return Clamp( i, 0, size - 1 );
+	}
+}
+
+
+// Copies a row with radius texels of edge handling on both sides
+static void PadRow( const float* row, const uint32_t width, const uint32_t radius, const filterEdge_t edge, float* padded )
+{
+	const int32_t count = static_cast<int32_t>( width + 2 * radius );
+	for ( int32_t p = 0; p < count; ++p )
+	{
+		const int32_t x = EdgeIndex( p - static_cast<int32_t>( radius ), static_cast<int32_t>( width ), edge );
+		for ( uint32_t c = 0; c < 4; ++c ) {
+			padded[ 4 * p + c ] = ( x >= 0 ) ? row[ 4 * x + c ] : 0.0f;
+		}
+	}
+}
+
+
+static void ConvolveRow( const float* padded, const uint32_t width, const float* kernel, const uint32_t taps, float* dst )
+{
+	for ( uint32_t x = 0; x < width; ++x )
+	{
+		const float* window = padded + 4 * x;
+#if defined( GFX_SIMD_SSE )
+		__m128 sum = _mm_setzero_ps();
+		for ( uint32_t k = 0; k < taps; ++k ) {
+			sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( kernel[ k ] ), _mm_loadu_ps( window + 4 * k ) ) );
+		}
+		_mm_storeu_ps( dst + 4 * x, sum );
+#else
+		float sum[ 4 ] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for ( uint32_t k = 0; k < taps; ++k ) {
+			for ( uint32_t c = 0; c < 4; ++c ) {
+				sum[ c ] += kernel[ k ] * window[ 4 * k + c ];
+			}
+		}
+		for ( uint32_t c = 0; c < 4; ++c ) {
+			dst[ 4 * x + c ] = sum[ c ];
+		}
+#endif
+	}
+}
+
+
+// dst += weight * src over count floats
+static inline void AccumulateRow( const float* src, const float weight, const uint32_t count, float* dst )
+{
+	uint32_t i = 0;
+#if defined( GFX_SIMD_SSE )
+	const __m128 w = _mm_set1_ps( weight );
+	for ( ; ( i + 4 ) <= count; i += 4 ) {
+		_mm_storeu_ps( dst + i, _mm_add_ps( _mm_loadu_ps( dst + i ), _mm_mul_ps( w, _mm_loadu_ps( src + i ) ) ) );
+	}
+#endif
+	for ( ; i < count; ++i ) {
+		dst[ i ] += weight * src[ i ];
+	}
+}
+
+
+void BuildGaussianKernel( const float sigma, std::vector<float>& weights )
+{
+	const int32_t radius = static_cast<int32_t>( ceilf( 3.0f * Max( sigma, 0.0f ) ) );
+	weights.resize( 2 * radius + 1 );
+
+	if ( radius == 0 )
+	{
+		weights[ 0 ] = 1.0f;
+		return;
+	}
+
+	const float invTwoSigmaSq = 1.0f / ( 2.0f * sigma * sigma );
+	float sum = 0.0f;
+	for ( int32_t i = -radius; i <= radius; ++i )
+	{
+		const float w = expf( -static_cast<float>( i * i ) * invTwoSigmaSq );
+		weights[ i + radius ] = w;
+		sum += w;
+	}
+	for ( float& w : weights ) {
+		w /= sum;
+	}
+}
+
+
+void ConvolveSeparableSurface( const float* src, const uint32_t width, const uint32_t height, float* dst, const float* kernelX, const uint32_t radiusX, const float* kernelY, const uint32_t radiusY, const filterEdge_t edge )
+{
+	if ( ( width == 0 ) || ( height == 0 ) ) {
+		return;
+	}
+
+	const uint32_t rowFloats = 4 * width;
+	std::vector<float> scratch( static_cast<size_t>( height ) * rowFloats );
+
+	ParallelFor( height, RowGrainSize, [&]( const uint32_t begin, const uint32_t end )
+	{
+		std::vector<float> padded( 4 * static_cast<size_t>( width + 2 * radiusX ) );
+		for ( uint32_t y = begin; y < end; ++y )
+		{
+			PadRow( src + static_cast<size_t>( y ) * rowFloats, width, radiusX, edge, padded.data() );
+			ConvolveRow( padded.data(), width, kernelX, 2 * radiusX + 1, scratch.data() + static_cast<size_t>( y ) * rowFloats );
+		}
+	} );
+
+	// Whole rows at a time keeps the vertical reads sequential
+	ParallelFor( height, RowGrainSize, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t y = begin; y < end; ++y )
+		{
+			float* row = dst + static_cast<size_t>( y ) * rowFloats;
+			for ( uint32_t i = 0; i < rowFloats; ++i ) {
+				row[ i ] = 0.0f;
+			}
+
+			for ( uint32_t k = 0; k <= 2 * radiusY; ++k )
+			{
+				const int32_t sy = EdgeIndex( static_cast<int32_t>( y + k ) - static_cast<int32_t>( radiusY ), static_cast<int32_t>( height ), edge );
+				if ( sy >= 0 ) {
+					AccumulateRow( scratch.data() + static_cast<size_t>( sy ) * rowFloats, kernelY[ k ], rowFloats, row );
+				}
+			}
+		}
+	} );
+}
+
+
+void BoxBlurSurface( const float* src, const uint32_t width, const uint32_t height, float* dst, const uint32_t radiusX, const uint32_t radiusY, const filterEdge_t edge )
+{
+	if ( ( width == 0 ) || ( height == 0 ) ) {
+		return;
+	}
+
+	const uint32_t rowFloats = 4 * width;
+	std::vector<float> scratch( static_cast<size_t>( height ) * rowFloats );
+
+	const float scaleX = 1.0f / static_cast<float>( 2 * radiusX + 1 );
+	const float scaleY = 1.0f / static_cast<float>( 2 * radiusY + 1 );
+
+	ParallelFor( height, RowGrainSize, [&]( const uint32_t begin, const uint32_t end )
+	{
+		const uint32_t taps = 2 * radiusX + 1;
+		std::vector<float> padded( 4 * static_cast<size_t>( width + 2 * radiusX ) );
+
+		for ( uint32_t y = begin; y < end; ++y )
+		{
+			PadRow( src + static_cast<size_t>( y ) * rowFloats, width, radiusX, edge, padded.data() );
+			float* out = scratch.data() + static_cast<size_t>( y ) * rowFloats;
+			const float* p = padded.data();
+
+#if defined( GFX_SIMD_SSE )
+			const __m128 scale = _mm_set1_ps( scaleX );
+			__m128 sum = _mm_setzero_ps();
+			for ( uint32_t k = 0; k < taps; ++k ) {
+				sum = _mm_add_ps( sum, _mm_loadu_ps( p + 4 * k ) );
+			}
+			_mm_storeu_ps( out, _mm_mul_ps( sum, scale ) );
+
+			for ( uint32_t x = 1; x < width; ++x )
+			{
+				sum = _mm_add_ps( sum, _mm_sub_ps( _mm_loadu_ps( p + 4 * ( x + taps - 1 ) ), _mm_loadu_ps( p + 4 * ( x - 1 ) ) ) );
+				_mm_storeu_ps( out + 4 * x, _mm_mul_ps( sum, scale ) );
+			}
+#else
+			float sum[ 4 ] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for ( uint32_t k = 0; k < taps; ++k ) {
+				for ( uint32_t c = 0; c < 4; ++c ) {
+					sum[ c ] += p[ 4 * k + c ];
+				}
+			}
+			for ( uint32_t c = 0; c < 4; ++c ) {
+				out[ c ] = sum[ c ] * scaleX;
+			}
+
+			for ( uint32_t x = 1; x < width; ++x )
+			{
+				for ( uint32_t c = 0; c < 4; ++c )
+				{
+					sum[ c ] += p[ 4 * ( x + taps - 1 ) + c ] - p[ 4 * ( x - 1 ) + c ];
+					out[ 4 * x + c ] = sum[ c ] * scaleX;
+				}
+			}
+#endif
+		}
+	} );
+
+	// The vertical running sum has to walk down the image, so split the columns into strips instead of rows
+	const uint32_t stripCount = ( rowFloats + StripFloats - 1 ) / StripFloats;
+	ParallelFor( stripCount, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		float sum[ StripFloats ];
+		for ( uint32_t strip = begin; strip < end; ++strip )
+		{
+			const uint32_t first = strip * StripFloats;
+			const uint32_t count = Min( StripFloats, rowFloats - first );
+
+			auto rowAt = [&]( const int32_t y ) -> const float*
+			{
+				const int32_t sy = EdgeIndex( y, static_cast<int32_t>( height ), edge );
+				return ( sy >= 0 ) ? ( scratch.data() + static_cast<size_t>( sy ) * rowFloats + first ) : nullptr;
+			};
+
+			for ( uint32_t i = 0; i < count; ++i ) {
+				sum[ i ] = 0.0f;
+			}
+			for ( int32_t k = -static_cast<int32_t>( radiusY ); k <= static_cast<int32_t>( radiusY ); ++k )
+			{
+				const float* row = rowAt( k );
+				if ( row != nullptr ) {
+					AccumulateRow( row, 1.0f, count, sum );
+				}
+			}
+
+			for ( uint32_t y = 0; y < height; ++y )
+			{
+				float* out = dst + static_cast<size_t>( y ) * rowFloats + first;
+				for ( uint32_t i = 0; i < count; ++i ) {
+					out[ i ] = sum[ i ] * scaleY;
+				}
+
+				const float* enter = rowAt( static_cast<int32_t>( y + radiusY + 1 ) );
+				const float* leave = rowAt( static_cast<int32_t>( y ) - static_cast<int32_t>( radiusY ) );
+				if ( enter != nullptr ) {
+					AccumulateRow( enter, 1.0f, count, sum );
+				}
+				if ( leave != nullptr ) {
+					AccumulateRow( leave, -1.0f, count, sum );
+				}
+			}
+		}
+	} );
+}
+
+
+// Three box passes whose combined variance matches sigma, see "Efficient Gaussian blur with linear time" ( Kovesi )
+static void GaussianBoxRadii( const float sigma, uint32_t radii[ GaussianBoxPasses ] )
+{
+	const float n = static_cast<float>( GaussianBoxPasses );
+	const float idealWidth = sqrtf( 12.0f * sigma * sigma / n + 1.0f );
+
+	int32_t lower = static_cast<int32_t>( floorf( idealWidth ) );
+	if ( ( lower % 2 ) == 0 ) {
+		--lower;
+	}
+	const int32_t upper = lower + 2;
+
+	const float idealLowerCount = ( 12.0f * sigma * sigma - n * lower * lower - 4.0f * n * lower - 3.0f * n ) / ( -4.0f * lower - 4.0f );
+	const uint32_t lowerCount = static_cast<uint32_t>( Max( 0.0f, roundf( idealLowerCount ) ) );
+
+	for ( uint32_t i = 0; i < GaussianBoxPasses; ++i ) {
+		radii[ i ] = static_cast<uint32_t>( ( ( i < lowerCount ) ? lower : upper ) - 1 ) / 2;
+	}
+}
+
+
+void GaussianBlurSurface( const float* src, const uint32_t width, const uint32_t height, float* dst, const float sigma, const filterEdge_t edge )
+{
+	if ( ( width == 0 ) || ( height == 0 ) ) {
+		return;
+	}
+
+	const uint32_t radius = static_cast<uint32_t>( ceilf( 3.0f * Max( sigma, 0.0f ) ) );
+	if ( radius == 0 )
+	{
+		memcpy( dst, src, 4 * sizeof( float ) * width * height );
+		return;
+	}
+
+	if ( radius <= GaussianDirectMaxRadius )
+	{
+		std::vector<float> kernel;
+		BuildGaussianKernel( sigma, kernel );
+		ConvolveSeparableSurface( src, width, height, dst, kernel.data(), radius, kernel.data(), radius, edge );
+		return;
+	}
+
+	uint32_t radii[ GaussianBoxPasses ];
+	GaussianBoxRadii( sigma, radii );
+
+	// Ping-pong so the last pass lands in dst
+	std::vector<float> temp( 4 * static_cast<size_t>( width ) * height );
+	BoxBlurSurface( src, width, height, dst, radii[ 0 ], radii[ 0 ], edge );
+	BoxBlurSurface( dst, width, height, temp.data(), radii[ 1 ], radii[ 1 ], edge );
+	BoxBlurSurface( temp.data(), width, height, dst, radii[ 2 ], radii[ 2 ], edge );
+}
+
+
+void ConvolveSurface( const float* src, const uint32_t width, const uint32_t height, float* dst, const float* kernel, const uint32_t kernelWidth, const uint32_t kernelHeight, const filterEdge_t edge )
+{
+	if ( ( width == 0 ) || ( height == 0 ) || ( kernelWidth == 0 ) || ( kernelHeight == 0 ) ) {
+		return;
+	}
+
+	const uint32_t radiusX = kernelWidth / 2;
+	const uint32_t radiusY = kernelHeight / 2;
+	const uint32_t paddedWidth = width + kernelWidth - 1;
+	const uint32_t paddedHeight = height + kernelHeight - 1;
+	const size_t paddedRowFloats = 4 * static_cast<size_t>( paddedWidth );
+
+	// Resolve the edges once up front so the inner loop has no bounds checks
+	std::vector<float> padded( paddedRowFloats * paddedHeight );
+	ParallelFor( paddedHeight, RowGrainSize, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t py = begin; py < end; ++py )
+		{
+			float* row = padded.data() + py * paddedRowFloats;
+			const int32_t sy = EdgeIndex( static_cast<int32_t>( py ) - static_cast<int32_t>( radiusY ), static_cast<int32_t>( height ), edge );
+			if ( sy < 0 )
+			{
+				memset( row, 0, paddedRowFloats * sizeof( float ) );
+				continue;
+			}
+
+			for ( uint32_t px = 0; px < paddedWidth; ++px )
+			{
+				const int32_t sx = EdgeIndex( static_cast<int32_t>( px ) - static_cast<int32_t>( radiusX ), static_cast<int32_t>( width ), edge );
+				for ( uint32_t c = 0; c < 4; ++c ) {
+					row[ 4 * px + c ] = ( sx >= 0 ) ? src[ 4 * ( static_cast<size_t>( sy ) * width + sx ) + c ] : 0.0f;
+				}
+			}
+		}
+	} );
+
+	const uint32_t tilesX = ( width + TileSize - 1 ) / TileSize;
+	const uint32_t tilesY = ( height + TileSize - 1 ) / TileSize;
+
+	ParallelFor( tilesX * tilesY, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t tile = begin; tile < end; ++tile )
+		{
+			const uint32_t x0 = ( tile % tilesX ) * TileSize;
+			const uint32_t y0 = ( tile / tilesX ) * TileSize;
+			const uint32_t x1 = Min( x0 + TileSize, width );
+			const uint32_t y1 = Min( y0 + TileSize, height );
+
+			for ( uint32_t y = y0; y < y1; ++y )
+			{
+				float* out = dst + 4 * ( static_cast<size_t>( y ) * width );
+				for ( uint32_t x = x0; x < x1; ++x )
+				{
+#if defined( GFX_SIMD_SSE )
+					__m128 sum = _mm_setzero_ps();
+					for ( uint32_t ky = 0; ky < kernelHeight; ++ky )
+					{
+						const float* window = padded.data() + ( y + ky ) * paddedRowFloats + 4 * x;
+						const float* weights = kernel + ky * kernelWidth;
+						for ( uint32_t kx = 0; kx < kernelWidth; ++kx ) {
+							sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( weights[ kx ] ), _mm_loadu_ps( window + 4 * kx ) ) );
+						}
+					}
+					_mm_storeu_ps( out + 4 * x, sum );
+#else
+					float sum[ 4 ] = { 0.0f, 0.0f, 0.0f, 0.0f };
+					for ( uint32_t ky = 0; ky < kernelHeight; ++ky )
+					{
+						const float* window = padded.data() + ( y + ky ) * paddedRowFloats + 4 * x;
+						const float* weights = kernel + ky * kernelWidth;
+						for ( uint32_t kx = 0; kx < kernelWidth; ++kx ) {
+							for ( uint32_t c = 0; c < 4; ++c ) {
+								sum[ c ] += weights[ kx ] * window[ 4 * kx + c ];
+							}
+						}
+					}
+					for ( uint32_t c = 0; c < 4; ++c ) {
+						out[ 4 * x + c ] = sum[ c ];
+					}
+#endif
+				}
+			}
+		}
+	} );
+}
+
+
+// Runs filter( srcTexels, dstTexels, width, height ) on the top mip of every layer
+template<typename T, class Filter>
+static bool FilterImage( const ImageBuffer<T>& src, const imageFilterSettings_t& settings, ImageBuffer<T>& dst, const Filter& filter )
+{
+	if ( ( src.GetWidth() == 0 ) || ( src.GetHeight() == 0 ) || ( &src == &dst ) ) {
+		return false;
+	}
+
+	imageBufferInfo_t info {};
+	info.width = src.GetWidth();
+	info.height = src.GetHeight();
+	info.layers = src.GetLayers();
+	info.mipCount = 1;
+	info.bpp = sizeof( T );
+
+	dst.Init( info, src.GetName() );
+
+	std::vector<float> srcTexels;
+	std::vector<float> dstTexels( 4 * static_cast<size_t>( info.width ) * info.height );
+
+	for ( uint32_t layer = 0; layer < info.layers; ++layer )
+	{
+		LoadSliceFloat4<T>( src.GetSlice( layer, 0 ), settings.srgb, settings.alphaWeighted, srcTexels );
+		filter( srcTexels.data(), dstTexels.data(), info.width, info.height );
+		StoreSliceFloat4<T>( dstTexels, settings.srgb, settings.alphaWeighted, dst.GetSlice( layer, 0 ) );
+	}
+	return true;
+}
+
+
+template<typename T>
+bool GaussianBlurImage( const ImageBuffer<T>& src, const float sigma, const imageFilterSettings_t& settings, ImageBuffer<T>& dst )
+{
+	return FilterImage( src, settings, dst, [&]( const float* in, float* out, const uint32_t width, const uint32_t height ) {
+		GaussianBlurSurface( in, width, height, out, sigma, settings.edge );
+	} );
+}
+
+
+template<typename T>
+bool BoxBlurImage( const ImageBuffer<T>& src, const uint32_t radius, const imageFilterSettings_t& settings, ImageBuffer<T>& dst )
+{
+	return FilterImage( src, settings, dst, [&]( const float* in, float* out, const uint32_t width, const uint32_t height ) {
+		BoxBlurSurface( in, width, height, out, radius, radius, settings.edge );
+	} );
+}
+
+
+template<typename T>
+bool ConvolveImage( const ImageBuffer<T>& src, const float* kernel, const uint32_t kernelWidth, const uint32_t kernelHeight, const imageFilterSettings_t& settings, ImageBuffer<T>& dst )
+{
+	if ( ( kernel == nullptr ) || ( kernelWidth == 0 ) || ( kernelHeight == 0 ) ) {
+		return false;
+	}
+
+	return FilterImage( src, settings, dst, [&]( const float* in, float* out, const uint32_t width, const uint32_t height ) {
+		ConvolveSurface( in, width, height, out, kernel, kernelWidth, kernelHeight, settings.edge );
+	} );
+}
+
+
+template bool GaussianBlurImage<uint8_t>( const ImageBuffer<uint8_t>&, const float, const imageFilterSettings_t&, ImageBuffer<uint8_t>& );
+template bool GaussianBlurImage<uint16_t>( const ImageBuffer<uint16_t>&, const float, const imageFilterSettings_t&, ImageBuffer<uint16_t>& );
+template bool GaussianBlurImage<float>( const ImageBuffer<float>&, const float, const imageFilterSettings_t&, ImageBuffer<float>& );
+template bool GaussianBlurImage<rgb8_t>( const ImageBuffer<rgb8_t>&, const float, const imageFilterSettings_t&, ImageBuffer<rgb8_t>& );
+template bool GaussianBlurImage<rgba8_t>( const ImageBuffer<rgba8_t>&, const float, const imageFilterSettings_t&, ImageBuffer<rgba8_t>& );
+template bool GaussianBlurImage<rgb16_t>( const ImageBuffer<rgb16_t>&, const float, const imageFilterSettings_t&, ImageBuffer<rgb16_t>& );
+template bool GaussianBlurImage<rgba16_t>( const ImageBuffer<rgba16_t>&, const float, const imageFilterSettings_t&, ImageBuffer<rgba16_t>& );
+template bool GaussianBlurImage<Color>( const ImageBuffer<Color>&, const float, const imageFilterSettings_t&, ImageBuffer<Color>& );
+
+template bool BoxBlurImage<uint8_t>( const ImageBuffer<uint8_t>&, const uint32_t, const imageFilterSettings_t&, ImageBuffer<uint8_t>& );
+template bool BoxBlurImage<uint16_t>( const ImageBuffer<uint16_t>&, const uint32_t, const imageFilterSettings_t&, ImageBuffer<uint16_t>& );
+template bool BoxBlurImage<float>( const ImageBuffer<float>&, const uint32_t, const imageFilterSettings_t&, ImageBuffer<float>& );
+template bool BoxBlurImage<rgb8_t>( const ImageBuffer<rgb8_t>&, const uint32_t, const imageFilterSettings_t&, ImageBuffer<rgb8_t>& );
+template bool BoxBlurImage<rgba8_t>( const ImageBuffer<rgba8_t>&, const uint32_t, const imageFilterSettings_t&, ImageBuffer<rgba8_t>& );
+template bool BoxBlurImage<rgb16_t>( const ImageBuffer<rgb16_t>&, const uint32_t, const imageFilterSettings_t&, ImageBuffer<rgb16_t>& );
+template bool BoxBlurImage<rgba16_t>( const ImageBuffer<rgba16_t>&, const uint32_t, const imageFilterSettings_t&, ImageBuffer<rgba16_t>& );
+template bool BoxBlurImage<Color>( const ImageBuffer<Color>&, const uint32_t, const imageFilterSettings_t&, ImageBuffer<Color>& );
+
+template bool ConvolveImage<uint8_t>( const ImageBuffer<uint8_t>&, const float*, const uint32_t, const uint32_t, const imageFilterSettings_t&, ImageBuffer<uint8_t>& );
+template bool ConvolveImage<uint16_t>( const ImageBuffer<uint16_t>&, const float*, const uint32_t, const uint32_t, const imageFilterSettings_t&, ImageBuffer<uint16_t>& );
+template bool ConvolveImage<float>( const ImageBuffer<float>&, const float*, const uint32_t, const uint32_t, const imageFilterSettings_t&, ImageBuffer<float>& );
+template bool ConvolveImage<rgb8_t>( const ImageBuffer<rgb8_t>&, const float*, const uint32_t, const uint32_t, const imageFilterSettings_t&, ImageBuffer<rgb8_t>& );
+template bool ConvolveImage<rgba8_t>( const ImageBuffer<rgba8_t>&, const float*, const uint32_t, const uint32_t, const imageFilterSettings_t&, ImageBuffer<rgba8_t>& );
+template bool ConvolveImage<rgb16_t>( const ImageBuffer<rgb16_t>&, const float*, const uint32_t, const uint32_t, const imageFilterSettings_t&, ImageBuffer<rgb16_t>& );
+template bool ConvolveImage<rgba16_t>( const ImageBuffer<rgba16_t>&, const float*, const uint32_t, const uint32_t, const imageFilterSettings_t&, ImageBuffer<rgba16_t>& );
+template bool ConvolveImage<Color>( const ImageBuffer<Color>&, const float*, const uint32_t, const uint32_t, const imageFilterSettings_t&, ImageBuffer<Color>& );
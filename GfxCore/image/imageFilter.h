@@ -0,0 +1,76 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <vector>
+
+#include "image.h"
+
+enum filterEdge_t : uint32_t
+{
+	FILTER_EDGE_CLAMP,
+	FILTER_EDGE_WRAP,
+	FILTER_EDGE_MIRROR,		// Reflects including the edge texel, dcba|abcd|dcba
+	FILTER_EDGE_ZERO,		// Texels outside the image read as transparent black
+};
+
+struct imageFilterSettings_t
+{
+	filterEdge_t	edge;
+	bool			srgb;			// Decode RGB to linear light before filtering and re-encode after
+	bool			alphaWeighted;	// Filter premultiplied so fully transparent texels don't bleed their color
+
+	imageFilterSettings_t() : edge( FILTER_EDGE_CLAMP ), srgb( false ), alphaWeighted( true ) {}
+};
+
+/* === Image Filters - Convolution of tightly packed 4 channel float surfaces === */
+// Source and destination surfaces must not alias. Rows, or tiles for 2D kernels, are spread across threads.
+
+// Normalized Gaussian weights for offsets -radius..radius with radius = ceil( 3 * sigma )
+void BuildGaussianKernel( const float sigma, std::vector<float>& weights );
+
+// Horizontal then vertical pass, each kernel holds 2 * radius + 1 weights
+void ConvolveSeparableSurface( const float* src, const uint32_t width, const uint32_t height, float* dst, const float* kernelX, const uint32_t radiusX, const float* kernelY, const uint32_t radiusY, const filterEdge_t edge );
+
+// Running sums, the cost per texel doesn't depend on the radius
+void BoxBlurSurface( const float* src, const uint32_t width, const uint32_t height, float* dst, const uint32_t radiusX, const uint32_t radiusY, const filterEdge_t edge );
+
+// Direct separable kernel for small sigma, three box passes of matching variance once the kernel gets wide
+void GaussianBlurSurface( const float* src, const uint32_t width, const uint32_t height, float* dst, const float sigma, const filterEdge_t edge );
+
+// Arbitrary kernelWidth x kernelHeight kernel, row-major and centered on kernel[ kernelHeight / 2 ][ kernelWidth / 2 ]
+void ConvolveSurface( const float* src, const uint32_t width, const uint32_t height, float* dst, const float* kernel, const uint32_t kernelWidth, const uint32_t kernelHeight, const filterEdge_t edge );
+
+// Image versions filter the top mip of every layer into dst, which is created without mips.
+// Instantiated for every texel type Image::Create makes except block formats.
+template<typename T>
+bool GaussianBlurImage( const ImageBuffer<T>& src, const float sigma, const imageFilterSettings_t& settings, ImageBuffer<T>& dst );
+
+template<typename T>
+bool BoxBlurImage( const ImageBuffer<T>& src, const uint32_t radius, const imageFilterSettings_t& settings, ImageBuffer<T>& dst );
+
+template<typename T>
+bool ConvolveImage( const ImageBuffer<T>& src, const float* kernel, const uint32_t kernelWidth, const uint32_t kernelHeight, const imageFilterSettings_t& settings, ImageBuffer<T>& dst );
@@ -0,0 +1,144 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "rectPacker.h"
+#include "../core/common.h"
+
+
+void SkylinePacker::Init( const uint32_t width, const uint32_t height )
+{
+	m_width = width;
+	m_height = height;
+	m_usedHeight = 0;
+	m_usedArea = 0;
+
+	m_skyline.clear();
+	m_skyline.push_back( { 0, 0, width } );
+}
+
+
+bool SkylinePacker::Fit( const uint32_t index, const uint32_t width, const uint32_t height, uint32_t& y ) const
+{
+	const uint32_t x = m_skyline[ index ].x;
+	if ( ( x + width ) > m_width ) {
+		return false;
+	}
+
+	// The rect rests on the highest node it spans
+	uint32_t widthLeft = width;
+	uint32_t i = index;
+	y = m_skyline[ index ].y;
+	while ( widthLeft > 0 )
+	{
+		y = Max( y, m_skyline[ i ].y );
+		if ( ( y + height ) > m_height ) {
+			return false;
+		}
+		widthLeft -= Min( widthLeft, m_skyline[ i ].width );
+		++i;
+	}
+	return true;
+}
+
+
+void SkylinePacker::AddLevel( const uint32_t index, const uint32_t x, const uint32_t y, const uint32_t width, const uint32_t height )
+{
+	m_skyline.insert( m_skyline.begin() + index, { x, y + height, width } );
+
+	// Trim or remove the nodes now covered by the new one
+	for ( uint32_t i = index + 1; i < m_skyline.size(); )
+	{
+		skylineNode_t& prev = m_skyline[ i - 1 ];
+		skylineNode_t& node = m_skyline[ i ];
+
+		const uint32_t prevEnd = prev.x + prev.width;
+		if ( node.x >= prevEnd ) {
+			break;
+		}
+
+		const uint32_t shrink = prevEnd - node.x;
+		if ( node.width > shrink )
+		{
+			node.x += shrink;
+			node.width -= shrink;
+			break;
+		}
+		m_skyline.erase( m_skyline.begin() + i );
+	}
+
+	// Merge neighbors at the same height
+	for ( uint32_t i = 0; ( i + 1 ) < m_skyline.size(); )
+	{
+		if ( m_skyline[ i ].y == m_skyline[ i + 1 ].y )
+		{
+			m_skyline[ i ].width += m_skyline[ i + 1 ].width;
+			m_skyline.erase( m_skyline.begin() + i + 1 );
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+
+bool SkylinePacker::Insert( const uint32_t width, const uint32_t height, uint32_t& x, uint32_t& y )
+{
+	if ( ( width == 0 ) || ( height == 0 ) ) {
+		return false;
+	}
+
+	uint32_t bestIndex = UINT32_MAX;
+	uint32_t bestY = UINT32_MAX;
+	uint32_t bestWidth = UINT32_MAX;
+
+	const uint32_t nodeCount = static_cast<uint32_t>( m_skyline.size() );
+	for ( uint32_t i = 0; i < nodeCount; ++i )
+	{
+		uint32_t fitY;
+		if ( Fit( i, width, height, fitY ) == false ) {
+			continue;
+		}
+
+		const uint32_t top = fitY + height;
+		if ( ( top < bestY ) || ( ( top == bestY ) && ( m_skyline[ i ].width < bestWidth ) ) )
+		{
+			bestIndex = i;
+			bestY = top;
+			bestWidth = m_skyline[ i ].width;
+			y = fitY;
+		}
+	}
+
+	if ( bestIndex == UINT32_MAX ) {
+		return false;
+	}
+
+	x = m_skyline[ bestIndex ].x;
+	AddLevel( bestIndex, x, y, width, height );
+
+	m_usedHeight = Max( m_usedHeight, y + height );
+	m_usedArea += static_cast<uint64_t>( width ) * height;
+	return true;
+}
@@ -0,0 +1,82 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Skyline bottom-left rectangle packer. Places each rect at the lowest spot along the skyline, ties go to the
+// narrowest segment. Fast and within a few percent of maxrects when rects are inserted tallest first.
+class SkylinePacker
+{
+private:
+	struct skylineNode_t
+	{
+		uint32_t	x;
+		uint32_t	y;
+		uint32_t	width;
+	};
+
+	std::vector<skylineNode_t>	m_skyline;
+	uint32_t					m_width;
+	uint32_t					m_height;
+	uint32_t					m_usedHeight;
+	uint64_t					m_usedArea;
+
+	bool	Fit( const uint32_t index, const uint32_t width, const uint32_t height, uint32_t& y ) const;
+	void	AddLevel( const uint32_t index, const uint32_t x, const uint32_t y, const uint32_t width, const uint32_t height );
+
+public:
+	SkylinePacker() : m_width( 0 ), m_height( 0 ), m_usedHeight( 0 ), m_usedArea( 0 ) {}
+	SkylinePacker( const uint32_t width, const uint32_t height )
+	{
+		Init( width, height );
+	}
+
+	void	Init( const uint32_t width, const uint32_t height );
+	bool	Insert( const uint32_t width, const uint32_t height, uint32_t& x, uint32_t& y );
+
+	inline uint32_t GetWidth() const
+	{
+		return m_width;
+	}
+
+	inline uint32_t GetHeight() const
+	{
+		return m_height;
+	}
+
+	// Highest occupied row, callers can crop the target to this
+	inline uint32_t UsedHeight() const
+	{
+		return m_usedHeight;
+	}
+
+	inline float Occupancy() const
+	{
+		const uint64_t area = static_cast<uint64_t>( m_width ) * m_height;
+		return ( area > 0 ) ? static_cast<float>( m_usedArea ) / static_cast<float>( area ) : 0.0f;
+	}
+};
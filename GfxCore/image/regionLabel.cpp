@@ -0,0 +1,274 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#include "regionLabel.h"
+
+#include "../core/parallel.h"
+
+static const uint32_t BandRows = 64;
+
+
+// Union by smallest index keeps every parent below its child, which the flatten pass relies on
+static inline uint32_t FindRoot( uint32_t* parent, uint32_t i )
+{
+	while ( parent[ i ] != i )
+	{
+		parent[ i ] = parent[ parent[ i ] ];
+		i = parent[ i ];
+	}
+	return i;
+}
+
+
+static inline uint32_t UnionRoots( uint32_t* parent, const uint32_t a, const uint32_t b )
+{
+	const uint32_t rootA = FindRoot( parent, a );
+	const uint32_t rootB = FindRoot( parent, b );
+	if ( rootA < rootB ) {
+		parent[ rootB ] = rootA;
+		return rootA;
+	}
+	parent[ rootA ] = rootB;
+	return rootB;
+}
+
+
+uint32_t LabelConnectedComponents( const ImageBuffer<uint8_t>& mask, const labelConnectivity_t connectivity, ImageBuffer<uint32_t>& labels, std::vector<componentStats_t>* stats )
+{
+	const uint32_t width = mask.GetWidth();
+	const uint32_t height = mask.GetHeight();
+
+	if ( ( labels.GetWidth() != width ) || ( labels.GetHeight() != height ) || ( labels.GetLayers() != 1 ) || ( labels.GetMipCount() != 1 ) ) {
+		labels.Init( width, height, sizeof( uint32_t ), "_componentLabels" );
+	}
+	if ( stats != nullptr ) {
+		stats->clear();
+	}
+	if ( ( width == 0 ) || ( height == 0 ) ) {
+		return 0;
+	}
+
+	const uint8_t* maskTexels = reinterpret_cast<const uint8_t*>( mask.GetSlice( 0, 0 ).ptr );
+	uint32_t* labelTexels = reinterpret_cast<uint32_t*>( labels.GetSlice( 0, 0 ).ptr );
+	const bool diagonal = ( connectivity == LABEL_CONNECTIVITY_8 );
+
+	const uint32_t bandCount = ( height + BandRows - 1 ) / BandRows;
+	std::vector< std::vector<uint32_t> > bandParents( bandCount );
+
+	// Pass 1: label each band on its own, texels hold band local label + 1
+	ParallelFor( bandCount, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t band = begin; band < end; ++band )
+		{
+			std::vector<uint32_t>& parent = bandParents[ band ];
+			parent.clear();
+
+			const uint32_t y0 = band * BandRows;
+			const uint32_t y1 = Min( y0 + BandRows, height );
+			for ( uint32_t y = y0; y < y1; ++y )
+			{
+				const uint8_t* m = maskTexels + static_cast<size_t>( y ) * width;
+				uint32_t* l = labelTexels + static_cast<size_t>( y ) * width;
+				const uint32_t* up = ( y > y0 ) ? ( l - width ) : nullptr;
+
+				for ( uint32_t x = 0; x < width; ++x )
+				{
+					if ( m[ x ] == 0 ) {
+						l[ x ] = 0;
+						continue;
+					}
+
+					uint32_t label = 0;
+					auto link = [&]( const uint32_t neighbor )
+					{
+						if ( neighbor == 0 ) {
+							return;
+						}
+						if ( label == 0 ) {
+							label = neighbor;
+						} else if ( neighbor != label ) {
+							label = UnionRoots( parent.data(), label - 1, neighbor - 1 ) + 1;
+						}
+					};
+
+					const uint32_t left = ( x > 0 ) ? l[ x - 1 ] : 0;
+					const uint32_t above = ( up != nullptr ) ? up[ x ] : 0;
+					if ( !diagonal )
+					{
+						link( left );
+						link( above );
+					}
+					else if ( above != 0 )
+					{
+						// Left and both upper diagonals already touch the texel above
+						link( above );
+					}
+					else if ( up != nullptr )
+					{
+						// Left and upper left touch each other, only upper right can join a different tree
+						link( ( left != 0 ) ? left : ( ( x > 0 ) ? up[ x - 1 ] : 0 ) );
+						link( ( ( x + 1 ) < width ) ? up[ x + 1 ] : 0 );
+					}
+					else
+					{
+						link( left );
+					}
+
+					if ( label == 0 )
+					{
+						parent.push_back( static_cast<uint32_t>( parent.size() ) );
+						label = static_cast<uint32_t>( parent.size() );
+					}
+					l[ x ] = label;
+				}
+			}
+		}
+	} );
+
+	// Pass 2: move the band tables into one global table and stitch the rows where bands meet
+	std::vector<uint32_t> bandBase( bandCount + 1, 0 );
+	for ( uint32_t band = 0; band < bandCount; ++band ) {
+		bandBase[ band + 1 ] = bandBase[ band ] + static_cast<uint32_t>( bandParents[ band ].size() );
+	}
+	const uint32_t provisionalCount = bandBase[ bandCount ];
+
+	std::vector<uint32_t> parent( provisionalCount );
+	ParallelFor( bandCount, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t band = begin; band < end; ++band )
+		{
+			const std::vector<uint32_t>& local = bandParents[ band ];
+			for ( size_t i = 0; i < local.size(); ++i ) {
+				parent[ bandBase[ band ] + i ] = bandBase[ band ] + local[ i ];
+			}
+		}
+	} );
+
+	for ( uint32_t band = 1; band < bandCount; ++band )
+	{
+		const uint32_t y = band * BandRows;
+		const uint32_t* l = labelTexels + static_cast<size_t>( y ) * width;
+		const uint32_t* up = l - width;
+		const uint32_t base = bandBase[ band ];
+		const uint32_t upBase = bandBase[ band - 1 ];
+
+		for ( uint32_t x = 0; x < width; ++x )
+		{
+			if ( l[ x ] == 0 ) {
+				continue;
+			}
+
+			const uint32_t x0 = ( diagonal && ( x > 0 ) ) ? ( x - 1 ) : x;
+			const uint32_t x1 = ( diagonal && ( ( x + 1 ) < width ) ) ? ( x + 1 ) : x;
+			for ( uint32_t nx = x0; nx <= x1; ++nx )
+			{
+				if ( up[ nx ] != 0 ) {
+					UnionRoots( parent.data(), base + l[ x ] - 1, upBase + up[ nx ] - 1 );
+				}
+			}
+		}
+	}
+
+	// Pass 3: roots come out in raster order of their first texel, so a single ascending sweep numbers them
+	std::vector<uint32_t> finalLabel( provisionalCount );
+	uint32_t componentCount = 0;
+	for ( uint32_t i = 0; i < provisionalCount; ++i ) {
+		finalLabel[ i ] = ( parent[ i ] == i ) ? ++componentCount : finalLabel[ parent[ i ] ];
+	}
+
+	// Pass 4: write final labels, gathering stats per provisional label so bands never share an entry
+	std::vector<componentStats_t> provisionalStats;
+	if ( stats != nullptr )
+	{
+		componentStats_t empty;
+		empty.area = 0;
+		empty.minX = width;
+		empty.minY = height;
+		empty.maxX = 0;
+		empty.maxY = 0;
+		provisionalStats.resize( provisionalCount, empty );
+	}
+
+	ParallelFor( bandCount, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t band = begin; band < end; ++band )
+		{
+			const uint32_t base = bandBase[ band ];
+			const uint32_t y0 = band * BandRows;
+			const uint32_t y1 = Min( y0 + BandRows, height );
+			for ( uint32_t y = y0; y < y1; ++y )
+			{
+				uint32_t* l = labelTexels + static_cast<size_t>( y ) * width;
+				for ( uint32_t x = 0; x < width; ++x )
+				{
+					if ( l[ x ] == 0 ) {
+						continue;
+					}
+
+					const uint32_t provisional = base + l[ x ] - 1;
+					l[ x ] = finalLabel[ provisional ];
+
+					if ( stats != nullptr )
+					{
+						componentStats_t& s = provisionalStats[ provisional ];
+						s.area++;
+						s.minX = Min( s.minX, x );
+						s.minY = Min( s.minY, y );
+						s.maxX = Max( s.maxX, x );
+						s.maxY = Max( s.maxY, y );
+					}
+				}
+			}
+		}
+	} );
+
+	if ( stats != nullptr )
+	{
+		componentStats_t empty;
+		empty.area = 0;
+		empty.minX = width;
+		empty.minY = height;
+		empty.maxX = 0;
+		empty.maxY = 0;
+		stats->resize( componentCount, empty );
+
+		for ( uint32_t i = 0; i < provisionalCount; ++i )
+		{
+			const componentStats_t& src = provisionalStats[ i ];
+			if ( src.area == 0 ) {
+				continue;
+			}
+
+			componentStats_t& dst = ( *stats )[ finalLabel[ i ] - 1 ];
+			dst.area += src.area;
+			dst.minX = Min( dst.minX, src.minX );
+			dst.minY = Min( dst.minY, src.minY );
+			dst.maxX = Max( dst.maxX, src.maxX );
+			dst.maxY = Max( dst.maxY, src.maxY );
+		}
+	}
+
+	return componentCount;
+}
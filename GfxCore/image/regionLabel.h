@@ -0,0 +1,52 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <vector>
+
+#include "image.h"
+
+enum labelConnectivity_t : uint32_t
+{
+	LABEL_CONNECTIVITY_4,
+	LABEL_CONNECTIVITY_8,
+};
+
+struct componentStats_t
+{
+	uint32_t	area;
+	uint32_t	minX;
+	uint32_t	minY;
+	uint32_t	maxX;
+	uint32_t	maxY;
+};
+
+/* === Connected Component Labeling === */
+// Every nonzero mask texel gets the label of its component, background stays 0.
+// Labels run 1..N in raster order of each component's first texel, independent of thread count.
+// Rows are labeled in parallel bands that are then stitched with union-find over the band labels.
+// Returns N, stats[ label - 1 ] holds each component's area and bounds when requested.
+uint32_t LabelConnectedComponents( const ImageBuffer<uint8_t>& mask, const labelConnectivity_t connectivity, ImageBuffer<uint32_t>& labels, std::vector<componentStats_t>* stats = nullptr );
@@ -0,0 +1,286 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "resample.h"
+
+#include <vector>
+
+#include "texelConvert.h"
+#include "../core/parallel.h"
+#include "../core/simd.h"
+
+struct filterTaps_t
+{
+	std::vector<uint32_t>	offsets;	// First tap of each output texel, one extra entry marks the end
+	std::vector<uint32_t>	indices;	// Source texel, already clamped to the edge
+	std::vector<float>		weights;
+};
+
+
+static inline float FilterRadius( const resampleFilter_t filter )
+{
+	switch ( filter )
+	{
+		case RESAMPLE_FILTER_BOX:		return 0.5f;
+		case RESAMPLE_FILTER_TRIANGLE:	return 1.0f;
+		case RESAMPLE_FILTER_MITCHELL:	return 2.0f;
+		default:						return 3.0f;
+	}
+}
+
+
+static inline float Sinc( const float x )
+{
+	if ( fabsf( x ) < 1e-5f ) {
+		return 1.0f;
+	}
+	const float px = PI * x;
+	return sinf( px ) / px;
+}
+
+
+static inline float FilterWeight( const resampleFilter_t filter, const float x )
+{
+	const float ax = fabsf( x );
+	switch ( filter )
+	{
+		case RESAMPLE_FILTER_BOX:
+		{
+			return ( ( x >= -0.5f ) && ( x < 0.5f ) ) ? 1.0f : 0.0f;
+		}
+		case RESAMPLE_FILTER_TRIANGLE:
+		{
+			return Max( 0.0f, 1.0f - ax );
+		}
+		case RESAMPLE_FILTER_MITCHELL:
+		{
+			const float B = 1.0f / 3.0f;
+			const float C = 1.0f / 3.0f;
+			if ( ax < 1.0f ) {
+				return ( ( 12.0f - 9.0f * B - 6.0f * C ) * ax * ax * ax + ( -18.0f + 12.0f * B + 6.0f * C ) * ax * ax + ( 6.0f - 2.0f * B ) ) / 6.0f;
+			}
+			if ( ax < 2.0f ) {
+				return ( ( -B - 6.0f * C ) * ax * ax * ax + ( 6.0f * B + 30.0f * C ) * ax * ax + ( -12.0f * B - 48.0f * C ) * ax + ( 8.0f * B + 24.0f * C ) ) / 6.0f;
+			}
+			return 0.0f;
+		}
+		default:
+		{
+			return ( ax < 3.0f ) ? Sinc( x ) * Sinc( x / 3.0f ) : 0.0f;
+		}
+	}
+}
+
+
+// Polyphase weights for one axis. Minifying widens the kernel by the scale so every source texel contributes.
+static void BuildFilterTaps( const uint32_t srcSize, const uint32_t dstSize, const resampleFilter_t filter, filterTaps_t& taps )
+{
+	const float scale = static_cast<float>( dstSize ) / static_cast<float>( srcSize );
+	const float kernelScale = Min( scale, 1.0f );
+	const float support = FilterRadius( filter ) / kernelScale;
+
+	taps.offsets.resize( dstSize + 1 );
+	taps.indices.clear();
+	taps.weights.clear();
+
+	for ( uint32_t i = 0; i < dstSize; ++i )
+	{
+		const float center = ( static_cast<float>( i ) + 0.5f ) / scale;
+		const int32_t first = static_cast<int32_t>( floorf( center - support ) );
+		const int32_t last = static_cast<int32_t>( ceilf( center + support ) );
+
+		const uint32_t offset = static_cast<uint32_t>( taps.weights.size() );
+		taps.offsets[ i ] = offset;
+
+		float total = 0.0f;
+		for ( int32_t j = first; j <= last; ++j )
+		{
+			const float weight = FilterWeight( filter, ( static_cast<float>( j ) + 0.5f - center ) * kernelScale );
+			if ( weight == 0.0f ) {
+				continue;
+			}
+			taps.indices.push_back( static_cast<uint32_t>( Clamp( j, 0, static_cast<int32_t>( srcSize ) - 1 ) ) );
+			taps.weights.push_back( weight );
+			total += weight;
+		}
+
+		// Guards against a kernel that only saw zero or cancelling lobes
+		if ( fabsf( total ) < 1e-6f )
+		{
+			taps.weights.resize( offset );
+			taps.indices.resize( offset );
+			taps.indices.push_back( static_cast<uint32_t>( Clamp( static_cast<int32_t>( center ), 0, static_cast<int32_t>( srcSize ) - 1 ) ) );
+			taps.weights.push_back( 1.0f );
+			continue;
+		}
+
+		const float normalize = 1.0f / total;
+		for ( uint32_t t = offset; t < taps.weights.size(); ++t ) {
+			taps.weights[ t ] *= normalize;
+		}
+	}
+	taps.offsets[ dstSize ] = static_cast<uint32_t>( taps.weights.size() );
+}
+
+
+static void FilterRow( const float* src, float* dst, const filterTaps_t& taps, const uint32_t dstWidth )
+{
+	for ( uint32_t x = 0; x < dstWidth; ++x )
+	{
+		const uint32_t begin = taps.offsets[ x ];
+		const uint32_t end = taps.offsets[ x + 1 ];
+
+#if defined( GFX_SIMD_SSE )
+		__m128 sum = _mm_setzero_ps();
+		for ( uint32_t t = begin; t < end; ++t ) {
+			sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( taps.weights[ t ] ), _mm_loadu_ps( src + 4 * taps.indices[ t ] ) ) );
+		}
+		_mm_storeu_ps( dst + 4 * x, sum );
+#else
+		float sum[ 4 ] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for ( uint32_t t = begin; t < end; ++t )
+		{
+			const float* texel = src + 4 * taps.indices[ t ];
+			for ( uint32_t c = 0; c < 4; ++c ) {
+				sum[ c ] += taps.weights[ t ] * texel[ c ];
+			}
+		}
+		for ( uint32_t c = 0; c < 4; ++c ) {
+			dst[ 4 * x + c ] = sum[ c ];
+		}
+#endif
+	}
+}
+
+
+static void FilterColumn( const float* src, float* dst, const filterTaps_t& taps, const uint32_t y, const uint32_t rowFloats )
+{
+	const uint32_t begin = taps.offsets[ y ];
+	const uint32_t end = taps.offsets[ y + 1 ];
+
+	for ( uint32_t i = 0; i < rowFloats; ++i ) {
+		dst[ i ] = 0.0f;
+	}
+
+	// Whole rows at a time keeps the reads sequential
+	for ( uint32_t t = begin; t < end; ++t )
+	{
+		const float weight = taps.weights[ t ];
+		const float* row = src + taps.indices[ t ] * rowFloats;
+
+		uint32_t i = 0;
+#if defined( GFX_SIMD_SSE )
+		const __m128 w = _mm_set1_ps( weight );
+		for ( ; ( i + 4 ) <= rowFloats; i += 4 ) {
+			_mm_storeu_ps( dst + i, _mm_add_ps( _mm_loadu_ps( dst + i ), _mm_mul_ps( w, _mm_loadu_ps( row + i ) ) ) );
+		}
+#endif
+		for ( ; i < rowFloats; ++i ) {
+			dst[ i ] += weight * row[ i ];
+		}
+	}
+}
+
+
+void ResampleSurface( const float* src, const uint32_t srcWidth, const uint32_t srcHeight, float* dst, const uint32_t dstWidth, const uint32_t dstHeight, const resampleFilter_t filter )
+{
+	if ( ( srcWidth == 0 ) || ( srcHeight == 0 ) || ( dstWidth == 0 ) || ( dstHeight == 0 ) ) {
+		return;
+	}
+
+	filterTaps_t horizontal;
+	filterTaps_t vertical;
+	BuildFilterTaps( srcWidth, dstWidth, filter, horizontal );
+	BuildFilterTaps( srcHeight, dstHeight, filter, vertical );
+
+	const uint32_t rowFloats = 4 * dstWidth;
+	std::vector<float> scratch( static_cast<size_t>( srcHeight ) * rowFloats );
+
+	ParallelFor( srcHeight, 16, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t y = begin; y < end; ++y ) {
+			FilterRow( src + static_cast<size_t>( y ) * 4 * srcWidth, scratch.data() + static_cast<size_t>( y ) * rowFloats, horizontal, dstWidth );
+		}
+	} );
+
+	ParallelFor( dstHeight, 16, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t y = begin; y < end; ++y ) {
+			FilterColumn( scratch.data(), dst + static_cast<size_t>( y ) * rowFloats, vertical, y, rowFloats );
+		}
+	} );
+}
+
+
+template<typename T>
+bool ResampleImage( const ImageBuffer<T>& src, const uint32_t width, const uint32_t height, const resampleSettings_t& settings, ImageBuffer<T>& dst )
+{
+	if ( ( width == 0 ) || ( height == 0 ) || ( src.GetWidth() == 0 ) || ( src.GetHeight() == 0 ) || ( &src == &dst ) ) {
+		return false;
+	}
+
+	imageBufferInfo_t info {};
+	info.width = width;
+	info.height = height;
+	info.layers = src.GetLayers();
+	info.mipCount = ( src.GetMipCount() > 1 ) ? MipCount( width, height ) : 1;
+	info.bpp = sizeof( T );
+
+	dst.Init( info, src.GetName() );
+
+	std::vector<float> srcTexels;
+	std::vector<float> baseTexels;
+	std::vector<float> mipTexels;
+
+	for ( uint32_t layer = 0; layer < info.layers; ++layer )
+	{
+		const slice_t srcSlice = src.GetSlice( layer, 0 );
+		LoadSliceFloat4<T>( srcSlice, settings.srgb, settings.alphaWeighted, srcTexels );
+
+		baseTexels.resize( 4 * static_cast<size_t>( width ) * height );
+		ResampleSurface( srcTexels.data(), srcSlice.width, srcSlice.height, baseTexels.data(), width, height, settings.filter );
+		StoreSliceFloat4<T>( baseTexels, settings.srgb, settings.alphaWeighted, dst.GetSlice( layer, 0 ) );
+
+		// Each mip comes straight from the new top level so filtering error doesn't compound
+		for ( uint32_t mip = 1; mip < info.mipCount; ++mip )
+		{
+			const slice_t mipSlice = dst.GetSlice( layer, mip );
+			mipTexels.resize( 4 * static_cast<size_t>( mipSlice.width ) * mipSlice.height );
+
+			ResampleSurface( baseTexels.data(), width, height, mipTexels.data(), mipSlice.width, mipSlice.height, settings.filter );
+			StoreSliceFloat4<T>( mipTexels, settings.srgb, settings.alphaWeighted, mipSlice );
+		}
+	}
+	return true;
+}
+
+
+template bool ResampleImage<uint8_t>( const ImageBuffer<uint8_t>&, const uint32_t, const uint32_t, const resampleSettings_t&, ImageBuffer<uint8_t>& );
+template bool ResampleImage<uint16_t>( const ImageBuffer<uint16_t>&, const uint32_t, const uint32_t, const resampleSettings_t&, ImageBuffer<uint16_t>& );
+template bool ResampleImage<float>( const ImageBuffer<float>&, const uint32_t, const uint32_t, const resampleSettings_t&, ImageBuffer<float>& );
+template bool ResampleImage<rgb8_t>( const ImageBuffer<rgb8_t>&, const uint32_t, const uint32_t, const resampleSettings_t&, ImageBuffer<rgb8_t>& );
+template bool ResampleImage<rgba8_t>( const ImageBuffer<rgba8_t>&, const uint32_t, const uint32_t, const resampleSettings_t&, ImageBuffer<rgba8_t>& );
+template bool ResampleImage<rgb16_t>( const ImageBuffer<rgb16_t>&, const uint32_t, const uint32_t, const resampleSettings_t&, ImageBuffer<rgb16_t>& );
+template bool ResampleImage<rgba16_t>( const ImageBuffer<rgba16_t>&, const uint32_t, const uint32_t, const resampleSettings_t&, ImageBuffer<rgba16_t>& );
+template bool ResampleImage<Color>( const ImageBuffer<Color>&, const uint32_t, const uint32_t, const resampleSettings_t&, ImageBuffer<Color>& );
@@ -0,0 +1,52 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "image.h"
+
+enum resampleFilter_t : uint32_t
+{
+	RESAMPLE_FILTER_BOX,
+	RESAMPLE_FILTER_TRIANGLE,
+	RESAMPLE_FILTER_MITCHELL,	// B = C = 1/3
+	RESAMPLE_FILTER_LANCZOS3,
+};
+
+struct resampleSettings_t
+{
+	resampleFilter_t	filter;
+	bool				srgb;			// Decode RGB to linear light before filtering and re-encode after
+	bool				alphaWeighted;	// Filter premultiplied so fully transparent texels don't bleed their color
+
+	resampleSettings_t() : filter( RESAMPLE_FILTER_MITCHELL ), srgb( false ), alphaWeighted( true ) {}
+};
+
+// Separable resize of tightly packed 4 channel float texels. Rows are spread across threads.
+void ResampleSurface( const float* src, const uint32_t srcWidth, const uint32_t srcHeight, float* dst, const uint32_t dstWidth, const uint32_t dstHeight, const resampleFilter_t filter );
+
+// Resizes every layer of src into dst. If src has mips, dst gets a full chain filtered from the new top level.
+// Instantiated for every texel type Image::Create makes except block formats.
+template<typename T>
+bool ResampleImage( const ImageBuffer<T>& src, const uint32_t width, const uint32_t height, const resampleSettings_t& settings, ImageBuffer<T>& dst );
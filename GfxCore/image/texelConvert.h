@@ -0,0 +1,189 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <vector>
+
+#include "image.h"
+#include "color.h"
+#include "../math/half.h"
+
+// Widening of every uncompressed texel type to RGBA float surfaces, shared by the resampler and image filters
+
+inline float SrgbToLinearExact( const float value )
+{
+	return ( value <= 0.04045f ) ? ( value / 12.92f ) : powf( ( value + 0.055f ) / 1.055f, 2.4f );
+}
+
+
+inline float LinearToSrgbExact( const float value )
+{
+	return ( value <= 0.0031308f ) ? ( value * 12.92f ) : ( 1.055f * powf( value, 1.0f / 2.4f ) - 0.055f );
+}
+
+
+inline uint8_t ToUnorm8( const float value )
+{
+	return static_cast<uint8_t>( Clamp( value, 0.0f, 1.0f ) * 255.0f + 0.5f );
+}
+
+
+inline uint16_t ToUnorm16( const float value )
+{
+	return static_cast<uint16_t>( Clamp( value, 0.0f, 1.0f ) * 65535.0f + 0.5f );
+}
+
+
+// Every texel type is widened to RGBA float, missing channels read as 0 and alpha as 1
+template<typename T> struct texelTraits_t;
+
+template<> struct texelTraits_t<uint8_t>
+{
+	static const uint32_t Channels = 1;
+	static inline void Load( const uint8_t& t, float* v ) { v[ 0 ] = t / 255.0f; v[ 1 ] = 0.0f; v[ 2 ] = 0.0f; v[ 3 ] = 1.0f; }
+	static inline void Store( const float* v, uint8_t& t ) { t = ToUnorm8( v[ 0 ] ); }
+};
+
+template<> struct texelTraits_t<uint16_t>
+{
+	static const uint32_t Channels = 1;
+	static inline void Load( const uint16_t& t, float* v ) { v[ 0 ] = t / 65535.0f; v[ 1 ] = 0.0f; v[ 2 ] = 0.0f; v[ 3 ] = 1.0f; }
+	static inline void Store( const float* v, uint16_t& t ) { t = ToUnorm16( v[ 0 ] ); }
+};
+
+template<> struct texelTraits_t<float>
+{
+	static const uint32_t Channels = 1;
+	static inline void Load( const float& t, float* v ) { v[ 0 ] = t; v[ 1 ] = 0.0f; v[ 2 ] = 0.0f; v[ 3 ] = 1.0f; }
+	static inline void Store( const float* v, float& t ) { t = v[ 0 ]; }
+};
+
+template<> struct texelTraits_t<rgb8_t>
+{
+	static const uint32_t Channels = 3;
+	static inline void Load( const rgb8_t& t, float* v ) { v[ 0 ] = t.r / 255.0f; v[ 1 ] = t.g / 255.0f; v[ 2 ] = t.b / 255.0f; v[ 3 ] = 1.0f; }
+	static inline void Store( const float* v, rgb8_t& t ) { t = rgb8_t( ToUnorm8( v[ 0 ] ), ToUnorm8( v[ 1 ] ), ToUnorm8( v[ 2 ] ) ); }
+};
+
+template<> struct texelTraits_t<rgba8_t>
+{
+	static const uint32_t Channels = 4;
+	static inline void Load( const rgba8_t& t, float* v )
+	{
+		for ( uint32_t c = 0; c < 4; ++c ) {
+			v[ c ] = t.vec[ c ] / 255.0f;
+		}
+	}
+	static inline void Store( const float* v, rgba8_t& t )
+	{
+		for ( uint32_t c = 0; c < 4; ++c ) {
+			t.vec[ c ] = ToUnorm8( v[ c ] );
+		}
+	}
+};
+
+template<> struct texelTraits_t<rgb16_t>
+{
+	static const uint32_t Channels = 3;
+	static inline void Load( const rgb16_t& t, float* v ) { v[ 0 ] = UnpackFloat32( t.r ); v[ 1 ] = UnpackFloat32( t.g ); v[ 2 ] = UnpackFloat32( t.b ); v[ 3 ] = 1.0f; }
+	static inline void Store( const float* v, rgb16_t& t ) { t = rgb16_t( PackFloat32( v[ 0 ] ), PackFloat32( v[ 1 ] ), PackFloat32( v[ 2 ] ) ); }
+};
+
+template<> struct texelTraits_t<rgba16_t>
+{
+	static const uint32_t Channels = 4;
+	static inline void Load( const rgba16_t& t, float* v ) { v[ 0 ] = UnpackFloat32( t.r ); v[ 1 ] = UnpackFloat32( t.g ); v[ 2 ] = UnpackFloat32( t.b ); v[ 3 ] = UnpackFloat32( t.a ); }
+	static inline void Store( const float* v, rgba16_t& t ) { t.r = PackFloat32( v[ 0 ] ); t.g = PackFloat32( v[ 1 ] ); t.b = PackFloat32( v[ 2 ] ); t.a = PackFloat32( v[ 3 ] ); }
+};
+
+template<> struct texelTraits_t<Color>
+{
+	static const uint32_t Channels = 4;
+	static inline void Load( const Color& t, float* v )
+	{
+		for ( uint32_t c = 0; c < 4; ++c ) {
+			v[ c ] = t[ c ];
+		}
+	}
+	static inline void Store( const float* v, Color& t ) { t = Color( v[ 0 ], v[ 1 ], v[ 2 ], v[ 3 ] ); }
+};
+
+
+template<typename T>
+void LoadSliceFloat4( const slice_t& slice, const bool srgbDecode, const bool alphaWeighted, std::vector<float>& texels )
+{
+	using traits = texelTraits_t<T>;
+
+	const uint32_t count = slice.width * slice.height;
+	texels.resize( 4 * static_cast<size_t>( count ) );
+
+	const bool srgb = srgbDecode && ( traits::Channels >= 3 );
+	const bool premultiply = alphaWeighted && ( traits::Channels == 4 );
+
+	const T* src = reinterpret_cast<const T*>( slice.ptr );
+	for ( uint32_t i = 0; i < count; ++i )
+	{
+		float* v = &texels[ 4 * i ];
+		traits::Load( src[ i ], v );
+
+		for ( uint32_t c = 0; srgb && ( c < 3 ); ++c ) {
+			v[ c ] = SrgbToLinearExact( v[ c ] );
+		}
+		for ( uint32_t c = 0; premultiply && ( c < 3 ); ++c ) {
+			v[ c ] *= v[ 3 ];
+		}
+	}
+}
+
+
+template<typename T>
+void StoreSliceFloat4( const std::vector<float>& texels, const bool srgbEncode, const bool alphaWeighted, const slice_t& slice )
+{
+	using traits = texelTraits_t<T>;
+
+	const bool srgb = srgbEncode && ( traits::Channels >= 3 );
+	const bool premultiply = alphaWeighted && ( traits::Channels == 4 );
+
+	T* dst = reinterpret_cast<T*>( slice.ptr );
+
+	const uint32_t count = slice.width * slice.height;
+	for ( uint32_t i = 0; i < count; ++i )
+	{
+		float v[ 4 ] = { texels[ 4 * i ], texels[ 4 * i + 1 ], texels[ 4 * i + 2 ], texels[ 4 * i + 3 ] };
+
+		if ( premultiply )
+		{
+			const float invAlpha = ( v[ 3 ] > 1e-6f ) ? ( 1.0f / v[ 3 ] ) : 0.0f;
+			for ( uint32_t c = 0; c < 3; ++c ) {
+				v[ c ] *= invAlpha;
+			}
+		}
+		for ( uint32_t c = 0; srgb && ( c < 3 ); ++c ) {
+			v[ c ] = LinearToSrgbExact( Max( v[ c ], 0.0f ) );
+		}
+		traits::Store( v, dst[ i ] );
+	}
+}
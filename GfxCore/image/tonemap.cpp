@@ -0,0 +1,736 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "tonemap.h"
+
+#include <vector>
+#include <cmath>
+
+#include "texelConvert.h"
+#include "../core/parallel.h"
+#include "../core/simd.h"
+#include "../math/half.h"
+
+static const uint32_t ResolveTileSize = 64;
+static const uint32_t ReduceBandRows = 16;
+static const uint32_t BlueNoiseSize = 64;
+static const uint32_t BlueNoiseCount = BlueNoiseSize * BlueNoiseSize;
+static const uint32_t SrgbLutSize = 4096;			// Indexed by sqrt( linear ), close to uniform in sRGB
+static const float MinLogLuminance = 1e-4f;
+static const float AgxMinEv = -12.47393f;
+static const float AgxMaxEv = 4.026069f;
+static const float AgxMinValue = 1e-10f;
+
+struct resolveConstants_t
+{
+	float			exposure;
+	float			invWhiteSq;
+	bool			srgb;
+	const float*	srgbLut;		// SrgbLutSize + 1 entries, scaled to [0, 255]
+	const float*	dither;			// BlueNoiseCount offsets in [-0.5, 0.5], nullptr when disabled
+};
+
+
+/*
+===================================
+Lane ops
+- float and SSE overloads so the curves below are written once for both paths
+===================================
+*/
+static inline float LaneSplat( const float v, float )				{ return v; }
+static inline float LaneAdd( const float a, const float b )			{ return a + b; }
+static inline float LaneSub( const float a, const float b )			{ return a - b; }
+static inline float LaneMul( const float a, const float b )			{ return a * b; }
+static inline float LaneDiv( const float a, const float b )			{ return a / b; }
+static inline float LaneMin( const float a, const float b )			{ return Min( a, b ); }
+static inline float LaneMax( const float a, const float b )			{ return Max( a, b ); }
+
+
+// Polynomial fits, log2 is within 3e-6 and exp2 within 2e-7 relative. Inputs must be positive normal floats.
+static inline float LaneLog2( const float x )
+{
+	uint32_t bits;
+	memcpy( &bits, &x, sizeof( bits ) );
+	const float exponent = static_cast<float>( static_cast<int32_t>( bits >> 23 ) - 127 );
+	bits = ( bits & 0x007FFFFFu ) | 0x3F800000u;
+	float mantissa;
+	memcpy( &mantissa, &bits, sizeof( mantissa ) );
+
+	const float t = mantissa - 1.0f;
+	const float p = 1.4425347636701336f + t * ( -0.7180333355774029f + t * ( 0.45715680829780153f + t * ( -0.2773387247226606f + t * ( 0.12147002400947987f + t * -0.025791264327662045f ) ) ) );
+	return exponent + t * p;
+}
+
+
+static inline float LaneExp2( const float x )
+{
+	const float clamped = Min( Max( x, -126.0f ), 126.0f );
+	const float whole = floorf( clamped );
+	const float f = clamped - whole;
+	const float p = 1.0f + f * ( 0.693152536061187f + f * ( 0.24015243573268283f + f * ( 0.05583662848492896f + f * ( 0.008972858694809965f + f * 0.0018854222423880876f ) ) ) );
+
+	const uint32_t bits = static_cast<uint32_t>( static_cast<int32_t>( whole ) + 127 ) << 23;
+	float scale;
+	memcpy( &scale, &bits, sizeof( scale ) );
+	return p * scale;
+}
+
+
+#if defined( GFX_SIMD_SSE )
+static inline __m128 LaneSplat( const float v, __m128 )				{ return _mm_set1_ps( v ); }
+static inline __m128 LaneAdd( const __m128 a, const __m128 b )		{ return _mm_add_ps( a, b ); }
+static inline __m128 LaneSub( const __m128 a, const __m128 b )		{ return _mm_sub_ps( a, b ); }
+static inline __m128 LaneMul( const __m128 a, const __m128 b )		{ return _mm_mul_ps( a, b ); }
+static inline __m128 LaneDiv( const __m128 a, const __m128 b )		{ return _mm_div_ps( a, b ); }
+static inline __m128 LaneMin( const __m128 a, const __m128 b )		{ return _mm_min_ps( a, b ); }
+static inline __m128 LaneMax( const __m128 a, const __m128 b )		{ return _mm_max_ps( a, b ); }
+
+
+static inline __m128 LaneLog2( const __m128 x )
+{
+	const __m128i bits = _mm_castps_si128( x );
+	const __m128 exponent = _mm_cvtepi32_ps( _mm_sub_epi32( _mm_srli_epi32( bits, 23 ), _mm_set1_epi32( 127 ) ) );
+	const __m128 mantissa = _mm_castsi128_ps( _mm_or_si128( _mm_and_si128( bits, _mm_set1_epi32( 0x007FFFFF ) ), _mm_set1_epi32( 0x3F800000 ) ) );
+
+	const __m128 t = _mm_sub_ps( mantissa, _mm_set1_ps( 1.0f ) );
+	__m128 p = _mm_set1_ps( -0.025791264327662045f );
+	p = _mm_add_ps( _mm_mul_ps( p, t ), _mm_set1_ps( 0.12147002400947987f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, t ), _mm_set1_ps( -0.2773387247226606f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, t ), _mm_set1_ps( 0.45715680829780153f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, t ), _mm_set1_ps( -0.7180333355774029f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, t ), _mm_set1_ps( 1.4425347636701336f ) );
+	return _mm_add_ps( exponent, _mm_mul_ps( t, p ) );
+}
+
+
+static inline __m128 LaneExp2( const __m128 x )
+{
+	const __m128 clamped = _mm_min_ps( _mm_max_ps( x, _mm_set1_ps( -126.0f ) ), _mm_set1_ps( 126.0f ) );
+
+	// Truncation rounds negatives up, step those back down to the floor
+	__m128i whole = _mm_cvttps_epi32( clamped );
+	const __m128 roundedUp = _mm_cmpgt_ps( _mm_cvtepi32_ps( whole ), clamped );
+	whole = _mm_add_epi32( whole, _mm_castps_si128( roundedUp ) );
+	const __m128 f = _mm_sub_ps( clamped, _mm_cvtepi32_ps( whole ) );
+
+	__m128 p = _mm_set1_ps( 0.0018854222423880876f );
+	p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 0.008972858694809965f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 0.05583662848492896f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 0.24015243573268283f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 0.693152536061187f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 1.0f ) );
+
+	const __m128 scale = _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( whole, _mm_set1_epi32( 127 ) ), 23 ) );
+	return _mm_mul_ps( p, scale );
+}
+#endif
+
+
+template<tonemapOperator_t Op, typename L>
+static inline void Tonemap( L& r, L& g, L& b, const resolveConstants_t& k )
+{
+	const L one = LaneSplat( 1.0f, r );
+
+	if ( Op == tonemapOperator_t::REINHARD )
+	{
+		const L invWhiteSq = LaneSplat( k.invWhiteSq, r );
+		auto curve = [&]( const L x ) {
+			return LaneDiv( LaneMul( x, LaneAdd( one, LaneMul( x, invWhiteSq ) ) ), LaneAdd( one, x ) );
+		};
+		r = curve( r );
+		g = curve( g );
+		b = curve( b );
+	}
+	else if ( Op == tonemapOperator_t::ACES )
+	{
+		const L a = LaneSplat( 2.51f, r );
+		const L c = LaneSplat( 0.03f, r );
+		const L d = LaneSplat( 2.43f, r );
+		const L e = LaneSplat( 0.59f, r );
+		const L f = LaneSplat( 0.14f, r );
+		auto curve = [&]( const L x ) {
+			return LaneDiv( LaneMul( x, LaneAdd( LaneMul( a, x ), c ) ), LaneAdd( LaneMul( x, LaneAdd( LaneMul( d, x ), e ) ), f ) );
+		};
+		r = curve( r );
+		g = curve( g );
+		b = curve( b );
+	}
+	else if ( Op == tonemapOperator_t::AGX )
+	{
+		// Inset into the AgX working space
+		const L r0 = LaneAdd( LaneAdd( LaneMul( LaneSplat( 0.842479062253094f, r ), r ), LaneMul( LaneSplat( 0.0784335999999992f, r ), g ) ), LaneMul( LaneSplat( 0.0792237451477643f, r ), b ) );
+		const L g0 = LaneAdd( LaneAdd( LaneMul( LaneSplat( 0.0423282422610123f, r ), r ), LaneMul( LaneSplat( 0.878468636469772f, r ), g ) ), LaneMul( LaneSplat( 0.0791661274605434f, r ), b ) );
+		const L b0 = LaneAdd( LaneAdd( LaneMul( LaneSplat( 0.0423756549057051f, r ), r ), LaneMul( LaneSplat( 0.0784336f, r ), g ) ), LaneMul( LaneSplat( 0.879142973793104f, r ), b ) );
+
+		const L minValue = LaneSplat( AgxMinValue, r );
+		const L minEv = LaneSplat( AgxMinEv, r );
+		const L maxEv = LaneSplat( AgxMaxEv, r );
+		const L invRange = LaneSplat( 1.0f / ( AgxMaxEv - AgxMinEv ), r );
+		auto curve = [&]( const L x )
+		{
+			const L ev = LaneMin( LaneMax( LaneLog2( LaneMax( x, minValue ) ), minEv ), maxEv );
+			const L t = LaneMul( LaneSub( ev, minEv ), invRange );
+			const L t2 = LaneMul( t, t );
+			const L t4 = LaneMul( t2, t2 );
+			L y = LaneMul( LaneSplat( 15.5f, r ), LaneMul( t4, t2 ) );
+			y = LaneSub( y, LaneMul( LaneSplat( 40.14f, r ), LaneMul( t4, t ) ) );
+			y = LaneAdd( y, LaneMul( LaneSplat( 31.96f, r ), t4 ) );
+			y = LaneSub( y, LaneMul( LaneSplat( 6.868f, r ), LaneMul( t2, t ) ) );
+			y = LaneAdd( y, LaneMul( LaneSplat( 0.4298f, r ), t2 ) );
+			y = LaneAdd( y, LaneMul( LaneSplat( 0.1191f, r ), t ) );
+			return LaneSub( y, LaneSplat( 0.00232f, r ) );
+		};
+		const L r1 = curve( r0 );
+		const L g1 = curve( g0 );
+		const L b1 = curve( b0 );
+
+		// Outset, the curve output is 2.2 gamma encoded so bring it back to linear for the sRGB encode
+		const L gamma = LaneSplat( 2.2f, r );
+		auto linearize = [&]( const L x ) {
+			return LaneExp2( LaneMul( gamma, LaneLog2( LaneMax( x, minValue ) ) ) );
+		};
+		r = linearize( LaneAdd( LaneAdd( LaneMul( LaneSplat( 1.19687900512017f, r ), r1 ), LaneMul( LaneSplat( -0.0980208811401368f, r ), g1 ) ), LaneMul( LaneSplat( -0.0990297440797205f, r ), b1 ) ) );
+		g = linearize( LaneAdd( LaneAdd( LaneMul( LaneSplat( -0.0528968517574562f, r ), r1 ), LaneMul( LaneSplat( 1.15190312990417f, r ), g1 ) ), LaneMul( LaneSplat( -0.0989611768448433f, r ), b1 ) ) );
+		b = linearize( LaneAdd( LaneAdd( LaneMul( LaneSplat( -0.0529716355144438f, r ), r1 ), LaneMul( LaneSplat( -0.0980434501171241f, r ), g1 ) ), LaneMul( LaneSplat( 1.15107367264116f, r ), b1 ) ) );
+	}
+}
+
+
+static const float* GetSrgbLut()
+{
+	static const std::vector<float> lut = []()
+	{
+		std::vector<float> table( SrgbLutSize + 1 );
+		for ( uint32_t i = 0; i <= SrgbLutSize; ++i )
+		{
+			const float s = static_cast<float>( i ) / SrgbLutSize;
+			table[ i ] = 255.0f * LinearToSrgbExact( s * s );
+		}
+		return table;
+	}();
+	return lut.data();
+}
+
+
+// Void-and-cluster ( Ulichney 1993 ) on a toroidal Gaussian energy. Energies are double, in float the far tails
+// underflow to ties and the ranks fall into a lattice.
+const uint16_t* GetBlueNoiseRanks()
+{
+	static const std::vector<uint16_t> ranks = []()
+	{
+		const double sigma = 1.5;
+		std::vector<double> kernel( BlueNoiseCount );
+		for ( uint32_t y = 0; y < BlueNoiseSize; ++y )
+		{
+			for ( uint32_t x = 0; x < BlueNoiseSize; ++x )
+			{
+				const double dx = static_cast<double>( Min( x, BlueNoiseSize - x ) );
+				const double dy = static_cast<double>( Min( y, BlueNoiseSize - y ) );
+				kernel[ y * BlueNoiseSize + x ] = exp( -( dx * dx + dy * dy ) / ( 2.0 * sigma * sigma ) );
+			}
+		}
+
+		std::vector<double> energy( BlueNoiseCount, 0.0 );
+		std::vector<uint8_t> set( BlueNoiseCount, 0 );
+
+		auto splat = [&]( const uint32_t index, const double sign )
+		{
+			set[ index ] = ( sign > 0.0 ) ? 1 : 0;
+			const uint32_t px = index % BlueNoiseSize;
+			const uint32_t py = index / BlueNoiseSize;
+			for ( uint32_t y = 0; y < BlueNoiseSize; ++y )
+			{
+				const double* kernelRow = &kernel[ ( ( y + BlueNoiseSize - py ) % BlueNoiseSize ) * BlueNoiseSize ];
+				double* energyRow = &energy[ y * BlueNoiseSize ];
+				for ( uint32_t x = 0; x < BlueNoiseSize; ++x ) {
+					energyRow[ x ] += sign * kernelRow[ ( x + BlueNoiseSize - px ) % BlueNoiseSize ];
+				}
+			}
+		};
+
+		// Tightest cluster is the set pixel with the most energy, largest void the empty pixel with the least
+		auto tightestCluster = [&]()
+		{
+			uint32_t best = 0;
+			double bestEnergy = -DBL_MAX;
+			for ( uint32_t i = 0; i < BlueNoiseCount; ++i )
+			{
+				if ( ( set[ i ] != 0 ) && ( energy[ i ] > bestEnergy ) )
+				{
+					best = i;
+					bestEnergy = energy[ i ];
+				}
+			}
+			return best;
+		};
+
+		auto largestVoid = [&]()
+		{
+			uint32_t best = 0;
+			double bestEnergy = DBL_MAX;
+			for ( uint32_t i = 0; i < BlueNoiseCount; ++i )
+			{
+				if ( ( set[ i ] == 0 ) && ( energy[ i ] < bestEnergy ) )
+				{
+					best = i;
+					bestEnergy = energy[ i ];
+				}
+			}
+			return best;
+		};
+
+		// 1. Fixed seed random pattern, relaxed by moving the tightest cluster into the largest void until it stops moving
+		const uint32_t initialCount = BlueNoiseCount / 10;
+		uint32_t seed = 0x9E3779B9u;
+		for ( uint32_t placed = 0; placed < initialCount; )
+		{
+			seed = seed * 1664525u + 1013904223u;
+			const uint32_t index = ( seed >> 8 ) % BlueNoiseCount;
+			if ( set[ index ] == 0 )
+			{
+				splat( index, 1.0 );
+				++placed;
+			}
+		}
+
+		for ( uint32_t iteration = 0; iteration < BlueNoiseCount; ++iteration )
+		{
+			const uint32_t cluster = tightestCluster();
+			splat( cluster, -1.0 );
+			const uint32_t hole = largestVoid();
+			splat( hole, 1.0 );
+			if ( hole == cluster ) {
+				break;
+			}
+		}
+
+		const std::vector<double> initialEnergy = energy;
+		const std::vector<uint8_t> initialSet = set;
+		std::vector<uint16_t> result( BlueNoiseCount );
+
+		// 2. Rank the initial points by removing clusters first
+		for ( uint32_t rank = initialCount; rank-- > 0; )
+		{
+			const uint32_t cluster = tightestCluster();
+			result[ cluster ] = static_cast<uint16_t>( rank );
+			splat( cluster, -1.0 );
+		}
+
+		// 3. Fill the rest void by void
+		energy = initialEnergy;
+		set = initialSet;
+		for ( uint32_t rank = initialCount; rank < BlueNoiseCount; ++rank )
+		{
+			const uint32_t hole = largestVoid();
+			result[ hole ] = static_cast<uint16_t>( rank );
+			splat( hole, 1.0 );
+		}
+		return result;
+	}();
+	return ranks.data();
+}
+
+
+static const float* GetDitherOffsets()
+{
+	static const std::vector<float> offsets = []()
+	{
+		const uint16_t* ranks = GetBlueNoiseRanks();
+		std::vector<float> table( BlueNoiseCount );
+		for ( uint32_t i = 0; i < BlueNoiseCount; ++i ) {
+			table[ i ] = ( ranks[ i ] + 0.5f ) / BlueNoiseCount - 0.5f;
+		}
+		return table;
+	}();
+	return offsets.data();
+}
+
+
+template<bool Srgb>
+static inline uint32_t EncodeChannel( const float v, const float dither, const float* srgbLut )
+{
+	const float x = Min( Max( v, 0.0f ), 1.0f );
+	const float encoded = Srgb ? srgbLut[ static_cast<uint32_t>( sqrtf( x ) * SrgbLutSize + 0.5f ) ] : ( 255.0f * x );
+	return static_cast<uint32_t>( Min( Max( encoded + dither, 0.0f ), 255.0f ) + 0.5f );
+}
+
+
+// Pixels are RGBA float, x is the image column of src[ 0 ] and picks the dither column
+template<tonemapOperator_t Op, bool Srgb>
+static void ResolveRow( const float* src, const uint32_t x, const uint32_t y, const uint32_t count, const resolveConstants_t& k, rgba8_t* dst )
+{
+	// Locals so the stores below can't force reloads of k
+	const float* ditherRow = ( k.dither != nullptr ) ? ( k.dither + ( y % BlueNoiseSize ) * BlueNoiseSize ) : nullptr;
+	const float* srgbLut = k.srgbLut;
+	const float exposureScale = k.exposure;
+	uint32_t i = 0;
+
+#if defined( GFX_SIMD_SSE )
+	const __m128 exposure = _mm_set1_ps( exposureScale );
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 half = _mm_set1_ps( 0.5f );
+	const __m128 maxCode = _mm_set1_ps( 255.0f );
+	const __m128 lutScale = _mm_set1_ps( static_cast<float>( SrgbLutSize ) );
+
+	auto encode = [&]( const __m128 v, const __m128 dither )
+	{
+		const __m128 clamped = _mm_min_ps( _mm_max_ps( v, zero ), one );
+		__m128 encoded;
+		if ( Srgb )
+		{
+			alignas( 16 ) int32_t index[ 4 ];
+			_mm_store_si128( reinterpret_cast<__m128i*>( index ), _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( _mm_sqrt_ps( clamped ), lutScale ), half ) ) );
+			encoded = _mm_setr_ps( srgbLut[ index[ 0 ] ], srgbLut[ index[ 1 ] ], srgbLut[ index[ 2 ] ], srgbLut[ index[ 3 ] ] );
+		}
+		else
+		{
+			encoded = _mm_mul_ps( clamped, maxCode );
+		}
+		return _mm_cvttps_epi32( _mm_add_ps( _mm_min_ps( _mm_max_ps( _mm_add_ps( encoded, dither ), zero ), maxCode ), half ) );
+	};
+
+	// Tiles start on multiples of 64 so four pixels never wrap around the dither row
+	for ( ; ( i + 4 ) <= count; i += 4 )
+	{
+		__m128 r = _mm_loadu_ps( src + 4 * i + 0 );
+		__m128 g = _mm_loadu_ps( src + 4 * i + 4 );
+		__m128 b = _mm_loadu_ps( src + 4 * i + 8 );
+		__m128 a = _mm_loadu_ps( src + 4 * i + 12 );
+		_MM_TRANSPOSE4_PS( r, g, b, a );
+
+		r = _mm_mul_ps( r, exposure );
+		g = _mm_mul_ps( g, exposure );
+		b = _mm_mul_ps( b, exposure );
+		Tonemap<Op>( r, g, b, k );
+
+		const __m128 dither = ( ditherRow != nullptr ) ? _mm_loadu_ps( ditherRow + ( ( x + i ) % BlueNoiseSize ) ) : zero;
+		const __m128i r8 = encode( r, dither );
+		const __m128i g8 = encode( g, dither );
+		const __m128i b8 = encode( b, dither );
+		const __m128i a8 = _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( _mm_min_ps( _mm_max_ps( a, zero ), one ), maxCode ), half ) );
+
+		// rgba8_t hex is 0xRRGGBBAA
+		const __m128i packed = _mm_or_si128( _mm_or_si128( _mm_slli_epi32( r8, 24 ), _mm_slli_epi32( g8, 16 ) ), _mm_or_si128( _mm_slli_epi32( b8, 8 ), a8 ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), packed );
+	}
+#endif
+
+	for ( ; i < count; ++i )
+	{
+		const float* pixel = src + 4 * i;
+		float r = pixel[ 0 ] * exposureScale;
+		float g = pixel[ 1 ] * exposureScale;
+		float b = pixel[ 2 ] * exposureScale;
+		Tonemap<Op>( r, g, b, k );
+
+		const float dither = ( ditherRow != nullptr ) ? ditherRow[ ( x + i ) % BlueNoiseSize ] : 0.0f;
+		const uint32_t a8 = static_cast<uint32_t>( Min( Max( pixel[ 3 ], 0.0f ), 1.0f ) * 255.0f + 0.5f );
+		dst[ i ].hex = ( EncodeChannel<Srgb>( r, dither, srgbLut ) << 24 ) | ( EncodeChannel<Srgb>( g, dither, srgbLut ) << 16 ) | ( EncodeChannel<Srgb>( b, dither, srgbLut ) << 8 ) | a8;
+	}
+}
+
+
+// loadRow( x, y, count, scratch ) returns RGBA floats for count pixels starting at ( x, y )
+template<tonemapOperator_t Op, class LoadRow>
+static void ResolveTiles( const uint32_t width, const uint32_t height, const resolveConstants_t& k, const LoadRow& loadRow, rgba8_t* dst )
+{
+	const uint32_t tilesX = ( width + ResolveTileSize - 1 ) / ResolveTileSize;
+	const uint32_t tilesY = ( height + ResolveTileSize - 1 ) / ResolveTileSize;
+	const auto resolveRow = k.srgb ? ResolveRow<Op, true> : ResolveRow<Op, false>;
+
+	ParallelFor( tilesX * tilesY, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		std::vector<float> scratch( 4 * ResolveTileSize );
+		for ( uint32_t tile = begin; tile < end; ++tile )
+		{
+			const uint32_t x0 = ( tile % tilesX ) * ResolveTileSize;
+			const uint32_t y0 = ( tile / tilesX ) * ResolveTileSize;
+			const uint32_t count = Min( ResolveTileSize, width - x0 );
+			const uint32_t y1 = Min( y0 + ResolveTileSize, height );
+
+			for ( uint32_t y = y0; y < y1; ++y ) {
+				resolveRow( loadRow( x0, y, count, scratch.data() ), x0, y, count, k, dst + static_cast<size_t>( y ) * width + x0 );
+			}
+		}
+	} );
+}
+
+
+template<class LoadRow>
+static void ResolveImage( const uint32_t width, const uint32_t height, const tonemapSettings_t& settings, const LoadRow& loadRow, ImageBuffer<rgba8_t>& dst )
+{
+	if ( ( dst.GetWidth() != width ) || ( dst.GetHeight() != height ) ) {
+		dst.Init( width, height, sizeof( rgba8_t ), "_hdrResolve" );
+	}
+	if ( ( width == 0 ) || ( height == 0 ) ) {
+		return;
+	}
+
+	resolveConstants_t k;
+	k.exposure = settings.exposure;
+	k.invWhiteSq = 1.0f / Max( settings.whitePoint * settings.whitePoint, 1e-6f );
+	k.srgb = settings.srgb;
+	k.srgbLut = GetSrgbLut();
+	k.dither = settings.dither ? GetDitherOffsets() : nullptr;
+
+	rgba8_t* pixels = reinterpret_cast<rgba8_t*>( dst.GetSlice( 0, 0 ).ptr );
+	switch ( settings.op )
+	{
+		case tonemapOperator_t::REINHARD:	ResolveTiles<tonemapOperator_t::REINHARD>( width, height, k, loadRow, pixels );	break;
+		case tonemapOperator_t::ACES:		ResolveTiles<tonemapOperator_t::ACES>( width, height, k, loadRow, pixels );		break;
+		case tonemapOperator_t::AGX:		ResolveTiles<tonemapOperator_t::AGX>( width, height, k, loadRow, pixels );		break;
+		default:							ResolveTiles<tonemapOperator_t::CLAMP>( width, height, k, loadRow, pixels );	break;
+	}
+}
+
+
+void ResolveHdr( const ImageBuffer<Color>& src, ImageBuffer<rgba8_t>& dst, const tonemapSettings_t& settings )
+{
+	const uint32_t width = src.GetWidth();
+	const float* pixels = reinterpret_cast<const float*>( src.GetSlice( 0, 0 ).ptr );
+
+	ResolveImage( width, src.GetHeight(), settings, [&]( const uint32_t x, const uint32_t y, const uint32_t, float* )
+	{
+		return pixels + 4 * ( static_cast<size_t>( y ) * width + x );
+	}, dst );
+}
+
+
+void ResolveHdr( const ImageBuffer<rgba16_t>& src, ImageBuffer<rgba8_t>& dst, const tonemapSettings_t& settings )
+{
+	const uint32_t width = src.GetWidth();
+	const uint16_t* pixels = reinterpret_cast<const uint16_t*>( src.GetSlice( 0, 0 ).ptr );
+
+	ResolveImage( width, src.GetHeight(), settings, [&]( const uint32_t x, const uint32_t y, const uint32_t count, float* scratch )
+	{
+		UnpackFloat32( pixels + 4 * ( static_cast<size_t>( y ) * width + x ), scratch, 4 * count );
+		return static_cast<const float*>( scratch );
+	}, dst );
+}
+
+
+struct luminanceSums_t
+{
+	float	minLuminance;
+	float	maxLuminance;
+	double	sum;
+	double	logSum;
+};
+
+
+static void AccumulateLuminance( const float* src, const uint32_t count, luminanceSums_t& sums )
+{
+	uint32_t i = 0;
+	float rowSum = 0.0f;
+	float rowLogSum = 0.0f;
+
+#if defined( GFX_SIMD_SSE )
+	const __m128 wr = _mm_set1_ps( 0.2126f );
+	const __m128 wg = _mm_set1_ps( 0.7152f );
+	const __m128 wb = _mm_set1_ps( 0.0722f );
+	const __m128 minLog = _mm_set1_ps( MinLogLuminance );
+	__m128 minLum = _mm_set1_ps( sums.minLuminance );
+	__m128 maxLum = _mm_set1_ps( sums.maxLuminance );
+	__m128 sum = _mm_setzero_ps();
+	__m128 logSum = _mm_setzero_ps();
+
+	for ( ; ( i + 4 ) <= count; i += 4 )
+	{
+		__m128 r = _mm_loadu_ps( src + 4 * i + 0 );
+		__m128 g = _mm_loadu_ps( src + 4 * i + 4 );
+		__m128 b = _mm_loadu_ps( src + 4 * i + 8 );
+		__m128 a = _mm_loadu_ps( src + 4 * i + 12 );
+		_MM_TRANSPOSE4_PS( r, g, b, a );
+
+		const __m128 lum = _mm_add_ps( _mm_add_ps( _mm_mul_ps( wr, r ), _mm_mul_ps( wg, g ) ), _mm_mul_ps( wb, b ) );
+		minLum = _mm_min_ps( minLum, lum );
+		maxLum = _mm_max_ps( maxLum, lum );
+		sum = _mm_add_ps( sum, lum );
+		logSum = _mm_add_ps( logSum, LaneLog2( _mm_max_ps( lum, minLog ) ) );
+	}
+
+	alignas( 16 ) float lanes[ 4 ][ 4 ];
+	_mm_store_ps( lanes[ 0 ], minLum );
+	_mm_store_ps( lanes[ 1 ], maxLum );
+	_mm_store_ps( lanes[ 2 ], sum );
+	_mm_store_ps( lanes[ 3 ], logSum );
+	for ( uint32_t lane = 0; lane < 4; ++lane )
+	{
+		sums.minLuminance = Min( sums.minLuminance, lanes[ 0 ][ lane ] );
+		sums.maxLuminance = Max( sums.maxLuminance, lanes[ 1 ][ lane ] );
+		rowSum += lanes[ 2 ][ lane ];
+		rowLogSum += lanes[ 3 ][ lane ];
+	}
+#endif
+
+	for ( ; i < count; ++i )
+	{
+		const float* pixel = src + 4 * i;
+		const float lum = 0.2126f * pixel[ 0 ] + 0.7152f * pixel[ 1 ] + 0.0722f * pixel[ 2 ];
+		sums.minLuminance = Min( sums.minLuminance, lum );
+		sums.maxLuminance = Max( sums.maxLuminance, lum );
+		rowSum += lum;
+		rowLogSum += LaneLog2( Max( lum, MinLogLuminance ) );
+	}
+
+	// Rows are summed in float and carried in double so large images don't lose precision
+	sums.sum += rowSum;
+	sums.logSum += rowLogSum;
+}
+
+
+template<class LoadRow>
+static luminanceStats_t ReduceLuminance( const uint32_t width, const uint32_t height, const LoadRow& loadRow )
+{
+	const uint32_t bandCount = ( height + ReduceBandRows - 1 ) / ReduceBandRows;
+	std::vector<luminanceSums_t> bands( bandCount );
+
+	ParallelFor( bandCount, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		std::vector<float> scratch( 4 * static_cast<size_t>( width ) );
+		for ( uint32_t band = begin; band < end; ++band )
+		{
+			luminanceSums_t& sums = bands[ band ];
+			sums.minLuminance = FLT_MAX;
+			sums.maxLuminance = -FLT_MAX;
+			sums.sum = 0.0;
+			sums.logSum = 0.0;
+
+			const uint32_t y1 = Min( ( band + 1 ) * ReduceBandRows, height );
+			for ( uint32_t y = band * ReduceBandRows; y < y1; ++y ) {
+				AccumulateLuminance( loadRow( y, scratch.data() ), width, sums );
+			}
+		}
+	} );
+
+	luminanceStats_t stats = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const double pixelCount = static_cast<double>( width ) * height;
+	if ( pixelCount == 0.0 ) {
+		return stats;
+	}
+
+	stats.minLuminance = FLT_MAX;
+	stats.maxLuminance = -FLT_MAX;
+	double sum = 0.0;
+	double logSum = 0.0;
+	for ( const luminanceSums_t& sums : bands )
+	{
+		stats.minLuminance = Min( stats.minLuminance, sums.minLuminance );
+		stats.maxLuminance = Max( stats.maxLuminance, sums.maxLuminance );
+		sum += sums.sum;
+		logSum += sums.logSum;
+	}
+	stats.averageLuminance = static_cast<float>( sum / pixelCount );
+	stats.logAverageLuminance = static_cast<float>( exp2( logSum / pixelCount ) );
+	return stats;
+}
+
+
+luminanceStats_t ComputeLuminanceStats( const ImageBuffer<Color>& image )
+{
+	const uint32_t width = image.GetWidth();
+	const float* pixels = reinterpret_cast<const float*>( image.GetSlice( 0, 0 ).ptr );
+
+	return ReduceLuminance( width, image.GetHeight(), [&]( const uint32_t y, float* ) {
+		return pixels + 4 * static_cast<size_t>( y ) * width;
+	} );
+}
+
+
+luminanceStats_t ComputeLuminanceStats( const ImageBuffer<rgba16_t>& image )
+{
+	const uint32_t width = image.GetWidth();
+	const uint16_t* pixels = reinterpret_cast<const uint16_t*>( image.GetSlice( 0, 0 ).ptr );
+
+	return ReduceLuminance( width, image.GetHeight(), [&]( const uint32_t y, float* scratch )
+	{
+		UnpackFloat32( pixels + 4 * static_cast<size_t>( y ) * width, scratch, 4 * static_cast<size_t>( width ) );
+		return static_cast<const float*>( scratch );
+	} );
+}
+
+
+float ComputeAutoExposure( const luminanceStats_t& stats, const float key )
+{
+	return key / Max( stats.logAverageLuminance, MinLogLuminance );
+}
+
+
+void ComputeMinMax( const ImageBuffer<float>& image, float& minValue, float& maxValue )
+{
+	const uint32_t width = image.GetWidth();
+	const uint32_t height = image.GetHeight();
+	const float* pixels = reinterpret_cast<const float*>( image.GetSlice( 0, 0 ).ptr );
+
+	const uint32_t bandCount = ( height + ReduceBandRows - 1 ) / ReduceBandRows;
+	std::vector<float> bandMin( bandCount, FLT_MAX );
+	std::vector<float> bandMax( bandCount, -FLT_MAX );
+
+	ParallelFor( bandCount, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t band = begin; band < end; ++band )
+		{
+			const size_t first = static_cast<size_t>( band ) * ReduceBandRows * width;
+			const size_t last = static_cast<size_t>( Min( ( band + 1 ) * ReduceBandRows, height ) ) * width;
+			size_t i = first;
+
+			float lo = FLT_MAX;
+			float hi = -FLT_MAX;
+#if defined( GFX_SIMD_SSE )
+			__m128 lo4 = _mm_set1_ps( FLT_MAX );
+			__m128 hi4 = _mm_set1_ps( -FLT_MAX );
+			for ( ; ( i + 4 ) <= last; i += 4 )
+			{
+				const __m128 v = _mm_loadu_ps( pixels + i );
+				lo4 = _mm_min_ps( lo4, v );
+				hi4 = _mm_max_ps( hi4, v );
+			}
+			alignas( 16 ) float lanes[ 2 ][ 4 ];
+			_mm_store_ps( lanes[ 0 ], lo4 );
+			_mm_store_ps( lanes[ 1 ], hi4 );
+			for ( uint32_t lane = 0; lane < 4; ++lane )
+			{
+				lo = Min( lo, lanes[ 0 ][ lane ] );
+				hi = Max( hi, lanes[ 1 ][ lane ] );
+			}
+#endif
+			for ( ; i < last; ++i )
+			{
+				lo = Min( lo, pixels[ i ] );
+				hi = Max( hi, pixels[ i ] );
+			}
+			bandMin[ band ] = lo;
+			bandMax[ band ] = hi;
+		}
+	} );
+
+	minValue = FLT_MAX;
+	maxValue = -FLT_MAX;
+	for ( uint32_t band = 0; band < bandCount; ++band )
+	{
+		minValue = Min( minValue, bandMin[ band ] );
+		maxValue = Max( maxValue, bandMax[ band ] );
+	}
+}
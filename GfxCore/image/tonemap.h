@@ -0,0 +1,80 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "image.h"
+#include "color.h"
+
+enum class tonemapOperator_t : uint32_t
+{
+	CLAMP,		// Exposure only, saturates at 1
+	REINHARD,	// Extended Reinhard per channel, whitePoint maps to 1
+	ACES,		// Narkowicz fit of the ACES filmic curve
+	AGX,		// Minimal AgX, log encoding with a sigmoid fit and its inset/outset matrices
+	COUNT,
+};
+
+struct tonemapSettings_t
+{
+	tonemapOperator_t	op;
+	float				exposure;		// Linear scale applied before the curve
+	float				whitePoint;		// REINHARD only
+	bool				srgb;			// Encode to sRGB, otherwise the curve output is stored as is
+	bool				dither;			// Blue noise offset of up to half a code value before rounding
+
+	tonemapSettings_t() :
+		op( tonemapOperator_t::ACES ),
+		exposure( 1.0f ),
+		whitePoint( 4.0f ),
+		srgb( true ),
+		dither( true )
+	{}
+};
+
+struct luminanceStats_t
+{
+	float	minLuminance;
+	float	maxLuminance;
+	float	averageLuminance;
+	float	logAverageLuminance;	// Geometric mean, the usual auto exposure input
+};
+
+/* === HDR resolve - Exposure, tonemap, sRGB encode and dither into 8-bit, SIMD and tile parallel === */
+// Alpha is clamped and stored without dithering. The destination is resized to match the source.
+void				ResolveHdr( const ImageBuffer<Color>& src, ImageBuffer<rgba8_t>& dst, const tonemapSettings_t& settings );
+void				ResolveHdr( const ImageBuffer<rgba16_t>& src, ImageBuffer<rgba8_t>& dst, const tonemapSettings_t& settings );
+
+// Single pass Rec. 709 luminance reductions over the top mip. Pixels darker than 1e-4 are clamped for the log average.
+luminanceStats_t	ComputeLuminanceStats( const ImageBuffer<Color>& image );
+luminanceStats_t	ComputeLuminanceStats( const ImageBuffer<rgba16_t>& image );
+
+// Exposure that maps the log average luminance to the middle grey key
+float				ComputeAutoExposure( const luminanceStats_t& stats, const float key = 0.18f );
+
+// Value range of a single channel image, e.g. depth
+void				ComputeMinMax( const ImageBuffer<float>& image, float& minValue, float& maxValue );
+
+// 64x64 tileable blue noise ranks in [0, 4096), built once on first use
+const uint16_t*		GetBlueNoiseRanks();
@@ -0,0 +1,454 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "virtualImage.h"
+#include <algorithm>
+#include <fstream>
+#include "../core/parallel.h"
+
+static const uint32_t TilePackMagic = 0x58455456; // "VTEX"
+static const uint32_t TilePackVersion = 1;
+
+
+static inline uint32_t MipExtent( const uint32_t extent, const uint32_t mip )
+{
+	return Max( 1u, extent >> mip );
+}
+
+
+static inline uint32_t TileCount( const uint32_t extent )
+{
+	return ( extent + VirtualImage::TileSize - 1 ) / VirtualImage::TileSize;
+}
+
+
+// Replicates the last valid row and column into the unused part of an edge tile
+static void PadTile( rgba8_t* tile, const uint32_t w, const uint32_t h )
+{
+	const uint32_t T = VirtualImage::TileSize;
+
+	for ( uint32_t y = 0; y < h; ++y )
+	{
+		for ( uint32_t x = w; x < T; ++x ) {
+			tile[ y * T + x ] = tile[ y * T + w - 1 ];
+		}
+	}
+
+	for ( uint32_t y = h; y < T; ++y ) {
+		memcpy( tile + y * T, tile + ( h - 1 ) * T, T * sizeof( rgba8_t ) );
+	}
+}
+
+
+bool BakeTilePack( const std::string& path, const uint32_t width, const uint32_t height, const tileSourceFn_t& source )
+{
+	if ( ( width == 0 ) || ( height == 0 ) ) {
+		return false;
+	}
+
+	std::fstream file( path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc );
+	if ( file.is_open() == false ) {
+		return false;
+	}
+
+	const uint32_t T = VirtualImage::TileSize;
+	const uint64_t headerBytes = sizeof( tilePackHeader_t );
+
+	tilePackHeader_t header {};
+	header.magic = TilePackMagic;
+	header.version = TilePackVersion;
+	header.width = width;
+	header.height = height;
+	header.tileSize = T;
+	header.mipCount = MipCount( width, height );
+
+	file.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+
+	std::vector<rgba8_t> tile( VirtualImage::TileTexels );
+	std::vector<rgba8_t> child( VirtualImage::TileTexels );
+
+	uint64_t tileIndex = 0;
+	uint64_t parentFirstTile = 0;
+
+	for ( uint32_t mip = 0; mip < header.mipCount; ++mip )
+	{
+		const uint32_t mipWidth = MipExtent( width, mip );
+		const uint32_t mipHeight = MipExtent( height, mip );
+		const uint64_t mipFirstTile = tileIndex;
+
+		for ( uint32_t ty = 0; ty < TileCount( mipHeight ); ++ty )
+		{
+			for ( uint32_t tx = 0; tx < TileCount( mipWidth ); ++tx )
+			{
+				const uint32_t w = Min( T, mipWidth - tx * T );
+				const uint32_t h = Min( T, mipHeight - ty * T );
+
+				if ( mip == 0 )
+				{
+					source( tx * T, ty * T, w, h, tile.data(), T );
+				}
+				else
+				{
+					// Each quadrant of this tile is a 2x box filter of one tile from the level above
+					const uint32_t parentWidth = MipExtent( width, mip - 1 );
+					const uint32_t parentHeight = MipExtent( height, mip - 1 );
+					const uint32_t parentTilesX = TileCount( parentWidth );
+					const uint32_t parentTilesY = TileCount( parentHeight );
+
+					for ( uint32_t qy = 0; qy < 2; ++qy )
+					{
+						for ( uint32_t qx = 0; qx < 2; ++qx )
+						{
+							const uint32_t childTx = 2 * tx + qx;
+							const uint32_t childTy = 2 * ty + qy;
+							if ( ( childTx >= parentTilesX ) || ( childTy >= parentTilesY ) ) {
+								continue;
+							}
+
+							file.seekg( headerBytes + ( parentFirstTile + childTy * parentTilesX + childTx ) * VirtualImage::TileBytes );
+							file.read( reinterpret_cast<char*>( child.data() ), VirtualImage::TileBytes );
+
+							const uint32_t childWidth = Min( T, parentWidth - childTx * T );
+							const uint32_t childHeight = Min( T, parentHeight - childTy * T );
+
+							for ( uint32_t y = 0; y < ( childHeight + 1 ) / 2; ++y )
+							{
+								const uint32_t y0 = 2 * y;
+								const uint32_t y1 = Min( 2 * y + 1, childHeight - 1 );
+								for ( uint32_t x = 0; x < ( childWidth + 1 ) / 2; ++x )
+								{
+									const uint32_t x0 = 2 * x;
+									const uint32_t x1 = Min( 2 * x + 1, childWidth - 1 );
+
+									rgba8_t& texel = tile[ ( qy * T / 2 + y ) * T + qx * T / 2 + x ];
+									for ( uint32_t c = 0; c < 4; ++c )
+									{
+										const uint32_t sum = child[ y0 * T + x0 ].vec[ c ] + child[ y0 * T + x1 ].vec[ c ] +
+															 child[ y1 * T + x0 ].vec[ c ] + child[ y1 * T + x1 ].vec[ c ];
+										texel.vec[ c ] = static_cast<uint8_t>( ( sum + 2 ) / 4 );
+									}
+								}
+							}
+						}
+					}
+				}
+
+				PadTile( tile.data(), w, h );
+
+				file.seekp( headerBytes + tileIndex * VirtualImage::TileBytes );
+				file.write( reinterpret_cast<const char*>( tile.data() ), VirtualImage::TileBytes );
+				++tileIndex;
+			}
+		}
+		parentFirstTile = mipFirstTile;
+	}
+
+	return file.good();
+}
+
+
+bool BakeTilePack( const std::string& path, const ImageBuffer<rgba8_t>& image )
+{
+	const slice_t slice = image.GetSlice( 0, 0 );
+	const rgba8_t* texels = reinterpret_cast<const rgba8_t*>( slice.ptr );
+
+	return BakeTilePack( path, slice.width, slice.height, [&]( const uint32_t x0, const uint32_t y0, const uint32_t w, const uint32_t h, rgba8_t* dst, const uint32_t stride )
+	{
+		for ( uint32_t y = 0; y < h; ++y ) {
+			memcpy( dst + y * stride, texels + ( y0 + y ) * slice.width + x0, w * sizeof( rgba8_t ) );
+		}
+	} );
+}
+
+
+bool VirtualImage::Open( const std::string& path, const uint64_t budgetBytes )
+{
+	Close();
+
+	std::ifstream file( path, std::ios::in | std::ios::binary );
+	if ( file.is_open() == false ) {
+		return false;
+	}
+
+	file.read( reinterpret_cast<char*>( &m_header ), sizeof( m_header ) );
+	if ( ( file.good() == false ) || ( m_header.magic != TilePackMagic ) || ( m_header.version != TilePackVersion ) || ( m_header.tileSize != TileSize ) )
+	{
+		m_header = {};
+		return false;
+	}
+	file.close();
+
+	m_path = path;
+
+	uint32_t tileCount = 0;
+	std::vector<uint32_t> pinnedTiles;
+
+	m_mipTileOffset.resize( m_header.mipCount );
+	m_mipTilesX.resize( m_header.mipCount );
+	for ( uint32_t mip = 0; mip < m_header.mipCount; ++mip )
+	{
+		const uint32_t tilesX = TileCount( MipExtent( m_header.width, mip ) );
+		const uint32_t tilesY = TileCount( MipExtent( m_header.height, mip ) );
+
+		m_mipTileOffset[ mip ] = tileCount;
+		m_mipTilesX[ mip ] = tilesX;
+
+		if ( ( tilesX == 1 ) && ( tilesY == 1 ) ) {
+			pinnedTiles.push_back( tileCount );
+		}
+		tileCount += tilesX * tilesY;
+	}
+
+	m_pageTable.assign( tileCount, NotResident );
+	m_requested.assign( tileCount, 0 );
+
+	const uint32_t pinnedCount = static_cast<uint32_t>( pinnedTiles.size() );
+	const uint64_t budgetSlots = Min( budgetBytes / TileBytes, uint64_t( tileCount ) );
+	m_slotCount = Max( static_cast<uint32_t>( budgetSlots ), Min( pinnedCount + 1, tileCount ) );
+
+	m_cache.reset( new rgba8_t[ size_t( m_slotCount ) * TileTexels ] );
+	m_slotTile.assign( m_slotCount, NotResident );
+	m_slotPinned.assign( m_slotCount, 0 );
+	m_slotLastUse.reset( new std::atomic<uint32_t>[ m_slotCount ] );
+	for ( uint32_t slot = 0; slot < m_slotCount; ++slot ) {
+		m_slotLastUse[ slot ] = 0;
+	}
+
+	std::vector<uint32_t> pinnedSlots( pinnedCount );
+	for ( uint32_t i = 0; i < pinnedCount; ++i )
+	{
+		pinnedSlots[ i ] = i;
+		m_slotPinned[ i ] = 1;
+	}
+
+	if ( LoadTiles( pinnedTiles, pinnedSlots ) == false )
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+
+void VirtualImage::Close()
+{
+	m_path.clear();
+	m_header = {};
+	m_mipTileOffset.clear();
+	m_mipTilesX.clear();
+	m_pageTable.clear();
+	m_requested.clear();
+	m_cache.reset();
+	m_slotTile.clear();
+	m_slotPinned.clear();
+	m_slotLastUse.reset();
+	m_slotCount = 0;
+	m_frame = 0;
+
+	std::lock_guard<std::mutex> lock( m_requestLock );
+	m_pendingTiles.clear();
+}
+
+
+uint32_t VirtualImage::TileIndex( const uint32_t x, const uint32_t y, const uint32_t mip ) const
+{
+	return m_mipTileOffset[ mip ] + ( y / TileSize ) * m_mipTilesX[ mip ] + ( x / TileSize );
+}
+
+
+void VirtualImage::RequestTile( const uint32_t tileIndex )
+{
+	std::lock_guard<std::mutex> lock( m_requestLock );
+	if ( m_requested[ tileIndex ] == 0 )
+	{
+		m_requested[ tileIndex ] = 1;
+		m_pendingTiles.push_back( tileIndex );
+	}
+}
+
+
+bool VirtualImage::LoadTiles( const std::vector<uint32_t>& tiles, const std::vector<uint32_t>& slots )
+{
+	std::atomic<bool> loaded( true );
+
+	ParallelFor( static_cast<uint32_t>( tiles.size() ), 4, [&]( const uint32_t begin, const uint32_t end )
+	{
+		std::ifstream file( m_path, std::ios::in | std::ios::binary );
+		for ( uint32_t i = begin; i < end; ++i )
+		{
+			rgba8_t* dst = &m_cache[ size_t( slots[ i ] ) * TileTexels ];
+
+			file.seekg( TileFileOffset( tiles[ i ] ) );
+			file.read( reinterpret_cast<char*>( dst ), TileBytes );
+			if ( file.good() == false )
+			{
+				loaded = false;
+				file.clear();
+				continue;
+			}
+
+			m_slotTile[ slots[ i ] ] = tiles[ i ];
+			m_pageTable[ tiles[ i ] ] = slots[ i ];
+		}
+	} );
+
+	return loaded;
+}
+
+
+rgba8_t VirtualImage::Fetch( uint32_t x, uint32_t y, uint32_t mip )
+{
+	if ( m_header.mipCount == 0 ) {
+		return rgba8_t();
+	}
+
+	const uint32_t frame = m_frame.load( std::memory_order_relaxed );
+
+	for ( mip = Min( mip, m_header.mipCount - 1 ); mip < m_header.mipCount; ++mip )
+	{
+		x = Min( x, MipExtent( m_header.width, mip ) - 1 );
+		y = Min( y, MipExtent( m_header.height, mip ) - 1 );
+
+		const uint32_t tileIndex = TileIndex( x, y, mip );
+		const int32_t slot = m_pageTable[ tileIndex ];
+		if ( slot != NotResident )
+		{
+			m_slotLastUse[ slot ].store( frame, std::memory_order_relaxed );
+			return m_cache[ size_t( slot ) * TileTexels + ( y % TileSize ) * TileSize + ( x % TileSize ) ];
+		}
+
+		RequestTile( tileIndex );
+		x >>= 1;
+		y >>= 1;
+	}
+	return rgba8_t();
+}
+
+
+Color VirtualImage::Sample( const float u, const float v, const float lod )
+{
+	if ( m_header.mipCount == 0 ) {
+		return Color();
+	}
+
+	const uint32_t mip = static_cast<uint32_t>( Clamp( lod, 0.0f, float( m_header.mipCount - 1 ) ) );
+
+	const float fx = Saturate( u ) * MipExtent( m_header.width, mip ) - 0.5f;
+	const float fy = Saturate( v ) * MipExtent( m_header.height, mip ) - 0.5f;
+
+	const float x0 = std::floor( fx );
+	const float y0 = std::floor( fy );
+	const float tx = fx - x0;
+	const float ty = fy - y0;
+
+	const uint32_t ix0 = static_cast<uint32_t>( Max( x0, 0.0f ) );
+	const uint32_t iy0 = static_cast<uint32_t>( Max( y0, 0.0f ) );
+	const uint32_t ix1 = static_cast<uint32_t>( Max( x0 + 1.0f, 0.0f ) );
+	const uint32_t iy1 = static_cast<uint32_t>( Max( y0 + 1.0f, 0.0f ) );
+
+	const Color c00 = Color( Fetch( ix0, iy0, mip ) );
+	const Color c10 = Color( Fetch( ix1, iy0, mip ) );
+	const Color c01 = Color( Fetch( ix0, iy1, mip ) );
+	const Color c11 = Color( Fetch( ix1, iy1, mip ) );
+
+	const Color top = ( 1.0f - tx ) * c00 + tx * c10;
+	const Color bottom = ( 1.0f - tx ) * c01 + tx * c11;
+	return ( 1.0f - ty ) * top + ty * bottom;
+}
+
+
+uint32_t VirtualImage::StreamTiles( const uint32_t maxTiles )
+{
+	std::vector<uint32_t> tiles;
+	{
+		std::lock_guard<std::mutex> lock( m_requestLock );
+
+		const size_t count = Min( size_t( maxTiles ), m_pendingTiles.size() );
+		tiles.assign( m_pendingTiles.begin(), m_pendingTiles.begin() + count );
+		m_pendingTiles.erase( m_pendingTiles.begin(), m_pendingTiles.begin() + count );
+	}
+
+	if ( tiles.empty() ) {
+		return 0;
+	}
+
+	// Empty slots sort first, then oldest use
+	std::vector<uint32_t> candidates;
+	candidates.reserve( m_slotCount );
+	for ( uint32_t slot = 0; slot < m_slotCount; ++slot )
+	{
+		if ( m_slotPinned[ slot ] == 0 ) {
+			candidates.push_back( slot );
+		}
+	}
+
+	const size_t slotCount = Min( tiles.size(), candidates.size() );
+	std::partial_sort( candidates.begin(), candidates.begin() + slotCount, candidates.end(), [&]( const uint32_t a, const uint32_t b )
+	{
+		const bool emptyA = ( m_slotTile[ a ] == NotResident );
+		const bool emptyB = ( m_slotTile[ b ] == NotResident );
+		if ( emptyA != emptyB ) {
+			return emptyA;
+		}
+		return m_slotLastUse[ a ].load( std::memory_order_relaxed ) < m_slotLastUse[ b ].load( std::memory_order_relaxed );
+	} );
+
+	std::vector<uint32_t> slots( candidates.begin(), candidates.begin() + slotCount );
+	for ( const uint32_t slot : slots )
+	{
+		if ( m_slotTile[ slot ] != NotResident )
+		{
+			m_pageTable[ m_slotTile[ slot ] ] = NotResident;
+			m_slotTile[ slot ] = NotResident;
+		}
+	}
+
+	const std::vector<uint32_t> unplaced( tiles.begin() + slotCount, tiles.end() );
+	tiles.resize( slotCount );
+
+	LoadTiles( tiles, slots );
+
+	{
+		std::lock_guard<std::mutex> lock( m_requestLock );
+
+		// Failed loads can be requested again, tiles without a slot wait for the next call
+		for ( const uint32_t tile : tiles ) {
+			m_requested[ tile ] = 0;
+		}
+		m_pendingTiles.insert( m_pendingTiles.begin(), unplaced.begin(), unplaced.end() );
+	}
+
+	m_frame++;
+	return static_cast<uint32_t>( slotCount );
+}
+
+
+uint32_t VirtualImage::ResidentTileCount() const
+{
+	uint32_t count = 0;
+	for ( const int32_t tile : m_slotTile ) {
+		count += ( tile != NotResident ) ? 1 : 0;
+	}
+	return count;
+}
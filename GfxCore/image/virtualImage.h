@@ -0,0 +1,136 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "color.h"
+#include "image.h"
+
+/* === Virtual Image - Tiled, partially resident images ===
+* Images too large to hold in memory are baked into a tile pack: every mip split into fixed 128x128
+* RGBA8 tiles. At runtime a page table per mip maps tiles to slots of a fixed budget cache.
+* Sampling a missing tile queues it and falls back to the next coarser mip. The mip tail that fits
+* in one tile is pinned so the fallback always finds something.
+*/
+
+struct tilePackHeader_t
+{
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	width;
+	uint32_t	height;
+	uint32_t	tileSize;
+	uint32_t	mipCount;
+};
+
+// Fills a w x h region of mip 0 at (x0, y0) into texels, rows are stride texels apart
+using tileSourceFn_t = std::function<void( const uint32_t x0, const uint32_t y0, const uint32_t w, const uint32_t h, rgba8_t* texels, const uint32_t stride )>;
+
+// Writes a tile pack one tile at a time. Coarser mips are filtered from tiles already on disk so memory use doesn't grow with the source.
+bool BakeTilePack( const std::string& path, const uint32_t width, const uint32_t height, const tileSourceFn_t& source );
+bool BakeTilePack( const std::string& path, const ImageBuffer<rgba8_t>& image );
+
+class VirtualImage
+{
+public:
+	static constexpr uint32_t TileSize = 128;
+	static constexpr uint32_t TileTexels = TileSize * TileSize;
+	static constexpr uint32_t TileBytes = TileTexels * sizeof( rgba8_t );
+
+private:
+	static constexpr int32_t NotResident = -1;
+
+	std::string						m_path;
+	tilePackHeader_t				m_header;
+
+	std::vector<uint32_t>			m_mipTileOffset;	// First tile index of each mip
+	std::vector<uint32_t>			m_mipTilesX;		// Tiles per row of each mip
+	std::vector<int32_t>			m_pageTable;		// Tile index -> cache slot
+	std::vector<uint8_t>			m_requested;		// Tile index -> already queued
+
+	std::unique_ptr<rgba8_t[]>		m_cache;			// slotCount * TileTexels, allocated once
+	std::vector<int32_t>			m_slotTile;			// Slot -> tile index
+	std::vector<uint8_t>			m_slotPinned;
+	std::unique_ptr<std::atomic<uint32_t>[]>	m_slotLastUse;
+	uint32_t						m_slotCount;
+	std::atomic<uint32_t>			m_frame;
+
+	std::mutex						m_requestLock;
+	std::vector<uint32_t>			m_pendingTiles;
+
+	inline uint64_t	TileFileOffset( const uint32_t tileIndex ) const
+	{
+		return sizeof( tilePackHeader_t ) + uint64_t( tileIndex ) * TileBytes;
+	}
+
+	uint32_t		TileIndex( const uint32_t x, const uint32_t y, const uint32_t mip ) const;
+	void			RequestTile( const uint32_t tileIndex );
+	bool			LoadTiles( const std::vector<uint32_t>& tiles, const std::vector<uint32_t>& slots );
+
+public:
+	VirtualImage() : m_header{}, m_slotCount( 0 ), m_frame( 0 ) {}
+
+	VirtualImage( const VirtualImage& ) = delete;
+	VirtualImage& operator=( const VirtualImage& ) = delete;
+
+	// The budget is rounded down to whole tiles and raised to fit the pinned mip tail
+	bool			Open( const std::string& path, const uint64_t budgetBytes );
+	void			Close();
+
+	// Safe to call from many threads, but not while StreamTiles() runs
+	rgba8_t			Fetch( uint32_t x, uint32_t y, uint32_t mip );
+	Color			Sample( const float u, const float v, const float lod );
+
+	// Loads up to maxTiles queued tiles in parallel, evicting the least recently used. Call once per frame.
+	uint32_t		StreamTiles( const uint32_t maxTiles = 64 );
+
+	uint32_t		ResidentTileCount() const;
+
+	inline uint32_t GetWidth() const
+	{
+		return m_header.width;
+	}
+
+	inline uint32_t GetHeight() const
+	{
+		return m_header.height;
+	}
+
+	inline uint32_t GetMipCount() const
+	{
+		return m_header.mipCount;
+	}
+
+	inline uint64_t GetBudgetBytes() const
+	{
+		return uint64_t( m_slotCount ) * TileBytes;
+	}
+};
@@ -28,6 +28,7 @@
 #include <string>
 #include <sstream>
 #include <unordered_map>
+#include <atomic>
 
 #include <syscore/serializer.h>
 #include <syscore/common.h>
@@ -36,6 +37,7 @@
 #include "../scene/assetManager.h"
 #include "../asset_types/model.h"
 #include "../asset_types/texture.h"
+#include "../core/parallel.h"
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "../../external/tiny_obj_loader.h"
@@ -91,11 +93,7 @@ bool LoadImageHDR( const char* texturePath, Image& texture )
 	ImageBuffer<rgba16_t>* imageBuffer = new ImageBuffer<rgba16_t>( info.width, info.height, info.layers );
 	
 	const uint32_t elementCount = 4 * imageBuffer->GetPixelCount();
-
-	uint16_t* buffer = reinterpret_cast<uint16_t*>( imageBuffer->Ptr() );
-	for ( uint32_t i = 0; i < elementCount; ++i ) {
-		buffer[ i ] = PackFloat32( elements[ i ] );
-	}
+	PackFloat32( elements, reinterpret_cast<uint16_t*>( imageBuffer->Ptr() ), elementCount );
 
 	texture.Create( info, imageBuffer, nullptr );
 
@@ -115,65 +113,68 @@ bool LoadCubeMapImage( const char* textureBasePath, const char* ext, Image& text
 		( std::string( textureBasePath ) + "_back." + ext ),
 	};
 
-	int sizeBytes = 0;
-	Image textures2D[ 6 ];
+	// Headers first so the layered buffer is allocated once, before any face is decoded
+	int texWidth = 0;
+	int texHeight = 0;
 	for ( int i = 0; i < 6; ++i )
 	{
-		if ( LoadImage( paths[ i ].c_str(), false, textures2D[ i ] ) == false ) {
-			sizeBytes = 0;
-			break;
+		int faceWidth, faceHeight, faceChannels;
+		if ( stbi_info( paths[ i ].c_str(), &faceWidth, &faceHeight, &faceChannels ) == 0 ) {
+			return false;
 		}
-		assert( textures2D[ i ].cpuImage != nullptr );
-		assert( textures2D[ i ].cpuImage->GetByteCount() > 0 );
-		sizeBytes += textures2D[ i ].cpuImage->GetByteCount();
-	}
 
-	if ( sizeBytes == 0 ) {
-		for ( int i = 0; i < 6; ++i )
+		if ( i == 0 )
 		{
-			delete textures2D[ i ].cpuImage;
-			textures2D[ i ].cpuImage = nullptr;
+			texWidth = faceWidth;
+			texHeight = faceHeight;
+		}
+		else if ( ( faceWidth != texWidth ) || ( faceHeight != texHeight ) ) {
+			return false;
 		}
-		return false;
 	}
 
-	const int texWidth = textures2D[ 0 ].info.width;
-	const int texHeight = textures2D[ 0 ].info.height;
-	const int texChannels = textures2D[ 0 ].info.channels;
+	imageInfo_t info = DefaultImage2dInfo( texWidth, texHeight );
+	info.layers = 6;
+	info.type = IMAGE_TYPE_CUBE;
+
+	imageBufferInfo_t bufferInfo {};
+	bufferInfo.width = info.width;
+	bufferInfo.height = info.height;
+	bufferInfo.layers = info.layers;
+	bufferInfo.mipCount = info.mipLevels;
+	bufferInfo.bpp = sizeof( rgba8_t );
 
-	uint8_t* bytes = new uint8_t[ sizeBytes ];
+	ImageBuffer<rgba8_t>* cubeImage = new ImageBuffer<rgba8_t>();
+	cubeImage->Init( bufferInfo );
 
-	int byteOffset = 0;
-	for ( int i = 0; i < 6; ++i )
+	// stb always returns its own allocation, so each face is copied once into its slice and freed
+	std::atomic<bool> loaded( true );
+	ParallelFor( 6, 1, [&]( const uint32_t begin, const uint32_t end )
 	{
-		if ( ( texWidth != textures2D[ i ].info.width ) ||
-			( texHeight != textures2D[ i ].info.height ) ||
-			( texChannels != textures2D[ i ].info.channels ) )
+		for ( uint32_t face = begin; face < end; ++face )
 		{
-			if ( bytes != nullptr ) {
-				delete[] bytes;
-			}
-			for ( int j = 0; j < 6; ++j )
-			{
-				delete textures2D[ i ].cpuImage;
-				textures2D[ i ].cpuImage = nullptr;
+			int faceWidth, faceHeight, faceChannels;
+			stbi_uc* pixels = stbi_load( paths[ face ].c_str(), &faceWidth, &faceHeight, &faceChannels, STBI_rgb_alpha );
+
+			const slice_t slice = cubeImage->GetSlice( face, 0 );
+			if ( ( pixels == nullptr ) || ( faceWidth != texWidth ) || ( faceHeight != texHeight ) ) {
+				loaded = false;
+			} else {
+				memcpy( slice.ptr, pixels, slice.size );
 			}
-			return false;
+			stbi_image_free( pixels );
 		}
+	} );
 
-		memcpy( bytes + byteOffset, textures2D[ i ].cpuImage->Ptr(), textures2D[ i ].cpuImage->GetByteCount() );
-		byteOffset += textures2D[ i ].cpuImage->GetByteCount();
+	if ( loaded == false )
+	{
+		delete cubeImage;
+		return false;
 	}
 
-	assert( sizeBytes == byteOffset );
-	imageInfo_t info = DefaultImage2dInfo( texWidth, texHeight );
-	info.channels = texChannels;
-	info.layers = 6;
-	info.type = IMAGE_TYPE_CUBE;
-
-	texture.Create( info, bytes, sizeBytes );
-
-	delete[] bytes;
+	const samplerState_t sampler = texture.sampler;
+	texture.Create( info, cubeImage, nullptr );
+	texture.sampler = sampler;
 
 	return true;
 }
@@ -229,22 +230,23 @@ bool LoadRawModel( AssetManager& assets, const std::string& fileName, const std:
 		{
 			const std::string& name;
 			bool isLinear;
+			imageUsage_t usage;
 		};
 
 		std::vector<loadInfo_t> supportedTextures;
 		
 		if( isPbr )
 		{
-			supportedTextures.push_back( loadInfo_t{ material.diffuse_texname, false } );
-			supportedTextures.push_back( loadInfo_t{ material.normal_texname, true } );
-			supportedTextures.push_back( loadInfo_t{ material.roughness_texname, true } );
-			supportedTextures.push_back( loadInfo_t{ material.metallic_texname, true } );
+			supportedTextures.push_back( loadInfo_t{ material.diffuse_texname, false, IMAGE_USAGE_COLOR } );
+			supportedTextures.push_back( loadInfo_t{ material.normal_texname, true, IMAGE_USAGE_NORMAL } );
+			supportedTextures.push_back( loadInfo_t{ material.roughness_texname, true, IMAGE_USAGE_MASK } );
+			supportedTextures.push_back( loadInfo_t{ material.metallic_texname, true, IMAGE_USAGE_MASK } );
 		}
 		else
 		{
-			supportedTextures.push_back( loadInfo_t{ material.diffuse_texname, false } );
-			supportedTextures.push_back( loadInfo_t{ material.bump_texname, true } );
-			supportedTextures.push_back( loadInfo_t{ material.specular_texname, true } );
+			supportedTextures.push_back( loadInfo_t{ material.diffuse_texname, false, IMAGE_USAGE_COLOR } );
+			supportedTextures.push_back( loadInfo_t{ material.bump_texname, true, IMAGE_USAGE_NORMAL } );
+			supportedTextures.push_back( loadInfo_t{ material.specular_texname, true, IMAGE_USAGE_MASK } );
 		}
 
 		const uint32_t textureCount = static_cast<uint32_t>( supportedTextures.size() );
@@ -254,7 +256,9 @@ bool LoadRawModel( AssetManager& assets, const std::string& fileName, const std:
 			if( name.length() == 0 ) {
 				continue;
 			}
-			assets.textureLib.AddDeferred( name.c_str(), pImgLoader_t( new ImageLoader( texturePath, name, supportedTextures[ i ].isLinear ) ) );
+			ImageLoader* loader = new ImageLoader( texturePath, name, supportedTextures[ i ].isLinear );
+			loader->SetUsage( supportedTextures[ i ].usage );
+			assets.textureLib.AddDeferred( name.c_str(), pImgLoader_t( loader ) );
 		}
 		
 		Material mat;
@@ -48,6 +48,22 @@ void Vector<D, T>::Serialize( Serializer* serializer )
 }
 
 
+#if defined( GFX_SIMD_SSE )
+void Vector<4, float>::Serialize( Serializer* serializer )
+{
+	Serializer* s = reinterpret_cast<Serializer*>( serializer );
+	uint32_t length = 4;
+	s->Next( length );
+	if ( length != 4 ) {
+		throw std::runtime_error( "Wrong vector length." );
+	}
+	for ( size_t i = 0; i < 4; ++i ) {
+		s->Next( data[i] );
+	}
+}
+#endif
+
+
 void SerializeStruct( Serializer* s, vertex_t& v )
 {
 	static_assert( sizeof( vertex_t ) == 84, "Serialization out-of-date" );
@@ -118,6 +134,38 @@ void AABB::Serialize( Serializer* s )
 }
 
 
+void Bvh::Serialize( Serializer* s )
+{
+	uint32_t version = Version;
+	s->Next( version );
+	if ( version != Version ) {
+		throw std::runtime_error( "Wrong version number." );
+	}
+
+	// The flat image is stored as is, so a loaded tree matches what MapFlat() would see
+	uint32_t byteCount = static_cast<uint32_t>( GetFlatSize() );
+	s->Next( byteCount );
+
+	if ( s->GetMode() == serializeMode_t::LOAD )
+	{
+		Clear();
+		m_storage.resize( byteCount );
+		if ( byteCount > 0 ) {
+			SerializeArray( s, m_storage.data(), byteCount );
+		}
+		if ( ( byteCount > 0 ) && ( ValidateFlat( m_storage.data(), m_storage.size(), true ) == false ) )
+		{
+			Clear();
+			throw std::runtime_error( "Invalid BVH image." );
+		}
+	}
+	else if ( byteCount > 0 )
+	{
+		SerializeArray( s, const_cast<uint8_t*>( GetFlatData() ), byteCount );
+	}
+}
+
+
 void ImageBufferInterface::Serialize( Serializer* s )
 {
 	uint32_t version = Version;
@@ -129,11 +177,16 @@ void ImageBufferInterface::Serialize( Serializer* s )
 	s->Next( bpp );
 	s->Next( mipCount );
 
-	if ( version == 5 )
+	if ( version >= 5 )
 	{
 		s->Next( byteCount );
 	}
 
+	if ( version >= 6 )
+	{
+		s->Next( blockSize );
+	}
+
 	if ( s->GetMode() == serializeMode_t::LOAD )
 	{
 		imageBufferInfo_t info{};
@@ -142,13 +195,14 @@ void ImageBufferInterface::Serialize( Serializer* s )
 		info.layers = layers;
 		info.mipCount = mipCount > 0 ? mipCount : 1;
 		info.bpp = bpp;
+		info.blockSize = ( version >= 6 ) ? blockSize : 1;
 
 		const uint32_t storedLength = length; // TODO: replace with byteCount
 		_Init( info );
 		assert( storedLength == length );
 	}
 
-	if( version == 5 )
+	if( version >= 5 )
 	{
 		assert( buffer != nullptr );
 		SerializeArray( s, buffer, byteCount );
@@ -165,7 +219,7 @@ void Material::Serialize( Serializer* s )
 {
 	uint32_t version = Version;
 	s->Next( version );
-	if ( version != Version ) {
+	if ( ( version == 0 ) || ( version > Version ) ) {
 		throw std::runtime_error( "Wrong version number." );
 	}
 	SerializeStruct( s, usage );
@@ -174,6 +228,16 @@ void Material::Serialize( Serializer* s )
 	s->Next( shaderBitSet );
 	SerializeArray( s, textures, MaxMaterialTextures );
 	SerializeArray( s, shaders, MaxMaterialShaders );
+
+	if ( version >= 2 )
+	{
+		for ( uint32_t i = 0; i < MaxMaterialTextures; ++i )
+		{
+			textureRemaps[ i ].scale.Serialize( s );
+			textureRemaps[ i ].bias.Serialize( s );
+			s->Next( textureRemaps[ i ].layer );
+		}
+	}
 }
 
 
@@ -0,0 +1,177 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2013-2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "vector.h"
+#include "matrix.h"
+
+// Row-major 3x4 affine transform, x' = L * x + t with an implicit ( 0, 0, 0, 1 ) last row.
+// Each row is a vec4f ( L[ r ][ 0..2 ], t[ r ] ), so the work goes through the SIMD vec4f overloads.
+class AffineTransform
+{
+private:
+	vec4f rows[ 3 ];
+
+public:
+
+	constexpr AffineTransform() : rows{ vec4f( 1.0f, 0.0f, 0.0f, 0.0f ), vec4f( 0.0f, 1.0f, 0.0f, 0.0f ), vec4f( 0.0f, 0.0f, 1.0f, 0.0f ) } {}
+
+	constexpr AffineTransform( const vec4f& row0, const vec4f& row1, const vec4f& row2 ) : rows{ row0, row1, row2 } {}
+
+	// Drops the last row of m
+	explicit constexpr AffineTransform( const mat4x4f& m ) :
+		rows{	vec4f( m[ 0 ][ 0 ], m[ 0 ][ 1 ], m[ 0 ][ 2 ], m[ 0 ][ 3 ] ),
+				vec4f( m[ 1 ][ 0 ], m[ 1 ][ 1 ], m[ 1 ][ 2 ], m[ 1 ][ 3 ] ),
+				vec4f( m[ 2 ][ 0 ], m[ 2 ][ 1 ], m[ 2 ][ 2 ], m[ 2 ][ 3 ] ) }
+	{}
+
+	// T * R * S, the usual entity composition
+	static AffineTransform FromRotationScale( const mat4x4f& rotation, const vec3f& scale, const vec3f& translation )
+	{
+		const vec4f s = vec4f( scale, 0.0f );
+		AffineTransform xform;
+		for ( uint32_t r = 0; r < 3; ++r )
+		{
+			xform.rows[ r ] = Multiply( vec4f( rotation[ r ][ 0 ], rotation[ r ][ 1 ], rotation[ r ][ 2 ], 0.0f ), s );
+			xform.rows[ r ][ 3 ] = translation[ r ];
+		}
+		return xform;
+	}
+
+	constexpr inline vec4f& operator[]( const size_t r )
+	{
+		return rows[ r ];
+	}
+
+	constexpr inline const vec4f& operator[]( const size_t r ) const
+	{
+		return rows[ r ];
+	}
+
+	vec3f GetTranslation() const
+	{
+		return vec3f( rows[ 0 ][ 3 ], rows[ 1 ][ 3 ], rows[ 2 ][ 3 ] );
+	}
+
+	mat4x4f ToMatrix() const
+	{
+		mat4x4f m( 1.0f );
+		for ( uint32_t r = 0; r < 3; ++r )
+		{
+			for ( uint32_t c = 0; c < 4; ++c ) {
+				m[ r ][ c ] = rows[ r ][ c ];
+			}
+		}
+		return m;
+	}
+
+	vec3f TransformPoint( const vec3f& p ) const
+	{
+		const vec4f p4 = vec4f( p, 1.0f );
+		return vec3f( Dot( rows[ 0 ], p4 ), Dot( rows[ 1 ], p4 ), Dot( rows[ 2 ], p4 ) );
+	}
+
+	vec3f TransformVector( const vec3f& v ) const
+	{
+		const vec4f v4 = vec4f( v, 0.0f );
+		return vec3f( Dot( rows[ 0 ], v4 ), Dot( rows[ 1 ], v4 ), Dot( rows[ 2 ], v4 ) );
+	}
+
+	// Transforms by the absolute linear part, maps box half-extents to world half-extents
+	vec3f TransformExtent( const vec3f& e ) const
+	{
+		vec3f out;
+		for ( uint32_t r = 0; r < 3; ++r ) {
+			out[ r ] = fabsf( rows[ r ][ 0 ] ) * e[ 0 ] + fabsf( rows[ r ][ 1 ] ) * e[ 1 ] + fabsf( rows[ r ][ 2 ] ) * e[ 2 ];
+		}
+		return out;
+	}
+
+	// General inverse through the adjugate of the linear part
+	AffineTransform Inverse( bool& invertible ) const
+	{
+		const vec3f r0 = vec3f( rows[ 0 ][ 0 ], rows[ 0 ][ 1 ], rows[ 0 ][ 2 ] );
+		const vec3f r1 = vec3f( rows[ 1 ][ 0 ], rows[ 1 ][ 1 ], rows[ 1 ][ 2 ] );
+		const vec3f r2 = vec3f( rows[ 2 ][ 0 ], rows[ 2 ][ 1 ], rows[ 2 ][ 2 ] );
+
+		// Columns of the adjugate
+		const vec3f c0 = Cross( r1, r2 );
+		const vec3f c1 = Cross( r2, r0 );
+		const vec3f c2 = Cross( r0, r1 );
+
+		const float det = Dot( r0, c0 );
+		if ( det == 0.0f )
+		{
+			invertible = false;
+			return AffineTransform();
+		}
+		invertible = true;
+
+		const float invDet = 1.0f / det;
+		AffineTransform inv(	vec4f( c0[ 0 ], c1[ 0 ], c2[ 0 ], 0.0f ) * invDet,
+								vec4f( c0[ 1 ], c1[ 1 ], c2[ 1 ], 0.0f ) * invDet,
+								vec4f( c0[ 2 ], c1[ 2 ], c2[ 2 ], 0.0f ) * invDet );
+		inv.SetInverseTranslation( GetTranslation() );
+		return inv;
+	}
+
+	// Fast path for rotation * scale without shear: the linear part has orthogonal columns,
+	// so its inverse rows are those columns divided by their squared lengths. Orthonormal
+	// transforms reduce to the transpose.
+	AffineTransform InverseOrthogonal() const
+	{
+		AffineTransform inv;
+		for ( uint32_t c = 0; c < 3; ++c )
+		{
+			const vec4f column = vec4f( rows[ 0 ][ c ], rows[ 1 ][ c ], rows[ 2 ][ c ], 0.0f );
+			const float lengthSq = Dot( column, column );
+			inv.rows[ c ] = ( lengthSq > 0.0f ) ? ( column / lengthSq ) : vec4f( 0.0f );
+		}
+		inv.SetInverseTranslation( GetTranslation() );
+		return inv;
+	}
+
+private:
+	// t' = -L^-1 * t, with L^-1 already in place
+	void SetInverseTranslation( const vec3f& t )
+	{
+		const vec3f invT = TransformVector( t );
+		rows[ 0 ][ 3 ] = -invT[ 0 ];
+		rows[ 1 ][ 3 ] = -invT[ 1 ];
+		rows[ 2 ][ 3 ] = -invT[ 2 ];
+	}
+};
+
+
+// a * b applies b first
+inline AffineTransform operator*( const AffineTransform& a, const AffineTransform& b )
+{
+	const vec4f w = vec4f( 0.0f, 0.0f, 0.0f, 1.0f );
+	AffineTransform c;
+	for ( uint32_t r = 0; r < 3; ++r ) {
+		c[ r ] = a[ r ][ 0 ] * b[ 0 ] + a[ r ][ 1 ] * b[ 1 ] + a[ r ][ 2 ] * b[ 2 ] + a[ r ][ 3 ] * w;
+	}
+	return c;
+}
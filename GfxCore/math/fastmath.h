@@ -0,0 +1,443 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2013-2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cfloat>
+#include "vector.h"
+#include "../core/common.h"
+
+// Polynomial approximations of libm functions in scalar and SSE forms. Error bounds are measured against double precision:
+//	FastSin, FastCos, FastSinCos	abs error < 2e-7 for |x| < 8192
+//	FastExp2						rel error < 2e-7, x clamped to [ -126, 127 ]
+//	FastLog2						abs error < 2e-7 * max( 1, |log2( x )| ), x > 0 ( denormals read as FLT_MIN )
+//	FastPow							rel error < 3e-6 while |y * log2( x )| < 32, x > 0. x = 0 gives 1, 0 or +inf for y = 0, > 0, < 0, x < 0 gives 0
+//	FastRsqrt						rel error < 5e-7, x > 0
+//	FastAcos						abs error < 6e-7, x clamped to [ -1, 1 ]
+// With SSE the scalar forms run one lane of the Simd* form, so both give identical results.
+
+static constexpr float FastTwoOverPi	= 0.636619772367581343f;
+static constexpr float FastPiOver2A		= 1.5703125f;					// Pi / 2 split in three for exact reduction
+static constexpr float FastPiOver2B		= 4.837512969970703125e-4f;
+static constexpr float FastPiOver2C		= 7.54978995489188216e-8f;
+static constexpr float FastSqrtHalf		= 0.707106781186547524f;
+static constexpr float FastLog2EMinus1	= 0.44269504088896340736f;		// log2( e ) - 1
+
+// Minimax polynomials on the reduced ranges ( Cephes sinf, cosf, exp2f and logf, Abramowitz and Stegun 4.4.46 for acos )
+static constexpr float FastSinPoly[ 3 ]		= { -1.9515295891e-4f, 8.3321608736e-3f, -1.6666654611e-1f };
+static constexpr float FastCosPoly[ 3 ]		= { 2.443315711809948e-5f, -1.388731625493765e-3f, 4.166664568298827e-2f };
+static constexpr float FastExp2Poly[ 6 ]	= { 1.535336188319500e-4f, 1.339887440266574e-3f, 9.618437357674640e-3f, 5.550332471162809e-2f, 2.402264791363012e-1f, 6.931472028550421e-1f };
+static constexpr float FastLogPoly[ 9 ]		= { 7.0376836292e-2f, -1.1514610310e-1f, 1.1676998740e-1f, -1.2420140846e-1f, 1.4249322787e-1f, -1.6668057665e-1f, 2.0000714765e-1f, -2.4999993993e-1f, 3.3333331174e-1f };
+static constexpr float FastAcosPoly[ 8 ]	= { -0.0012624911f, 0.0066700901f, -0.0170881256f, 0.0308918810f, -0.0501743046f, 0.0889789874f, -0.2145988016f, 1.5707963050f };
+
+
+#if defined( GFX_SIMD_SSE )
+
+inline __m128 SimdSelect( const __m128 mask, const __m128 a, const __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+
+// c[ 0 ] * x + c[ 1 ]. Polynomials below are written out in Estrin's form so the dependency chains stay short.
+inline __m128 SimdLinear( const float* c, const __m128 x )
+{
+	return SimdMadd( _mm_set1_ps( c[ 0 ] ), x, _mm_set1_ps( c[ 1 ] ) );
+}
+
+
+// c[ 0 ] * x^3 + c[ 1 ] * x^2 + c[ 2 ] * x + c[ 3 ]
+inline __m128 SimdCubic( const float* c, const __m128 x, const __m128 x2 )
+{
+	return SimdMadd( SimdLinear( c, x ), x2, SimdLinear( c + 2, x ) );
+}
+
+
+// c[ 0 ] * x^2 + c[ 1 ] * x + c[ 2 ]
+inline __m128 SimdQuadratic( const float* c, const __m128 x, const __m128 x2 )
+{
+	return SimdMadd( _mm_set1_ps( c[ 0 ] ), x2, SimdLinear( c + 1, x ) );
+}
+
+
+inline void SimdSinCos( const __m128 x, __m128& outSin, __m128& outCos )
+{
+	// x = r + q * pi / 2 with |r| <= pi / 4
+	const __m128i q = _mm_cvtps_epi32( _mm_mul_ps( x, _mm_set1_ps( FastTwoOverPi ) ) );
+	const __m128 j = _mm_cvtepi32_ps( q );
+	__m128 r = SimdMadd( j, _mm_set1_ps( -FastPiOver2A ), x );
+	r = SimdMadd( j, _mm_set1_ps( -FastPiOver2B ), r );
+	r = SimdMadd( j, _mm_set1_ps( -FastPiOver2C ), r );
+
+	const __m128 r2 = _mm_mul_ps( r, r );
+	const __m128 r4 = _mm_mul_ps( r2, r2 );
+	const __m128 s = SimdMadd( _mm_mul_ps( SimdQuadratic( FastSinPoly, r2, r4 ), r2 ), r, r );
+	const __m128 c = SimdMadd( SimdQuadratic( FastCosPoly, r2, r4 ), r4, SimdMadd( r2, _mm_set1_ps( -0.5f ), _mm_set1_ps( 1.0f ) ) );
+
+	// Odd quadrants swap sin and cos, sin flips sign in quadrants 2 and 3, cos in quadrants 1 and 2
+	const __m128i one = _mm_set1_epi32( 1 );
+	const __m128i two = _mm_set1_epi32( 2 );
+	const __m128 swap = _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_and_si128( q, one ), one ) );
+	const __m128 sinSign = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( q, two ), 30 ) );
+	const __m128 cosSign = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( _mm_add_epi32( q, one ), two ), 30 ) );
+
+	outSin = _mm_xor_ps( SimdSelect( swap, c, s ), sinSign );
+	outCos = _mm_xor_ps( SimdSelect( swap, s, c ), cosSign );
+}
+
+
+inline __m128 SimdSin( const __m128 x )
+{
+	__m128 s, c;
+	SimdSinCos( x, s, c );
+	return s;
+}
+
+
+inline __m128 SimdCos( const __m128 x )
+{
+	__m128 s, c;
+	SimdSinCos( x, s, c );
+	return c;
+}
+
+
+inline __m128 SimdExp2( const __m128 x )
+{
+	const __m128 clamped = _mm_min_ps( _mm_max_ps( x, _mm_set1_ps( -126.0f ) ), _mm_set1_ps( 127.0f ) );
+	const __m128i i = _mm_cvtps_epi32( clamped );
+	const __m128 f = _mm_sub_ps( clamped, _mm_cvtepi32_ps( i ) );
+
+	const __m128 f2 = _mm_mul_ps( f, f );
+	const __m128 f4 = _mm_mul_ps( f2, f2 );
+	const __m128 poly = SimdMadd( SimdLinear( FastExp2Poly, f ), f4, SimdMadd( SimdLinear( FastExp2Poly + 2, f ), f2, SimdLinear( FastExp2Poly + 4, f ) ) );
+	const __m128 p = SimdMadd( poly, f, _mm_set1_ps( 1.0f ) );
+	const __m128 scale = _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( i, _mm_set1_epi32( 127 ) ), 23 ) );
+	return _mm_mul_ps( p, scale );
+}
+
+
+inline __m128 SimdLog2( const __m128 x )
+{
+	// x = m * 2^e with m in [ sqrt( 1/2 ), sqrt( 2 ) )
+	const __m128i bits = _mm_castps_si128( _mm_max_ps( x, _mm_set1_ps( FLT_MIN ) ) );
+	__m128i e = _mm_sub_epi32( _mm_srli_epi32( bits, 23 ), _mm_set1_epi32( 127 ) );
+	__m128 m = _mm_castsi128_ps( _mm_or_si128( _mm_and_si128( bits, _mm_set1_epi32( 0x007FFFFF ) ), _mm_set1_epi32( 0x3F800000 ) ) );
+
+	const __m128 upper = _mm_cmpgt_ps( m, _mm_set1_ps( 1.0f / FastSqrtHalf ) );
+	m = SimdSelect( upper, _mm_mul_ps( m, _mm_set1_ps( 0.5f ) ), m );
+	e = _mm_sub_epi32( e, _mm_castps_si128( upper ) );
+
+	// log( 1 + t ) = t - t^2 / 2 + t^3 * P( t )
+	const __m128 t = _mm_sub_ps( m, _mm_set1_ps( 1.0f ) );
+	const __m128 t2 = _mm_mul_ps( t, t );
+	const __m128 t4 = _mm_mul_ps( t2, t2 );
+	const __m128 poly = SimdMadd( SimdMadd( SimdCubic( FastLogPoly, t, t2 ), t4, SimdCubic( FastLogPoly + 4, t, t2 ) ), t, _mm_set1_ps( FastLogPoly[ 8 ] ) );
+	__m128 y = _mm_mul_ps( _mm_mul_ps( poly, t ), t2 );
+	y = SimdMadd( t2, _mm_set1_ps( -0.5f ), y );
+
+	// log2 = ( y + t ) * log2( e ), with log2( e ) split as 1 + ( log2( e ) - 1 ) to keep precision
+	const __m128 sum = _mm_add_ps( y, t );
+	return _mm_add_ps( SimdMadd( sum, _mm_set1_ps( FastLog2EMinus1 ), sum ), _mm_cvtepi32_ps( e ) );
+}
+
+
+inline __m128 SimdPow( const __m128 x, const __m128 y )
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 result = SimdExp2( _mm_mul_ps( y, SimdLog2( x ) ) );
+
+	// pow( 0, y ) is 1 for y = 0, +inf for y < 0 and 0 for y > 0
+	const __m128 zeroPow = _mm_or_ps( _mm_and_ps( _mm_cmpeq_ps( y, zero ), _mm_set1_ps( 1.0f ) ),
+		_mm_and_ps( _mm_cmplt_ps( y, zero ), _mm_set1_ps( std::numeric_limits<float>::infinity() ) ) );
+
+	return _mm_or_ps( _mm_and_ps( _mm_cmpgt_ps( x, zero ), result ), _mm_and_ps( _mm_cmpeq_ps( x, zero ), zeroPow ) );
+}
+
+
+inline __m128 SimdRsqrt( const __m128 x )
+{
+	// Hardware estimate plus one Newton step
+	const __m128 r = _mm_rsqrt_ps( x );
+	const __m128 halfX = _mm_mul_ps( x, _mm_set1_ps( 0.5f ) );
+	return _mm_mul_ps( r, SimdMadd( _mm_mul_ps( halfX, r ), _mm_sub_ps( _mm_setzero_ps(), r ), _mm_set1_ps( 1.5f ) ) );
+}
+
+
+inline __m128 SimdAcos( const __m128 x )
+{
+	const __m128 signBit = _mm_set1_ps( -0.0f );
+	const __m128 ax = _mm_min_ps( _mm_andnot_ps( signBit, x ), _mm_set1_ps( 1.0f ) );
+	const __m128 ax2 = _mm_mul_ps( ax, ax );
+	const __m128 poly = SimdMadd( SimdCubic( FastAcosPoly, ax, ax2 ), _mm_mul_ps( ax2, ax2 ), SimdCubic( FastAcosPoly + 4, ax, ax2 ) );
+	const __m128 r = _mm_mul_ps( _mm_sqrt_ps( _mm_sub_ps( _mm_set1_ps( 1.0f ), ax ) ), poly );
+
+	// acos( -x ) = pi - acos( x )
+	const __m128 negative = _mm_cmplt_ps( x, _mm_setzero_ps() );
+	return SimdSelect( negative, _mm_sub_ps( _mm_set1_ps( PI ), r ), r );
+}
+
+#else
+
+template<size_t N>
+inline float ScalarPolynomial( const float ( &coefficients )[ N ], const float x )
+{
+	float p = coefficients[ 0 ];
+	for ( size_t i = 1; i < N; ++i ) {
+		p = p * x + coefficients[ i ];
+	}
+	return p;
+}
+
+
+inline float FloatFromBits( const uint32_t bits )
+{
+	float f;
+	memcpy( &f, &bits, sizeof( f ) );
+	return f;
+}
+
+
+inline uint32_t BitsFromFloat( const float f )
+{
+	uint32_t bits;
+	memcpy( &bits, &f, sizeof( bits ) );
+	return bits;
+}
+
+#endif
+
+
+inline void FastSinCos( const float x, float& outSin, float& outCos )
+{
+#if defined( GFX_SIMD_SSE )
+	__m128 s, c;
+	SimdSinCos( _mm_set_ss( x ), s, c );
+	outSin = _mm_cvtss_f32( s );
+	outCos = _mm_cvtss_f32( c );
+#else
+	const float scaled = x * FastTwoOverPi;
+	const int32_t q = static_cast<int32_t>( scaled + ( ( scaled >= 0.0f ) ? 0.5f : -0.5f ) );
+	const float j = static_cast<float>( q );
+	const float r = ( ( x - j * FastPiOver2A ) - j * FastPiOver2B ) - j * FastPiOver2C;
+
+	const float r2 = r * r;
+	const float s = ScalarPolynomial( FastSinPoly, r2 ) * r2 * r + r;
+	const float c = ScalarPolynomial( FastCosPoly, r2 ) * r2 * r2 + ( 1.0f - 0.5f * r2 );
+
+	outSin = ( q & 1 ) ? c : s;
+	outCos = ( q & 1 ) ? s : c;
+	if ( q & 2 ) {
+		outSin = -outSin;
+	}
+	if ( ( q + 1 ) & 2 ) {
+		outCos = -outCos;
+	}
+#endif
+}
+
+
+inline float FastSin( const float x )
+{
+	float s, c;
+	FastSinCos( x, s, c );
+	return s;
+}
+
+
+inline float FastCos( const float x )
+{
+	float s, c;
+	FastSinCos( x, s, c );
+	return c;
+}
+
+
+inline float FastExp2( const float x )
+{
+#if defined( GFX_SIMD_SSE )
+	return _mm_cvtss_f32( SimdExp2( _mm_set_ss( x ) ) );
+#else
+	const float clamped = Clamp( x, -126.0f, 127.0f );
+	const int32_t i = static_cast<int32_t>( clamped + ( ( clamped >= 0.0f ) ? 0.5f : -0.5f ) );
+	const float f = clamped - static_cast<float>( i );
+	const float p = ScalarPolynomial( FastExp2Poly, f ) * f + 1.0f;
+	return p * FloatFromBits( static_cast<uint32_t>( i + 127 ) << 23 );
+#endif
+}
+
+
+inline float FastLog2( const float x )
+{
+#if defined( GFX_SIMD_SSE )
+	return _mm_cvtss_f32( SimdLog2( _mm_set_ss( x ) ) );
+#else
+	const uint32_t bits = BitsFromFloat( Max( x, FLT_MIN ) );
+	int32_t e = static_cast<int32_t>( bits >> 23 ) - 127;
+	float m = FloatFromBits( ( bits & 0x007FFFFF ) | 0x3F800000 );
+	if ( m > ( 1.0f / FastSqrtHalf ) )
+	{
+		m *= 0.5f;
+		e += 1;
+	}
+
+	const float t = m - 1.0f;
+	const float t2 = t * t;
+	const float y = ScalarPolynomial( FastLogPoly, t ) * t * t2 - 0.5f * t2;
+	const float sum = y + t;
+	return ( sum * FastLog2EMinus1 + sum ) + static_cast<float>( e );
+#endif
+}
+
+
+inline float FastPow( const float x, const float y )
+{
+#if defined( GFX_SIMD_SSE )
+	return _mm_cvtss_f32( SimdPow( _mm_set_ss( x ), _mm_set_ss( y ) ) );
+#else
+	if ( x > 0.0f ) {
+		return FastExp2( y * FastLog2( x ) );
+	}
+	if ( x == 0.0f ) {
+		return ( y == 0.0f ) ? 1.0f : ( ( y < 0.0f ) ? std::numeric_limits<float>::infinity() : 0.0f );
+	}
+	return 0.0f;
+#endif
+}
+
+
+inline float FastRsqrt( const float x )
+{
+#if defined( GFX_SIMD_SSE )
+	return _mm_cvtss_f32( SimdRsqrt( _mm_set_ss( x ) ) );
+#else
+	return 1.0f / sqrtf( x );
+#endif
+}
+
+
+inline float FastAcos( const float x )
+{
+#if defined( GFX_SIMD_SSE )
+	return _mm_cvtss_f32( SimdAcos( _mm_set_ss( x ) ) );
+#else
+	const float ax = Min( fabsf( x ), 1.0f );
+	const float r = sqrtf( 1.0f - ax ) * ScalarPolynomial( FastAcosPoly, ax );
+	return ( x < 0.0f ) ? ( PI - r ) : r;
+#endif
+}
+
+
+// Three values in one SIMD call, for Euler angles and color channels
+inline void FastSinCos( const vec3f& x, vec3f& outSin, vec3f& outCos )
+{
+#if defined( GFX_SIMD_SSE )
+	__m128 s, c;
+	SimdSinCos( _mm_setr_ps( x[ 0 ], x[ 1 ], x[ 2 ], 0.0f ), s, c );
+
+	alignas( 16 ) float sinLanes[ 4 ];
+	alignas( 16 ) float cosLanes[ 4 ];
+	_mm_store_ps( sinLanes, s );
+	_mm_store_ps( cosLanes, c );
+	outSin = vec3f( sinLanes[ 0 ], sinLanes[ 1 ], sinLanes[ 2 ] );
+	outCos = vec3f( cosLanes[ 0 ], cosLanes[ 1 ], cosLanes[ 2 ] );
+#else
+	for ( size_t i = 0; i < 3; ++i ) {
+		FastSinCos( x[ i ], outSin[ i ], outCos[ i ] );
+	}
+#endif
+}
+
+
+inline vec3f FastPow( const vec3f& x, const float y )
+{
+#if defined( GFX_SIMD_SSE )
+	alignas( 16 ) float lanes[ 4 ];
+	_mm_store_ps( lanes, SimdPow( _mm_setr_ps( x[ 0 ], x[ 1 ], x[ 2 ], 0.0f ), _mm_set1_ps( y ) ) );
+	return vec3f( lanes[ 0 ], lanes[ 1 ], lanes[ 2 ] );
+#else
+	return vec3f( FastPow( x[ 0 ], y ), FastPow( x[ 1 ], y ), FastPow( x[ 2 ], y ) );
+#endif
+}
+
+
+/* === Precision policy === */
+// Hot paths call through mathDefault_t. It maps to libm unless the build defines GFX_FAST_MATH,
+// callers that always want one behavior can name mathPolicy_t< mathPrecision_t::EXACT/FAST > directly.
+
+enum class mathPrecision_t : uint32_t
+{
+	EXACT,	// libm
+	FAST,	// Fast* approximations above
+};
+
+template<mathPrecision_t Precision>
+struct mathPolicy_t;
+
+template<>
+struct mathPolicy_t< mathPrecision_t::EXACT >
+{
+	static inline float Sin( const float x ) { return sinf( x ); }
+	static inline float Cos( const float x ) { return cosf( x ); }
+	static inline void SinCos( const float x, float& outSin, float& outCos ) { outSin = sinf( x ); outCos = cosf( x ); }
+	static inline float Exp2( const float x ) { return exp2f( x ); }
+	static inline float Log2( const float x ) { return log2f( x ); }
+	static inline float Pow( const float x, const float y ) { return powf( x, y ); }
+	static inline float Rsqrt( const float x ) { return 1.0f / sqrtf( x ); }
+	static inline float Acos( const float x ) { return acosf( x ); }
+
+	static inline void SinCos( const vec3f& x, vec3f& outSin, vec3f& outCos )
+	{
+		for ( size_t i = 0; i < 3; ++i ) {
+			SinCos( x[ i ], outSin[ i ], outCos[ i ] );
+		}
+	}
+
+	static inline vec3f Pow( const vec3f& x, const float y ) { return vec3f( powf( x[ 0 ], y ), powf( x[ 1 ], y ), powf( x[ 2 ], y ) ); }
+};
+
+template<>
+struct mathPolicy_t< mathPrecision_t::FAST >
+{
+	static inline float Sin( const float x ) { return FastSin( x ); }
+	static inline float Cos( const float x ) { return FastCos( x ); }
+	static inline void SinCos( const float x, float& outSin, float& outCos ) { FastSinCos( x, outSin, outCos ); }
+	static inline float Exp2( const float x ) { return FastExp2( x ); }
+	static inline float Log2( const float x ) { return FastLog2( x ); }
+	static inline float Pow( const float x, const float y ) { return FastPow( x, y ); }
+	static inline float Rsqrt( const float x ) { return FastRsqrt( x ); }
+	static inline float Acos( const float x ) { return FastAcos( x ); }
+	static inline void SinCos( const vec3f& x, vec3f& outSin, vec3f& outCos ) { FastSinCos( x, outSin, outCos ); }
+	static inline vec3f Pow( const vec3f& x, const float y ) { return FastPow( x, y ); }
+};
+
+#if defined( GFX_FAST_MATH )
+static constexpr mathPrecision_t DefaultMathPrecision = mathPrecision_t::FAST;
+#else
+static constexpr mathPrecision_t DefaultMathPrecision = mathPrecision_t::EXACT;
+#endif
+
+using mathDefault_t = mathPolicy_t< DefaultMathPrecision >;
@@ -0,0 +1,175 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "half.h"
+#include "../core/simd.h"
+
+#if defined( GFX_SIMD_SSE )
+
+GFX_TARGET_F16C static void PackFloat32F16C( const float* src, uint16_t* dst, const size_t count )
+{
+	size_t i = 0;
+	for ( ; ( i + 8 ) <= count; i += 8 )
+	{
+		const __m256 f = _mm256_loadu_ps( src + i );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm256_cvtps_ph( f, _MM_FROUND_TO_NEAREST_INT ) );
+	}
+	for ( ; i < count; ++i ) {
+		dst[ i ] = PackFloat32( src[ i ] );
+	}
+}
+
+
+GFX_TARGET_F16C static void UnpackFloat32F16C( const uint16_t* src, float* dst, const size_t count )
+{
+	size_t i = 0;
+	for ( ; ( i + 8 ) <= count; i += 8 )
+	{
+		const __m128i h = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+		_mm256_storeu_ps( dst + i, _mm256_cvtph_ps( h ) );
+	}
+	for ( ; i < count; ++i ) {
+		dst[ i ] = UnpackFloat32( src[ i ] );
+	}
+}
+
+
+// SSE2 port of the scalar PackFloat32(), every path is computed and the result selected with masks
+static inline __m128i PackFloat32x4( const __m128 f )
+{
+	const __m128i f16Max = _mm_set1_epi32( ( 127 + 16 ) << 23 );
+	const __m128i f16MinNormal = _mm_set1_epi32( ( 127 - 14 ) << 23 );
+	const __m128i denormMagic = _mm_set1_epi32( ( ( 127 - 15 ) + ( 23 - 10 ) + 1 ) << 23 );
+	const __m128i normalBias = _mm_set1_epi32( 0xFFF - ( ( 127 - 15 ) << 23 ) );
+	const __m128i nanBit = _mm_set1_epi32( 0x200 );
+	const __m128i infinity = _mm_set1_epi32( 0x7C00 );
+
+	const __m128 justSign = _mm_and_ps( f, _mm_castsi128_ps( _mm_set1_epi32( 0x80000000 ) ) );
+	const __m128 absF = _mm_xor_ps( f, justSign );
+	const __m128i absBits = _mm_castps_si128( absF );
+
+	const __m128i isNan = _mm_castps_si128( _mm_cmpunord_ps( absF, absF ) );
+	const __m128i isRegular = _mm_cmpgt_epi32( f16Max, absBits );
+	const __m128i isDenorm = _mm_cmpgt_epi32( f16MinNormal, absBits );
+	const __m128i special = _mm_or_si128( _mm_and_si128( isNan, nanBit ), infinity );
+
+	const __m128 denormAdd = _mm_add_ps( absF, _mm_castsi128_ps( denormMagic ) );
+	const __m128i denorm = _mm_sub_epi32( _mm_castps_si128( denormAdd ), denormMagic );
+
+	const __m128i mantissaOdd = _mm_srai_epi32( _mm_slli_epi32( absBits, 31 - 13 ), 31 );
+	const __m128i normal = _mm_srli_epi32( _mm_sub_epi32( _mm_add_epi32( absBits, normalBias ), mantissaOdd ), 13 );
+
+	const __m128i finite = _mm_or_si128( _mm_and_si128( isDenorm, denorm ), _mm_andnot_si128( isDenorm, normal ) );
+	const __m128i joined = _mm_or_si128( _mm_and_si128( isRegular, finite ), _mm_andnot_si128( isRegular, special ) );
+
+	// Arithmetic shift keeps negative results in int16 range so the saturating pack is lossless
+	return _mm_or_si128( joined, _mm_srai_epi32( _mm_castps_si128( justSign ), 16 ) );
+}
+
+
+static inline __m128 UnpackFloat32x4( const __m128i h )
+{
+	const __m128i noSignMask = _mm_set1_epi32( 0x7FFF );
+	const __m128 magic = _mm_castsi128_ps( _mm_set1_epi32( ( 254 - 15 ) << 23 ) );
+	const __m128i maxFinite = _mm_set1_epi32( 0x7BFF );
+	const __m128 infNanExp = _mm_castsi128_ps( _mm_set1_epi32( 255 << 23 ) );
+
+	const __m128i expMantissa = _mm_and_si128( h, noSignMask );
+	const __m128i justSign = _mm_xor_si128( h, expMantissa );
+
+	// Scaling by 2^(127-15) rebiases the exponent and normalizes denormals in one multiply
+	const __m128 scaled = _mm_mul_ps( _mm_castsi128_ps( _mm_slli_epi32( expMantissa, 13 ) ), magic );
+	const __m128i wasInfNan = _mm_cmpgt_epi32( expMantissa, maxFinite );
+
+	const __m128 sign = _mm_castsi128_ps( _mm_slli_epi32( justSign, 16 ) );
+	const __m128 infNan = _mm_and_ps( _mm_castsi128_ps( wasInfNan ), infNanExp );
+
+	return _mm_or_ps( scaled, _mm_or_ps( sign, infNan ) );
+}
+
+
+static void PackFloat32SSE2( const float* src, uint16_t* dst, const size_t count )
+{
+	size_t i = 0;
+	for ( ; ( i + 8 ) <= count; i += 8 )
+	{
+		const __m128i lo = PackFloat32x4( _mm_loadu_ps( src + i ) );
+		const __m128i hi = PackFloat32x4( _mm_loadu_ps( src + i + 4 ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_packs_epi32( lo, hi ) );
+	}
+	for ( ; i < count; ++i ) {
+		dst[ i ] = PackFloat32( src[ i ] );
+	}
+}
+
+
+static void UnpackFloat32SSE2( const uint16_t* src, float* dst, const size_t count )
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	size_t i = 0;
+	for ( ; ( i + 8 ) <= count; i += 8 )
+	{
+		const __m128i h = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+		_mm_storeu_ps( dst + i, UnpackFloat32x4( _mm_unpacklo_epi16( h, zero ) ) );
+		_mm_storeu_ps( dst + i + 4, UnpackFloat32x4( _mm_unpackhi_epi16( h, zero ) ) );
+	}
+	for ( ; i < count; ++i ) {
+		dst[ i ] = UnpackFloat32( src[ i ] );
+	}
+}
+
+#endif
+
+
+void PackFloat32( const float* src, uint16_t* dst, const size_t count )
+{
+#if defined( GFX_SIMD_SSE )
+	if ( GetCpuFeatures().f16c ) {
+		PackFloat32F16C( src, dst, count );
+	} else {
+		PackFloat32SSE2( src, dst, count );
+	}
+#else
+	for ( size_t i = 0; i < count; ++i ) {
+		dst[ i ] = PackFloat32( src[ i ] );
+	}
+#endif
+}
+
+
+void UnpackFloat32( const uint16_t* src, float* dst, const size_t count )
+{
+#if defined( GFX_SIMD_SSE )
+	if ( GetCpuFeatures().f16c ) {
+		UnpackFloat32F16C( src, dst, count );
+	} else {
+		UnpackFloat32SSE2( src, dst, count );
+	}
+#else
+	for ( size_t i = 0; i < count; ++i ) {
+		dst[ i ] = UnpackFloat32( src[ i ] );
+	}
+#endif
+}
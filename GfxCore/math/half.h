@@ -0,0 +1,123 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+union packFp16_t
+{
+	struct fp16_t
+	{
+		uint16_t	mantissa	: 10;
+		uint16_t	exp			: 5;
+		uint16_t	sign		: 1;
+	} fp;
+	uint16_t    u;
+};
+
+union packFp32_t
+{
+	struct fp32_t
+	{
+		uint32_t	mantissa	: 23;
+		uint32_t	exp			: 8;
+		uint32_t	sign		: 1;
+	} fp;
+	uint32_t    u;
+	float       f;
+};
+
+
+// Round-to-nearest-even. Overflow goes to INF, NaNs stay quiet NaNs, results below FP16_MIN become denormals
+inline uint16_t PackFloat32( const float unpacked )
+{
+	static const uint32_t f32Infinity = 255 << 23;
+	static const uint32_t f16Max = ( 127 + 16 ) << 23;
+	static const uint32_t f16MinNormal = ( 127 - 14 ) << 23;
+
+	packFp32_t denormMagic;
+	denormMagic.u = ( ( 127 - 15 ) + ( 23 - 10 ) + 1 ) << 23;
+
+	packFp32_t full;
+	full.f = unpacked;
+
+	const uint32_t sign = full.u & 0x80000000u;
+	full.u ^= sign;
+
+	uint16_t half;
+	if ( full.u >= f16Max )
+	{
+		half = ( full.u > f32Infinity ) ? 0x7E00 : 0x7C00;
+	}
+	else if ( full.u < f16MinNormal )
+	{
+		// The FPU aligns the mantissa and rounds it for us
+		full.f += denormMagic.f;
+		half = static_cast<uint16_t>( full.u - denormMagic.u );
+	}
+	else
+	{
+		const uint32_t mantissaOdd = ( full.u >> 13 ) & 1;
+		full.u += ( static_cast<uint32_t>( 15 - 127 ) << 23 ) + 0xFFF;
+		full.u += mantissaOdd;
+		half = static_cast<uint16_t>( full.u >> 13 );
+	}
+
+	return static_cast<uint16_t>( half | ( sign >> 16 ) );
+}
+
+
+inline float UnpackFloat32( const uint16_t packed )
+{
+	static const uint32_t shiftedExp = 0x7C00 << 13;
+
+	packFp32_t denormMagic;
+	denormMagic.u = 113 << 23;
+
+	packFp32_t full;
+	full.u = ( packed & 0x7FFF ) << 13;
+
+	const uint32_t exp = shiftedExp & full.u;
+	full.u += ( 127 - 15 ) << 23;
+
+	if ( exp == shiftedExp )
+	{
+		full.u += ( 128 - 16 ) << 23; // INF/NaN
+	}
+	else if ( exp == 0 )
+	{
+		full.u += 1 << 23; // Zero/Denormal, renormalize
+		full.f -= denormMagic.f;
+	}
+
+	full.u |= static_cast<uint32_t>( packed & 0x8000 ) << 16;
+	return full.f;
+}
+
+
+// Bulk conversions, match the scalar versions above except for NaN payloads. Uses F16C if the CPU reports it
+void PackFloat32( const float* src, uint16_t* dst, const size_t count );
+void UnpackFloat32( const uint16_t* src, float* dst, const size_t count );
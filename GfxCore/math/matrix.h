@@ -36,16 +36,16 @@ class MatrixRow
 {
 private:
 
-	T row[ N ];
+	T row[ N ] = {};
 
 public:
 
-	inline T& operator[]( size_t i )
+	constexpr inline T& operator[]( size_t i )
 	{
 		return row[ i ];
 	}
 
-	inline const T& operator[]( size_t i ) const
+	constexpr inline const T& operator[]( size_t i ) const
 	{
 		return row[ i ];
 	}
@@ -63,7 +63,7 @@ public:
 	static const size_t Rows = N;
 	static const size_t Cols = M;
 
-	Matrix( T diagonalValue = static_cast<T>( 0.0 ) )
+	constexpr Matrix( T diagonalValue = static_cast<T>( 0.0 ) ) : data()
 	{
 		for ( size_t j = 0; j < N; ++j )
 		{
@@ -74,7 +74,7 @@ public:
 		}
 	}
 
-	Matrix( const T values[] )
+	constexpr Matrix( const T values[] ) : data()
 	{
 		for ( size_t j = 0; j < N; ++j )
 		{
@@ -85,14 +85,14 @@ public:
 		}
 	}
 
-	Matrix<N, M, T>	Transpose( void );
-	Matrix<N, M, T>	Transpose( void ) const;
-	bool IsInvertible() const;
+	constexpr Matrix<N, M, T> Transpose( void );
+	constexpr Matrix<N, M, T> Transpose( void ) const;
+	constexpr bool IsInvertible() const;
 	bool IsOrthonormal( const float epsilon ) const;
 	// Matrix<M, N, T>	Inverse(bool&);
 
-	MatrixRow<N, T>& operator[]( const size_t i );
-	const MatrixRow<N, T>& operator[]( const size_t i ) const;
+	constexpr MatrixRow<N, T>& operator[]( const size_t i );
+	constexpr const MatrixRow<N, T>& operator[]( const size_t i ) const;
 };
 
 template< size_t N, typename T>
@@ -132,11 +132,11 @@ public:
 };
 
 template< typename T>
-T Det( Matrix<2, 2, T> m );
+constexpr T Det( Matrix<2, 2, T> m );
 template< typename T>
-T Det( Matrix<3, 3, T> m );
+constexpr T Det( Matrix<3, 3, T> m );
 template< typename T>
-T Det( Matrix<4, 4, T> m );
+constexpr T Det( Matrix<4, 4, T> m );
 
 typedef Matrix<2, 2, double>	mat2x2d;
 typedef Matrix<2, 2, float>		mat2x2f;
@@ -147,9 +147,13 @@ typedef Matrix<3, 3, float>		mat3x3f;
 typedef Matrix<4, 4, double>	mat4x4d;
 typedef Matrix<4, 4, float>		mat4x4f;
 
+#if defined( GFX_SIMD_SSE )
+#include "matrixSimd.h"
+#endif
+
 
 template< size_t M, size_t N, typename T>
-Matrix<N, M, T> Matrix<M, N, T>::Transpose( void )
+constexpr Matrix<N, M, T> Matrix<M, N, T>::Transpose( void )
 {
 	Matrix<N, M, T> mt;
 	for ( size_t c = 0; c < N; ++c ) {
@@ -163,7 +167,7 @@ Matrix<N, M, T> Matrix<M, N, T>::Transpose( void )
 
 
 template< size_t M, size_t N, typename T>
-Matrix<N, M, T> Matrix<M, N, T>::Transpose( void ) const
+constexpr Matrix<N, M, T> Matrix<M, N, T>::Transpose( void ) const
 {
 	Matrix<N, M, T> mt;
 	for ( size_t c = 0; c < N; ++c )
@@ -178,7 +182,7 @@ Matrix<N, M, T> Matrix<M, N, T>::Transpose( void ) const
 
 
 template< size_t M, size_t N, typename T>
-bool Matrix<M, N, T>::IsInvertible() const
+constexpr bool Matrix<M, N, T>::IsInvertible() const
 {
 	return ( Det( *this ) != 0 );
 }
@@ -209,21 +213,21 @@ bool Matrix<M, N, T>::IsOrthonormal( const float epsilon ) const
 
 
 template< size_t M, size_t N, typename T>
-MatrixRow<N, T>& Matrix<M, N, T>::operator[]( const size_t i )
+constexpr MatrixRow<N, T>& Matrix<M, N, T>::operator[]( const size_t i )
 {
 	return data[ i ];
 }
 
 
 template< size_t M, size_t N, typename T>
-const MatrixRow<N, T>& Matrix<M, N, T>::operator[]( const size_t i ) const
+constexpr const MatrixRow<N, T>& Matrix<M, N, T>::operator[]( const size_t i ) const
 {
 	return data[ i ];
 }
 
 
 template< size_t M, size_t N, typename T>
-Matrix<M, N, T> operator+( const Matrix<M, N, T>& m1, const Matrix<M, N, T>& m2 )
+constexpr Matrix<M, N, T> operator+( const Matrix<M, N, T>& m1, const Matrix<M, N, T>& m2 )
 {
 	Matrix<M, N, T> m3;
 	for ( size_t c( 0 ); c < N; ++c )
@@ -238,7 +242,7 @@ Matrix<M, N, T> operator+( const Matrix<M, N, T>& m1, const Matrix<M, N, T>& m2
 
 
 template< size_t M, size_t N, typename T>
-Matrix<M, N, T> operator-( const Matrix<M, N, T>& m1, const Matrix<M, N, T>& m2 )
+constexpr Matrix<M, N, T> operator-( const Matrix<M, N, T>& m1, const Matrix<M, N, T>& m2 )
 {
 	Matrix<M, N, T> m3;
 	for ( size_t c( 0 ); c < N; ++c )
@@ -253,7 +257,7 @@ Matrix<M, N, T> operator-( const Matrix<M, N, T>& m1, const Matrix<M, N, T>& m2
 
 
 template< size_t M, size_t N, typename T>
-Matrix<M, N, T> operator/( const Matrix<M, N, T>& m, T s )
+constexpr Matrix<M, N, T> operator/( const Matrix<M, N, T>& m, T s )
 {
 	Matrix<M, N, T> md;
 	for ( size_t c = 0; c < M; ++c )
@@ -268,7 +272,7 @@ Matrix<M, N, T> operator/( const Matrix<M, N, T>& m, T s )
 
 
 template< size_t M1, size_t N1, size_t N2, typename T>
-Matrix<M1, N2, T> operator*( const Matrix<M1, N1, T>& m1, const Matrix<N1, N2, T>& m2 )
+constexpr Matrix<M1, N2, T> operator*( const Matrix<M1, N1, T>& m1, const Matrix<N1, N2, T>& m2 )
 {
 	Matrix<M1, N2, T> m3;
 	for ( size_t r = 0; r < M1; ++r )
@@ -286,7 +290,7 @@ Matrix<M1, N2, T> operator*( const Matrix<M1, N1, T>& m1, const Matrix<N1, N2, T
 
 
 template< size_t M, size_t N, typename T>
-Matrix<M, N, T> operator*( const Matrix<M, N, T>& m, T s )
+constexpr Matrix<M, N, T> operator*( const Matrix<M, N, T>& m, T s )
 {
 	Matrix<M, N, T> md;
 	for ( size_t c = 0; c < N; ++c ) {
@@ -299,14 +303,14 @@ Matrix<M, N, T> operator*( const Matrix<M, N, T>& m, T s )
 
 
 template< size_t M, size_t N, typename T>
-Matrix<M, N, T> operator*( T s, const Matrix<M, N, T>& m )
+constexpr Matrix<M, N, T> operator*( T s, const Matrix<M, N, T>& m )
 {
 	return m * s;
 }
 
 
 template< size_t M, size_t N, typename T>
-Vector<N, T> operator*( const Vector<N, T>& u, const Matrix<M, N, T>& m )
+constexpr Vector<N, T> operator*( const Vector<N, T>& u, const Matrix<M, N, T>& m )
 {
 	Vector< N, T > v;
 	for ( size_t c = 0; c < N; ++c )
@@ -321,7 +325,7 @@ Vector<N, T> operator*( const Vector<N, T>& u, const Matrix<M, N, T>& m )
 
 
 template< size_t M, size_t N, typename T>
-Vector<N, T> operator*( const Matrix<M, N, T>& m, const Vector<M, T>& u )
+constexpr Vector<N, T> operator*( const Matrix<M, N, T>& m, const Vector<M, T>& u )
 {
 	Vector< N, T > v;
 	for ( size_t r = 0; r < M; ++r )
@@ -336,14 +340,14 @@ Vector<N, T> operator*( const Matrix<M, N, T>& m, const Vector<M, T>& u )
 
 
 template< typename T>
-T Det( Matrix<2, 2, T> m )
+constexpr T Det( Matrix<2, 2, T> m )
 {
 	return m[ 0 ][ 0 ] * m[ 1 ][ 1 ] - m[ 1 ][ 0 ] * m[ 0 ][ 1 ];
 }
 
 
 template< typename T>
-T Det( Matrix<3, 3, T> m )
+constexpr T Det( Matrix<3, 3, T> m )
 {
 	T cof00[] = { m[ 1 ][ 1 ], m[ 1 ][ 2 ], m[ 2 ][ 1 ], m[ 2 ][ 2 ] };
 	T cof01[] = { m[ 1 ][ 0 ], m[ 1 ][ 2 ], m[ 2 ][ 0 ], m[ 2 ][ 2 ] };
@@ -354,7 +358,7 @@ T Det( Matrix<3, 3, T> m )
 
 
 template< typename T>
-T Det( Matrix<4, 4, T> m )
+constexpr T Det( Matrix<4, 4, T> m )
 {
 	T cof00[] = { m[ 1 ][ 1 ], m[ 1 ][ 2 ], m[ 1 ][ 3 ],  m[ 2 ][ 1 ], m[ 2 ][ 2 ], m[ 2 ][ 3 ],  m[ 3 ][ 1 ], m[ 3 ][ 2 ], m[ 3 ][ 3 ] };
 	T cof01[] = { m[ 1 ][ 0 ], m[ 1 ][ 2 ], m[ 1 ][ 3 ],  m[ 2 ][ 0 ], m[ 2 ][ 2 ], m[ 2 ][ 3 ],  m[ 3 ][ 0 ], m[ 3 ][ 2 ], m[ 3 ][ 3 ] };
@@ -427,7 +431,7 @@ Matrix<4, 4, T> Inverse( const Matrix<4, 4, T>& m, bool& invertible )
 }
 
 template< size_t M, size_t N, typename T>
-T Convolution( const Matrix<M, N, T>& m1, const Matrix<M, N, T>& m2 )
+constexpr T Convolution( const Matrix<M, N, T>& m1, const Matrix<M, N, T>& m2 )
 {
 	T sum = 0;
 	for ( size_t r = 0; r < M; ++r )
@@ -442,7 +446,7 @@ T Convolution( const Matrix<M, N, T>& m1, const Matrix<M, N, T>& m2 )
 
 
 template< size_t M, size_t N, typename T>
-Matrix<M, N, T> Identity()
+constexpr Matrix<M, N, T> Identity()
 {
 	return Matrix<M, N, T>( static_cast<T>( 1.0 ) );
 }
@@ -463,7 +467,7 @@ std::ostream& operator<<( std::ostream& stream, const Matrix<M, N, T>& m )
 }
 
 template< typename T >
-Matrix<2, 2, T> CreateMatrix2x2(	T m00, T m01,
+constexpr Matrix<2, 2, T> CreateMatrix2x2(	T m00, T m01,
 									T m10, T m11 )
 {
 	Matrix<2, 2, T> m;
@@ -478,7 +482,7 @@ Matrix<2, 2, T> CreateMatrix2x2(	T m00, T m01,
 }
 
 template< typename T >
-Matrix<3, 3, T> CreateMatrix3x3(	T m00, T m01, T m02,
+constexpr Matrix<3, 3, T> CreateMatrix3x3(	T m00, T m01, T m02,
 									T m10, T m11, T m12,
 									T m20, T m21, T m22 )
 {
@@ -501,7 +505,7 @@ Matrix<3, 3, T> CreateMatrix3x3(	T m00, T m01, T m02,
 
 
 template< typename T >
-Matrix<3, 3, T> CreateMatrix3x3( const Vector<3, T>& X, const Vector<3, T>& Y, const Vector<3, T>& Z )
+constexpr Matrix<3, 3, T> CreateMatrix3x3( const Vector<3, T>& X, const Vector<3, T>& Y, const Vector<3, T>& Z )
 {
 	Matrix<3, 3, T> m;
 
@@ -522,7 +526,7 @@ Matrix<3, 3, T> CreateMatrix3x3( const Vector<3, T>& X, const Vector<3, T>& Y, c
 
 
 template< typename T >
-Matrix<4, 4, T> CreateMatrix4x4( const Vector<4, T>& X, const Vector<4, T>& Y, const Vector<4, T>& Z, const Vector<4, T>& W )
+constexpr Matrix<4, 4, T> CreateMatrix4x4( const Vector<4, T>& X, const Vector<4, T>& Y, const Vector<4, T>& Z, const Vector<4, T>& W )
 {
 	Matrix<4, 4, T> m;
 
@@ -551,7 +555,7 @@ Matrix<4, 4, T> CreateMatrix4x4( const Vector<4, T>& X, const Vector<4, T>& Y, c
 
 
 template< typename T >
-Matrix<4, 4, T> CreateMatrix4x4(	T m00, T m01, T m02, T m03,
+constexpr Matrix<4, 4, T> CreateMatrix4x4(	T m00, T m01, T m02, T m03,
 									T m10, T m11, T m12, T m13,
 									T m20, T m21, T m22, T m23,
 									T m30, T m31, T m32, T m33 )
@@ -0,0 +1,418 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2013-2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+// Included by matrix.h, do not include directly.
+// SSE specialization of Matrix<4, 4, float>. Rows are packed floats read with unaligned loads, so matrices
+// inside any struct or container stay valid; alignas only keeps a matrix from straddling cache lines.
+// GFX_CONSTEXPR functions take a scalar branch during constant evaluation, the Simd* helpers are runtime-only.
+
+template <>
+class alignas( 16 ) Matrix<4, 4, float>
+{
+private:
+	MatrixRow<4, float> data[ 4 ];
+	static constexpr float epsilon = std::numeric_limits< float >::epsilon() * 2.0f;
+
+public:
+
+	static const size_t Rows = 4;
+	static const size_t Cols = 4;
+
+	constexpr Matrix( float diagonalValue = 0.0f ) : data()
+	{
+		for ( size_t r = 0; r < 4; ++r ) {
+			data[ r ][ r ] = diagonalValue;
+		}
+	}
+
+	constexpr Matrix( const float values[] ) : data()
+	{
+		for ( size_t r = 0; r < 4; ++r )
+		{
+			for ( size_t c = 0; c < 4; ++c ) {
+				data[ r ][ c ] = values[ 4 * r + c ];
+			}
+		}
+	}
+
+	Matrix( const __m128 r0, const __m128 r1, const __m128 r2, const __m128 r3 )
+	{
+		StoreRow( 0, r0 );
+		StoreRow( 1, r1 );
+		StoreRow( 2, r2 );
+		StoreRow( 3, r3 );
+	}
+
+	inline __m128 LoadRow( const size_t r ) const
+	{
+		return _mm_loadu_ps( &data[ r ][ 0 ] );
+	}
+
+	inline void StoreRow( const size_t r, const __m128 v )
+	{
+		_mm_storeu_ps( &data[ r ][ 0 ], v );
+	}
+
+	GFX_CONSTEXPR Matrix<4, 4, float> Transpose( void );
+	GFX_CONSTEXPR Matrix<4, 4, float> Transpose( void ) const;
+	GFX_CONSTEXPR bool IsInvertible() const;
+	bool IsOrthonormal( const float epsilon ) const;
+
+	constexpr inline MatrixRow<4, float>& operator[]( const size_t i )
+	{
+		assert( i < 4 );
+		return data[ i ];
+	}
+
+	constexpr inline const MatrixRow<4, float>& operator[]( const size_t i ) const
+	{
+		assert( i < 4 );
+		return data[ i ];
+	}
+};
+
+
+inline mat4x4f SimdTranspose( const mat4x4f& m )
+{
+	__m128 r0 = m.LoadRow( 0 );
+	__m128 r1 = m.LoadRow( 1 );
+	__m128 r2 = m.LoadRow( 2 );
+	__m128 r3 = m.LoadRow( 3 );
+	_MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+	return mat4x4f( r0, r1, r2, r3 );
+}
+
+
+// Each result row is a linear combination of m2's rows
+inline mat4x4f SimdMultiply( const mat4x4f& m1, const mat4x4f& m2 )
+{
+#if defined( GFX_SIMD_AVX )
+	// Two result rows per 256-bit register, the in-lane shuffle splats each row's own coefficient
+	const __m256 b0 = _mm256_broadcast_ps( reinterpret_cast<const __m128*>( &m2[ 0 ][ 0 ] ) );
+	const __m256 b1 = _mm256_broadcast_ps( reinterpret_cast<const __m128*>( &m2[ 1 ][ 0 ] ) );
+	const __m256 b2 = _mm256_broadcast_ps( reinterpret_cast<const __m128*>( &m2[ 2 ][ 0 ] ) );
+	const __m256 b3 = _mm256_broadcast_ps( reinterpret_cast<const __m128*>( &m2[ 3 ][ 0 ] ) );
+
+	__m256 rows[ 2 ];
+	for ( size_t i = 0; i < 2; ++i )
+	{
+		const __m256 a = _mm256_loadu_ps( &m1[ 2 * i ][ 0 ] );
+		__m256 acc = _mm256_mul_ps( _mm256_shuffle_ps( a, a, _MM_SHUFFLE( 0, 0, 0, 0 ) ), b0 );
+#if defined( GFX_SIMD_FMA )
+		acc = _mm256_fmadd_ps( _mm256_shuffle_ps( a, a, _MM_SHUFFLE( 1, 1, 1, 1 ) ), b1, acc );
+		acc = _mm256_fmadd_ps( _mm256_shuffle_ps( a, a, _MM_SHUFFLE( 2, 2, 2, 2 ) ), b2, acc );
+		acc = _mm256_fmadd_ps( _mm256_shuffle_ps( a, a, _MM_SHUFFLE( 3, 3, 3, 3 ) ), b3, acc );
+#else
+		acc = _mm256_add_ps( acc, _mm256_mul_ps( _mm256_shuffle_ps( a, a, _MM_SHUFFLE( 1, 1, 1, 1 ) ), b1 ) );
+		acc = _mm256_add_ps( acc, _mm256_mul_ps( _mm256_shuffle_ps( a, a, _MM_SHUFFLE( 2, 2, 2, 2 ) ), b2 ) );
+		acc = _mm256_add_ps( acc, _mm256_mul_ps( _mm256_shuffle_ps( a, a, _MM_SHUFFLE( 3, 3, 3, 3 ) ), b3 ) );
+#endif
+		rows[ i ] = acc;
+	}
+
+	return mat4x4f(	_mm256_castps256_ps128( rows[ 0 ] ), _mm256_extractf128_ps( rows[ 0 ], 1 ),
+					_mm256_castps256_ps128( rows[ 1 ] ), _mm256_extractf128_ps( rows[ 1 ], 1 ) );
+#else
+	const __m128 b0 = m2.LoadRow( 0 );
+	const __m128 b1 = m2.LoadRow( 1 );
+	const __m128 b2 = m2.LoadRow( 2 );
+	const __m128 b3 = m2.LoadRow( 3 );
+
+	__m128 rows[ 4 ];
+	for ( size_t r = 0; r < 4; ++r )
+	{
+		const __m128 a = m1.LoadRow( r );
+		__m128 acc = _mm_mul_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE( 0, 0, 0, 0 ) ), b0 );
+		acc = SimdMadd( _mm_shuffle_ps( a, a, _MM_SHUFFLE( 1, 1, 1, 1 ) ), b1, acc );
+		acc = SimdMadd( _mm_shuffle_ps( a, a, _MM_SHUFFLE( 2, 2, 2, 2 ) ), b2, acc );
+		acc = SimdMadd( _mm_shuffle_ps( a, a, _MM_SHUFFLE( 3, 3, 3, 3 ) ), b3, acc );
+		rows[ r ] = acc;
+	}
+	return mat4x4f( rows[ 0 ], rows[ 1 ], rows[ 2 ], rows[ 3 ] );
+#endif
+}
+
+
+inline vec4f SimdMultiply( const vec4f& u, const mat4x4f& m )
+{
+	const __m128 v = u.Load();
+	__m128 acc = _mm_mul_ps( _mm_shuffle_ps( v, v, _MM_SHUFFLE( 0, 0, 0, 0 ) ), m.LoadRow( 0 ) );
+	acc = SimdMadd( _mm_shuffle_ps( v, v, _MM_SHUFFLE( 1, 1, 1, 1 ) ), m.LoadRow( 1 ), acc );
+	acc = SimdMadd( _mm_shuffle_ps( v, v, _MM_SHUFFLE( 2, 2, 2, 2 ) ), m.LoadRow( 2 ), acc );
+	acc = SimdMadd( _mm_shuffle_ps( v, v, _MM_SHUFFLE( 3, 3, 3, 3 ) ), m.LoadRow( 3 ), acc );
+	return vec4f( acc );
+}
+
+
+// Row dot products; transposing the products keeps the scalar summation order per component
+inline vec4f SimdMultiply( const mat4x4f& m, const vec4f& u )
+{
+	const __m128 v = u.Load();
+	__m128 p0 = _mm_mul_ps( m.LoadRow( 0 ), v );
+	__m128 p1 = _mm_mul_ps( m.LoadRow( 1 ), v );
+	__m128 p2 = _mm_mul_ps( m.LoadRow( 2 ), v );
+	__m128 p3 = _mm_mul_ps( m.LoadRow( 3 ), v );
+	_MM_TRANSPOSE4_PS( p0, p1, p2, p3 );
+	return vec4f( _mm_add_ps( _mm_add_ps( _mm_add_ps( p0, p1 ), p2 ), p3 ) );
+}
+
+
+// Expansion by the 2x2 minors of rows 0-1 and rows 2-3
+inline float SimdDet( const mat4x4f& m )
+{
+	const __m128 a = m.LoadRow( 0 );
+	const __m128 b = m.LoadRow( 1 );
+	const __m128 c = m.LoadRow( 2 );
+	const __m128 d = m.LoadRow( 3 );
+
+	// s = { a0b1 - a1b0, a0b2 - a2b0, a0b3 - a3b0, a1b2 - a2b1 }, { a1b3 - a3b1, a2b3 - a3b2 }
+	const __m128 sLo = _mm_sub_ps(	_mm_mul_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE( 1, 0, 0, 0 ) ), _mm_shuffle_ps( b, b, _MM_SHUFFLE( 2, 3, 2, 1 ) ) ),
+									_mm_mul_ps( _mm_shuffle_ps( b, b, _MM_SHUFFLE( 1, 0, 0, 0 ) ), _mm_shuffle_ps( a, a, _MM_SHUFFLE( 2, 3, 2, 1 ) ) ) );
+	const __m128 sHi = _mm_sub_ps(	_mm_mul_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE( 0, 0, 2, 1 ) ), _mm_shuffle_ps( b, b, _MM_SHUFFLE( 0, 0, 3, 3 ) ) ),
+									_mm_mul_ps( _mm_shuffle_ps( b, b, _MM_SHUFFLE( 0, 0, 2, 1 ) ), _mm_shuffle_ps( a, a, _MM_SHUFFLE( 0, 0, 3, 3 ) ) ) );
+
+	// Complementary minors of rows 2-3 in matching order
+	const __m128 cLo = _mm_sub_ps(	_mm_mul_ps( _mm_shuffle_ps( c, c, _MM_SHUFFLE( 0, 1, 1, 2 ) ), _mm_shuffle_ps( d, d, _MM_SHUFFLE( 3, 2, 3, 3 ) ) ),
+									_mm_mul_ps( _mm_shuffle_ps( d, d, _MM_SHUFFLE( 0, 1, 1, 2 ) ), _mm_shuffle_ps( c, c, _MM_SHUFFLE( 3, 2, 3, 3 ) ) ) );
+	const __m128 cHi = _mm_sub_ps(	_mm_mul_ps( _mm_shuffle_ps( c, c, _MM_SHUFFLE( 0, 0, 0, 0 ) ), _mm_shuffle_ps( d, d, _MM_SHUFFLE( 0, 0, 1, 2 ) ) ),
+									_mm_mul_ps( _mm_shuffle_ps( d, d, _MM_SHUFFLE( 0, 0, 0, 0 ) ), _mm_shuffle_ps( c, c, _MM_SHUFFLE( 0, 0, 1, 2 ) ) ) );
+
+	const __m128 signLo = _mm_setr_ps( 1.0f, -1.0f, 1.0f, 1.0f );
+	const __m128 signHi = _mm_setr_ps( -1.0f, 1.0f, 0.0f, 0.0f );
+	const __m128 terms = _mm_add_ps( _mm_mul_ps( _mm_mul_ps( sLo, cLo ), signLo ), _mm_mul_ps( _mm_mul_ps( sHi, cHi ), signHi ) );
+	return SimdHorizontalSum( terms );
+}
+
+
+GFX_CONSTEXPR inline mat4x4f Matrix<4, 4, float>::Transpose( void )
+{
+	return static_cast<const Matrix<4, 4, float>&>( *this ).Transpose();
+}
+
+
+GFX_CONSTEXPR inline mat4x4f Matrix<4, 4, float>::Transpose( void ) const
+{
+	if ( IsConstantEvaluated() )
+	{
+		mat4x4f mt;
+		for ( size_t r = 0; r < 4; ++r )
+		{
+			for ( size_t c = 0; c < 4; ++c ) {
+				mt[ c ][ r ] = data[ r ][ c ];
+			}
+		}
+		return mt;
+	}
+	return SimdTranspose( *this );
+}
+
+
+// Non-template overloads win over the generic templates in matrix.h
+GFX_CONSTEXPR inline mat4x4f operator+( const mat4x4f& m1, const mat4x4f& m2 )
+{
+	if ( IsConstantEvaluated() )
+	{
+		mat4x4f m3;
+		for ( size_t r = 0; r < 4; ++r )
+		{
+			for ( size_t c = 0; c < 4; ++c ) {
+				m3[ r ][ c ] = m1[ r ][ c ] + m2[ r ][ c ];
+			}
+		}
+		return m3;
+	}
+	return mat4x4f(	_mm_add_ps( m1.LoadRow( 0 ), m2.LoadRow( 0 ) ),
+					_mm_add_ps( m1.LoadRow( 1 ), m2.LoadRow( 1 ) ),
+					_mm_add_ps( m1.LoadRow( 2 ), m2.LoadRow( 2 ) ),
+					_mm_add_ps( m1.LoadRow( 3 ), m2.LoadRow( 3 ) ) );
+}
+
+
+GFX_CONSTEXPR inline mat4x4f operator-( const mat4x4f& m1, const mat4x4f& m2 )
+{
+	if ( IsConstantEvaluated() )
+	{
+		mat4x4f m3;
+		for ( size_t r = 0; r < 4; ++r )
+		{
+			for ( size_t c = 0; c < 4; ++c ) {
+				m3[ r ][ c ] = m1[ r ][ c ] - m2[ r ][ c ];
+			}
+		}
+		return m3;
+	}
+	return mat4x4f(	_mm_sub_ps( m1.LoadRow( 0 ), m2.LoadRow( 0 ) ),
+					_mm_sub_ps( m1.LoadRow( 1 ), m2.LoadRow( 1 ) ),
+					_mm_sub_ps( m1.LoadRow( 2 ), m2.LoadRow( 2 ) ),
+					_mm_sub_ps( m1.LoadRow( 3 ), m2.LoadRow( 3 ) ) );
+}
+
+
+GFX_CONSTEXPR inline mat4x4f operator*( const mat4x4f& m, float s )
+{
+	if ( IsConstantEvaluated() )
+	{
+		mat4x4f md;
+		for ( size_t r = 0; r < 4; ++r )
+		{
+			for ( size_t c = 0; c < 4; ++c ) {
+				md[ r ][ c ] = m[ r ][ c ] * s;
+			}
+		}
+		return md;
+	}
+	return mat4x4f(	_mm_mul_ps( m.LoadRow( 0 ), _mm_set1_ps( s ) ),
+					_mm_mul_ps( m.LoadRow( 1 ), _mm_set1_ps( s ) ),
+					_mm_mul_ps( m.LoadRow( 2 ), _mm_set1_ps( s ) ),
+					_mm_mul_ps( m.LoadRow( 3 ), _mm_set1_ps( s ) ) );
+}
+
+
+GFX_CONSTEXPR inline mat4x4f operator*( float s, const mat4x4f& m )
+{
+	return m * s;
+}
+
+
+GFX_CONSTEXPR inline mat4x4f operator/( const mat4x4f& m, float s )
+{
+	if ( IsConstantEvaluated() )
+	{
+		mat4x4f md;
+		for ( size_t r = 0; r < 4; ++r )
+		{
+			for ( size_t c = 0; c < 4; ++c ) {
+				md[ r ][ c ] = m[ r ][ c ] / s;
+			}
+		}
+		return md;
+	}
+	return mat4x4f(	_mm_div_ps( m.LoadRow( 0 ), _mm_set1_ps( s ) ),
+					_mm_div_ps( m.LoadRow( 1 ), _mm_set1_ps( s ) ),
+					_mm_div_ps( m.LoadRow( 2 ), _mm_set1_ps( s ) ),
+					_mm_div_ps( m.LoadRow( 3 ), _mm_set1_ps( s ) ) );
+}
+
+
+GFX_CONSTEXPR inline mat4x4f operator*( const mat4x4f& m1, const mat4x4f& m2 )
+{
+	if ( IsConstantEvaluated() )
+	{
+		mat4x4f m3;
+		for ( size_t r = 0; r < 4; ++r )
+		{
+			for ( size_t c = 0; c < 4; ++c )
+			{
+				for ( size_t a = 0; a < 4; ++a ) {
+					m3[ r ][ c ] += m1[ r ][ a ] * m2[ a ][ c ];
+				}
+			}
+		}
+		return m3;
+	}
+	return SimdMultiply( m1, m2 );
+}
+
+
+GFX_CONSTEXPR inline vec4f operator*( const vec4f& u, const mat4x4f& m )
+{
+	if ( IsConstantEvaluated() )
+	{
+		vec4f v;
+		for ( size_t c = 0; c < 4; ++c )
+		{
+			for ( size_t r = 0; r < 4; ++r ) {
+				v[ c ] += u[ r ] * m[ r ][ c ];
+			}
+		}
+		return v;
+	}
+	return SimdMultiply( u, m );
+}
+
+
+GFX_CONSTEXPR inline vec4f operator*( const mat4x4f& m, const vec4f& u )
+{
+	if ( IsConstantEvaluated() )
+	{
+		vec4f v;
+		for ( size_t r = 0; r < 4; ++r )
+		{
+			for ( size_t c = 0; c < 4; ++c ) {
+				v[ r ] += m[ r ][ c ] * u[ c ];
+			}
+		}
+		return v;
+	}
+	return SimdMultiply( m, u );
+}
+
+
+GFX_CONSTEXPR inline float Det( const mat4x4f& m )
+{
+	if ( IsConstantEvaluated() )
+	{
+		const float s0 = m[ 0 ][ 0 ] * m[ 1 ][ 1 ] - m[ 1 ][ 0 ] * m[ 0 ][ 1 ];
+		const float s1 = m[ 0 ][ 0 ] * m[ 1 ][ 2 ] - m[ 1 ][ 0 ] * m[ 0 ][ 2 ];
+		const float s2 = m[ 0 ][ 0 ] * m[ 1 ][ 3 ] - m[ 1 ][ 0 ] * m[ 0 ][ 3 ];
+		const float s3 = m[ 0 ][ 1 ] * m[ 1 ][ 2 ] - m[ 1 ][ 1 ] * m[ 0 ][ 2 ];
+		const float s4 = m[ 0 ][ 1 ] * m[ 1 ][ 3 ] - m[ 1 ][ 1 ] * m[ 0 ][ 3 ];
+		const float s5 = m[ 0 ][ 2 ] * m[ 1 ][ 3 ] - m[ 1 ][ 2 ] * m[ 0 ][ 3 ];
+
+		const float c5 = m[ 2 ][ 2 ] * m[ 3 ][ 3 ] - m[ 3 ][ 2 ] * m[ 2 ][ 3 ];
+		const float c4 = m[ 2 ][ 1 ] * m[ 3 ][ 3 ] - m[ 3 ][ 1 ] * m[ 2 ][ 3 ];
+		const float c3 = m[ 2 ][ 1 ] * m[ 3 ][ 2 ] - m[ 3 ][ 1 ] * m[ 2 ][ 2 ];
+		const float c2 = m[ 2 ][ 0 ] * m[ 3 ][ 3 ] - m[ 3 ][ 0 ] * m[ 2 ][ 3 ];
+		const float c1 = m[ 2 ][ 0 ] * m[ 3 ][ 2 ] - m[ 3 ][ 0 ] * m[ 2 ][ 2 ];
+		const float c0 = m[ 2 ][ 0 ] * m[ 3 ][ 1 ] - m[ 3 ][ 0 ] * m[ 2 ][ 1 ];
+
+		return ( ( s0 * c5 - s4 * c1 ) + s2 * c3 ) + ( ( s5 * c0 - s1 * c4 ) + s3 * c2 );
+	}
+	return SimdDet( m );
+}
+
+
+GFX_CONSTEXPR inline bool Matrix<4, 4, float>::IsInvertible() const
+{
+	return ( Det( *this ) != 0 );
+}
+
+
+inline bool Matrix<4, 4, float>::IsOrthonormal( const float epsilon ) const
+{
+	const mat4x4f m = ( *this ) * Transpose();
+	const mat4x4f identity( 1.0f );
+	const __m128 tolerance = _mm_set1_ps( epsilon );
+	const __m128 signMask = _mm_set1_ps( -0.0f );
+	for ( size_t r = 0; r < 4; ++r )
+	{
+		const __m128 error = _mm_andnot_ps( signMask, _mm_sub_ps( m.LoadRow( r ), identity.LoadRow( r ) ) );
+		if ( _mm_movemask_ps( _mm_cmpgt_ps( error, tolerance ) ) != 0 ) {
+			return false;
+		}
+	}
+	return true;
+}
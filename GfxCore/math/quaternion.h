@@ -26,23 +26,23 @@
 #include <cmath>
 #include <ostream>
 #include "vector.h"
+#include "matrix.h"
+#include "../core/common.h"
 
 
 template <typename T>
 class Quaternion
 {
-private:
-	static const T PI = static_cast<T>( 3.14159265358979323846 );
 public:
 	T x, y, z, w;
 
 	using vec3 = Vector<3, T>;
 
-	Quaternion( T theta, vec3& axis )
+	Quaternion( T theta, const vec3& axis )
 	{	
-		T phi = theta * ( T(PI) / T(180.0) );
+		T phi = Radians( theta );
 
-		vec3 ax = axis.normalize();
+		vec3 ax = axis.Normalize();
 
 		x = ax[0] * sin( phi / T(2.0) );
 		y = ax[1] * sin( phi / T(2.0) );
@@ -67,12 +67,20 @@ public:
 
 	Quaternion(): x( T(0.0) ), y( T(0.0) ), z( T(0.0) ), w( T(0.0) ) {}
 
+	static Quaternion<T> Identity()
+	{
+		return Quaternion<T>( T(1.0), T(0.0), T(0.0), T(0.0) );
+	}
+
 	T				Length() const;
 	Quaternion<T>	Normalize() const;
-	Quaternion<T>	Conjugate();
-	Quaternion<T>	operator-();
+	Quaternion<T>	Conjugate() const;
+	Quaternion<T>	operator-() const;
+	Matrix<4, 4, T>	ToMatrix() const;
 };
 
+using quatf = Quaternion<float>;
+
 
 template <typename T>
 T Quaternion<T>::Length() const
@@ -84,7 +92,7 @@ T Quaternion<T>::Length() const
 template <typename T>
 Quaternion<T> Quaternion<T>::Normalize() const
 {   
-	T L = length();   
+	T L = Length();   
 
 	Quaternion<T> q = *this;
 	q.x /= L;   
@@ -96,7 +104,7 @@ Quaternion<T> Quaternion<T>::Normalize() const
 
 
 template <typename T>
-Quaternion<T> Quaternion<T>::Conjugate()
+Quaternion<T> Quaternion<T>::Conjugate() const
 {
 	Quaternion<T> q = *this;
 	q.x = -x;   
@@ -106,6 +114,65 @@ Quaternion<T> Quaternion<T>::Conjugate()
 }
 
 
+// Rotation matrix for a unit quaternion, column vector convention like ComputeRotationZYX()
+template <typename T>
+Matrix<4, 4, T> Quaternion<T>::ToMatrix() const
+{
+	const T xx = x * x;
+	const T yy = y * y;
+	const T zz = z * z;
+	const T xy = x * y;
+	const T xz = x * z;
+	const T yz = y * z;
+	const T wx = w * x;
+	const T wy = w * y;
+	const T wz = w * z;
+	const T one = T(1.0);
+	const T two = T(2.0);
+
+	Matrix<4, 4, T> m( one );
+	m[0][0] = one - two * ( yy + zz );
+	m[0][1] = two * ( xy - wz );
+	m[0][2] = two * ( xz + wy );
+	m[1][0] = two * ( xy + wz );
+	m[1][1] = one - two * ( xx + zz );
+	m[1][2] = two * ( yz - wx );
+	m[2][0] = two * ( xz - wy );
+	m[2][1] = two * ( yz + wx );
+	m[2][2] = one - two * ( xx + yy );
+	return m;
+}
+
+
+// Same rotation as ComputeRotationZYX(), Rz * Ry * Rx
+template <typename T>
+Quaternion<T> ComputeQuaternionZYX( const T xDegrees, const T yDegrees, const T zDegrees )
+{
+	const T halfAlpha = T(0.5) * Radians( xDegrees );
+	const T halfBeta = T(0.5) * Radians( yDegrees );
+	const T halfGamma = T(0.5) * Radians( zDegrees );
+
+	const T cx = cos( halfAlpha );
+	const T cy = cos( halfBeta );
+	const T cz = cos( halfGamma );
+	const T sx = sin( halfAlpha );
+	const T sy = sin( halfBeta );
+	const T sz = sin( halfGamma );
+
+	return Quaternion<T>(	cx * cy * cz + sx * sy * sz,
+							sx * cy * cz - cx * sy * sz,
+							cx * sy * cz + sx * cy * sz,
+							cx * cy * sz - sx * sy * cz );
+}
+
+
+template <typename T>
+T Dot( const Quaternion<T>& A, const Quaternion<T>& B )
+{
+	return ( A.w * B.w + A.x * B.x + A.y * B.y + A.z * B.z );
+}
+
+
 template <typename T>
 Quaternion<T> Mult( const Quaternion<T>& A, const Quaternion<T>& B )
 {
@@ -140,7 +207,7 @@ Quaternion<T> operator+( const Quaternion<T>& A, const Quaternion<T>& B )
 
 
 template <typename T>
-Quaternion<T> Quaternion<T>::operator-()
+Quaternion<T> Quaternion<T>::operator-() const
 {
 	return Quaternion<T>( -w, -x, -y, -z );
 }
@@ -151,7 +218,7 @@ void Rotate( const Quaternion<T>& Q, Vector<3, T>& P)
 {
 	Quaternion<T> V( P );
 
-	V = Mult( Mult( Q, V ), Q.conjugate() );
+	V = Mult( Mult( Q, V ), Q.Conjugate() );
 
 	P[0] = V.x;
 	P[1] = V.y;
@@ -165,7 +232,7 @@ void Rotate( const T theta, const Vector<3, T>& axis, Vector<3, T>& P )
 	Quaternion<T> V( P );
 	Quaternion<T> R( theta, axis );
 
-	V = R * V * R.conjugate();
+	V = R * V * R.Conjugate();
 
 	P[0] = V.x;
 	P[1] = V.y;
@@ -173,13 +240,22 @@ void Rotate( const T theta, const Vector<3, T>& axis, Vector<3, T>& P )
 }
 
 
+// Normalized lerp along the shorter arc. Not constant speed, but close to Slerp() for nearby keys.
+template <typename T>
+Quaternion<T> Nlerp( const Quaternion<T>& quat1, const Quaternion<T>& quat2, const T t )
+{
+	const T sign = ( Dot( quat1, quat2 ) < T(0.0) ) ? T(-1.0) : T(1.0);
+	return ( ( T(1.0) - t ) * quat1 + ( sign * t ) * quat2 ).Normalize();
+}
+
+
 template <typename T>
 Quaternion<T> Slerp( const Quaternion<T>& quat1, const Quaternion<T>& quat2, const T t )
 {
 	Quaternion<T> q3;
-	Quaternion<T> q1 = quat1.normalize();
-	Quaternion<T> q2 = quat2.normalize();
-	T cosOmega = q1.w * q2.w + q1.x * q2.x + q1.y * q2.y + q1.z * q2.z;
+	Quaternion<T> q1 = quat1.Normalize();
+	Quaternion<T> q2 = quat2.Normalize();
+	T cosOmega = Dot( q1, q2 );
 
 	//if negative dot, negate one of the input
 	//quaternions to take the shorter 4D "arc"
@@ -200,15 +276,15 @@ Quaternion<T> Slerp( const Quaternion<T>& quat1, const Quaternion<T>& quat2, con
 		T sinOmega = sqrt( T(1.0) - ( cosOmega * cosOmega ) );
 		T omega = atan2( sinOmega, cosOmega );
 
-		k0 = sin( T(1.0) - t ) * ( omega / sinOmega );
+		k0 = sin( ( T(1.0) - t ) * omega ) / sinOmega;
 		k1 = sin( t * omega ) / sinOmega;
 		
-		return ( ( k0 * q1 ) + ( k1 * q3 ) ).normalize();
+		return ( ( k0 * q1 ) + ( k1 * q3 ) ).Normalize();
 	}
 	else
 	{
 		Quaternion<T> q4 = ( T(1.0) - t ) * q1 + t * q3;
-		return q4.normalize();
+		return q4.Normalize();
 	}
 }
 
@@ -233,7 +309,7 @@ Vector<3, T> ToEuler( const Quaternion<T>& q )
 		h = atan2( T( q.x * q.z + q.w * q.y ), T( 0.5 - q.x * q.x - q.y * q.y ) );
 		b = atan2( T( q.x * q.y + q.w * q.z ), T( 0.5 - q.x * q.x - q.z * q.z ) );
 	}	
-	return Vector<3, T>( p * ( T(180.0) / PI ), h * ( T(180.0) / PI ), b * ( T(180.0) / PI ) );
+	return Vector<3, T>( Degrees( p ), Degrees( h ), Degrees( b ) );
 }
 
 
@@ -242,4 +318,4 @@ std::ostream& operator<<( std::ostream& stream, const Quaternion<T>& q )
 {
 	stream << "[ " << q.x << " " << q.y << " " << q.z << " | " << q.w << " ]";
 	return stream;
-}
\ No newline at end of file
+}
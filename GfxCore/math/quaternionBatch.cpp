@@ -0,0 +1,364 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "quaternionBatch.h"
+#include "../core/simd.h"
+#include "../core/parallel.h"
+
+static const uint32_t QuaternionGrainSize = 32768;
+
+// sin( t * omega ) / sin( omega ) = t * ( 1 + c1 * y * ( 1 + c2 * y * ( 1 + ... ) ) ), y = cos( omega ) - 1, ci = t^2 / ( i( 2i + 1 ) ) - i / ( 2i + 1 ).
+// The series is cut after SlerpTermCount terms and the last term is scaled to balance the truncation error.
+// Series error is below 8e-7 over the whole shorter arc, cos( omega ) in [ 0, 1 ]; results are within 2e-6 of an exact slerp.
+static const uint32_t SlerpTermCount = 12;
+static const float SlerpTailScale = 1.892f;
+
+struct slerpCoefficients_t
+{
+	float	u[ SlerpTermCount ];	// 1 / ( i( 2i + 1 ) )
+	float	v[ SlerpTermCount ];	// i / ( 2i + 1 )
+};
+
+static constexpr slerpCoefficients_t BuildSlerpCoefficients()
+{
+	slerpCoefficients_t c = {};
+	for ( uint32_t n = 0; n < SlerpTermCount; ++n )
+	{
+		const double i = n + 1.0;
+		const double scale = ( n == ( SlerpTermCount - 1 ) ) ? SlerpTailScale : 1.0;
+		c.u[ n ] = static_cast<float>( scale / ( i * ( 2.0 * i + 1.0 ) ) );
+		c.v[ n ] = static_cast<float>( scale * i / ( 2.0 * i + 1.0 ) );
+	}
+	return c;
+}
+
+static constexpr slerpCoefficients_t SlerpCoefficients = BuildSlerpCoefficients();
+
+struct quatBatch_t
+{
+	soaStream4f_t	a;
+	soaStream4f_t	b;
+	const float*	t;
+	float			uniformT;
+	soaTarget4f_t	out;
+};
+
+
+template<quatInterpolation_t Mode, bool UniformT>
+static void InterpolateScalar( const quatBatch_t& batch, const uint32_t begin, const uint32_t end )
+{
+	const slerpCoefficients_t& c = SlerpCoefficients;
+
+	for ( uint32_t i = begin; i < end; ++i )
+	{
+		const float t = UniformT ? batch.uniformT : batch.t[ i ];
+
+		const float ax = batch.a.x[ i ];
+		const float ay = batch.a.y[ i ];
+		const float az = batch.a.z[ i ];
+		const float aw = batch.a.w[ i ];
+		float bx = batch.b.x[ i ];
+		float by = batch.b.y[ i ];
+		float bz = batch.b.z[ i ];
+		float bw = batch.b.w[ i ];
+
+		float d = ax * bx + ay * by + az * bz + aw * bw;
+		if ( d < 0.0f )
+		{
+			bx = -bx;
+			by = -by;
+			bz = -bz;
+			bw = -bw;
+			d = -d;
+		}
+
+		const float s = 1.0f - t;
+		float k0 = s;
+		float k1 = t;
+		if ( Mode == quatInterpolation_t::SLERP )
+		{
+			const float y = d - 1.0f;
+			const float s2 = s * s;
+			const float t2 = t * t;
+			float p0 = 1.0f;
+			float p1 = 1.0f;
+			for ( int32_t n = SlerpTermCount - 1; n >= 0; --n ) {
+				p0 = 1.0f + ( c.u[ n ] * s2 - c.v[ n ] ) * y * p0;
+				p1 = 1.0f + ( c.u[ n ] * t2 - c.v[ n ] ) * y * p1;
+			}
+			k0 = s * p0;
+			k1 = t * p1;
+		}
+
+		float rx = k0 * ax + k1 * bx;
+		float ry = k0 * ay + k1 * by;
+		float rz = k0 * az + k1 * bz;
+		float rw = k0 * aw + k1 * bw;
+
+		if ( Mode == quatInterpolation_t::NLERP )
+		{
+			const float invLength = 1.0f / sqrtf( rx * rx + ry * ry + rz * rz + rw * rw );
+			rx *= invLength;
+			ry *= invLength;
+			rz *= invLength;
+			rw *= invLength;
+		}
+
+		batch.out.x[ i ] = rx;
+		batch.out.y[ i ] = ry;
+		batch.out.z[ i ] = rz;
+		batch.out.w[ i ] = rw;
+	}
+}
+
+
+#if defined( GFX_SIMD_SSE )
+
+template<quatInterpolation_t Mode, bool UniformT>
+static uint32_t InterpolateSSE( const quatBatch_t& batch, const uint32_t begin, const uint32_t end )
+{
+	const slerpCoefficients_t& c = SlerpCoefficients;
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 half = _mm_set1_ps( 0.5f );
+	const __m128 threeHalves = _mm_set1_ps( 1.5f );
+	const __m128 signBit = _mm_set1_ps( -0.0f );
+	const __m128 uniformT = _mm_set1_ps( batch.uniformT );
+
+	uint32_t i = begin;
+	for ( ; ( i + 4 ) <= end; i += 4 )
+	{
+		const __m128 t = UniformT ? uniformT : _mm_loadu_ps( batch.t + i );
+
+		const __m128 ax = _mm_loadu_ps( batch.a.x + i );
+		const __m128 ay = _mm_loadu_ps( batch.a.y + i );
+		const __m128 az = _mm_loadu_ps( batch.a.z + i );
+		const __m128 aw = _mm_loadu_ps( batch.a.w + i );
+		__m128 bx = _mm_loadu_ps( batch.b.x + i );
+		__m128 by = _mm_loadu_ps( batch.b.y + i );
+		__m128 bz = _mm_loadu_ps( batch.b.z + i );
+		__m128 bw = _mm_loadu_ps( batch.b.w + i );
+
+		// Flip b where the dot is negative to take the shorter arc
+		__m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( ax, bx ), _mm_mul_ps( ay, by ) ), _mm_add_ps( _mm_mul_ps( az, bz ), _mm_mul_ps( aw, bw ) ) );
+		const __m128 flip = _mm_and_ps( d, signBit );
+		bx = _mm_xor_ps( bx, flip );
+		by = _mm_xor_ps( by, flip );
+		bz = _mm_xor_ps( bz, flip );
+		bw = _mm_xor_ps( bw, flip );
+		d = _mm_xor_ps( d, flip );
+
+		const __m128 s = _mm_sub_ps( one, t );
+		__m128 k0 = s;
+		__m128 k1 = t;
+		if ( Mode == quatInterpolation_t::SLERP )
+		{
+			const __m128 y = _mm_sub_ps( d, one );
+			const __m128 s2 = _mm_mul_ps( s, s );
+			const __m128 t2 = _mm_mul_ps( t, t );
+			__m128 p0 = one;
+			__m128 p1 = one;
+			for ( int32_t n = SlerpTermCount - 1; n >= 0; --n )
+			{
+				const __m128 u = _mm_set1_ps( c.u[ n ] );
+				const __m128 v = _mm_set1_ps( c.v[ n ] );
+				p0 = _mm_add_ps( one, _mm_mul_ps( _mm_mul_ps( _mm_sub_ps( _mm_mul_ps( u, s2 ), v ), y ), p0 ) );
+				p1 = _mm_add_ps( one, _mm_mul_ps( _mm_mul_ps( _mm_sub_ps( _mm_mul_ps( u, t2 ), v ), y ), p1 ) );
+			}
+			k0 = _mm_mul_ps( s, p0 );
+			k1 = _mm_mul_ps( t, p1 );
+		}
+
+		__m128 rx = _mm_add_ps( _mm_mul_ps( k0, ax ), _mm_mul_ps( k1, bx ) );
+		__m128 ry = _mm_add_ps( _mm_mul_ps( k0, ay ), _mm_mul_ps( k1, by ) );
+		__m128 rz = _mm_add_ps( _mm_mul_ps( k0, az ), _mm_mul_ps( k1, bz ) );
+		__m128 rw = _mm_add_ps( _mm_mul_ps( k0, aw ), _mm_mul_ps( k1, bw ) );
+
+		if ( Mode == quatInterpolation_t::NLERP )
+		{
+			// Estimate plus one Newton step. The lerp of two keys on the shorter arc is never shorter than 1 / sqrt( 2 )
+			const __m128 lengthSq = _mm_add_ps( _mm_add_ps( _mm_mul_ps( rx, rx ), _mm_mul_ps( ry, ry ) ), _mm_add_ps( _mm_mul_ps( rz, rz ), _mm_mul_ps( rw, rw ) ) );
+			__m128 invLength = _mm_rsqrt_ps( lengthSq );
+			invLength = _mm_mul_ps( invLength, _mm_sub_ps( threeHalves, _mm_mul_ps( _mm_mul_ps( half, lengthSq ), _mm_mul_ps( invLength, invLength ) ) ) );
+			rx = _mm_mul_ps( rx, invLength );
+			ry = _mm_mul_ps( ry, invLength );
+			rz = _mm_mul_ps( rz, invLength );
+			rw = _mm_mul_ps( rw, invLength );
+		}
+
+		_mm_storeu_ps( batch.out.x + i, rx );
+		_mm_storeu_ps( batch.out.y + i, ry );
+		_mm_storeu_ps( batch.out.z + i, rz );
+		_mm_storeu_ps( batch.out.w + i, rw );
+	}
+	return i;
+}
+
+
+template<quatInterpolation_t Mode, bool UniformT>
+GFX_TARGET_AVX2 static uint32_t InterpolateAVX2( const quatBatch_t& batch, const uint32_t begin, const uint32_t end )
+{
+	const slerpCoefficients_t& c = SlerpCoefficients;
+	const __m256 one = _mm256_set1_ps( 1.0f );
+	const __m256 half = _mm256_set1_ps( 0.5f );
+	const __m256 threeHalves = _mm256_set1_ps( 1.5f );
+	const __m256 signBit = _mm256_set1_ps( -0.0f );
+	const __m256 uniformT = _mm256_set1_ps( batch.uniformT );
+
+	uint32_t i = begin;
+	for ( ; ( i + 8 ) <= end; i += 8 )
+	{
+		const __m256 t = UniformT ? uniformT : _mm256_loadu_ps( batch.t + i );
+
+		const __m256 ax = _mm256_loadu_ps( batch.a.x + i );
+		const __m256 ay = _mm256_loadu_ps( batch.a.y + i );
+		const __m256 az = _mm256_loadu_ps( batch.a.z + i );
+		const __m256 aw = _mm256_loadu_ps( batch.a.w + i );
+		__m256 bx = _mm256_loadu_ps( batch.b.x + i );
+		__m256 by = _mm256_loadu_ps( batch.b.y + i );
+		__m256 bz = _mm256_loadu_ps( batch.b.z + i );
+		__m256 bw = _mm256_loadu_ps( batch.b.w + i );
+
+		__m256 d = _mm256_fmadd_ps( ax, bx, _mm256_fmadd_ps( ay, by, _mm256_fmadd_ps( az, bz, _mm256_mul_ps( aw, bw ) ) ) );
+		const __m256 flip = _mm256_and_ps( d, signBit );
+		bx = _mm256_xor_ps( bx, flip );
+		by = _mm256_xor_ps( by, flip );
+		bz = _mm256_xor_ps( bz, flip );
+		bw = _mm256_xor_ps( bw, flip );
+		d = _mm256_xor_ps( d, flip );
+
+		const __m256 s = _mm256_sub_ps( one, t );
+		__m256 k0 = s;
+		__m256 k1 = t;
+		if ( Mode == quatInterpolation_t::SLERP )
+		{
+			const __m256 y = _mm256_sub_ps( d, one );
+			const __m256 s2 = _mm256_mul_ps( s, s );
+			const __m256 t2 = _mm256_mul_ps( t, t );
+			__m256 p0 = one;
+			__m256 p1 = one;
+			for ( int32_t n = SlerpTermCount - 1; n >= 0; --n )
+			{
+				const __m256 u = _mm256_set1_ps( c.u[ n ] );
+				const __m256 v = _mm256_set1_ps( c.v[ n ] );
+				p0 = _mm256_fmadd_ps( _mm256_mul_ps( _mm256_fmsub_ps( u, s2, v ), y ), p0, one );
+				p1 = _mm256_fmadd_ps( _mm256_mul_ps( _mm256_fmsub_ps( u, t2, v ), y ), p1, one );
+			}
+			k0 = _mm256_mul_ps( s, p0 );
+			k1 = _mm256_mul_ps( t, p1 );
+		}
+
+		__m256 rx = _mm256_fmadd_ps( k0, ax, _mm256_mul_ps( k1, bx ) );
+		__m256 ry = _mm256_fmadd_ps( k0, ay, _mm256_mul_ps( k1, by ) );
+		__m256 rz = _mm256_fmadd_ps( k0, az, _mm256_mul_ps( k1, bz ) );
+		__m256 rw = _mm256_fmadd_ps( k0, aw, _mm256_mul_ps( k1, bw ) );
+
+		if ( Mode == quatInterpolation_t::NLERP )
+		{
+			const __m256 lengthSq = _mm256_fmadd_ps( rx, rx, _mm256_fmadd_ps( ry, ry, _mm256_fmadd_ps( rz, rz, _mm256_mul_ps( rw, rw ) ) ) );
+			__m256 invLength = _mm256_rsqrt_ps( lengthSq );
+			invLength = _mm256_mul_ps( invLength, _mm256_fnmadd_ps( _mm256_mul_ps( half, lengthSq ), _mm256_mul_ps( invLength, invLength ), threeHalves ) );
+			rx = _mm256_mul_ps( rx, invLength );
+			ry = _mm256_mul_ps( ry, invLength );
+			rz = _mm256_mul_ps( rz, invLength );
+			rw = _mm256_mul_ps( rw, invLength );
+		}
+
+		_mm256_storeu_ps( batch.out.x + i, rx );
+		_mm256_storeu_ps( batch.out.y + i, ry );
+		_mm256_storeu_ps( batch.out.z + i, rz );
+		_mm256_storeu_ps( batch.out.w + i, rw );
+	}
+	return i;
+}
+
+#endif
+
+
+template<quatInterpolation_t Mode, bool UniformT>
+static void InterpolateStreams( const quatBatch_t& batch, const uint32_t count )
+{
+#if defined( GFX_SIMD_SSE )
+	const bool useAvx2 = GetCpuFeatures().avx2 && GetCpuFeatures().fma;
+#endif
+
+	ParallelFor( count, QuaternionGrainSize, [&]( const uint32_t begin, const uint32_t end )
+	{
+		uint32_t i = begin;
+#if defined( GFX_SIMD_SSE )
+		i = useAvx2 ? InterpolateAVX2<Mode, UniformT>( batch, i, end ) : InterpolateSSE<Mode, UniformT>( batch, i, end );
+#endif
+		InterpolateScalar<Mode, UniformT>( batch, i, end );
+	} );
+}
+
+
+void NlerpQuaternions( const soaStream4f_t& a, const soaStream4f_t& b, const float* t, const soaTarget4f_t& out, const uint32_t count )
+{
+	const quatBatch_t batch = { a, b, t, 0.0f, out };
+	InterpolateStreams<quatInterpolation_t::NLERP, false>( batch, count );
+}
+
+
+void NlerpQuaternions( const soaStream4f_t& a, const soaStream4f_t& b, const float t, const soaTarget4f_t& out, const uint32_t count )
+{
+	const quatBatch_t batch = { a, b, nullptr, t, out };
+	InterpolateStreams<quatInterpolation_t::NLERP, true>( batch, count );
+}
+
+
+void SlerpQuaternions( const soaStream4f_t& a, const soaStream4f_t& b, const float* t, const soaTarget4f_t& out, const uint32_t count )
+{
+	const quatBatch_t batch = { a, b, t, 0.0f, out };
+	InterpolateStreams<quatInterpolation_t::SLERP, false>( batch, count );
+}
+
+
+void SlerpQuaternions( const soaStream4f_t& a, const soaStream4f_t& b, const float t, const soaTarget4f_t& out, const uint32_t count )
+{
+	const quatBatch_t batch = { a, b, nullptr, t, out };
+	InterpolateStreams<quatInterpolation_t::SLERP, true>( batch, count );
+}
+
+
+void SampleRotationClip( const rotationClip_t& clip, const float time, const quatInterpolation_t mode, const soaTarget4f_t& out )
+{
+	const uint32_t trackCount = clip.trackCount;
+	if ( ( trackCount == 0 ) || ( clip.keyCount == 0 ) ) {
+		return;
+	}
+
+	const float lastKey = static_cast<float>( clip.keyCount - 1 );
+	const float position = Clamp( time * clip.keysPerSecond, 0.0f, lastKey );
+	const uint32_t key = Min( static_cast<uint32_t>( position ), ( clip.keyCount > 1 ) ? ( clip.keyCount - 2 ) : 0u );
+	const uint32_t nextKey = Min( key + 1, clip.keyCount - 1 );
+	const float t = position - static_cast<float>( key );
+
+	const soaStream4f_t a = clip.keys.Stream( key * trackCount );
+	const soaStream4f_t b = clip.keys.Stream( nextKey * trackCount );
+
+	if ( mode == quatInterpolation_t::SLERP ) {
+		SlerpQuaternions( a, b, t, out, trackCount );
+	} else {
+		NlerpQuaternions( a, b, t, out, trackCount );
+	}
+}
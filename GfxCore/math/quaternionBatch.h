@@ -0,0 +1,106 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "quaternion.h"
+#include "transformBatch.h"
+
+// Owns the component arrays of a quaternion stream, element i is ( x[ i ], y[ i ], z[ i ], w[ i ] )
+struct soaQuatf_t
+{
+	std::vector<float>	x;
+	std::vector<float>	y;
+	std::vector<float>	z;
+	std::vector<float>	w;
+
+	inline void Resize( const uint32_t count )
+	{
+		x.resize( count );
+		y.resize( count );
+		z.resize( count );
+		w.resize( count );
+	}
+
+	inline uint32_t Size() const
+	{
+		return static_cast<uint32_t>( x.size() );
+	}
+
+	inline void Set( const uint32_t i, const quatf& q )
+	{
+		x[ i ] = q.x;
+		y[ i ] = q.y;
+		z[ i ] = q.z;
+		w[ i ] = q.w;
+	}
+
+	inline quatf Get( const uint32_t i ) const
+	{
+		return quatf( w[ i ], x[ i ], y[ i ], z[ i ] );
+	}
+
+	inline soaStream4f_t Stream( const uint32_t offset = 0 ) const
+	{
+		return soaStream4f_t{ x.data() + offset, y.data() + offset, z.data() + offset, w.data() + offset };
+	}
+
+	inline soaTarget4f_t Target( const uint32_t offset = 0 )
+	{
+		return soaTarget4f_t{ x.data() + offset, y.data() + offset, z.data() + offset, w.data() + offset };
+	}
+};
+
+enum class quatInterpolation_t : uint32_t
+{
+	NLERP,	// Normalized lerp, cheapest, not constant speed
+	SLERP,	// Constant speed, within 2e-6 of an exact slerp
+};
+
+/* === Batched quaternion interpolation - SSE or AVX2 kernels over structure of arrays streams === */
+// Keys are expected to be unit length. Each result follows the shorter arc from a[ i ] to b[ i ].
+// The target may alias either input. Large counts are split across threads.
+
+// out[ i ] = Nlerp( a[ i ], b[ i ], t[ i ] )
+void NlerpQuaternions( const soaStream4f_t& a, const soaStream4f_t& b, const float* t, const soaTarget4f_t& out, const uint32_t count );
+void NlerpQuaternions( const soaStream4f_t& a, const soaStream4f_t& b, const float t, const soaTarget4f_t& out, const uint32_t count );
+
+// out[ i ] = Slerp( a[ i ], b[ i ], t[ i ] ). Uses a polynomial in cos( omega ) instead of trig calls
+void SlerpQuaternions( const soaStream4f_t& a, const soaStream4f_t& b, const float* t, const soaTarget4f_t& out, const uint32_t count );
+void SlerpQuaternions( const soaStream4f_t& a, const soaStream4f_t& b, const float t, const soaTarget4f_t& out, const uint32_t count );
+
+// Baked rotation clip with uniformly spaced keys. Key k of track i is keys[ k * trackCount + i ], so every key is one contiguous stream.
+struct rotationClip_t
+{
+	soaQuatf_t	keys;
+	uint32_t	trackCount;
+	uint32_t	keyCount;
+	float		keysPerSecond;
+};
+
+// Samples every track at the same time in seconds, clamped to the clip length
+void SampleRotationClip( const rotationClip_t& clip, const float time, const quatInterpolation_t mode, const soaTarget4f_t& out );
@@ -0,0 +1,253 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "transformBatch.h"
+#include "../core/simd.h"
+#include "../core/parallel.h"
+
+static const uint32_t TransformGrainSize = 65536;
+static const float ProjectEpsilonW = 1e-7f;	// Same bias as ProjectPoint()
+
+enum class soaTransform_t : uint32_t
+{
+	POINT,				// xyz of m * ( p, 1 )
+	POINT_HOMOGENEOUS,	// xyzw of m * ( p, 1 )
+	DIRECTION,			// xyz of m * ( d, 0 )
+	PROJECT,			// Screen space xy, NDC z and w
+};
+
+struct soaTransform4x4_t
+{
+	float	m[ 4 ][ 4 ];
+	float	halfWidth;
+	float	halfHeight;
+};
+
+
+template<soaTransform_t Mode>
+static void TransformScalar( const soaTransform4x4_t& xf, const soaStream3f_t& in, const soaTarget4f_t& out, const uint32_t begin, const uint32_t end )
+{
+	const float t = ( Mode == soaTransform_t::DIRECTION ) ? 0.0f : 1.0f;
+	const float( &m )[ 4 ][ 4 ] = xf.m;
+
+	for ( uint32_t i = begin; i < end; ++i )
+	{
+		const float x = in.x[ i ];
+		const float y = in.y[ i ];
+		const float z = in.z[ i ];
+
+		float r0 = m[ 0 ][ 0 ] * x + m[ 0 ][ 1 ] * y + m[ 0 ][ 2 ] * z + m[ 0 ][ 3 ] * t;
+		float r1 = m[ 1 ][ 0 ] * x + m[ 1 ][ 1 ] * y + m[ 1 ][ 2 ] * z + m[ 1 ][ 3 ] * t;
+		float r2 = m[ 2 ][ 0 ] * x + m[ 2 ][ 1 ] * y + m[ 2 ][ 2 ] * z + m[ 2 ][ 3 ] * t;
+
+		if ( Mode == soaTransform_t::PROJECT )
+		{
+			const float w = m[ 3 ][ 0 ] * x + m[ 3 ][ 1 ] * y + m[ 3 ][ 2 ] * z + m[ 3 ][ 3 ] + ProjectEpsilonW;
+			const float invW = 1.0f / w;
+			r0 = xf.halfWidth * ( r0 * invW ) + xf.halfWidth;
+			r1 = xf.halfHeight * ( r1 * invW ) + xf.halfHeight;
+			r2 = r2 * invW;
+			out.w[ i ] = w;
+		}
+		else if ( Mode == soaTransform_t::POINT_HOMOGENEOUS )
+		{
+			out.w[ i ] = m[ 3 ][ 0 ] * x + m[ 3 ][ 1 ] * y + m[ 3 ][ 2 ] * z + m[ 3 ][ 3 ];
+		}
+
+		out.x[ i ] = r0;
+		out.y[ i ] = r1;
+		out.z[ i ] = r2;
+	}
+}
+
+
+#if defined( GFX_SIMD_SSE )
+
+template<soaTransform_t Mode>
+static uint32_t TransformSSE( const soaTransform4x4_t& xf, const soaStream3f_t& in, const soaTarget4f_t& out, const uint32_t begin, const uint32_t end )
+{
+	const uint32_t rowCount = ( Mode == soaTransform_t::POINT || Mode == soaTransform_t::DIRECTION ) ? 3 : 4;
+
+	__m128 m[ 4 ][ 4 ];
+	for ( uint32_t r = 0; r < 4; ++r ) {
+		for ( uint32_t c = 0; c < 4; ++c ) {
+			m[ r ][ c ] = _mm_set1_ps( ( ( Mode == soaTransform_t::DIRECTION ) && ( c == 3 ) ) ? 0.0f : xf.m[ r ][ c ] );
+		}
+	}
+	const __m128 halfWidth = _mm_set1_ps( xf.halfWidth );
+	const __m128 halfHeight = _mm_set1_ps( xf.halfHeight );
+	const __m128 epsilonW = _mm_set1_ps( ProjectEpsilonW );
+	const __m128 one = _mm_set1_ps( 1.0f );
+
+	uint32_t i = begin;
+	for ( ; ( i + 4 ) <= end; i += 4 )
+	{
+		const __m128 x = _mm_loadu_ps( in.x + i );
+		const __m128 y = _mm_loadu_ps( in.y + i );
+		const __m128 z = _mm_loadu_ps( in.z + i );
+
+		__m128 r[ 4 ];
+		for ( uint32_t row = 0; row < rowCount; ++row ) {
+			r[ row ] = _mm_add_ps( _mm_add_ps( _mm_mul_ps( m[ row ][ 0 ], x ), _mm_mul_ps( m[ row ][ 1 ], y ) ), _mm_add_ps( _mm_mul_ps( m[ row ][ 2 ], z ), m[ row ][ 3 ] ) );
+		}
+
+		if ( Mode == soaTransform_t::PROJECT )
+		{
+			const __m128 w = _mm_add_ps( r[ 3 ], epsilonW );
+			const __m128 invW = _mm_div_ps( one, w );
+			r[ 0 ] = _mm_add_ps( _mm_mul_ps( halfWidth, _mm_mul_ps( r[ 0 ], invW ) ), halfWidth );
+			r[ 1 ] = _mm_add_ps( _mm_mul_ps( halfHeight, _mm_mul_ps( r[ 1 ], invW ) ), halfHeight );
+			r[ 2 ] = _mm_mul_ps( r[ 2 ], invW );
+			r[ 3 ] = w;
+		}
+
+		_mm_storeu_ps( out.x + i, r[ 0 ] );
+		_mm_storeu_ps( out.y + i, r[ 1 ] );
+		_mm_storeu_ps( out.z + i, r[ 2 ] );
+		if ( rowCount == 4 ) {
+			_mm_storeu_ps( out.w + i, r[ 3 ] );
+		}
+	}
+	return i;
+}
+
+
+template<soaTransform_t Mode>
+GFX_TARGET_AVX2 static uint32_t TransformAVX2( const soaTransform4x4_t& xf, const soaStream3f_t& in, const soaTarget4f_t& out, const uint32_t begin, const uint32_t end )
+{
+	const uint32_t rowCount = ( Mode == soaTransform_t::POINT || Mode == soaTransform_t::DIRECTION ) ? 3 : 4;
+
+	__m256 m[ 4 ][ 4 ];
+	for ( uint32_t r = 0; r < 4; ++r ) {
+		for ( uint32_t c = 0; c < 4; ++c ) {
+			m[ r ][ c ] = _mm256_set1_ps( ( ( Mode == soaTransform_t::DIRECTION ) && ( c == 3 ) ) ? 0.0f : xf.m[ r ][ c ] );
+		}
+	}
+	const __m256 halfWidth = _mm256_set1_ps( xf.halfWidth );
+	const __m256 halfHeight = _mm256_set1_ps( xf.halfHeight );
+	const __m256 epsilonW = _mm256_set1_ps( ProjectEpsilonW );
+	const __m256 one = _mm256_set1_ps( 1.0f );
+
+	uint32_t i = begin;
+	for ( ; ( i + 8 ) <= end; i += 8 )
+	{
+		const __m256 x = _mm256_loadu_ps( in.x + i );
+		const __m256 y = _mm256_loadu_ps( in.y + i );
+		const __m256 z = _mm256_loadu_ps( in.z + i );
+
+		__m256 r[ 4 ];
+		for ( uint32_t row = 0; row < rowCount; ++row ) {
+			r[ row ] = _mm256_fmadd_ps( m[ row ][ 0 ], x, _mm256_fmadd_ps( m[ row ][ 1 ], y, _mm256_fmadd_ps( m[ row ][ 2 ], z, m[ row ][ 3 ] ) ) );
+		}
+
+		if ( Mode == soaTransform_t::PROJECT )
+		{
+			const __m256 w = _mm256_add_ps( r[ 3 ], epsilonW );
+			const __m256 invW = _mm256_div_ps( one, w );
+			r[ 0 ] = _mm256_fmadd_ps( halfWidth, _mm256_mul_ps( r[ 0 ], invW ), halfWidth );
+			r[ 1 ] = _mm256_fmadd_ps( halfHeight, _mm256_mul_ps( r[ 1 ], invW ), halfHeight );
+			r[ 2 ] = _mm256_mul_ps( r[ 2 ], invW );
+			r[ 3 ] = w;
+		}
+
+		_mm256_storeu_ps( out.x + i, r[ 0 ] );
+		_mm256_storeu_ps( out.y + i, r[ 1 ] );
+		_mm256_storeu_ps( out.z + i, r[ 2 ] );
+		if ( rowCount == 4 ) {
+			_mm256_storeu_ps( out.w + i, r[ 3 ] );
+		}
+	}
+	return i;
+}
+
+#endif
+
+
+template<soaTransform_t Mode>
+static void TransformStreams( const soaTransform4x4_t& xf, const soaStream3f_t& in, const soaTarget4f_t& out, const uint32_t count )
+{
+#if defined( GFX_SIMD_SSE )
+	const bool useAvx2 = GetCpuFeatures().avx2 && GetCpuFeatures().fma;
+#endif
+
+	ParallelFor( count, TransformGrainSize, [&]( const uint32_t begin, const uint32_t end )
+	{
+		uint32_t i = begin;
+#if defined( GFX_SIMD_SSE )
+		i = useAvx2 ? TransformAVX2<Mode>( xf, in, out, i, end ) : TransformSSE<Mode>( xf, in, out, i, end );
+#endif
+		TransformScalar<Mode>( xf, in, out, i, end );
+	} );
+}
+
+
+static soaTransform4x4_t MakeTransform( const mat4x4f& m )
+{
+	soaTransform4x4_t xf;
+	for ( uint32_t r = 0; r < 4; ++r ) {
+		for ( uint32_t c = 0; c < 4; ++c ) {
+			xf.m[ r ][ c ] = m[ r ][ c ];
+		}
+	}
+	xf.halfWidth = 0.0f;
+	xf.halfHeight = 0.0f;
+	return xf;
+}
+
+
+void TransformPoints( const mat4x4f& m, const soaStream3f_t& points, const soaTarget3f_t& out, const uint32_t count )
+{
+	const soaTarget4f_t target = { out.x, out.y, out.z, nullptr };
+	TransformStreams<soaTransform_t::POINT>( MakeTransform( m ), points, target, count );
+}
+
+
+void TransformPoints( const mat4x4f& m, const soaStream3f_t& points, const soaTarget4f_t& out, const uint32_t count )
+{
+	TransformStreams<soaTransform_t::POINT_HOMOGENEOUS>( MakeTransform( m ), points, out, count );
+}
+
+
+void TransformDirections( const mat3x3f& m, const soaStream3f_t& directions, const soaTarget3f_t& out, const uint32_t count )
+{
+	soaTransform4x4_t xf = MakeTransform( mat4x4f( 1.0f ) );
+	for ( uint32_t r = 0; r < 3; ++r ) {
+		for ( uint32_t c = 0; c < 3; ++c ) {
+			xf.m[ r ][ c ] = m[ r ][ c ];
+		}
+	}
+
+	const soaTarget4f_t target = { out.x, out.y, out.z, nullptr };
+	TransformStreams<soaTransform_t::DIRECTION>( xf, directions, target, count );
+}
+
+
+void ProjectPoints( const mat4x4f& mvp, const vec2i& screenSize, const soaStream3f_t& points, const soaTarget4f_t& out, const uint32_t count )
+{
+	soaTransform4x4_t xf = MakeTransform( mvp );
+	xf.halfWidth = 0.5f * screenSize[ 0 ];
+	xf.halfHeight = 0.5f * screenSize[ 1 ];
+
+	TransformStreams<soaTransform_t::PROJECT>( xf, points, out, count );
+}
@@ -0,0 +1,119 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "vector.h"
+#include "matrix.h"
+
+// Structure of arrays views, element i is ( x[ i ], y[ i ], z[ i ] ). A target may be its own stream for in place transforms.
+struct soaStream3f_t
+{
+	const float*	x;
+	const float*	y;
+	const float*	z;
+};
+
+struct soaStream4f_t
+{
+	const float*	x;
+	const float*	y;
+	const float*	z;
+	const float*	w;
+};
+
+struct soaTarget3f_t
+{
+	float*			x;
+	float*			y;
+	float*			z;
+};
+
+struct soaTarget4f_t
+{
+	float*			x;
+	float*			y;
+	float*			z;
+	float*			w;
+};
+
+// Owns the component arrays for the views above
+struct soaVec3f_t
+{
+	std::vector<float>	x;
+	std::vector<float>	y;
+	std::vector<float>	z;
+
+	inline void Resize( const uint32_t count )
+	{
+		x.resize( count );
+		y.resize( count );
+		z.resize( count );
+	}
+
+	inline uint32_t Size() const
+	{
+		return static_cast<uint32_t>( x.size() );
+	}
+
+	inline void Set( const uint32_t i, const vec3f& v )
+	{
+		x[ i ] = v[ 0 ];
+		y[ i ] = v[ 1 ];
+		z[ i ] = v[ 2 ];
+	}
+
+	inline vec3f Get( const uint32_t i ) const
+	{
+		return vec3f( x[ i ], y[ i ], z[ i ] );
+	}
+
+	inline soaStream3f_t Stream() const
+	{
+		return soaStream3f_t{ x.data(), y.data(), z.data() };
+	}
+
+	inline soaTarget3f_t Target()
+	{
+		return soaTarget3f_t{ x.data(), y.data(), z.data() };
+	}
+};
+
+/* === Batched transforms - SSE or AVX2 kernels over structure of arrays streams === */
+// Matrices use column vectors ( m * v ) like the rest of the library. Large counts are split across threads.
+
+// m * ( p, 1 ), the projective row is ignored
+void TransformPoints( const mat4x4f& m, const soaStream3f_t& points, const soaTarget3f_t& out, const uint32_t count );
+
+// m * ( p, 1 ) with w kept, for clip space positions
+void TransformPoints( const mat4x4f& m, const soaStream3f_t& points, const soaTarget4f_t& out, const uint32_t count );
+
+// m * d, no translation
+void TransformDirections( const mat3x3f& m, const soaStream3f_t& directions, const soaTarget3f_t& out, const uint32_t count );
+
+// Batched ProjectPoint(), out is screen x, screen y, NDC depth and clip w
+void ProjectPoints( const mat4x4f& mvp, const vec2i& screenSize, const soaStream3f_t& points, const soaTarget4f_t& out, const uint32_t count );
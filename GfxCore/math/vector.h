@@ -28,6 +28,7 @@
 #include <iostream>
 #include <string>
 #include <assert.h>
+#include "../core/simd.h"
 
 class Serializer;
 
@@ -45,30 +46,30 @@ public:
 
 	static const size_t size = D;
 
-	Vector() { Zero(); };
-	Vector( const Vector<D, T>& vec );
-	Vector( const Vector<D - 1, T>& vec, T value );
-	Vector( const Vector<D + 1, T>& vec );
-	Vector( const T& d1 );
-	Vector( const T& d1, const T& d2 );
-	Vector( const T& d1, const T& d2, const T& d3 );
-	Vector( const T& d1, const T& d2, const T& d3, const T& d4 );
-	Vector( T values[] );
+	constexpr Vector() : data() {};
+	constexpr Vector( const Vector<D, T>& vec );
+	constexpr Vector( const Vector<D - 1, T>& vec, T value );
+	constexpr Vector( const Vector<D + 1, T>& vec );
+	constexpr Vector( const T& d1 );
+	constexpr Vector( const T& d1, const T& d2 );
+	constexpr Vector( const T& d1, const T& d2, const T& d3 );
+	constexpr Vector( const T& d1, const T& d2, const T& d3, const T& d4 );
+	constexpr Vector( T values[] );
 
 	void FlushDenorms();
 
 	T Length() const;
 	Vector<D, T> Normalize() const;
-	Vector<D, T> Reverse() const;
-	void Zero();
+	constexpr Vector<D, T> Reverse() const;
+	constexpr void Zero();
 
-	const T& operator []( const size_t i ) const;
-	T& operator []( const size_t i );
-	Vector<D, T>& operator=( const Vector<D, T>& u );
-	Vector<D, T>& operator+=( const Vector<D, T> & u );
-	Vector<D, T>& operator-=( const Vector<D, T>& u );
-	Vector<D, T>& operator*=( T& s );
-	Vector<D, T>& operator/=( T& s );
+	constexpr const T& operator []( const size_t i ) const;
+	constexpr T& operator []( const size_t i );
+	constexpr Vector<D, T>& operator=( const Vector<D, T>& u );
+	constexpr Vector<D, T>& operator+=( const Vector<D, T> & u );
+	constexpr Vector<D, T>& operator-=( const Vector<D, T>& u );
+	constexpr Vector<D, T>& operator*=( T& s );
+	constexpr Vector<D, T>& operator/=( T& s );
 
 	void Serialize( Serializer* serializer );
 };
@@ -83,8 +84,12 @@ using vec2d = Vector<2, double>;
 using vec3d = Vector<3, double>;
 using vec4d = Vector<4, double>;
 
+#if defined( GFX_SIMD_SSE )
+#include "vectorSimd.h"
+#endif
+
 template<size_t D, typename T>
-Vector<D, T>::Vector( const Vector<D, T>& vec )
+constexpr Vector<D, T>::Vector( const Vector<D, T>& vec ) : data()
 {
 	for ( size_t i = 0; i < D; ++i ) {
 		data[ i ] = vec.data[ i ];
@@ -93,7 +98,7 @@ Vector<D, T>::Vector( const Vector<D, T>& vec )
 
 
 template<size_t D, typename T>
-Vector<D, T>::Vector( const Vector< ( D - 1 ), T>& vec, T value )
+constexpr Vector<D, T>::Vector( const Vector< ( D - 1 ), T>& vec, T value ) : data()
 {
 	for ( size_t i = 0; i < ( D - 1 ); ++i ) {
 		data[ i ] = vec[ i ];
@@ -103,7 +108,7 @@ Vector<D, T>::Vector( const Vector< ( D - 1 ), T>& vec, T value )
 
 
 template<size_t D, typename T>
-Vector<D, T>::Vector( const Vector< ( D + 1 ), T>& vec )
+constexpr Vector<D, T>::Vector( const Vector< ( D + 1 ), T>& vec ) : data()
 {
 	for ( size_t i = 0; i < D; ++i ) {
 		data[ i ] = vec[ i ];
@@ -112,7 +117,7 @@ Vector<D, T>::Vector( const Vector< ( D + 1 ), T>& vec )
 
 
 template< size_t D, typename T >
-Vector<D, T>::Vector( const T& value )
+constexpr Vector<D, T>::Vector( const T& value ) : data()
 {
 	for ( size_t i = 0; i < D; ++i ) {
 		data[ i ] = value;
@@ -121,9 +126,8 @@ Vector<D, T>::Vector( const T& value )
 
 
 template< size_t D, typename T >
-Vector<D, T>::Vector( const T& d1, const T& d2 )
+constexpr Vector<D, T>::Vector( const T& d1, const T& d2 ) : data()
 {
-	Zero();
 	if ( D >= 2 )
 	{
 		data[ 0 ] = d1;
@@ -133,9 +137,8 @@ Vector<D, T>::Vector( const T& d1, const T& d2 )
 
 
 template <size_t D, typename T>
-Vector<D, T>::Vector( const T& d1, const T& d2, const T& d3 )
+constexpr Vector<D, T>::Vector( const T& d1, const T& d2, const T& d3 ) : data()
 {
-	Zero();
 	if ( D >= 3 )
 	{
 		data[ 0 ] = d1;
@@ -146,9 +149,8 @@ Vector<D, T>::Vector( const T& d1, const T& d2, const T& d3 )
 
 
 template<size_t D, typename T>
-Vector<D, T>::Vector( const T& d1, const T& d2, const T& d3, const T& d4 )
+constexpr Vector<D, T>::Vector( const T& d1, const T& d2, const T& d3, const T& d4 ) : data()
 {
-	Zero();
 	if ( D >= 4 )
 	{
 		data[ 0 ] = d1;
@@ -160,7 +162,7 @@ Vector<D, T>::Vector( const T& d1, const T& d2, const T& d3, const T& d4 )
 
 
 template<size_t D, typename T>
-Vector<D, T>::Vector( T values[] )
+constexpr Vector<D, T>::Vector( T values[] ) : data()
 {
 	for ( size_t i = 0; i < D; ++i )
 	{
@@ -216,7 +218,7 @@ Vector<D, T> Vector<D, T>::Normalize() const
 
 
 template<size_t D, typename T>
-Vector<D, T> Vector<D, T>::Reverse() const
+constexpr Vector<D, T> Vector<D, T>::Reverse() const
 {
 	Vector< D, T> v;
 	for ( size_t i = 0; i < D; ++i ) {
@@ -227,7 +229,7 @@ Vector<D, T> Vector<D, T>::Reverse() const
 
 
 template<size_t D, typename T>
-void Vector<D, T>::Zero()
+constexpr void Vector<D, T>::Zero()
 {
 	for ( size_t i = 0; i < D; ++i ) {
 		data[ i ] = static_cast<T>( 0.0 );
@@ -236,7 +238,7 @@ void Vector<D, T>::Zero()
 
 
 template<size_t D, typename T>
-const T& Vector<D, T>::operator[]( const size_t i ) const
+constexpr const T& Vector<D, T>::operator[]( const size_t i ) const
 {
 	if ( i >= D )
 	{
@@ -248,7 +250,7 @@ const T& Vector<D, T>::operator[]( const size_t i ) const
 
 
 template<size_t D, typename T>
-T& Vector<D, T>::operator[]( const size_t i )
+constexpr T& Vector<D, T>::operator[]( const size_t i )
 {
 	if ( i >= D )
 	{
@@ -260,7 +262,7 @@ T& Vector<D, T>::operator[]( const size_t i )
 
 
 template<size_t D, typename T>
-Vector<D, T>& Vector< D, T >::operator=( const Vector<D, T>& vec )
+constexpr Vector<D, T>& Vector< D, T >::operator=( const Vector<D, T>& vec )
 {
 	if( this != &vec ) {
 		for ( size_t i = 0; i < D; ++i ) {
@@ -272,7 +274,7 @@ Vector<D, T>& Vector< D, T >::operator=( const Vector<D, T>& vec )
 
 
 template<size_t D, typename T>
-Vector<D, T>& Vector<D, T>::operator+=( const Vector<D, T>& u )
+constexpr Vector<D, T>& Vector<D, T>::operator+=( const Vector<D, T>& u )
 {
 	for ( size_t i = 0; i < D; ++i ) {
 		data[ i ] += u.data[ i ];
@@ -282,7 +284,7 @@ Vector<D, T>& Vector<D, T>::operator+=( const Vector<D, T>& u )
 
 
 template<size_t D, typename T>
-Vector<D, T>& Vector<D, T>::operator-=( const Vector<D, T>& u )
+constexpr Vector<D, T>& Vector<D, T>::operator-=( const Vector<D, T>& u )
 {
 	for ( size_t i = 0; i < D; ++i ) {
 		data[ i ] -= u.data[ i ];
@@ -292,7 +294,7 @@ Vector<D, T>& Vector<D, T>::operator-=( const Vector<D, T>& u )
 
 
 template<size_t D, typename T>
-Vector<D, T>& Vector< D, T >::operator*=( T& s )
+constexpr Vector<D, T>& Vector< D, T >::operator*=( T& s )
 {
 	for ( size_t i = 0; i < D; ++i ) {
 		data[ i ] *= s;
@@ -302,7 +304,7 @@ Vector<D, T>& Vector< D, T >::operator*=( T& s )
 
 
 template<size_t D, typename T>
-Vector<D, T>& Vector<D, T>::operator/=( T& s )
+constexpr Vector<D, T>& Vector<D, T>::operator/=( T& s )
 {
 	for ( size_t i = 0; i < D; ++i ) {
 		data[ i ] /= s;
@@ -312,7 +314,7 @@ Vector<D, T>& Vector<D, T>::operator/=( T& s )
 
 
 template<size_t D, typename T>
-bool operator==( const Vector<D, T>& u, const Vector<D, T>& v )
+constexpr bool operator==( const Vector<D, T>& u, const Vector<D, T>& v )
 {
 	for ( size_t i = 0; i < D; ++i ) {
 		if ( u[ i ] != v[ i ] ) {
@@ -324,14 +326,14 @@ bool operator==( const Vector<D, T>& u, const Vector<D, T>& v )
 
 
 template<size_t D, typename T>
-bool operator !=( const Vector<D, T>& u, const Vector<D, T>& v )
+constexpr bool operator !=( const Vector<D, T>& u, const Vector<D, T>& v )
 {
 	return !( u == v );
 }
 
 
 template<size_t D, typename T>
-Vector<D, T> operator+( const Vector<D, T>& u, const Vector<D, T>& v )
+constexpr Vector<D, T> operator+( const Vector<D, T>& u, const Vector<D, T>& v )
 {
 	Vector<D, T> w;
 	for ( size_t i = 0; i < D; ++i ) {
@@ -342,7 +344,7 @@ Vector<D, T> operator+( const Vector<D, T>& u, const Vector<D, T>& v )
 
 
 template<size_t D, typename T>
-Vector<D, T> operator-( const Vector<D, T>& u, const Vector<D, T>& v )
+constexpr Vector<D, T> operator-( const Vector<D, T>& u, const Vector<D, T>& v )
 {
 	Vector<D, T> w;
 	for ( size_t i = 0; i < D; ++i ) {
@@ -353,7 +355,7 @@ Vector<D, T> operator-( const Vector<D, T>& u, const Vector<D, T>& v )
 
 
 template<size_t D, typename T>
-T Dot( const Vector<D, T>& u, const Vector<D, T>& v )
+constexpr T Dot( const Vector<D, T>& u, const Vector<D, T>& v )
 {
 	T dot( 0.0 );
 	for ( size_t i = 0; i < D; ++i ) {
@@ -364,7 +366,7 @@ T Dot( const Vector<D, T>& u, const Vector<D, T>& v )
 
 
 template<size_t D, typename T>
-Vector<D, T> operator*( T s, const Vector<D, T>& u )
+constexpr Vector<D, T> operator*( T s, const Vector<D, T>& u )
 {
 	Vector< D, T> v;
 	for ( size_t i = 0; i < D; ++i ) {
@@ -375,14 +377,14 @@ Vector<D, T> operator*( T s, const Vector<D, T>& u )
 
 
 template< size_t D, typename T >
-Vector<D, T> operator*( const Vector<D, T>& u, T s )
+constexpr Vector<D, T> operator*( const Vector<D, T>& u, T s )
 {
 	return s * u;
 }
 
 
 template< size_t D, typename T >
-Vector<D, T> operator/( const Vector<D, T>& u, T s )
+constexpr Vector<D, T> operator/( const Vector<D, T>& u, T s )
 {
 	Vector<D, T> v;
 	for ( size_t i = 0; i < D; ++i ) {
@@ -393,7 +395,7 @@ Vector<D, T> operator/( const Vector<D, T>& u, T s )
 
 
 template<typename T>
-Vector<3, T> Cross( const Vector<3, T>& u, const Vector<3, T>& v )
+constexpr Vector<3, T> Cross( const Vector<3, T>& u, const Vector<3, T>& v )
 {
 	Vector<3, T> w;
 	w[ 0 ] = u[ 1 ] * v[ 2 ] - u[ 2 ] * v[ 1 ];
@@ -424,14 +426,14 @@ T Angle( const Vector<D, T>& u, const Vector<D, T>& v )
 
 
 template<typename T>
-T TripleScalar( const Vector<3, T>& u, const Vector<3, T>& v, const Vector<3, T>& w )
+constexpr T TripleScalar( const Vector<3, T>& u, const Vector<3, T>& v, const Vector<3, T>& w )
 {
 	return Dot( Cross( u, v ), w );
 }
 
 
 template<size_t D, typename T>
-Vector<D, T> Divide( const Vector<D, T>& u, const Vector<D, T>& v )
+constexpr Vector<D, T> Divide( const Vector<D, T>& u, const Vector<D, T>& v )
 {
 	Vector<D, T> w;
 
@@ -443,7 +445,7 @@ Vector<D, T> Divide( const Vector<D, T>& u, const Vector<D, T>& v )
 
 
 template<size_t D, typename T>
-Vector<D, T> Multiply( const Vector<D, T>& u, const Vector<D, T>& v )
+constexpr Vector<D, T> Multiply( const Vector<D, T>& u, const Vector<D, T>& v )
 {
 	Vector<D, T> w;
 
@@ -455,7 +457,7 @@ Vector<D, T> Multiply( const Vector<D, T>& u, const Vector<D, T>& v )
 
 
 template<size_t SrcLength, size_t TruncNum, typename T, size_t DestLength = ( SrcLength - TruncNum )>
-Vector<DestLength, T> Trunc( const Vector< SrcLength, T>& u )
+constexpr Vector<DestLength, T> Trunc( const Vector< SrcLength, T>& u )
 {
 	Vector<DestLength, T> dstVec;
 
@@ -467,7 +469,7 @@ Vector<DestLength, T> Trunc( const Vector< SrcLength, T>& u )
 
 
 template<size_t SrcLength, size_t ConcatNum, typename T, size_t DestLength = ( SrcLength + ConcatNum )>
-Vector<DestLength, T> Concat( const Vector<SrcLength, T>& u, const T fillValue = static_cast<T>( 0.0 ) )
+constexpr Vector<DestLength, T> Concat( const Vector<SrcLength, T>& u, const T fillValue = static_cast<T>( 0.0 ) )
 {
 	Vector<DestLength, T> dstVec;
 
@@ -0,0 +1,284 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2013-2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+// Included by vector.h, do not include directly.
+// SSE specialization of Vector<4, float>. Storage stays four packed floats with unaligned loads,
+// so vertex layouts, serialized data and buffers from any allocator remain valid.
+// GFX_CONSTEXPR functions take a scalar branch during constant evaluation.
+
+inline __m128 SimdMadd( const __m128 a, const __m128 b, const __m128 c )
+{
+#if defined( GFX_SIMD_FMA )
+	return _mm_fmadd_ps( a, b, c );
+#else
+	return _mm_add_ps( _mm_mul_ps( a, b ), c );
+#endif
+}
+
+
+// Sums as ( v0 + v2 ) + ( v1 + v3 ), constexpr fallbacks use the same order
+inline float SimdHorizontalSum( const __m128 v )
+{
+	const __m128 pairs = _mm_add_ps( v, _mm_movehl_ps( v, v ) );
+	return _mm_cvtss_f32( _mm_add_ss( pairs, _mm_shuffle_ps( pairs, pairs, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) );
+}
+
+
+template <>
+class Vector<4, float>
+{
+private:
+	static constexpr float epsilon = std::numeric_limits< float >::epsilon() * 2.0f;
+	static const uint32_t version = 1;
+
+	float data[ 4 ];
+public:
+
+	static const size_t size = 4;
+
+	constexpr Vector() : data{ 0.0f, 0.0f, 0.0f, 0.0f } {}
+	constexpr Vector( const Vector<4, float>& vec ) = default;
+	constexpr Vector( const Vector<3, float>& vec, float value ) : data{ vec[ 0 ], vec[ 1 ], vec[ 2 ], value } {}
+	constexpr Vector( const Vector<5, float>& vec ) : data{ vec[ 0 ], vec[ 1 ], vec[ 2 ], vec[ 3 ] } {}
+	constexpr Vector( const float& d1 ) : data{ d1, d1, d1, d1 } {}
+	constexpr Vector( const float& d1, const float& d2 ) : data{ d1, d2, 0.0f, 0.0f } {}
+	constexpr Vector( const float& d1, const float& d2, const float& d3 ) : data{ d1, d2, d3, 0.0f } {}
+	constexpr Vector( const float& d1, const float& d2, const float& d3, const float& d4 ) : data{ d1, d2, d3, d4 } {}
+	constexpr Vector( float values[] ) : data{ values[ 0 ], values[ 1 ], values[ 2 ], values[ 3 ] } {}
+	explicit Vector( const __m128 v ) { Store( v ); }
+
+	inline __m128 Load() const
+	{
+		return _mm_loadu_ps( data );
+	}
+
+	inline void Store( const __m128 v )
+	{
+		_mm_storeu_ps( data, v );
+	}
+
+	void FlushDenorms()
+	{
+		const __m128 v = Load();
+		const __m128 mag = _mm_andnot_ps( _mm_set1_ps( -0.0f ), v );
+		const __m128 denorm = _mm_and_ps( _mm_cmplt_ps( mag, _mm_set1_ps( std::numeric_limits<float>::min() ) ), _mm_cmpgt_ps( mag, _mm_setzero_ps() ) );
+		Store( _mm_andnot_ps( _mm_or_ps( denorm, _mm_cmpunord_ps( v, v ) ), v ) );
+	}
+
+	float Length() const
+	{
+		const __m128 v = Load();
+		return _mm_cvtss_f32( _mm_sqrt_ss( _mm_set_ss( SimdHorizontalSum( _mm_mul_ps( v, v ) ) ) ) );
+	}
+
+	Vector<4, float> Normalize() const
+	{
+		float m = Length();
+		if ( m <= epsilon ) {
+			m = 1.0f;
+		}
+
+		const __m128 v = _mm_div_ps( Load(), _mm_set1_ps( m ) );
+		const __m128 mag = _mm_andnot_ps( _mm_set1_ps( -0.0f ), v );
+		return Vector<4, float>( _mm_andnot_ps( _mm_cmple_ps( mag, _mm_set1_ps( epsilon ) ), v ) );
+	}
+
+	GFX_CONSTEXPR Vector<4, float> Reverse() const
+	{
+		if ( IsConstantEvaluated() ) {
+			return Vector<4, float>( -data[ 0 ], -data[ 1 ], -data[ 2 ], -data[ 3 ] );
+		}
+		return Vector<4, float>( _mm_xor_ps( Load(), _mm_set1_ps( -0.0f ) ) );
+	}
+
+	constexpr void Zero()
+	{
+		for ( size_t i = 0; i < 4; ++i ) {
+			data[ i ] = 0.0f;
+		}
+	}
+
+	constexpr inline const float& operator []( const size_t i ) const
+	{
+		assert( i < 4 );
+		return data[ i ];
+	}
+
+	constexpr inline float& operator []( const size_t i )
+	{
+		assert( i < 4 );
+		return data[ i ];
+	}
+
+	Vector<4, float>& operator=( const Vector<4, float>& u ) = default;
+
+	GFX_CONSTEXPR Vector<4, float>& operator+=( const Vector<4, float>& u )
+	{
+		if ( IsConstantEvaluated() )
+		{
+			for ( size_t i = 0; i < 4; ++i ) {
+				data[ i ] += u.data[ i ];
+			}
+		}
+		else
+		{
+			Store( _mm_add_ps( Load(), u.Load() ) );
+		}
+		return *this;
+	}
+
+	GFX_CONSTEXPR Vector<4, float>& operator-=( const Vector<4, float>& u )
+	{
+		if ( IsConstantEvaluated() )
+		{
+			for ( size_t i = 0; i < 4; ++i ) {
+				data[ i ] -= u.data[ i ];
+			}
+		}
+		else
+		{
+			Store( _mm_sub_ps( Load(), u.Load() ) );
+		}
+		return *this;
+	}
+
+	GFX_CONSTEXPR Vector<4, float>& operator*=( float& s )
+	{
+		if ( IsConstantEvaluated() )
+		{
+			for ( size_t i = 0; i < 4; ++i ) {
+				data[ i ] *= s;
+			}
+		}
+		else
+		{
+			Store( _mm_mul_ps( Load(), _mm_set1_ps( s ) ) );
+		}
+		return *this;
+	}
+
+	GFX_CONSTEXPR Vector<4, float>& operator/=( float& s )
+	{
+		if ( IsConstantEvaluated() )
+		{
+			for ( size_t i = 0; i < 4; ++i ) {
+				data[ i ] /= s;
+			}
+		}
+		else
+		{
+			Store( _mm_div_ps( Load(), _mm_set1_ps( s ) ) );
+		}
+		return *this;
+	}
+
+	void Serialize( Serializer* serializer );
+};
+
+
+// Non-template overloads win over the generic templates in vector.h
+GFX_CONSTEXPR inline bool operator==( const vec4f& u, const vec4f& v )
+{
+	if ( IsConstantEvaluated() ) {
+		return ( u[ 0 ] == v[ 0 ] ) && ( u[ 1 ] == v[ 1 ] ) && ( u[ 2 ] == v[ 2 ] ) && ( u[ 3 ] == v[ 3 ] );
+	}
+	return ( _mm_movemask_ps( _mm_cmpeq_ps( u.Load(), v.Load() ) ) == 0xF );
+}
+
+
+GFX_CONSTEXPR inline bool operator!=( const vec4f& u, const vec4f& v )
+{
+	return !( u == v );
+}
+
+
+GFX_CONSTEXPR inline vec4f operator+( const vec4f& u, const vec4f& v )
+{
+	if ( IsConstantEvaluated() ) {
+		return vec4f( u[ 0 ] + v[ 0 ], u[ 1 ] + v[ 1 ], u[ 2 ] + v[ 2 ], u[ 3 ] + v[ 3 ] );
+	}
+	return vec4f( _mm_add_ps( u.Load(), v.Load() ) );
+}
+
+
+GFX_CONSTEXPR inline vec4f operator-( const vec4f& u, const vec4f& v )
+{
+	if ( IsConstantEvaluated() ) {
+		return vec4f( u[ 0 ] - v[ 0 ], u[ 1 ] - v[ 1 ], u[ 2 ] - v[ 2 ], u[ 3 ] - v[ 3 ] );
+	}
+	return vec4f( _mm_sub_ps( u.Load(), v.Load() ) );
+}
+
+
+GFX_CONSTEXPR inline float Dot( const vec4f& u, const vec4f& v )
+{
+	if ( IsConstantEvaluated() ) {
+		return ( u[ 0 ] * v[ 0 ] + u[ 2 ] * v[ 2 ] ) + ( u[ 1 ] * v[ 1 ] + u[ 3 ] * v[ 3 ] );
+	}
+	return SimdHorizontalSum( _mm_mul_ps( u.Load(), v.Load() ) );
+}
+
+
+GFX_CONSTEXPR inline vec4f operator*( float s, const vec4f& u )
+{
+	if ( IsConstantEvaluated() ) {
+		return vec4f( u[ 0 ] * s, u[ 1 ] * s, u[ 2 ] * s, u[ 3 ] * s );
+	}
+	return vec4f( _mm_mul_ps( u.Load(), _mm_set1_ps( s ) ) );
+}
+
+
+GFX_CONSTEXPR inline vec4f operator*( const vec4f& u, float s )
+{
+	return s * u;
+}
+
+
+GFX_CONSTEXPR inline vec4f operator/( const vec4f& u, float s )
+{
+	if ( IsConstantEvaluated() ) {
+		return vec4f( u[ 0 ] / s, u[ 1 ] / s, u[ 2 ] / s, u[ 3 ] / s );
+	}
+	return vec4f( _mm_div_ps( u.Load(), _mm_set1_ps( s ) ) );
+}
+
+
+GFX_CONSTEXPR inline vec4f Divide( const vec4f& u, const vec4f& v )
+{
+	if ( IsConstantEvaluated() ) {
+		return vec4f( u[ 0 ] / v[ 0 ], u[ 1 ] / v[ 1 ], u[ 2 ] / v[ 2 ], u[ 3 ] / v[ 3 ] );
+	}
+	return vec4f( _mm_div_ps( u.Load(), v.Load() ) );
+}
+
+
+GFX_CONSTEXPR inline vec4f Multiply( const vec4f& u, const vec4f& v )
+{
+	if ( IsConstantEvaluated() ) {
+		return vec4f( u[ 0 ] * v[ 0 ], u[ 1 ] * v[ 1 ], u[ 2 ] * v[ 2 ], u[ 3 ] * v[ 3 ] );
+	}
+	return vec4f( _mm_mul_ps( u.Load(), v.Load() ) );
+}
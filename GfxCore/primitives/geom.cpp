@@ -31,6 +31,7 @@
 #include "../image/bitmap.h"
 #include "../image/image.h"
 #include "../core/util.h"
+#include "../math/transformBatch.h"
 #include "../scene/entity.h"
 #include "../scene/assetManager.h"
 #include "../scene/resourceManager.h"
@@ -92,12 +93,22 @@ void CreateRayTraceModel( ResourceManager& rm, const uint32_t modelIx, const mat
 	using triIndices = std::tuple<uint32_t, uint32_t, uint32_t>;
 	std::map< uint32_t, std::deque<triIndices> > vertToPolyMap;
 
+	const uint32_t vertCount = vbEnd - vbOffset;
+	soaVec3f_t positions;
+	positions.Resize( vertCount );
+	for ( uint32_t i = 0; i < vertCount; ++i ) {
+		positions.Set( i, Trunc<4, 1>( rm.GetVertex( vbOffset + i )->pos ) );
+	}
+	std::vector<float> positionW( vertCount );
+	const soaTarget4f_t transformed = { positions.x.data(), positions.y.data(), positions.z.data(), positionW.data() };
+	TransformPoints( outInstance->transform, positions.Stream(), transformed, vertCount );
+
 	vec3f centroid = vec3f( 0.0f, 0.0f, 0.0f );
 	for ( uint32_t i = vbOffset; i < vbEnd; ++i )
 	{
 		vertex_t vertex = *rm.GetVertex( i );
 
-		vertex.pos = outInstance->transform * vec4f( Trunc<4,1>( vertex.pos ), 1.0 );
+		vertex.pos = vec4f( positions.Get( i - vbOffset ), positionW[ i - vbOffset ] );
 		vertex.color *= tint;
 
 		rm.PushVB( vb );
@@ -216,56 +227,117 @@ void CreateRayTraceModel( AssetManager& assets, Entity* ent, RtModel* outInstanc
 		Surface& surf = model.surfs[ surfId ];
 
 		const uint32_t vertCount = static_cast<uint32_t>( surf.vertices.size() );
+
+		// Transform every vertex once up front, triangles share them
+		soaVec3f_t positions;
+		soaVec3f_t tangents;
+		soaVec3f_t bitangents;
+		positions.Resize( vertCount );
+		tangents.Resize( vertCount );
+		bitangents.Resize( vertCount );
 		for ( uint32_t vertIx = 0; vertIx < vertCount; ++vertIx )
 		{
 			const vertex_t& vertex = surf.vertices[ vertIx ];
-			centroid += outInstance->transform * vec4f( vec3f( vertex.pos ), 1.0 );
+			positions.Set( vertIx, vec3f( vertex.pos ) );
+			tangents.Set( vertIx, vertex.tangent );
+			bitangents.Set( vertIx, vertex.bitangent );
+		}
+
+		mat3x3f basis;
+		for ( uint32_t r = 0; r < 3; ++r ) {
+			for ( uint32_t c = 0; c < 3; ++c ) {
+				basis[ r ][ c ] = outInstance->transform[ r ][ c ];
+			}
+		}
+
+		TransformPoints( outInstance->transform, positions.Stream(), positions.Target(), vertCount );
+		TransformDirections( basis, tangents.Stream(), tangents.Target(), vertCount );
+		TransformDirections( basis, bitangents.Stream(), bitangents.Target(), vertCount );
+
+		for ( uint32_t vertIx = 0; vertIx < vertCount; ++vertIx ) {
+			centroid += vec4f( positions.Get( vertIx ), 0.0f );
 		}
 
 		outInstance->centroid = vec3f( centroid / (float)( vertCount ) );
 
 		const hdl_t materialId = ( overrideMaterial != INVALID_HDL ) ? overrideMaterial : surf.materialHdl;
 
+		auto transformedVertex = [&]( const uint32_t vertIx )
+		{
+			vertex_t v = surf.vertices[ vertIx ];
+			v.pos = vec4f( positions.Get( vertIx ), 0.0f );
+			v.tangent = tangents.Get( vertIx );
+			v.bitangent = bitangents.Get( vertIx );
+			v.normal = Cross( v.tangent, v.bitangent );
+			return v;
+		};
+
 		const uint32_t indexCount = static_cast<uint32_t>( surf.indices.size() );
 		for ( uint32_t ix = 0; ix < ( indexCount - 2 ); ix += 3 )
 		{
-			uint32_t indices[ 3 ];
-			indices[ 0 ] = surf.indices[ ix + 0 ];
-			indices[ 1 ] = surf.indices[ ix + 1 ];
-			indices[ 2 ] = surf.indices[ ix + 2 ];
+			const vertex_t v0 = transformedVertex( surf.indices[ ix + 0 ] );
+			const vertex_t v1 = transformedVertex( surf.indices[ ix + 1 ] );
+			const vertex_t v2 = transformedVertex( surf.indices[ ix + 2 ] );
 
-			vertex_t v0 = surf.vertices[ indices[ 0 ] ];
-			vertex_t v1 = surf.vertices[ indices[ 1 ] ];
-			vertex_t v2 = surf.vertices[ indices[ 2 ] ];
+			outInstance->triCache.push_back( Triangle( v0, v1, v2, CLOCKWISE, materialId ) );
+		}
+	}
+	outInstance->BuildAS();
+}
 
-			v0.pos[3] = 1.0f;
-			v1.pos[3] = 1.0f;
-			v2.pos[3] = 1.0f;
 
-			v0.pos = outInstance->transform * v0.pos;
-			v1.pos = outInstance->transform * v1.pos;
-			v2.pos = outInstance->transform * v2.pos;
+bool RtModel::ClosestHit( const Ray& ray, rtHit_t& outHit ) const
+{
+	bool found = false;
+	float tMax = ray.t;
 
-			v0.bitangent = outInstance->transform * vec4f( v0.bitangent, 0.0f );
-			v1.bitangent = outInstance->transform * vec4f( v1.bitangent, 0.0f );
-			v2.bitangent = outInstance->transform * vec4f( v2.bitangent, 0.0f );
+	bvh.Traverse( ray, ray.mint, tMax, [&]( const uint32_t* prims, const uint32_t count, float& tLimit ) {
+		for ( uint32_t i = 0; i < count; ++i )
+		{
+			bool backface;
+			float t;
+			vec3f barycentrics;
+			if ( RayToTriangleIntersection( ray, triCache[ prims[ i ] ], backface, t, barycentrics ) == false ) {
+				continue;
+			}
+			if ( found && ( t >= outHit.t ) ) {
+				continue;
+			}
 
-			v0.tangent = outInstance->transform * vec4f( v0.tangent, 0.0f );
-			v1.tangent = outInstance->transform * vec4f( v1.tangent, 0.0f );
-			v2.tangent = outInstance->transform * vec4f( v2.tangent, 0.0f );
+			found = true;
+			outHit.t = t;
+			outHit.triIndex = prims[ i ];
+			outHit.barycentrics = barycentrics;
+			outHit.backface = backface;
 
-			v0.normal = Cross( v0.tangent, v0.bitangent );
-			v1.normal = Cross( v1.tangent, v1.bitangent );
-			v2.normal = Cross( v2.tangent, v2.bitangent );
+			// Nodes entered beyond this hit are culled from here on
+			tLimit = t;
+		}
+		return false;
+	} );
+	return found;
+}
 
-			v0.pos[ 3 ] = 0.0f;
-			v1.pos[ 3 ] = 0.0f;
-			v2.pos[ 3 ] = 0.0f;
 
-			outInstance->triCache.push_back( Triangle( v0, v1, v2, CLOCKWISE, materialId ) );
+bool RtModel::AnyHit( const Ray& ray, const float tMax ) const
+{
+	bool found = false;
+	float tLimit = Min( tMax, ray.t );
+
+	bvh.Traverse( ray, ray.mint, tLimit, [&]( const uint32_t* prims, const uint32_t count, float& tLeafLimit ) {
+		for ( uint32_t i = 0; i < count; ++i )
+		{
+			bool backface;
+			float t;
+			if ( RayToTriangleIntersection( ray, triCache[ prims[ i ] ], backface, t ) && ( t <= tLeafLimit ) )
+			{
+				found = true;
+				return true;
+			}
 		}
-	}
-	outInstance->BuildAS();
+		return false;
+	} );
+	return found;
 }
 
 
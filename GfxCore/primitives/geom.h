@@ -31,7 +31,7 @@
 #include "../io/meshIO.h"
 #include "../acceleration/aabb.h"
 #include "../primitives/ray.h"
-#include "../acceleration/octree.h"
+#include "../acceleration/bvh.h"
 #include "../core/common.h"
 #include "../core/handle.h"
 #include "../core/util.h"
@@ -186,33 +186,41 @@ public:
 };
 
 
+struct rtHit_t
+{
+	float		t;
+	uint32_t	triIndex;		// Into RtModel::triCache
+	vec3f		barycentrics;	// Weights of v0, v1, v2, same order as PointToBarycentric()
+	bool		backface;
+};
+
+
 class RtModel
 {
 public:
 	std::vector<Triangle>	triCache;
-	Octree<uint32_t>		octree;
+	Bvh						bvh;
 	mat4x4f					transform;
 	vec3f					centroid;
 
-	void BuildAS()
+	void BuildAS( const bvhBuildSettings_t& settings = bvhBuildSettings_t() )
 	{
-		AABB aabb;
+		const uint32_t triCnt = static_cast<uint32_t>( triCache.size() );
 
-		const size_t triCnt = triCache.size();
-		for ( size_t i = 0; i < triCnt; ++i )
-		{
-			aabb.Expand( triCache[ i ].aabb.min );
-			aabb.Expand( triCache[ i ].aabb.max );
+		std::vector<AABB> triBounds( triCnt );
+		for ( uint32_t i = 0; i < triCnt; ++i ) {
+			triBounds[ i ] = triCache[ i ].aabb;
 		}
 
-		octree = Octree<uint32_t>( aabb.min, aabb.max );
-
-		for( uint32_t i = 0; i < triCnt; ++ i )
-		{
-			// Build the octree using triangle indices
-			octree.Insert( triCache[ i ].aabb, i );
-		}
+		// Built over triangle indices, then the triangles are stored in leaf order
+		bvh.Build( triBounds.data(), triCnt, settings );
+		bvh.ReorderPrimitives( triCache );
 	}
+
+	// Ray queries against triCache, in the same space as the triangles. Rays are tested over [mint, t].
+	// Both walk the BVH front to back without allocating.
+	bool ClosestHit( const Ray& ray, rtHit_t& outHit ) const;
+	bool AnyHit( const Ray& ray, const float tMax = FLT_MAX ) const;
 };
 
 
@@ -250,7 +258,7 @@ RayToTriangleIntersection
 - MllerTrumbore ray-triangle intersection algorithm
 ===================================
 */
-inline bool RayToTriangleIntersection( const Ray& r, const Triangle& tri, bool& outBackface, float& outT )
+inline bool RayToTriangleIntersection( const Ray& r, const Triangle& tri, bool& outBackface, float& outT, vec3f& outBarycentric )
 {
 	const float		epsilon	= 1e-7f;
 	const vec3f		e0		= tri.e0;
@@ -286,6 +294,7 @@ inline bool RayToTriangleIntersection( const Ray& r, const Triangle& tri, bool&
 	if ( r.Inside( t ) ) // Within ray parameterization
 	{
 		outT = t;
+		outBarycentric = vec3f( 1.0f - u - v, u, v );
 		outBackface = ( tri.frontFace == CLOCKWISE ) ? ( det < 0.0f ) : ( det >= 0.0f );
 		return true;
 	}
@@ -295,6 +304,13 @@ inline bool RayToTriangleIntersection( const Ray& r, const Triangle& tri, bool&
 	}
 }
 
+
+inline bool RayToTriangleIntersection( const Ray& r, const Triangle& tri, bool& outBackface, float& outT )
+{
+	vec3f barycentric;
+	return RayToTriangleIntersection( r, tri, outBackface, outT, barycentric );
+}
+
 void CreateRayTraceModel( ResourceManager& rm, const uint32_t modelIx, const mat4x4f& modelMatrix, const bool smoothNormals, const Color& tint, RtModel* outInstance, const matHdl_t materialId = -1 );
 void CreateRayTraceModel( AssetManager& assets, Entity* ent, RtModel* outInstance, const hdl_t overrideMaterial = INVALID_HDL );
 uint32_t CreatePlaneModel( ResourceManager& rm, const vec2f& size, const vec2i& cellCnt, const matHdl_t materialId = -1 );
\ No newline at end of file
@@ -63,6 +63,113 @@ static void BakeLibraryAssets( AssetLib<T>& lib, const std::string& path, const
 }
 
 
+// Compresses each loaded RGBA8 image in place so both the baked file and the resident copy shrink.
+// The encoder spreads each surface across threads.
+static void CompressImageLibrary( AssetLib<Image>& lib, const bcQuality_t quality )
+{
+	const uint32_t count = lib.Count();
+	for ( uint32_t i = 0; i < count; ++i )
+	{
+		Asset<Image>* asset = lib.Find( i );
+
+		if ( ( asset->CanBake() == false ) || ( asset->IsLoaded() == false ) ) {
+			continue;
+		}
+
+		Image& image = asset->Get();
+
+		const imageFmt_t fmt = SelectCompressedFormat( image );
+		if ( fmt != image.info.fmt ) {
+			CompressImage( image, fmt, quality );
+		}
+	}
+}
+
+
+static inline bool CanResampleImage( const Asset<Image>& asset )
+{
+	if ( ( asset.CanBake() == false ) || ( asset.IsLoaded() == false ) ) {
+		return false;
+	}
+	const Image& image = asset.Get();
+	return ( image.cpuImage != nullptr ) && ( IsBlockCompressed( image.info.fmt ) == false ) && ( image.usage < IMAGE_USAGE_COUNT );
+}
+
+
+// Downsizes images that break their group's budget. Runs first so packing and compression only see final sizes.
+static void FitImageLibraryToBudget( AssetLib<Image>& lib, const imageBudget_t budgets[ IMAGE_USAGE_COUNT ] )
+{
+	const uint32_t count = lib.Count();
+	for ( uint32_t i = 0; i < count; ++i )
+	{
+		Asset<Image>* asset = lib.Find( i );
+		if ( CanResampleImage( *asset ) == false ) {
+			continue;
+		}
+
+		Image& image = asset->Get();
+		const imageBudget_t& budget = budgets[ image.usage ];
+
+		const uint32_t longestSide = Max( image.info.width, image.info.height );
+		if ( ( budget.maxDimension == 0 ) || ( longestSide <= budget.maxDimension ) ) {
+			continue;
+		}
+
+		const float scale = static_cast<float>( budget.maxDimension ) / static_cast<float>( longestSide );
+		const uint32_t width = Max( 1u, static_cast<uint32_t>( image.info.width * scale + 0.5f ) );
+		const uint32_t height = Max( 1u, static_cast<uint32_t>( image.info.height * scale + 0.5f ) );
+		ResampleImage( image, width, height, budget.filter );
+	}
+
+	for ( uint32_t usage = 0; usage < IMAGE_USAGE_COUNT; ++usage )
+	{
+		const imageBudget_t& budget = budgets[ usage ];
+		if ( budget.maxBytes == 0 ) {
+			continue;
+		}
+
+		std::vector<Image*> group;
+		uint64_t totalBytes = 0;
+		for ( uint32_t i = 0; i < count; ++i )
+		{
+			Asset<Image>* asset = lib.Find( i );
+			if ( CanResampleImage( *asset ) && ( asset->Get().usage == usage ) )
+			{
+				group.push_back( &asset->Get() );
+				totalBytes += asset->Get().cpuImage->GetByteCount();
+			}
+		}
+
+		// Halving the largest image each step spreads the loss over the textures that cost the most
+		while ( totalBytes > budget.maxBytes )
+		{
+			Image* largest = nullptr;
+			for ( Image* image : group )
+			{
+				if ( ( image->info.width <= 1 ) && ( image->info.height <= 1 ) ) {
+					continue;
+				}
+				if ( ( largest == nullptr ) || ( image->cpuImage->GetByteCount() > largest->cpuImage->GetByteCount() ) ) {
+					largest = image;
+				}
+			}
+
+			if ( largest == nullptr ) {
+				break;
+			}
+
+			const uint64_t bytesBefore = largest->cpuImage->GetByteCount();
+			const uint32_t width = Max( 1u, largest->info.width / 2 );
+			const uint32_t height = Max( 1u, largest->info.height / 2 );
+			if ( ResampleImage( *largest, width, height, budget.filter ) == false ) {
+				break;
+			}
+			totalBytes = totalBytes - bytesBefore + largest->cpuImage->GetByteCount();
+		}
+	}
+}
+
+
 void AssetBaker::AddAssetLib( AssetLib<Model>* lib, const std::string path, const std::string ext )
 {
 	m_modelLib = lib;
@@ -93,6 +200,28 @@ void AssetBaker::AddBakeDirectory( const std::string path )
 }
 
 
+void AssetBaker::SetImageCompression( const bool compress, const bcQuality_t quality )
+{
+	m_compressImages = compress;
+	m_compressQuality = quality;
+}
+
+
+void AssetBaker::SetTexturePacking( const bool pack, const texturePackSettings_t& settings )
+{
+	m_packTextures = pack;
+	m_packSettings = settings;
+}
+
+
+void AssetBaker::SetImageBudget( const imageUsage_t usage, const imageBudget_t& budget )
+{
+	if ( usage < IMAGE_USAGE_COUNT ) {
+		m_imageBudgets[ usage ] = budget;
+	}
+}
+
+
 void AssetBaker::Bake()
 {
 	s = new Serializer( MB( 128 ), serializeMode_t::STORE );
@@ -105,6 +234,14 @@ void AssetBaker::Bake()
 	if( m_imageLib != nullptr )
 	{
 		MakeDirectory( m_bakePath + m_imagePath );
+		FitImageLibraryToBudget( *m_imageLib, m_imageBudgets );
+		// Packing rewrites material texture slots, so it has to run before either library is written
+		if ( m_packTextures && ( m_materialLib != nullptr ) ) {
+			PackMaterialTextures( *m_imageLib, *m_materialLib, m_packSettings );
+		}
+		if ( m_compressImages ) {
+			CompressImageLibrary( *m_imageLib, m_compressQuality );
+		}
 		BakeLibraryAssets( *m_imageLib, m_bakePath + m_imagePath, m_imageExt );
 	}
 
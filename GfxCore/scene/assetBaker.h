@@ -1,6 +1,9 @@
 #pragma once
 #include <vector>
 #include <string>
+#include "../image/bcn.h"
+#include "../asset_types/texture.h"
+#include "texturePacker.h"
 
 template<class T>
 class AssetLib;
@@ -10,6 +13,16 @@ class Material;
 class Image;
 class GpuProgram;
 
+// Per usage group limits applied before packing and compression. Zero disables a limit.
+struct imageBudget_t
+{
+	uint32_t			maxDimension;	// Longest side, aspect ratio is kept
+	uint64_t			maxBytes;		// Total for the group, the largest images are halved until it fits
+	resampleFilter_t	filter;
+
+	imageBudget_t() : maxDimension( 0 ), maxBytes( 0 ), filter( RESAMPLE_FILTER_MITCHELL ) {}
+};
+
 class AssetBaker
 {
 private:
@@ -23,12 +36,20 @@ private:
 	AssetLib<Model>*		m_modelLib;
 	AssetLib<Material>*		m_materialLib;
 	 AssetLib<Image>*		m_imageLib;
+	bool					m_compressImages;
+	bcQuality_t				m_compressQuality;
+	bool					m_packTextures;
+	texturePackSettings_t	m_packSettings;
+	imageBudget_t			m_imageBudgets[ IMAGE_USAGE_COUNT ];
 public:
-	AssetBaker() {}
+	AssetBaker() : m_modelLib( nullptr ), m_materialLib( nullptr ), m_imageLib( nullptr ), m_compressImages( false ), m_compressQuality( BC_QUALITY_NORMAL ), m_packTextures( false ) {}
 
 	void AddAssetLib( AssetLib<Model>* lib, const std::string path, const std::string ext );
 	void AddAssetLib( AssetLib<Material>* lib, const std::string path, const std::string ext );
 	void AddAssetLib( AssetLib<Image>* lib, const std::string path, const std::string ext );
 	void AddBakeDirectory( const std::string path );
+	void SetImageCompression( const bool compress, const bcQuality_t quality = BC_QUALITY_NORMAL );
+	void SetTexturePacking( const bool pack, const texturePackSettings_t& settings = texturePackSettings_t() );
+	void SetImageBudget( const imageUsage_t usage, const imageBudget_t& budget );
 	void Bake();
 };
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "camera.h"
 
+// Out-of-class definition for C++14 odr-uses
+constexpr mat4x4f Camera::DefaultAxis;
+
 
 void Camera::SetAspectRatio( const float aspectRatio )
 {
@@ -95,10 +98,24 @@ vec4f Camera::GetOrigin() const
 
 mat4x4f Camera::GetAxis() const
 {
-	mat4x4f view = ( ComputeRotationY( Degrees( -yaw ) ) * axis ); // TODO: check if rotation mat is right direction. Just flipped the sign for now
-	view = ( ComputeRotationX( Degrees( -pitch ) ) * view );
-	view = ( ComputeRotationZ( Degrees( -roll ) ) * view );
-	return view;
+	// Rz( -roll ) * Rx( -pitch ) * Ry( -yaw ) * axis, expanded so the three angles share one sincos
+	// TODO: check if rotation mat is right direction. Just flipped the sign for now
+	vec3f s;
+	vec3f c;
+	mathDefault_t::SinCos( vec3f( -pitch, -yaw, -roll ), s, c );
+
+	const float sa = s[ 0 ];
+	const float sb = s[ 1 ];
+	const float sg = s[ 2 ];
+	const float ca = c[ 0 ];
+	const float cb = c[ 1 ];
+	const float cg = c[ 2 ];
+
+	const mat4x4f rotation = CreateMatrix4x4(	cg * cb - sg * sa * sb,		-sg * ca,	cg * sb + sg * sa * cb,		0.0f,
+												sg * cb + cg * sa * sb,		cg * ca,	sg * sb - cg * sa * cb,		0.0f,
+												-ca * sb,					sa,			ca * cb,					0.0f,
+												0.0f,						0.0f,		0.0f,						1.0f );
+	return ( rotation * axis );
 }
 
 
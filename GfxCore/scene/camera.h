@@ -87,6 +87,12 @@ private:
 	plane_t		GetFocalPlane() const;
 
 public:
+	// Rows are right, up and back: looks down world +X with right along -Y and up along -Z
+	static constexpr mat4x4f DefaultAxis = CreateMatrix4x4(	0.0f, -1.0f, 0.0f, 0.0f,
+															0.0f, 0.0f, -1.0f, 0.0f,
+															-1.0f, 0.0f, 0.0f, 0.0f,
+															0.0f, 0.0f, 0.0f, 1.0f );
+
 	void Init( const vec4f& _origin, const mat4x4f& _axis, const float _aspect = 1.0f, const float _fov = 90.0f, const float _near = 1.0f, const float _far = 1000.0f )
 	{
 		float aspectRatio = ( _aspect != 0.0f ) ? _aspect : 1.0f;
@@ -107,21 +113,12 @@ public:
 
 	Camera()
 	{
-		vec4f origin = vec4f( 0.0f, 0.0f, 0.0f, 0.0f );
-		float axisValues[ 16 ] = {	0.0f, -1.0f, 0.0f, 0.0f,
-									0.0f, 0.0f, -1.0f, 0.0f,
-									-1.0f, 0.0f, 0.0f, 0.0f,
-									0.0f, 0.0f, 0.0f, 1.0f };
-		Init( origin, mat4x4f( axisValues ) );
+		Init( vec4f( 0.0f, 0.0f, 0.0f, 0.0f ), DefaultAxis );
 	}
 
 	Camera( const vec4f& _origin )
 	{
-		float axisValues[ 16 ] = { 0.0f, -1.0f, 0.0f, 0.0f,
-									0.0f, 0.0f, -1.0f, 0.0f,
-									-1.0f, 0.0f, 0.0f, 0.0f,
-									0.0f, 0.0f, 0.0f, 1.0f };
-		Init( _origin, mat4x4f( axisValues ) );
+		Init( _origin, DefaultAxis );
 	}
 
 	Camera( const vec4f& _origin, const mat4x4f& _axis )
@@ -35,6 +35,7 @@ void Entity::ExpandBounds( const AABB& modelBounds )
 {
 	bounds.Expand( modelBounds.GetMin() );
 	bounds.Expand( modelBounds.GetMax() );
+	worldDirty = true;
 }
 
 
@@ -55,6 +56,7 @@ void Entity::SetOrigin( const vec3f& origin )
 	translation[0] = origin[ 0 ];
 	translation[1] = origin[ 1 ];
 	translation[2] = origin[ 2 ];
+	worldDirty = true;
 }
 
 
@@ -64,33 +66,81 @@ void Entity::SetScale( const vec3f& s )
 	scale[ 1 ][ 1 ] = s[ 1 ];
 	scale[ 2 ][ 2 ] = s[ 2 ];
 	scale[ 3 ][ 3 ] = 1.0f;
+	worldDirty = true;
 }
 
 
 mat4x4f Entity::GetRotation() const
 {
-	return orientation;
+	return orientation.ToMatrix();
 }
 
 
 void Entity::SetRotation( const vec3f& xyzDegrees )
 {
-	orientation = ComputeRotationZYX( xyzDegrees[ 0 ], xyzDegrees[ 1 ], xyzDegrees[ 2 ] );
+	orientation = ComputeQuaternionZYX( xyzDegrees[ 0 ], xyzDegrees[ 1 ], xyzDegrees[ 2 ] );
+	worldDirty = true;
+}
+
+
+quatf Entity::GetOrientation() const
+{
+	return orientation;
+}
+
+
+void Entity::SetOrientation( const quatf& rotation )
+{
+	orientation = rotation;
+	worldDirty = true;
 }
 
 
 mat4x4f Entity::GetMatrix() const
 {
-	mat4x4f result;
-	result = orientation * scale;
-	result[ 0 ][ 3 ] = translation[ 0 ];
-	result[ 1 ][ 3 ] = translation[ 1 ];
-	result[ 2 ][ 3 ] = translation[ 2 ];
+	mat4x4f result = GetTransform().ToMatrix();
 	result[ 3 ][ 3 ] = HasFlag( ENT_FLAG_CAMERA_LOCKED ) ? 0.0f : 1.0f;
 	return result;
 }
 
 
+const AffineTransform& Entity::GetTransform() const
+{
+	if ( worldDirty ) {
+		UpdateWorld();
+	}
+	return worldTransform;
+}
+
+
+const AffineTransform& Entity::GetInverseTransform() const
+{
+	if ( worldDirty ) {
+		UpdateWorld();
+	}
+	return worldInverse;
+}
+
+
+const AABB& Entity::GetWorldBounds() const
+{
+	if ( worldDirty ) {
+		UpdateWorld();
+	}
+	return worldBounds;
+}
+
+
+void Entity::UpdateWorld() const
+{
+	// Orientation is a unit quaternion and scale is diagonal, so the orthogonal inverse is exact
+	worldTransform = AffineTransform::FromRotationScale( GetRotation(), GetScale(), GetOrigin() );
+	worldInverse = worldTransform.InverseOrthogonal();
+	worldBounds = bounds.Transform( worldTransform );
+	worldDirty = false;
+}
+
+
 void Entity::SetFlag( const entityFlags_t flag )
 {
 	flags = static_cast<entityFlags_t>( flags | flag );
@@ -24,6 +24,7 @@
 #pragma once
 
 #include "../math/matrix.h"
+#include "../math/quaternion.h"
 #include "../core/handle.h"
 #include "../acceleration/aabb.h"
 
@@ -36,6 +37,7 @@ enum entityFlags_t
 	ENT_FLAG_WIREFRAME		= ( 1 << 3 ),
 	ENT_FLAG_DEBUG			= ( 1 << 4 ),
 	ENT_FLAG_CAMERA_LOCKED	= ( 1 << 5 ),
+	ENT_FLAG_OCCLUDER		= ( 1 << 6 ),
 };
 
 class Entity
@@ -43,7 +45,7 @@ class Entity
 public:
 	Entity()
 	{
-		orientation = mat4x4f( 1.0f );
+		orientation = quatf::Identity();
 		scale = mat4x4f( 1.0f );
 		translation = vec4f( 0.0f );
 		modelHdl = INVALID_HDL;
@@ -53,6 +55,7 @@ public:
 
 		envMap = INVALID_HDL;
 		diffuseIblMap = INVALID_HDL;
+		worldDirty = true;
 	}
 
 	Entity( const Entity& ent )
@@ -66,6 +69,7 @@ public:
 		outline = ent.flags;
 		envMap = ent.envMap;
 		diffuseIblMap = ent.diffuseIblMap;
+		worldDirty = true;
 	}
 
 	std::string		name;
@@ -84,15 +88,29 @@ public:
 	void			SetScale( const vec3f& scale );
 	mat4x4f			GetRotation() const;
 	void			SetRotation( const vec3f& xyzDegrees );
+	quatf			GetOrientation() const;
+	void			SetOrientation( const quatf& rotation );
 	mat4x4f			GetMatrix() const;
+	const AffineTransform&	GetTransform() const;
+	const AffineTransform&	GetInverseTransform() const;
+	const AABB&		GetWorldBounds() const;
 	void			SetFlag( const entityFlags_t flag );
 	void			ClearFlag( const entityFlags_t flag );
 	bool			HasFlag( const entityFlags_t flag ) const;
 
 private:
 	entityFlags_t	flags;
-	mat4x4f			orientation;
+	quatf			orientation;
+	mutable bool	worldDirty;	// Kept beside orientation so per-frame SetOrientation() touches one cache line
 	mat4x4f			scale;
 	vec4f			translation;
 	AABB			bounds;
+
+	// World space cache, rebuilt on first query after a setter marks it dirty.
+	// Not synchronized: refresh it before reading entities from several threads.
+	mutable AffineTransform	worldTransform;
+	mutable AffineTransform	worldInverse;
+	mutable AABB	worldBounds;
+
+	void			UpdateWorld() const;
 };
\ No newline at end of file
@@ -0,0 +1,626 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "iblBaker.h"
+
+#include <mutex>
+#include <vector>
+
+#include <SysCore/serializer.h>
+#include <SysCore/common.h>
+
+#include "../asset_types/texture.h"
+#include "../asset_types/material.h"
+#include "../core/parallel.h"
+#include "../core/util.h"
+
+static const uint32_t CubeFaceCount = 6;
+static const uint32_t ShCoeffCount = 9;
+static const uint32_t ShProjectionSize = 64;
+
+
+static inline vec3f CubeFaceDirection( const uint32_t face, const float u, const float v )
+{
+	const float s = 2.0f * u - 1.0f;
+	const float t = 2.0f * v - 1.0f;
+
+	vec3f dir;
+	switch ( face )
+	{
+		case IMAGE_CUBE_FACE_X_POS: dir = vec3f( 1.0f, -t, -s );	break;
+		case IMAGE_CUBE_FACE_X_NEG: dir = vec3f( -1.0f, -t, s );	break;
+		case IMAGE_CUBE_FACE_Y_POS: dir = vec3f( s, 1.0f, t );		break;
+		case IMAGE_CUBE_FACE_Y_NEG: dir = vec3f( s, -1.0f, -t );	break;
+		case IMAGE_CUBE_FACE_Z_POS: dir = vec3f( s, -t, 1.0f );		break;
+		default:					dir = vec3f( -s, -t, -1.0f );	break;
+	}
+	return dir.Normalize();
+}
+
+
+static inline void CubeFaceCoords( const vec3f& dir, uint32_t& face, float& u, float& v )
+{
+	const float ax = fabsf( dir[ 0 ] );
+	const float ay = fabsf( dir[ 1 ] );
+	const float az = fabsf( dir[ 2 ] );
+
+	float ma, s, t;
+	if ( ( ax >= ay ) && ( ax >= az ) )
+	{
+		face = ( dir[ 0 ] > 0.0f ) ? IMAGE_CUBE_FACE_X_POS : IMAGE_CUBE_FACE_X_NEG;
+		ma = ax;
+		s = ( dir[ 0 ] > 0.0f ) ? -dir[ 2 ] : dir[ 2 ];
+		t = -dir[ 1 ];
+	}
+	else if ( ay >= az )
+	{
+		face = ( dir[ 1 ] > 0.0f ) ? IMAGE_CUBE_FACE_Y_POS : IMAGE_CUBE_FACE_Y_NEG;
+		ma = ay;
+		s = dir[ 0 ];
+		t = ( dir[ 1 ] > 0.0f ) ? dir[ 2 ] : -dir[ 2 ];
+	}
+	else
+	{
+		face = ( dir[ 2 ] > 0.0f ) ? IMAGE_CUBE_FACE_Z_POS : IMAGE_CUBE_FACE_Z_NEG;
+		ma = az;
+		s = ( dir[ 2 ] > 0.0f ) ? dir[ 0 ] : -dir[ 0 ];
+		t = -dir[ 1 ];
+	}
+
+	u = 0.5f * ( s / ma + 1.0f );
+	v = 0.5f * ( t / ma + 1.0f );
+}
+
+
+static inline Color SampleSlice( const slice_t& slice, const float fx, const float fy, const bool wrapX )
+{
+	const Color* texels = reinterpret_cast<const Color*>( slice.ptr );
+	const int32_t w = static_cast<int32_t>( slice.width );
+	const int32_t h = static_cast<int32_t>( slice.height );
+
+	const float x = fx - 0.5f;
+	const float y = Clamp( fy - 0.5f, 0.0f, static_cast<float>( h - 1 ) );
+
+	const int32_t x0 = static_cast<int32_t>( floorf( x ) );
+	const int32_t y0 = static_cast<int32_t>( floorf( y ) );
+	const float tx = x - static_cast<float>( x0 );
+	const float ty = y - static_cast<float>( y0 );
+
+	int32_t xa, xb;
+	if ( wrapX )
+	{
+		xa = ( ( x0 % w ) + w ) % w;
+		xb = ( xa + 1 ) % w;
+	}
+	else
+	{
+		xa = Clamp( x0, 0, w - 1 );
+		xb = Clamp( x0 + 1, 0, w - 1 );
+	}
+	const int32_t ya = Clamp( y0, 0, h - 1 );
+	const int32_t yb = Clamp( y0 + 1, 0, h - 1 );
+
+	const Color top = ( 1.0f - tx ) * texels[ ya * w + xa ] + tx * texels[ ya * w + xb ];
+	const Color bottom = ( 1.0f - tx ) * texels[ yb * w + xa ] + tx * texels[ yb * w + xb ];
+	return ( 1.0f - ty ) * top + ty * bottom;
+}
+
+
+static inline Color SampleCube( const ImageBuffer<Color>& cube, const vec3f& dir, const uint32_t mip )
+{
+	uint32_t face;
+	float u, v;
+	CubeFaceCoords( dir, face, u, v );
+
+	const slice_t slice = cube.GetSlice( face, mip );
+	return SampleSlice( slice, u * slice.width, v * slice.height, false );
+}
+
+
+static inline Color SampleCubeLod( const ImageBuffer<Color>& cube, const vec3f& dir, const float lod )
+{
+	const float maxLod = static_cast<float>( cube.GetMipCount() - 1 );
+	const float level = Clamp( lod, 0.0f, maxLod );
+
+	const uint32_t mip0 = static_cast<uint32_t>( level );
+	const uint32_t mip1 = Min( mip0 + 1, cube.GetMipCount() - 1 );
+	const float t = level - static_cast<float>( mip0 );
+
+	const Color c0 = SampleCube( cube, dir, mip0 );
+	if ( ( t <= 0.0f ) || ( mip0 == mip1 ) ) {
+		return c0;
+	}
+	return ( 1.0f - t ) * c0 + t * SampleCube( cube, dir, mip1 );
+}
+
+
+static inline float RadicalInverse( uint32_t bits )
+{
+	bits = ( bits << 16u ) | ( bits >> 16u );
+	bits = ( ( bits & 0x55555555u ) << 1u ) | ( ( bits & 0xAAAAAAAAu ) >> 1u );
+	bits = ( ( bits & 0x33333333u ) << 2u ) | ( ( bits & 0xCCCCCCCCu ) >> 2u );
+	bits = ( ( bits & 0x0F0F0F0Fu ) << 4u ) | ( ( bits & 0xF0F0F0F0u ) >> 4u );
+	bits = ( ( bits & 0x00FF00FFu ) << 8u ) | ( ( bits & 0xFF00FF00u ) >> 8u );
+	return static_cast<float>( bits ) * 2.3283064365386963e-10f;
+}
+
+
+// Half vector around +Z distributed by D( h ) * NoH
+static inline vec3f ImportanceSampleGGX( const uint32_t i, const uint32_t count, const float alpha )
+{
+	const float u = static_cast<float>( i ) / static_cast<float>( count );
+	const float v = RadicalInverse( i );
+
+	const float phi = 2.0f * PI * u;
+	const float cosTheta = sqrtf( ( 1.0f - v ) / ( 1.0f + ( alpha * alpha - 1.0f ) * v ) );
+	const float sinTheta = sqrtf( Max( 0.0f, 1.0f - cosTheta * cosTheta ) );
+
+	float sinPhi;
+	float cosPhi;
+	mathDefault_t::SinCos( phi, sinPhi, cosPhi );
+	return vec3f( sinTheta * cosPhi, sinTheta * sinPhi, cosTheta );
+}
+
+
+static inline float TexelAreaElement( const float x, const float y )
+{
+	return atan2f( x * y, sqrtf( x * x + y * y + 1.0f ) );
+}
+
+
+static inline float TexelSolidAngle( const uint32_t x, const uint32_t y, const uint32_t size )
+{
+	const float invSize = 1.0f / static_cast<float>( size );
+	const float s = 2.0f * ( static_cast<float>( x ) + 0.5f ) * invSize - 1.0f;
+	const float t = 2.0f * ( static_cast<float>( y ) + 0.5f ) * invSize - 1.0f;
+
+	const float x0 = s - invSize;
+	const float x1 = s + invSize;
+	const float y0 = t - invSize;
+	const float y1 = t + invSize;
+
+	return TexelAreaElement( x0, y0 ) - TexelAreaElement( x0, y1 ) - TexelAreaElement( x1, y0 ) + TexelAreaElement( x1, y1 );
+}
+
+
+static inline void ShBasis( const vec3f& d, float basis[ ShCoeffCount ] )
+{
+	const float x = d[ 0 ];
+	const float y = d[ 1 ];
+	const float z = d[ 2 ];
+
+	basis[ 0 ] = 0.282095f;
+	basis[ 1 ] = 0.488603f * y;
+	basis[ 2 ] = 0.488603f * z;
+	basis[ 3 ] = 0.488603f * x;
+	basis[ 4 ] = 1.092548f * x * y;
+	basis[ 5 ] = 1.092548f * y * z;
+	basis[ 6 ] = 0.315392f * ( 3.0f * z * z - 1.0f );
+	basis[ 7 ] = 1.092548f * x * z;
+	basis[ 8 ] = 0.546274f * ( x * x - y * y );
+}
+
+
+static void InitCubeBuffer( const uint32_t faceSize, const uint32_t mipCount, ImageBuffer<Color>& cube )
+{
+	imageBufferInfo_t info {};
+	info.width = faceSize;
+	info.height = faceSize;
+	info.layers = CubeFaceCount;
+	info.mipCount = mipCount;
+	info.bpp = sizeof( Color );
+
+	cube.Init( info );
+}
+
+
+static void BuildCubeMips( ImageBuffer<Color>& cube )
+{
+	for ( uint32_t mip = 1; mip < cube.GetMipCount(); ++mip )
+	{
+		ParallelFor( CubeFaceCount, 1, [&]( const uint32_t begin, const uint32_t end )
+		{
+			for ( uint32_t face = begin; face < end; ++face )
+			{
+				const slice_t src = cube.GetSlice( face, mip - 1 );
+				const slice_t dst = cube.GetSlice( face, mip );
+				const Color* srcTexels = reinterpret_cast<const Color*>( src.ptr );
+				Color* dstTexels = reinterpret_cast<Color*>( dst.ptr );
+
+				for ( uint32_t y = 0; y < dst.height; ++y )
+				{
+					const uint32_t y0 = Min( 2 * y, src.height - 1 );
+					const uint32_t y1 = Min( 2 * y + 1, src.height - 1 );
+					for ( uint32_t x = 0; x < dst.width; ++x )
+					{
+						const uint32_t x0 = Min( 2 * x, src.width - 1 );
+						const uint32_t x1 = Min( 2 * x + 1, src.width - 1 );
+
+						const Color sum = srcTexels[ y0 * src.width + x0 ] + srcTexels[ y0 * src.width + x1 ]
+										+ srcTexels[ y1 * src.width + x0 ] + srcTexels[ y1 * src.width + x1 ];
+						dstTexels[ y * dst.width + x ] = 0.25f * sum;
+					}
+				}
+			}
+		} );
+	}
+}
+
+
+// Runs body( face, mip, x, y, dir ) for every texel of the cube, one face row per job
+template<class Body>
+static void ForEachCubeTexel( ImageBuffer<Color>& cube, const uint32_t mip, const Body& body )
+{
+	const slice_t first = cube.GetSlice( 0, mip );
+	const uint32_t rows = first.height;
+
+	ParallelFor( CubeFaceCount * rows, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t row = begin; row < end; ++row )
+		{
+			const uint32_t face = row / rows;
+			const uint32_t y = row % rows;
+
+			const slice_t slice = cube.GetSlice( face, mip );
+			Color* texels = reinterpret_cast<Color*>( slice.ptr ) + y * slice.width;
+
+			const float v = ( static_cast<float>( y ) + 0.5f ) / static_cast<float>( slice.height );
+			for ( uint32_t x = 0; x < slice.width; ++x )
+			{
+				const float u = ( static_cast<float>( x ) + 0.5f ) / static_cast<float>( slice.width );
+				texels[ x ] = body( CubeFaceDirection( face, u, v ) );
+			}
+		}
+	} );
+}
+
+
+static bool ReadHdrImage( const Image& image, ImageBuffer<Color>& buffer )
+{
+	if ( ( image.cpuImage == nullptr ) || ( image.info.fmt != IMAGE_FMT_RGBA_16 ) ) {
+		return false;
+	}
+	ImageConvert( *static_cast<const ImageBuffer<rgba16_t>*>( image.cpuImage ), buffer );
+	return true;
+}
+
+
+static void StoreHdrImage( const ImageBuffer<Color>& buffer, const imageType_t type, const samplerAddress_t addrMode, Image& image )
+{
+	ImageBuffer<rgba16_t>* halfImage = new ImageBuffer<rgba16_t>();
+	ImageConvert( buffer, *halfImage );
+
+	imageInfo_t info = DefaultImage2dInfo( buffer.GetWidth(), buffer.GetHeight() );
+	info.layers = buffer.GetLayers();
+	info.mipLevels = buffer.GetMipCount();
+	info.type = type;
+	info.fmt = IMAGE_FMT_RGBA_16;
+	info.tiling = IMAGE_TILING_LINEAR;
+
+	image.Destroy();
+	image.Create( info, halfImage, nullptr );
+	image.generateMips = false;
+	image.sampler.addrMode = addrMode;
+	image.sampler.filter = ( info.mipLevels > 1 ) ? SAMPLER_FILTER_TRILINEAR : SAMPLER_FILTER_BILINEAR;
+}
+
+
+bool BakeEnvironmentCube( const Image& equirect, const uint32_t faceSize, Image& envCube )
+{
+	ImageBuffer<Color> panorama;
+	if ( ReadHdrImage( equirect, panorama ) == false ) {
+		return false;
+	}
+
+	ImageBuffer<Color> cube;
+	InitCubeBuffer( faceSize, MipCount( faceSize, faceSize ), cube );
+
+	const slice_t src = panorama.GetSlice( 0, 0 );
+	ForEachCubeTexel( cube, 0, [&]( const vec3f& dir )
+	{
+		const float phi = atan2f( dir[ 2 ], dir[ 0 ] );
+		const float theta = mathDefault_t::Acos( Clamp( dir[ 1 ], -1.0f, 1.0f ) );
+
+		const float u = 0.5f + phi / ( 2.0f * PI );
+		const float v = theta / PI;
+		return SampleSlice( src, u * src.width, v * src.height, true );
+	} );
+
+	BuildCubeMips( cube );
+
+	StoreHdrImage( cube, IMAGE_TYPE_CUBE, SAMPLER_ADDRESS_CLAMP_EDGE, envCube );
+	return true;
+}
+
+
+bool BakeIrradianceCube( const Image& envCube, const uint32_t faceSize, Image& irradianceCube )
+{
+	ImageBuffer<Color> env;
+	if ( ( envCube.info.type != IMAGE_TYPE_CUBE ) || ( ReadHdrImage( envCube, env ) == false ) ) {
+		return false;
+	}
+
+	// Irradiance is band limited, so project from a small mip
+	uint32_t mip = 0;
+	while ( ( mip + 1 < env.GetMipCount() ) && ( env.GetSlice( 0, mip ).width > ShProjectionSize ) ) {
+		++mip;
+	}
+	const uint32_t size = env.GetSlice( 0, mip ).width;
+
+	std::mutex shLock;
+	Color sh[ ShCoeffCount ];
+	float totalWeight = 0.0f;
+
+	ParallelFor( CubeFaceCount * size, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		Color partial[ ShCoeffCount ];
+		float partialWeight = 0.0f;
+
+		for ( uint32_t row = begin; row < end; ++row )
+		{
+			const uint32_t face = row / size;
+			const uint32_t y = row % size;
+
+			const Color* texels = reinterpret_cast<const Color*>( env.GetSlice( face, mip ).ptr ) + y * size;
+			const float v = ( static_cast<float>( y ) + 0.5f ) / static_cast<float>( size );
+
+			for ( uint32_t x = 0; x < size; ++x )
+			{
+				const float u = ( static_cast<float>( x ) + 0.5f ) / static_cast<float>( size );
+				const float weight = TexelSolidAngle( x, y, size );
+
+				float basis[ ShCoeffCount ];
+				ShBasis( CubeFaceDirection( face, u, v ), basis );
+
+				for ( uint32_t i = 0; i < ShCoeffCount; ++i ) {
+					partial[ i ] += ( basis[ i ] * weight ) * texels[ x ];
+				}
+				partialWeight += weight;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock( shLock );
+		for ( uint32_t i = 0; i < ShCoeffCount; ++i ) {
+			sh[ i ] += partial[ i ];
+		}
+		totalWeight += partialWeight;
+	} );
+
+	// Fold in the cosine lobe convolution and the 1/PI of the Lambert BRDF
+	const float bandScale[ 3 ] = { 1.0f, 2.0f / 3.0f, 0.25f };
+	const float normalize = ( 4.0f * PI ) / Max( totalWeight, 1e-6f );
+	for ( uint32_t i = 0; i < ShCoeffCount; ++i )
+	{
+		const uint32_t band = ( i == 0 ) ? 0 : ( ( i < 4 ) ? 1 : 2 );
+		sh[ i ] = sh[ i ] * ( bandScale[ band ] * normalize );
+	}
+
+	ImageBuffer<Color> irradiance;
+	InitCubeBuffer( faceSize, 1, irradiance );
+
+	ForEachCubeTexel( irradiance, 0, [&]( const vec3f& dir )
+	{
+		float basis[ ShCoeffCount ];
+		ShBasis( dir, basis );
+
+		Color result( 0.0f, 0.0f, 0.0f, 0.0f );
+		for ( uint32_t i = 0; i < ShCoeffCount; ++i ) {
+			result += basis[ i ] * sh[ i ];
+		}
+		return Color( Max( result[ 0 ], 0.0f ), Max( result[ 1 ], 0.0f ), Max( result[ 2 ], 0.0f ), 1.0f );
+	} );
+
+	StoreHdrImage( irradiance, IMAGE_TYPE_CUBE, SAMPLER_ADDRESS_CLAMP_EDGE, irradianceCube );
+	return true;
+}
+
+
+bool BakeSpecularCube( const Image& envCube, const uint32_t faceSize, const uint32_t mipCount, const uint32_t sampleCount, Image& specularCube )
+{
+	ImageBuffer<Color> env;
+	if ( ( envCube.info.type != IMAGE_TYPE_CUBE ) || ( ReadHdrImage( envCube, env ) == false ) ) {
+		return false;
+	}
+
+	const uint32_t mips = Clamp( mipCount, 1u, MipCount( faceSize, faceSize ) );
+	const uint32_t envSize = env.GetWidth();
+	const float texelSolidAngle = ( 4.0f * PI ) / ( CubeFaceCount * envSize * envSize );
+
+	ImageBuffer<Color> specular;
+	InitCubeBuffer( faceSize, mips, specular );
+
+	struct lightSample_t
+	{
+		vec3f	dir;	// Tangent space, N = V = +Z
+		float	NoL;
+		float	lod;
+	};
+	std::vector<lightSample_t> samples;
+	samples.reserve( sampleCount );
+
+	for ( uint32_t mip = 0; mip < mips; ++mip )
+	{
+		const float roughness = ( mips > 1 ) ? ( static_cast<float>( mip ) / static_cast<float>( mips - 1 ) ) : 0.0f;
+		const float alpha = roughness * roughness;
+
+		// A mirror lobe is just the environment itself, resampled to this mip's size
+		if ( alpha <= 0.0f )
+		{
+			const float lod = log2f( static_cast<float>( envSize ) / static_cast<float>( specular.GetSlice( 0, mip ).width ) );
+			ForEachCubeTexel( specular, mip, [&]( const vec3f& dir ) {
+				return SampleCubeLod( env, dir, lod );
+			} );
+			continue;
+		}
+
+		// The lobe only depends on roughness once N = V, so build it once per mip.
+		// Each sample reads from the env mip whose texel footprint matches its pdf to avoid fireflies.
+		samples.clear();
+		for ( uint32_t i = 0; i < sampleCount; ++i )
+		{
+			const vec3f h = ImportanceSampleGGX( i, sampleCount, alpha );
+			const float NoH = h[ 2 ];
+
+			lightSample_t sample;
+			sample.dir = vec3f( 2.0f * NoH * h[ 0 ], 2.0f * NoH * h[ 1 ], 2.0f * NoH * NoH - 1.0f );
+			sample.NoL = sample.dir[ 2 ];
+			if ( sample.NoL <= 0.0f ) {
+				continue;
+			}
+
+			const float pdf = 0.25f * GGX( NoH, alpha );
+			const float sampleSolidAngle = 1.0f / ( static_cast<float>( sampleCount ) * pdf + 1e-6f );
+			sample.lod = Max( 0.5f * log2f( sampleSolidAngle / texelSolidAngle ) + 1.0f, 0.0f );
+
+			samples.push_back( sample );
+		}
+
+		ForEachCubeTexel( specular, mip, [&]( const vec3f& n )
+		{
+			const vec3f up = ( fabsf( n[ 2 ] ) < 0.999f ) ? vec3f( 0.0f, 0.0f, 1.0f ) : vec3f( 1.0f, 0.0f, 0.0f );
+			const vec3f tangent = Cross( up, n ).Normalize();
+			const vec3f bitangent = Cross( n, tangent );
+
+			Color sum( 0.0f, 0.0f, 0.0f, 0.0f );
+			float weight = 0.0f;
+			for ( const lightSample_t& sample : samples )
+			{
+				const vec3f l = sample.dir[ 0 ] * tangent + sample.dir[ 1 ] * bitangent + sample.dir[ 2 ] * n;
+				sum += sample.NoL * SampleCubeLod( env, l, sample.lod );
+				weight += sample.NoL;
+			}
+			const Color result = ( 1.0f / Max( weight, 1e-6f ) ) * sum;
+			return Color( result[ 0 ], result[ 1 ], result[ 2 ], 1.0f );
+		} );
+	}
+
+	StoreHdrImage( specular, IMAGE_TYPE_CUBE, SAMPLER_ADDRESS_CLAMP_EDGE, specularCube );
+	return true;
+}
+
+
+bool BakeBrdfLut( const uint32_t size, const uint32_t sampleCount, Image& brdfLut )
+{
+	ImageBuffer<Color> lut;
+
+	imageBufferInfo_t info {};
+	info.width = size;
+	info.height = size;
+	info.layers = 1;
+	info.mipCount = 1;
+	info.bpp = sizeof( Color );
+	lut.Init( info );
+
+	Color* texels = reinterpret_cast<Color*>( lut.GetSlice( 0, 0 ).ptr );
+
+	ParallelFor( size, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t y = begin; y < end; ++y )
+		{
+			const float roughness = ( static_cast<float>( y ) + 0.5f ) / static_cast<float>( size );
+			const float alpha = roughness * roughness;
+
+			for ( uint32_t x = 0; x < size; ++x )
+			{
+				const float NoV = ( static_cast<float>( x ) + 0.5f ) / static_cast<float>( size );
+				const vec3f v = vec3f( sqrtf( 1.0f - NoV * NoV ), 0.0f, NoV );
+
+				float scale = 0.0f;
+				float bias = 0.0f;
+				for ( uint32_t i = 0; i < sampleCount; ++i )
+				{
+					const vec3f h = ImportanceSampleGGX( i, sampleCount, alpha );
+					const float VoH = Dot( v, h );
+					const vec3f l = ( 2.0f * VoH ) * h - v;
+
+					const float NoL = l[ 2 ];
+					const float NoH = h[ 2 ];
+					if ( ( NoL <= 0.0f ) || ( VoH <= 0.0f ) ) {
+						continue;
+					}
+
+					// D cancels against the sample pdf D * NoH / ( 4 * VoH )
+					const float visibility = SmithGGXCorrelated( NoV, NoL, alpha ) * ( 4.0f * NoL * VoH / NoH );
+					const float m = 1.0f - VoH;
+					const float fresnel = ( m * m ) * ( m * m ) * m;
+
+					scale += ( 1.0f - fresnel ) * visibility;
+					bias += fresnel * visibility;
+				}
+
+				const float invCount = 1.0f / static_cast<float>( sampleCount );
+				texels[ y * size + x ] = Color( scale * invCount, bias * invCount, 0.0f, 1.0f );
+			}
+		}
+	} );
+
+	StoreHdrImage( lut, IMAGE_TYPE_2D, SAMPLER_ADDRESS_CLAMP_EDGE, brdfLut );
+	return true;
+}
+
+
+bool WriteImageAsset( const std::string& fileName, Image& image )
+{
+	if ( image.cpuImage == nullptr ) {
+		return false;
+	}
+
+	Serializer s( image.cpuImage->GetByteCount() + KB( 4 ), serializeMode_t::STORE );
+	image.Serialize( &s );
+
+	if ( s.Status() != serializeStatus_t::OK ) {
+		return false;
+	}
+	s.WriteFile( fileName );
+	return true;
+}
+
+
+bool BakeIbl( const Image& equirect, const iblBakeSettings_t& settings, const std::string& path, const std::string& envName, const std::string& diffuseName, const std::string& specName, const std::string& brdfName )
+{
+	Image envCube;
+	if ( BakeEnvironmentCube( equirect, settings.envSize, envCube ) == false ) {
+		return false;
+	}
+
+	Image irradianceCube;
+	Image specularCube;
+	Image brdfLut;
+
+	bool baked = true;
+	baked = baked && BakeIrradianceCube( envCube, settings.irradianceSize, irradianceCube );
+	baked = baked && BakeSpecularCube( envCube, settings.specularSize, settings.specularMips, settings.specularSamples, specularCube );
+	baked = baked && BakeBrdfLut( settings.brdfLutSize, settings.brdfLutSamples, brdfLut );
+
+	if ( baked == false ) {
+		return false;
+	}
+
+	bool written = true;
+	written = WriteImageAsset( path + envName + ".img", envCube ) && written;
+	written = WriteImageAsset( path + diffuseName + ".img", irradianceCube ) && written;
+	written = WriteImageAsset( path + specName + ".img", specularCube ) && written;
+	written = WriteImageAsset( path + brdfName + ".img", brdfLut ) && written;
+	return written;
+}
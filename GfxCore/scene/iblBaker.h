@@ -0,0 +1,71 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <string>
+
+class Image;
+
+struct iblBakeSettings_t
+{
+	uint32_t	envSize;			// Face size of the radiance cube converted from the equirect
+	uint32_t	irradianceSize;		// Face size of the diffuse irradiance cube
+	uint32_t	specularSize;		// Face size of the top mip of the prefiltered specular cube
+	uint32_t	specularMips;		// Roughness steps, mip i is prefiltered for roughness i / ( specularMips - 1 )
+	uint32_t	specularSamples;	// GGX importance samples per specular texel
+	uint32_t	brdfLutSize;
+	uint32_t	brdfLutSamples;
+
+	iblBakeSettings_t() :
+		envSize( 512 ),
+		irradianceSize( 32 ),
+		specularSize( 256 ),
+		specularMips( 6 ),
+		specularSamples( 256 ),
+		brdfLutSize( 128 ),
+		brdfLutSamples( 512 )
+	{}
+};
+
+/* === IBL Baker - CPU prefiltering of an HDR environment for split-sum image based lighting === */
+// Every stage reads and writes IMAGE_FMT_RGBA_16 images and spreads its texels across threads.
+
+// Resamples an equirect panorama into a cube with a full box filtered mip chain
+bool BakeEnvironmentCube( const Image& equirect, const uint32_t faceSize, Image& envCube );
+
+// Diffuse irradiance from an order 2 SH projection, stored divided by PI so the shader multiplies by albedo only
+bool BakeIrradianceCube( const Image& envCube, const uint32_t faceSize, Image& irradianceCube );
+
+// GGX prefiltered radiance, one roughness step per mip
+bool BakeSpecularCube( const Image& envCube, const uint32_t faceSize, const uint32_t mipCount, const uint32_t sampleCount, Image& specularCube );
+
+// Split-sum environment BRDF, x = NoV, y = perceptual roughness, rg = ( scale, bias ) applied to F0
+bool BakeBrdfLut( const uint32_t size, const uint32_t sampleCount, Image& brdfLut );
+
+// Writes the image as a .img asset that ImageLoader can read back
+bool WriteImageAsset( const std::string& fileName, Image& image );
+
+// Runs every stage and writes <path><name>.img for the env, diffuse, specular and BRDF images
+bool BakeIbl( const Image& equirect, const iblBakeSettings_t& settings, const std::string& path, const std::string& envName, const std::string& diffuseName, const std::string& specName, const std::string& brdfName );
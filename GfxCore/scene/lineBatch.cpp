@@ -0,0 +1,475 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#include "lineBatch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "entity.h"
+#include "../asset_types/model.h"
+#include "../core/parallel.h"
+#include "../image/blend.h"
+
+static const uint32_t ProjectGrainSize = 4096;
+static const uint32_t BinChunkSize = 4096;
+static const float ClipNearW = 1e-5f;
+static const float TilePadding = 2.0f;	// Wu lines touch one texel past the ideal line on either side
+
+// Screen space with texel centers on integer coordinates
+struct screenLine_t
+{
+	float		x0;
+	float		y0;
+	float		x1;
+	float		y1;
+	Color		color;
+	bool		visible;
+};
+
+struct tileRect_t
+{
+	int32_t		x0;
+	int32_t		y0;
+	int32_t		x1;
+	int32_t		y1;
+};
+
+
+struct lineBlendAlpha_t
+{
+	inline void operator()( Color& dst, const Color& src, const float coverage ) const
+	{
+		const float alpha = src[ 3 ] * coverage;
+		for ( uint32_t c = 0; c < 4; ++c ) {
+			dst[ c ] += ( src[ c ] - dst[ c ] ) * alpha;
+		}
+	}
+};
+
+struct lineBlendAdd_t
+{
+	inline void operator()( Color& dst, const Color& src, const float coverage ) const
+	{
+		for ( uint32_t c = 0; c < 4; ++c ) {
+			dst[ c ] += src[ c ] * coverage;
+		}
+	}
+};
+
+// Coverage masks the result of the blend equation
+template<blendMode_t Mode>
+struct lineBlendMasked_t
+{
+	inline void operator()( Color& dst, const Color& src, const float coverage ) const
+	{
+		dst = Lerp( dst, BlendColor<Mode>( src, dst ), coverage );
+	}
+};
+
+
+// Liang-Barsky against w > 0 and the x/y frustum planes, depth is left alone
+static bool ClipLineHomogeneous( vec4f& a, vec4f& b )
+{
+	float t0 = 0.0f;
+	float t1 = 1.0f;
+
+	for ( uint32_t plane = 0; plane < 5; ++plane )
+	{
+		float d0;
+		float d1;
+		switch ( plane )
+		{
+			case 0: d0 = a[ 3 ] - ClipNearW;	d1 = b[ 3 ] - ClipNearW;	break;
+			case 1: d0 = a[ 3 ] + a[ 0 ];		d1 = b[ 3 ] + b[ 0 ];		break;
+			case 2: d0 = a[ 3 ] - a[ 0 ];		d1 = b[ 3 ] - b[ 0 ];		break;
+			case 3: d0 = a[ 3 ] + a[ 1 ];		d1 = b[ 3 ] + b[ 1 ];		break;
+			default: d0 = a[ 3 ] - a[ 1 ];		d1 = b[ 3 ] - b[ 1 ];		break;
+		}
+
+		if ( ( d0 < 0.0f ) && ( d1 < 0.0f ) ) {
+			return false;
+		}
+		if ( d0 < 0.0f ) {
+			t0 = Max( t0, d0 / ( d0 - d1 ) );
+		} else if ( d1 < 0.0f ) {
+			t1 = Min( t1, d0 / ( d0 - d1 ) );
+		}
+	}
+
+	if ( t0 > t1 ) {
+		return false;
+	}
+
+	const vec4f delta = b - a;
+	b = a + t1 * delta;
+	a = a + t0 * delta;
+	return true;
+}
+
+
+template<class Visit>
+static void ForEachLineTile( const screenLine_t& line, const uint32_t tilesX, const uint32_t tilesY, const Visit& visit )
+{
+	const float tileSize = static_cast<float>( LineBatch::TileSize );
+	const float minY = Min( line.y0, line.y1 );
+	const float maxY = Max( line.y0, line.y1 );
+	const float dy = line.y1 - line.y0;
+
+	const int32_t tileY0 = Max( 0, static_cast<int32_t>( floorf( ( minY - TilePadding ) / tileSize ) ) );
+	const int32_t tileY1 = Min( static_cast<int32_t>( tilesY ) - 1, static_cast<int32_t>( floorf( ( maxY + TilePadding ) / tileSize ) ) );
+
+	for ( int32_t ty = tileY0; ty <= tileY1; ++ty )
+	{
+		// X extent of the segment inside this padded band of rows
+		const float bandLo = Max( minY, ty * tileSize - TilePadding );
+		const float bandHi = Min( maxY, ( ty + 1 ) * tileSize + TilePadding );
+
+		float xa = line.x0;
+		float xb = line.x1;
+		if ( fabsf( dy ) > 1e-6f )
+		{
+			const float slope = ( line.x1 - line.x0 ) / dy;
+			xa = line.x0 + ( bandLo - line.y0 ) * slope;
+			xb = line.x0 + ( bandHi - line.y0 ) * slope;
+		}
+
+		const int32_t tileX0 = Max( 0, static_cast<int32_t>( floorf( ( Min( xa, xb ) - TilePadding ) / tileSize ) ) );
+		const int32_t tileX1 = Min( static_cast<int32_t>( tilesX ) - 1, static_cast<int32_t>( floorf( ( Max( xa, xb ) + TilePadding ) / tileSize ) ) );
+		for ( int32_t tx = tileX0; tx <= tileX1; ++tx ) {
+			visit( static_cast<uint32_t>( ty ) * tilesX + static_cast<uint32_t>( tx ) );
+		}
+	}
+}
+
+
+// Both line paths step along the major axis from the unclipped endpoints, so every tile
+// computes the same texels for a line and nothing is doubled or dropped at tile seams
+template<class Blend>
+static void DrawTileLines( const tileRect_t& tile, const std::vector<screenLine_t>& lines, const uint32_t* indices, const uint32_t count, const bool antiAlias, const Blend& blend, Color* texels, const uint32_t width )
+{
+	for ( uint32_t i = 0; i < count; ++i )
+	{
+		const screenLine_t& line = lines[ indices[ i ] ];
+
+		const bool steep = fabsf( line.y1 - line.y0 ) > fabsf( line.x1 - line.x0 );
+		float x0 = steep ? line.y0 : line.x0;
+		float y0 = steep ? line.x0 : line.y0;
+		float x1 = steep ? line.y1 : line.x1;
+		float y1 = steep ? line.x1 : line.y1;
+		if ( x0 > x1 )
+		{
+			std::swap( x0, x1 );
+			std::swap( y0, y1 );
+		}
+
+		const float gradient = ( x1 > x0 ) ? ( ( y1 - y0 ) / ( x1 - x0 ) ) : 0.0f;
+		const int32_t majorLo = steep ? tile.y0 : tile.x0;
+		const int32_t majorHi = steep ? tile.y1 : tile.x1;
+
+		auto plot = [&]( const int32_t major, const int32_t minor, const float coverage )
+		{
+			const int32_t x = steep ? minor : major;
+			const int32_t y = steep ? major : minor;
+			if ( ( x >= tile.x0 ) && ( x <= tile.x1 ) && ( y >= tile.y0 ) && ( y <= tile.y1 ) && ( coverage > 0.0f ) ) {
+				blend( texels[ static_cast<size_t>( y ) * width + x ], line.color, coverage );
+			}
+		};
+
+		const int32_t start = static_cast<int32_t>( floorf( x0 + 0.5f ) );
+		const int32_t end = static_cast<int32_t>( floorf( x1 + 0.5f ) );
+
+		if ( !antiAlias )
+		{
+			for ( int32_t x = Max( start, majorLo ); x <= Min( end, majorHi ); ++x )
+			{
+				const float y = y0 + gradient * ( static_cast<float>( x ) - x0 );
+				plot( x, static_cast<int32_t>( floorf( y + 0.5f ) ), 1.0f );
+			}
+			continue;
+		}
+
+		// Xiaolin Wu, endpoints are weighted by how much of their texel the segment covers
+		const float startY = y0 + gradient * ( static_cast<float>( start ) - x0 );
+		const float endY = y1 + gradient * ( static_cast<float>( end ) - x1 );
+
+		if ( start == end )
+		{
+			const float gap = x1 - x0;
+			const float fy = startY - floorf( startY );
+			plot( start, static_cast<int32_t>( floorf( startY ) ), ( 1.0f - fy ) * gap );
+			plot( start, static_cast<int32_t>( floorf( startY ) ) + 1, fy * gap );
+			continue;
+		}
+
+		if ( ( start >= majorLo ) && ( start <= majorHi ) )
+		{
+			const float gap = 1.0f - ( ( x0 + 0.5f ) - floorf( x0 + 0.5f ) );
+			const float fy = startY - floorf( startY );
+			plot( start, static_cast<int32_t>( floorf( startY ) ), ( 1.0f - fy ) * gap );
+			plot( start, static_cast<int32_t>( floorf( startY ) ) + 1, fy * gap );
+		}
+
+		if ( ( end >= majorLo ) && ( end <= majorHi ) )
+		{
+			const float gap = ( x1 + 0.5f ) - floorf( x1 + 0.5f );
+			const float fy = endY - floorf( endY );
+			plot( end, static_cast<int32_t>( floorf( endY ) ), ( 1.0f - fy ) * gap );
+			plot( end, static_cast<int32_t>( floorf( endY ) ) + 1, fy * gap );
+		}
+
+		for ( int32_t x = Max( start + 1, majorLo ); x <= Min( end - 1, majorHi ); ++x )
+		{
+			const float y = startY + gradient * static_cast<float>( x - start );
+			const float fy = y - floorf( y );
+			plot( x, static_cast<int32_t>( floorf( y ) ), 1.0f - fy );
+			plot( x, static_cast<int32_t>( floorf( y ) ) + 1, fy );
+		}
+	}
+}
+
+
+void LineBatch::Reserve( const uint32_t lineCount )
+{
+	m_lines.reserve( lineCount );
+}
+
+
+void LineBatch::Clear()
+{
+	m_lines.clear();
+}
+
+
+uint32_t LineBatch::GetLineCount() const
+{
+	return static_cast<uint32_t>( m_lines.size() );
+}
+
+
+void LineBatch::AddLine( const vec3f& start, const vec3f& end, const Color& color )
+{
+	line_t line;
+	line.start = start;
+	line.end = end;
+	line.color = color;
+	m_lines.push_back( line );
+}
+
+
+void LineBatch::AddBox( const vec3f& minCorner, const vec3f& maxCorner, const Color& color )
+{
+	vec3f corners[ 8 ];
+	for ( uint32_t i = 0; i < 8; ++i ) {
+		corners[ i ] = vec3f( ( i & 1 ) ? maxCorner[ 0 ] : minCorner[ 0 ], ( i & 2 ) ? maxCorner[ 1 ] : minCorner[ 1 ], ( i & 4 ) ? maxCorner[ 2 ] : minCorner[ 2 ] );
+	}
+
+	// Corners differing in exactly one bit share an edge
+	for ( uint32_t i = 0; i < 8; ++i ) {
+		for ( uint32_t bit = 1; bit < 8; bit <<= 1 ) {
+			if ( ( i & bit ) == 0 ) {
+				AddLine( corners[ i ], corners[ i | bit ], color );
+			}
+		}
+	}
+}
+
+
+void LineBatch::AddWireframe( const Model& model, const mat4x4f& modelMatrix, const Color& color )
+{
+	std::vector<uint64_t> edges;
+	for ( const Surface& surface : model.surfs )
+	{
+		// Triangles share most of their edges, draw each one once so alpha blended wires stay even
+		edges.clear();
+		edges.reserve( surface.indices.size() );
+		for ( size_t i = 0; ( i + 2 ) < surface.indices.size(); i += 3 )
+		{
+			for ( uint32_t e = 0; e < 3; ++e )
+			{
+				const uint64_t a = surface.indices[ i + e ];
+				const uint64_t b = surface.indices[ i + ( ( e + 1 ) % 3 ) ];
+				edges.push_back( ( a < b ) ? ( ( a << 32 ) | b ) : ( ( b << 32 ) | a ) );
+			}
+		}
+		std::sort( edges.begin(), edges.end() );
+		edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+
+		m_lines.reserve( m_lines.size() + edges.size() );
+		for ( const uint64_t edge : edges )
+		{
+			const uint32_t a = static_cast<uint32_t>( edge >> 32 );
+			const uint32_t b = static_cast<uint32_t>( edge & 0xFFFFFFFF );
+			if ( ( a >= surface.vertices.size() ) || ( b >= surface.vertices.size() ) ) {
+				continue;
+			}
+
+			const vec4f& pa = surface.vertices[ a ].pos;
+			const vec4f& pb = surface.vertices[ b ].pos;
+			const vec4f wa = modelMatrix * vec4f( pa[ 0 ], pa[ 1 ], pa[ 2 ], 1.0f );
+			const vec4f wb = modelMatrix * vec4f( pb[ 0 ], pb[ 1 ], pb[ 2 ], 1.0f );
+			AddLine( vec3f( wa[ 0 ], wa[ 1 ], wa[ 2 ] ), vec3f( wb[ 0 ], wb[ 1 ], wb[ 2 ] ), color );
+		}
+	}
+}
+
+
+void LineBatch::AddWireframe( const Entity& entity, const Model& model, const Color& color )
+{
+	AddWireframe( model, entity.GetMatrix(), color );
+}
+
+
+void LineBatch::Draw( ImageBuffer<Color>& image, const mat4x4f& viewProjection, const lineDrawSettings_t& settings ) const
+{
+	const uint32_t width = image.GetWidth();
+	const uint32_t height = image.GetHeight();
+	const uint32_t lineCount = static_cast<uint32_t>( m_lines.size() );
+	if ( ( width == 0 ) || ( height == 0 ) || ( lineCount == 0 ) ) {
+		return;
+	}
+
+	const float w = static_cast<float>( width );
+	const float h = static_cast<float>( height );
+
+	std::vector<screenLine_t> lines( lineCount );
+	ParallelFor( lineCount, ProjectGrainSize, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t i = begin; i < end; ++i )
+		{
+			const line_t& src = m_lines[ i ];
+			screenLine_t& dst = lines[ i ];
+
+			vec4f a = viewProjection * vec4f( src.start[ 0 ], src.start[ 1 ], src.start[ 2 ], 1.0f );
+			vec4f b = viewProjection * vec4f( src.end[ 0 ], src.end[ 1 ], src.end[ 2 ], 1.0f );
+			dst.visible = ClipLineHomogeneous( a, b );
+			if ( !dst.visible ) {
+				continue;
+			}
+
+			// The clip leaves NDC within [-1, 1] up to rounding, clamp so the texel range stays on the image
+			dst.x0 = Clamp( ( a[ 0 ] / a[ 3 ] * 0.5f + 0.5f ) * w - 0.5f, -0.5f, w - 0.5f );
+			dst.y0 = Clamp( ( 0.5f - a[ 1 ] / a[ 3 ] * 0.5f ) * h - 0.5f, -0.5f, h - 0.5f );
+			dst.x1 = Clamp( ( b[ 0 ] / b[ 3 ] * 0.5f + 0.5f ) * w - 0.5f, -0.5f, w - 0.5f );
+			dst.y1 = Clamp( ( 0.5f - b[ 1 ] / b[ 3 ] * 0.5f ) * h - 0.5f, -0.5f, h - 0.5f );
+			dst.color = src.color;
+		}
+	} );
+
+	// Per chunk counts keep the scatter parallel and submission order inside each tile
+	const uint32_t tilesX = ( width + TileSize - 1 ) / TileSize;
+	const uint32_t tilesY = ( height + TileSize - 1 ) / TileSize;
+	const uint32_t tileCount = tilesX * tilesY;
+	const uint32_t chunkCount = ( lineCount + BinChunkSize - 1 ) / BinChunkSize;
+
+	std::vector<uint32_t> chunkOffsets( static_cast<size_t>( chunkCount ) * tileCount, 0 );
+	ParallelFor( chunkCount, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t chunk = begin; chunk < end; ++chunk )
+		{
+			uint32_t* counts = &chunkOffsets[ static_cast<size_t>( chunk ) * tileCount ];
+			const uint32_t last = Min( lineCount, ( chunk + 1 ) * BinChunkSize );
+			for ( uint32_t i = chunk * BinChunkSize; i < last; ++i )
+			{
+				if ( lines[ i ].visible ) {
+					ForEachLineTile( lines[ i ], tilesX, tilesY, [&]( const uint32_t tile ) { ++counts[ tile ]; } );
+				}
+			}
+		}
+	} );
+
+	std::vector<uint32_t> tileOffsets( tileCount + 1 );
+	uint32_t offset = 0;
+	for ( uint32_t tile = 0; tile < tileCount; ++tile )
+	{
+		tileOffsets[ tile ] = offset;
+		for ( uint32_t chunk = 0; chunk < chunkCount; ++chunk )
+		{
+			uint32_t& slot = chunkOffsets[ static_cast<size_t>( chunk ) * tileCount + tile ];
+			const uint32_t count = slot;
+			slot = offset;
+			offset += count;
+		}
+	}
+	tileOffsets[ tileCount ] = offset;
+
+	std::vector<uint32_t> tileLines( offset );
+	ParallelFor( chunkCount, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t chunk = begin; chunk < end; ++chunk )
+		{
+			uint32_t* cursor = &chunkOffsets[ static_cast<size_t>( chunk ) * tileCount ];
+			const uint32_t last = Min( lineCount, ( chunk + 1 ) * BinChunkSize );
+			for ( uint32_t i = chunk * BinChunkSize; i < last; ++i )
+			{
+				if ( lines[ i ].visible ) {
+					ForEachLineTile( lines[ i ], tilesX, tilesY, [&]( const uint32_t tile ) { tileLines[ cursor[ tile ]++ ] = i; } );
+				}
+			}
+		}
+	} );
+
+	Color* texels = reinterpret_cast<Color*>( image.GetSlice( 0, 0 ).ptr );
+	ParallelFor( tileCount, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t tile = begin; tile < end; ++tile )
+		{
+			const uint32_t count = tileOffsets[ tile + 1 ] - tileOffsets[ tile ];
+			if ( count == 0 ) {
+				continue;
+			}
+
+			tileRect_t rect;
+			rect.x0 = static_cast<int32_t>( ( tile % tilesX ) * TileSize );
+			rect.y0 = static_cast<int32_t>( ( tile / tilesX ) * TileSize );
+			rect.x1 = Min( rect.x0 + static_cast<int32_t>( TileSize ), static_cast<int32_t>( width ) ) - 1;
+			rect.y1 = Min( rect.y0 + static_cast<int32_t>( TileSize ), static_cast<int32_t>( height ) ) - 1;
+
+			const uint32_t* indices = &tileLines[ tileOffsets[ tile ] ];
+
+			// Pick the blend once per tile instead of switching per texel
+			const bool aa = settings.antiAlias;
+			switch ( settings.blendMode )
+			{
+				case blendMode_t::SRCALPHA:		DrawTileLines( rect, lines, indices, count, aa, lineBlendAlpha_t(), texels, width );							break;
+				case blendMode_t::ADD:			DrawTileLines( rect, lines, indices, count, aa, lineBlendAdd_t(), texels, width );								break;
+				case blendMode_t::DESTALPHA:	DrawTileLines( rect, lines, indices, count, aa, lineBlendMasked_t<blendMode_t::DESTALPHA>(), texels, width );		break;
+				case blendMode_t::INVSRCALPHA:	DrawTileLines( rect, lines, indices, count, aa, lineBlendMasked_t<blendMode_t::INVSRCALPHA>(), texels, width );	break;
+				case blendMode_t::INVDESTALPHA:	DrawTileLines( rect, lines, indices, count, aa, lineBlendMasked_t<blendMode_t::INVDESTALPHA>(), texels, width );	break;
+				case blendMode_t::DESTCOLOR:	break;	// Leaves the destination as is
+				case blendMode_t::INVSRCCOLOR:	DrawTileLines( rect, lines, indices, count, aa, lineBlendMasked_t<blendMode_t::INVSRCCOLOR>(), texels, width );	break;
+				case blendMode_t::INVDESTCOLOR:	DrawTileLines( rect, lines, indices, count, aa, lineBlendMasked_t<blendMode_t::INVDESTCOLOR>(), texels, width );	break;
+				case blendMode_t::ZERO:			DrawTileLines( rect, lines, indices, count, aa, lineBlendMasked_t<blendMode_t::ZERO>(), texels, width );			break;
+				case blendMode_t::ONE:			DrawTileLines( rect, lines, indices, count, aa, lineBlendMasked_t<blendMode_t::ONE>(), texels, width );			break;
+				case blendMode_t::SUBTRACT:		DrawTileLines( rect, lines, indices, count, aa, lineBlendMasked_t<blendMode_t::SUBTRACT>(), texels, width );		break;
+				case blendMode_t::REVSUBTRACT:	DrawTileLines( rect, lines, indices, count, aa, lineBlendMasked_t<blendMode_t::REVSUBTRACT>(), texels, width );	break;
+				case blendMode_t::MIN:			DrawTileLines( rect, lines, indices, count, aa, lineBlendMasked_t<blendMode_t::MIN>(), texels, width );			break;
+				case blendMode_t::MAX:			DrawTileLines( rect, lines, indices, count, aa, lineBlendMasked_t<blendMode_t::MAX>(), texels, width );			break;
+				case blendMode_t::XOR:			DrawTileLines( rect, lines, indices, count, aa, lineBlendMasked_t<blendMode_t::XOR>(), texels, width );			break;
+				default:						DrawTileLines( rect, lines, indices, count, aa, lineBlendMasked_t<blendMode_t::SRCCOLOR>(), texels, width );		break;
+			}
+		}
+	} );
+}
@@ -0,0 +1,75 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <vector>
+
+#include "../math/vector.h"
+#include "../math/matrix.h"
+#include "../image/color.h"
+#include "../image/image.h"
+
+class Model;
+class Entity;
+
+struct lineDrawSettings_t
+{
+	bool			antiAlias;		// Xiaolin Wu lines, coverage scales the source alpha
+	blendMode_t		blendMode;		// SRCALPHA and ADD scale the source by coverage, other modes are masked by it
+
+	lineDrawSettings_t() : antiAlias( true ), blendMode( blendMode_t::SRCALPHA ) {}
+};
+
+/* === LineBatch - World space debug lines drawn in bulk === */
+// Draw() projects and clips every segment against the view frustum in parallel, bins the survivors into
+// screen tiles and rasterizes each tile on its own thread. Lines touching a tile blend in submission order.
+// Screen space matches Rasterizer: column vector matrices and row 0 at the top of the image.
+class LineBatch
+{
+public:
+	static const uint32_t TileSize = 64;
+
+	void			Reserve( const uint32_t lineCount );
+	void			Clear();
+	uint32_t		GetLineCount() const;
+
+	void			AddLine( const vec3f& start, const vec3f& end, const Color& color );
+	void			AddBox( const vec3f& minCorner, const vec3f& maxCorner, const Color& color );
+	void			AddWireframe( const Model& model, const mat4x4f& modelMatrix, const Color& color );
+	void			AddWireframe( const Entity& entity, const Model& model, const Color& color );
+
+	void			Draw( ImageBuffer<Color>& image, const mat4x4f& viewProjection, const lineDrawSettings_t& settings ) const;
+
+private:
+	struct line_t
+	{
+		vec3f		start;
+		vec3f		end;
+		Color		color;
+	};
+
+	std::vector<line_t>	m_lines;
+};
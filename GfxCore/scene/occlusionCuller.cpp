@@ -0,0 +1,756 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#include "occlusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "camera.h"
+#include "entity.h"
+#include "../asset_types/model.h"
+#include "../core/parallel.h"
+#include "../core/simd.h"
+
+static const uint32_t RowBandSize = 8;
+static const uint32_t CullGrainSize = 4096;	// Multiple of 64 so threads never share a visibility word
+static const uint32_t ClipPlaneCount = 5;
+static const uint32_t MaxClipVertices = 3 + ClipPlaneCount;
+static const float MinProjectedW = 1e-6f;
+
+
+#if defined( GFX_SIMD_SSE )
+using cullLane_t = __m128;
+
+static inline cullLane_t LaneSet( const float v )							{ return _mm_set1_ps( v ); }
+static inline cullLane_t LaneLoad( const float v[ 4 ] )						{ return _mm_loadu_ps( v ); }
+static inline void LaneStore( const cullLane_t& a, float v[ 4 ] )			{ _mm_storeu_ps( v, a ); }
+static inline cullLane_t LaneAdd( const cullLane_t& a, const cullLane_t& b )	{ return _mm_add_ps( a, b ); }
+static inline cullLane_t LaneMul( const cullLane_t& a, const cullLane_t& b )	{ return _mm_mul_ps( a, b ); }
+static inline cullLane_t LaneDiv( const cullLane_t& a, const cullLane_t& b )	{ return _mm_div_ps( a, b ); }
+static inline cullLane_t LaneMin( const cullLane_t& a, const cullLane_t& b )	{ return _mm_min_ps( a, b ); }
+static inline cullLane_t LaneMax( const cullLane_t& a, const cullLane_t& b )	{ return _mm_max_ps( a, b ); }
+static inline uint32_t LaneLess( const cullLane_t& a, const cullLane_t& b )	{ return static_cast<uint32_t>( _mm_movemask_ps( _mm_cmplt_ps( a, b ) ) ); }
+#else
+struct cullLane_t
+{
+	float v[ 4 ];
+};
+
+#define CULL_LANE_OP( name, expr )									\
+static inline cullLane_t name( const cullLane_t& a, const cullLane_t& b )	\
+{																	\
+	cullLane_t r;													\
+	for ( uint32_t i = 0; i < 4; ++i ) {							\
+		r.v[ i ] = expr;											\
+	}																\
+	return r;														\
+}
+
+CULL_LANE_OP( LaneAdd, a.v[ i ] + b.v[ i ] )
+CULL_LANE_OP( LaneMul, a.v[ i ] * b.v[ i ] )
+CULL_LANE_OP( LaneDiv, a.v[ i ] / b.v[ i ] )
+CULL_LANE_OP( LaneMin, Min( a.v[ i ], b.v[ i ] ) )
+CULL_LANE_OP( LaneMax, Max( a.v[ i ], b.v[ i ] ) )
+
+#undef CULL_LANE_OP
+
+static inline cullLane_t LaneSet( const float v )
+{
+	cullLane_t r;
+	for ( uint32_t i = 0; i < 4; ++i ) {
+		r.v[ i ] = v;
+	}
+	return r;
+}
+
+static inline cullLane_t LaneLoad( const float v[ 4 ] )
+{
+	cullLane_t r;
+	for ( uint32_t i = 0; i < 4; ++i ) {
+		r.v[ i ] = v[ i ];
+	}
+	return r;
+}
+
+static inline void LaneStore( const cullLane_t& a, float v[ 4 ] )
+{
+	for ( uint32_t i = 0; i < 4; ++i ) {
+		v[ i ] = a.v[ i ];
+	}
+}
+
+static inline uint32_t LaneLess( const cullLane_t& a, const cullLane_t& b )
+{
+	uint32_t bits = 0;
+	for ( uint32_t i = 0; i < 4; ++i ) {
+		bits |= ( a.v[ i ] < b.v[ i ] ) ? ( 1u << i ) : 0u;
+	}
+	return bits;
+}
+#endif
+
+
+// Signed distance to the clip planes, 0 <= z, -w <= x <= w, -w <= y <= w. The far plane is left to the depth test.
+static inline float ClipDistance( const float pos[ 4 ], const uint32_t plane )
+{
+	switch ( plane )
+	{
+		case 0: return pos[ 2 ];
+		case 1: return pos[ 3 ] + pos[ 0 ];
+		case 2: return pos[ 3 ] - pos[ 0 ];
+		case 3: return pos[ 3 ] + pos[ 1 ];
+		default: return pos[ 3 ] - pos[ 1 ];
+	}
+}
+
+
+static inline uint32_t ClipOutcode( const float pos[ 4 ] )
+{
+	uint32_t code = 0;
+	for ( uint32_t plane = 0; plane < ClipPlaneCount; ++plane ) {
+		code |= ( ClipDistance( pos, plane ) < 0.0f ) ? ( 1u << plane ) : 0u;
+	}
+	return code;
+}
+
+
+static inline uint32_t LaneCount( const uint32_t bits )
+{
+	return ( bits & 1u ) + ( ( bits >> 1 ) & 1u ) + ( ( bits >> 2 ) & 1u ) + ( ( bits >> 3 ) & 1u );
+}
+
+
+OcclusionCuller::OcclusionCuller() : m_cullMode( RASTER_CULL_BACK )
+{
+	for ( uint32_t i = 0; i < 16; ++i ) {
+		m_viewProjection[ i ] = ( ( i % 5 ) == 0 ) ? 1.0f : 0.0f;
+	}
+}
+
+
+void OcclusionCuller::Init( const uint32_t width, const uint32_t height )
+{
+	uint32_t mipCount = 1;
+	while ( ( Max( width, height ) >> mipCount ) > 0 ) {
+		++mipCount;
+	}
+
+	imageBufferInfo_t info {};
+	info.width = width;
+	info.height = height;
+	info.layers = 1;
+	info.mipCount = mipCount;
+	info.bpp = sizeof( float );
+
+	m_depth.Init( info, "_occlusionDepth" );
+	m_depth.Clear( 1.0f );
+	m_triangles.clear();
+}
+
+
+void OcclusionCuller::SetCullMode( const rasterCullMode_t cullMode )
+{
+	m_cullMode = cullMode;
+}
+
+
+void OcclusionCuller::Begin( const mat4x4f& viewProjection )
+{
+	for ( uint32_t r = 0; r < 4; ++r ) {
+		for ( uint32_t c = 0; c < 4; ++c ) {
+			m_viewProjection[ r * 4 + c ] = viewProjection[ r ][ c ];
+		}
+	}
+
+	m_depth.Clear( 1.0f );
+	m_triangles.clear();
+}
+
+
+void OcclusionCuller::Begin( const Camera& camera )
+{
+	Begin( RasterViewProjection( camera ) );
+}
+
+
+void OcclusionCuller::AddOccluder( const Model& model, const mat4x4f& modelMatrix )
+{
+	// Occluders are few and coarse, transform straight into clip space while recording
+	const mat4x4f mvp = [&]()
+	{
+		mat4x4f vp;
+		for ( uint32_t r = 0; r < 4; ++r ) {
+			for ( uint32_t c = 0; c < 4; ++c ) {
+				vp[ r ][ c ] = m_viewProjection[ r * 4 + c ];
+			}
+		}
+		return vp * modelMatrix;
+	}();
+
+	std::vector<float> clipPositions;
+	for ( const Surface& surface : model.surfs )
+	{
+		const uint32_t vertexCount = static_cast<uint32_t>( surface.vertices.size() );
+		clipPositions.resize( 4 * static_cast<size_t>( vertexCount ) );
+
+		for ( uint32_t i = 0; i < vertexCount; ++i )
+		{
+			const vec4f& pos = surface.vertices[ i ].pos;
+			for ( uint32_t r = 0; r < 4; ++r ) {
+				clipPositions[ 4 * i + r ] = mvp[ r ][ 0 ] * pos[ 0 ] + mvp[ r ][ 1 ] * pos[ 1 ] + mvp[ r ][ 2 ] * pos[ 2 ] + mvp[ r ][ 3 ];
+			}
+		}
+
+		const uint32_t triangleCount = static_cast<uint32_t>( surface.indices.size() / 3 );
+		for ( uint32_t t = 0; t < triangleCount; ++t )
+		{
+			const uint32_t i0 = surface.indices[ 3 * t + 0 ];
+			const uint32_t i1 = surface.indices[ 3 * t + 1 ];
+			const uint32_t i2 = surface.indices[ 3 * t + 2 ];
+			if ( ( i0 >= vertexCount ) || ( i1 >= vertexCount ) || ( i2 >= vertexCount ) ) {
+				continue;
+			}
+			const uint32_t triIndices[ 3 ] = { i0, i1, i2 };
+
+			float verts[ MaxClipVertices ][ 4 ];
+			uint32_t outcodeAnd = ~0u;
+			uint32_t outcodeOr = 0;
+			for ( uint32_t i = 0; i < 3; ++i )
+			{
+				const float* src = &clipPositions[ 4 * static_cast<size_t>( triIndices[ i ] ) ];
+				for ( uint32_t c = 0; c < 4; ++c ) {
+					verts[ i ][ c ] = src[ c ];
+				}
+				const uint32_t code = ClipOutcode( verts[ i ] );
+				outcodeAnd &= code;
+				outcodeOr |= code;
+			}
+
+			if ( outcodeAnd != 0 ) {
+				continue;
+			}
+
+			if ( outcodeOr == 0 ) {
+				SetupTriangle( verts );
+				continue;
+			}
+
+			// Sutherland-Hodgman in homogeneous space against only the planes this triangle crosses
+			uint32_t count = 3;
+			for ( uint32_t plane = 0; ( plane < ClipPlaneCount ) && ( count >= 3 ); ++plane )
+			{
+				if ( ( outcodeOr & ( 1u << plane ) ) == 0 ) {
+					continue;
+				}
+
+				float clipped[ MaxClipVertices ][ 4 ];
+				uint32_t clippedCount = 0;
+				for ( uint32_t i = 0; i < count; ++i )
+				{
+					const float* a = verts[ i ];
+					const float* b = verts[ ( i + 1 ) % count ];
+					const float da = ClipDistance( a, plane );
+					const float db = ClipDistance( b, plane );
+
+					if ( da >= 0.0f )
+					{
+						for ( uint32_t c = 0; c < 4; ++c ) {
+							clipped[ clippedCount ][ c ] = a[ c ];
+						}
+						++clippedCount;
+					}
+					if ( ( da >= 0.0f ) != ( db >= 0.0f ) )
+					{
+						const float s = da / ( da - db );
+						for ( uint32_t c = 0; c < 4; ++c ) {
+							clipped[ clippedCount ][ c ] = a[ c ] + s * ( b[ c ] - a[ c ] );
+						}
+						++clippedCount;
+					}
+				}
+
+				count = clippedCount;
+				for ( uint32_t i = 0; i < count; ++i ) {
+					for ( uint32_t c = 0; c < 4; ++c ) {
+						verts[ i ][ c ] = clipped[ i ][ c ];
+					}
+				}
+			}
+
+			for ( uint32_t i = 2; i < count; ++i )
+			{
+				const float fan[ 3 ][ 4 ] = {
+					{ verts[ 0 ][ 0 ], verts[ 0 ][ 1 ], verts[ 0 ][ 2 ], verts[ 0 ][ 3 ] },
+					{ verts[ i - 1 ][ 0 ], verts[ i - 1 ][ 1 ], verts[ i - 1 ][ 2 ], verts[ i - 1 ][ 3 ] },
+					{ verts[ i ][ 0 ], verts[ i ][ 1 ], verts[ i ][ 2 ], verts[ i ][ 3 ] },
+				};
+				SetupTriangle( fan );
+			}
+		}
+	}
+}
+
+
+void OcclusionCuller::AddOccluder( const Entity& entity, const Model& model )
+{
+	AddOccluder( model, entity.GetMatrix() );
+}
+
+
+void OcclusionCuller::SetupTriangle( const float clip[ 3 ][ 4 ] )
+{
+	const float width = static_cast<float>( m_depth.GetWidth() );
+	const float height = static_cast<float>( m_depth.GetHeight() );
+
+	float x[ 3 ], y[ 3 ], z[ 3 ];
+	for ( uint32_t i = 0; i < 3; ++i )
+	{
+		const float invW = 1.0f / clip[ i ][ 3 ];
+		x[ i ] = ( clip[ i ][ 0 ] * invW * 0.5f + 0.5f ) * width;
+		y[ i ] = ( 0.5f - clip[ i ][ 1 ] * invW * 0.5f ) * height;
+		z[ i ] = clip[ i ][ 2 ] * invW;
+	}
+
+	triangle_t tri;
+	for ( uint32_t i = 0; i < 3; ++i )
+	{
+		const uint32_t j = ( i + 1 ) % 3;
+		const uint32_t k = ( i + 2 ) % 3;
+		tri.edge[ i ][ 0 ] = y[ j ] - y[ k ];
+		tri.edge[ i ][ 1 ] = x[ k ] - x[ j ];
+		tri.edge[ i ][ 2 ] = x[ j ] * y[ k ] - x[ k ] * y[ j ];
+	}
+
+	float area = tri.edge[ 0 ][ 0 ] * x[ 0 ] + tri.edge[ 0 ][ 1 ] * y[ 0 ] + tri.edge[ 0 ][ 2 ];
+	if ( ( area == 0.0f ) || !std::isfinite( area ) ) {
+		return;
+	}
+
+	// Same winding convention as the Rasterizer, counter-clockwise in NDC is front facing
+	const bool frontFacing = ( area < 0.0f );
+	if ( ( m_cullMode == RASTER_CULL_BACK ) && !frontFacing ) {
+		return;
+	}
+	if ( ( m_cullMode == RASTER_CULL_FRONT ) && frontFacing ) {
+		return;
+	}
+
+	if ( area < 0.0f )
+	{
+		area = -area;
+		for ( uint32_t i = 0; i < 3; ++i ) {
+			for ( uint32_t c = 0; c < 3; ++c ) {
+				tri.edge[ i ][ c ] = -tri.edge[ i ][ c ];
+			}
+		}
+	}
+
+	tri.minX = Max( 0, static_cast<int32_t>( ceilf( Min( x[ 0 ], Min( x[ 1 ], x[ 2 ] ) ) - 0.5f ) ) );
+	tri.minY = Max( 0, static_cast<int32_t>( ceilf( Min( y[ 0 ], Min( y[ 1 ], y[ 2 ] ) ) - 0.5f ) ) );
+	tri.maxX = Min( static_cast<int32_t>( m_depth.GetWidth() ) - 1, static_cast<int32_t>( floorf( Max( x[ 0 ], Max( x[ 1 ], x[ 2 ] ) ) - 0.5f ) ) );
+	tri.maxY = Min( static_cast<int32_t>( m_depth.GetHeight() ) - 1, static_cast<int32_t>( floorf( Max( y[ 0 ], Max( y[ 1 ], y[ 2 ] ) ) - 0.5f ) ) );
+	if ( ( tri.minX > tri.maxX ) || ( tri.minY > tri.maxY ) ) {
+		return;
+	}
+
+	const float invArea = 1.0f / area;
+	for ( uint32_t c = 0; c < 3; ++c ) {
+		tri.depth[ c ] = ( tri.edge[ 0 ][ c ] * z[ 0 ] + tri.edge[ 1 ][ c ] * z[ 1 ] + tri.edge[ 2 ][ c ] * z[ 2 ] ) * invArea;
+	}
+
+	// Bake the half pixel offset in so every plane is evaluated at integer pixel coordinates
+	auto centerPlane = []( float plane[ 3 ] ) {
+		plane[ 2 ] += 0.5f * ( plane[ 0 ] + plane[ 1 ] );
+	};
+
+	for ( uint32_t i = 0; i < 3; ++i ) {
+		centerPlane( tri.edge[ i ] );
+	}
+	centerPlane( tri.depth );
+
+	m_triangles.push_back( tri );
+}
+
+
+void OcclusionCuller::Flush()
+{
+	const uint32_t height = m_depth.GetHeight();
+	if ( height == 0 ) {
+		return;
+	}
+
+	if ( !m_triangles.empty() )
+	{
+		const uint32_t bandCount = ( height + RowBandSize - 1 ) / RowBandSize;
+		ParallelFor( bandCount, 1, [&]( const uint32_t begin, const uint32_t end )
+		{
+			for ( uint32_t band = begin; band < end; ++band ) {
+				RasterizeRows( band * RowBandSize, Min( height, ( band + 1 ) * RowBandSize ) - 1 );
+			}
+		} );
+		m_triangles.clear();
+	}
+
+	BuildPyramid();
+}
+
+
+void OcclusionCuller::RasterizeRows( const uint32_t y0, const uint32_t y1 )
+{
+	const uint32_t width = m_depth.GetWidth();
+	float* depthBase = reinterpret_cast<float*>( m_depth.GetSlice( 0, 0 ).ptr );
+
+	for ( const triangle_t& tri : m_triangles )
+	{
+		const int32_t rowBegin = Max( tri.minY, static_cast<int32_t>( y0 ) );
+		const int32_t rowEnd = Min( tri.maxY, static_cast<int32_t>( y1 ) );
+
+#if defined( GFX_SIMD_SSE )
+		const __m128 laneOffset = _mm_setr_ps( 0.0f, 1.0f, 2.0f, 3.0f );
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 edgeA0 = _mm_set1_ps( tri.edge[ 0 ][ 0 ] );
+		const __m128 edgeA1 = _mm_set1_ps( tri.edge[ 1 ][ 0 ] );
+		const __m128 edgeA2 = _mm_set1_ps( tri.edge[ 2 ][ 0 ] );
+		const __m128 depthA = _mm_set1_ps( tri.depth[ 0 ] );
+#endif
+
+		for ( int32_t y = rowBegin; y <= rowEnd; ++y )
+		{
+			float* depthRow = depthBase + static_cast<size_t>( y ) * width;
+			const float py = static_cast<float>( y );
+			int32_t x = tri.minX;
+
+#if defined( GFX_SIMD_SSE )
+			const __m128 edgeRow0 = _mm_set1_ps( tri.edge[ 0 ][ 1 ] * py + tri.edge[ 0 ][ 2 ] );
+			const __m128 edgeRow1 = _mm_set1_ps( tri.edge[ 1 ][ 1 ] * py + tri.edge[ 1 ][ 2 ] );
+			const __m128 edgeRow2 = _mm_set1_ps( tri.edge[ 2 ][ 1 ] * py + tri.edge[ 2 ][ 2 ] );
+			const __m128 depthRowPlane = _mm_set1_ps( tri.depth[ 1 ] * py + tri.depth[ 2 ] );
+
+			for ( ; ( x + 3 ) <= tri.maxX; x += 4 )
+			{
+				const __m128 px = _mm_add_ps( _mm_set1_ps( static_cast<float>( x ) ), laneOffset );
+				const __m128 e0 = _mm_add_ps( _mm_mul_ps( edgeA0, px ), edgeRow0 );
+				const __m128 e1 = _mm_add_ps( _mm_mul_ps( edgeA1, px ), edgeRow1 );
+				const __m128 e2 = _mm_add_ps( _mm_mul_ps( edgeA2, px ), edgeRow2 );
+				const __m128 inside = _mm_and_ps( _mm_and_ps( _mm_cmpge_ps( e0, zero ), _mm_cmpge_ps( e1, zero ) ), _mm_cmpge_ps( e2, zero ) );
+				if ( _mm_movemask_ps( inside ) == 0 ) {
+					continue;
+				}
+
+				const __m128 z = _mm_add_ps( _mm_mul_ps( depthA, px ), depthRowPlane );
+				const __m128 depth = _mm_loadu_ps( depthRow + x );
+				_mm_storeu_ps( depthRow + x, _mm_or_ps( _mm_and_ps( inside, _mm_min_ps( z, depth ) ), _mm_andnot_ps( inside, depth ) ) );
+			}
+#endif
+
+			for ( ; x <= tri.maxX; ++x )
+			{
+				const float px = static_cast<float>( x );
+				const float e0 = tri.edge[ 0 ][ 0 ] * px + tri.edge[ 0 ][ 1 ] * py + tri.edge[ 0 ][ 2 ];
+				const float e1 = tri.edge[ 1 ][ 0 ] * px + tri.edge[ 1 ][ 1 ] * py + tri.edge[ 1 ][ 2 ];
+				const float e2 = tri.edge[ 2 ][ 0 ] * px + tri.edge[ 2 ][ 1 ] * py + tri.edge[ 2 ][ 2 ];
+				if ( ( e0 < 0.0f ) || ( e1 < 0.0f ) || ( e2 < 0.0f ) ) {
+					continue;
+				}
+
+				const float z = tri.depth[ 0 ] * px + tri.depth[ 1 ] * py + tri.depth[ 2 ];
+				depthRow[ x ] = Min( depthRow[ x ], z );
+			}
+		}
+	}
+}
+
+
+// Mip dimensions round down, so the last row and column of an odd level fold into the texel before them
+void OcclusionCuller::BuildPyramid()
+{
+	for ( uint32_t mip = 1; mip < m_depth.GetMipCount(); ++mip )
+	{
+		const slice_t src = m_depth.GetSlice( 0, mip - 1 );
+		const slice_t dst = m_depth.GetSlice( 0, mip );
+		const float* srcTexels = reinterpret_cast<const float*>( src.ptr );
+		float* dstTexels = reinterpret_cast<float*>( dst.ptr );
+
+		for ( uint32_t y = 0; y < dst.height; ++y )
+		{
+			const uint32_t srcY0 = 2 * y;
+			const uint32_t srcY1 = ( y + 1 == dst.height ) ? ( src.height - 1 ) : ( srcY0 + 1 );
+
+			for ( uint32_t x = 0; x < dst.width; ++x )
+			{
+				const uint32_t srcX0 = 2 * x;
+				const uint32_t srcX1 = ( x + 1 == dst.width ) ? ( src.width - 1 ) : ( srcX0 + 1 );
+
+				float farthest = 0.0f;
+				for ( uint32_t sy = srcY0; sy <= srcY1; ++sy ) {
+					for ( uint32_t sx = srcX0; sx <= srcX1; ++sx ) {
+						farthest = Max( farthest, srcTexels[ sy * src.width + sx ] );
+					}
+				}
+				dstTexels[ y * dst.width + x ] = farthest;
+			}
+		}
+	}
+}
+
+
+bool OcclusionCuller::TestRect( const float ndcMinX, const float ndcMinY, const float ndcMaxX, const float ndcMaxY, const float minDepth ) const
+{
+	const int32_t width = static_cast<int32_t>( m_depth.GetWidth() );
+	const int32_t height = static_cast<int32_t>( m_depth.GetHeight() );
+
+	// Every pixel the rect touches, screen y points down
+	const int32_t x0 = Max( 0, static_cast<int32_t>( floorf( ( ndcMinX * 0.5f + 0.5f ) * width ) ) );
+	const int32_t x1 = Min( width - 1, static_cast<int32_t>( floorf( ( ndcMaxX * 0.5f + 0.5f ) * width ) ) );
+	const int32_t y0 = Max( 0, static_cast<int32_t>( floorf( ( 0.5f - ndcMaxY * 0.5f ) * height ) ) );
+	const int32_t y1 = Min( height - 1, static_cast<int32_t>( floorf( ( 0.5f - ndcMinY * 0.5f ) * height ) ) );
+	if ( ( x0 > x1 ) || ( y0 > y1 ) ) {
+		return false;
+	}
+
+	uint32_t mip = 0;
+	const uint32_t lastMip = m_depth.GetMipCount() - 1;
+	while ( ( mip < lastMip ) && ( ( ( x1 >> mip ) - ( x0 >> mip ) > 1 ) || ( ( y1 >> mip ) - ( y0 >> mip ) > 1 ) ) ) {
+		++mip;
+	}
+
+	const slice_t slice = m_depth.GetSlice( 0, mip );
+	const float* texels = reinterpret_cast<const float*>( slice.ptr );
+	const int32_t tx0 = Min( x0 >> mip, static_cast<int32_t>( slice.width ) - 1 );
+	const int32_t tx1 = Min( x1 >> mip, static_cast<int32_t>( slice.width ) - 1 );
+	const int32_t ty0 = Min( y0 >> mip, static_cast<int32_t>( slice.height ) - 1 );
+	const int32_t ty1 = Min( y1 >> mip, static_cast<int32_t>( slice.height ) - 1 );
+
+	for ( int32_t ty = ty0; ty <= ty1; ++ty ) {
+		for ( int32_t tx = tx0; tx <= tx1; ++tx ) {
+			if ( minDepth <= texels[ ty * slice.width + tx ] ) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+
+// Boxes are given as world space center and half extent, one lane each. Returns a bit per visible lane.
+uint32_t OcclusionCuller::TestBatch( const float centers[ 3 ][ 4 ], const float extents[ 3 ][ 4 ], const uint32_t count ) const
+{
+	const float* vp = m_viewProjection;
+
+	// Clip position of any corner is center + sx * ex + sy * ey + sz * ez with each term already projected
+	cullLane_t center[ 4 ];
+	cullLane_t axis[ 3 ][ 4 ];
+	for ( uint32_t r = 0; r < 4; ++r )
+	{
+		center[ r ] = LaneSet( vp[ r * 4 + 3 ] );
+		for ( uint32_t c = 0; c < 3; ++c )
+		{
+			const cullLane_t m = LaneSet( vp[ r * 4 + c ] );
+			center[ r ] = LaneAdd( center[ r ], LaneMul( m, LaneLoad( centers[ c ] ) ) );
+			axis[ c ][ r ] = LaneMul( m, LaneLoad( extents[ c ] ) );
+		}
+	}
+
+	const cullLane_t zero = LaneSet( 0.0f );
+	const cullLane_t one = LaneSet( 1.0f );
+	const cullLane_t negOne = LaneSet( -1.0f );
+	const cullLane_t minW = LaneSet( MinProjectedW );
+
+	cullLane_t minX = LaneSet( FLT_MAX );
+	cullLane_t minY = LaneSet( FLT_MAX );
+	cullLane_t minZ = LaneSet( FLT_MAX );
+	cullLane_t maxX = LaneSet( -FLT_MAX );
+	cullLane_t maxY = LaneSet( -FLT_MAX );
+
+	uint32_t crossesNear = 0;
+	uint32_t outside[ ClipPlaneCount ] = { 0xF, 0xF, 0xF, 0xF, 0xF };
+
+	for ( uint32_t corner = 0; corner < 8; ++corner )
+	{
+		cullLane_t pos[ 4 ];
+		for ( uint32_t r = 0; r < 4; ++r )
+		{
+			pos[ r ] = center[ r ];
+			for ( uint32_t c = 0; c < 3; ++c ) {
+				pos[ r ] = LaneAdd( pos[ r ], LaneMul( ( corner & ( 1u << c ) ) ? one : negOne, axis[ c ][ r ] ) );
+			}
+		}
+
+		const cullLane_t negW = LaneMul( pos[ 3 ], negOne );
+		const uint32_t behind = LaneLess( pos[ 2 ], zero );
+		crossesNear |= behind;
+		outside[ 0 ] &= behind;
+		outside[ 1 ] &= LaneLess( pos[ 0 ], negW );
+		outside[ 2 ] &= LaneLess( pos[ 3 ], pos[ 0 ] );
+		outside[ 3 ] &= LaneLess( pos[ 1 ], negW );
+		outside[ 4 ] &= LaneLess( pos[ 3 ], pos[ 1 ] );
+
+		// Lanes crossing the near plane skip the depth test, so their garbage projections are never read
+		const cullLane_t w = LaneMax( pos[ 3 ], minW );
+		const cullLane_t x = LaneDiv( pos[ 0 ], w );
+		const cullLane_t y = LaneDiv( pos[ 1 ], w );
+		const cullLane_t z = LaneDiv( pos[ 2 ], w );
+		minX = LaneMin( minX, x );
+		maxX = LaneMax( maxX, x );
+		minY = LaneMin( minY, y );
+		maxY = LaneMax( maxY, y );
+		minZ = LaneMin( minZ, z );
+	}
+
+	uint32_t culled = 0;
+	for ( uint32_t plane = 0; plane < ClipPlaneCount; ++plane ) {
+		culled |= outside[ plane ];
+	}
+	culled |= LaneLess( one, minZ );
+
+	float rect[ 5 ][ 4 ];
+	LaneStore( minX, rect[ 0 ] );
+	LaneStore( minY, rect[ 1 ] );
+	LaneStore( maxX, rect[ 2 ] );
+	LaneStore( maxY, rect[ 3 ] );
+	LaneStore( minZ, rect[ 4 ] );
+
+	uint32_t visible = 0;
+	for ( uint32_t lane = 0; lane < count; ++lane )
+	{
+		const uint32_t bit = ( 1u << lane );
+		if ( ( culled & bit ) != 0 ) {
+			continue;
+		}
+		if ( ( ( crossesNear & bit ) != 0 ) || TestRect( rect[ 0 ][ lane ], rect[ 1 ][ lane ], rect[ 2 ][ lane ], rect[ 3 ][ lane ], rect[ 4 ][ lane ] ) ) {
+			visible |= bit;
+		}
+	}
+	return visible;
+}
+
+
+bool OcclusionCuller::TestBounds( const AABB& worldBounds ) const
+{
+	float centers[ 3 ][ 4 ] = {};
+	float extents[ 3 ][ 4 ] = {};
+	for ( uint32_t c = 0; c < 3; ++c )
+	{
+		centers[ c ][ 0 ] = 0.5f * ( worldBounds.min[ c ] + worldBounds.max[ c ] );
+		extents[ c ][ 0 ] = 0.5f * ( worldBounds.max[ c ] - worldBounds.min[ c ] );
+	}
+	return TestBatch( centers, extents, 1 ) != 0;
+}
+
+
+uint32_t OcclusionCuller::TestBounds( const AABB* worldBounds, const uint32_t count, std::vector<uint64_t>& visibility ) const
+{
+	visibility.assign( ( count + 63 ) / 64, 0 );
+
+	std::atomic<uint32_t> visibleCount( 0 );
+	ParallelFor( count, CullGrainSize, [&]( const uint32_t begin, const uint32_t end )
+	{
+		uint32_t localCount = 0;
+		for ( uint32_t first = begin; first < end; first += 4 )
+		{
+			const uint32_t laneCount = Min( 4u, end - first );
+
+			float centers[ 3 ][ 4 ] = {};
+			float extents[ 3 ][ 4 ] = {};
+			for ( uint32_t lane = 0; lane < laneCount; ++lane )
+			{
+				const AABB& bounds = worldBounds[ first + lane ];
+				for ( uint32_t c = 0; c < 3; ++c )
+				{
+					centers[ c ][ lane ] = 0.5f * ( bounds.min[ c ] + bounds.max[ c ] );
+					extents[ c ][ lane ] = 0.5f * ( bounds.max[ c ] - bounds.min[ c ] );
+				}
+			}
+
+			const uint32_t bits = TestBatch( centers, extents, laneCount );
+			visibility[ first >> 6 ] |= static_cast<uint64_t>( bits ) << ( first & 63 );
+			localCount += LaneCount( bits );
+		}
+		visibleCount += localCount;
+	} );
+	return visibleCount;
+}
+
+
+uint32_t OcclusionCuller::CullEntities( const std::vector<Entity*>& entities, std::vector<uint64_t>& visibility ) const
+{
+	const uint32_t count = static_cast<uint32_t>( entities.size() );
+	visibility.assign( ( count + 63 ) / 64, 0 );
+
+	// Refresh the entity world caches serially, the parallel pass only reads them
+	for ( const Entity* ent : entities ) {
+		ent->GetWorldBounds();
+	}
+
+	std::atomic<uint32_t> visibleCount( 0 );
+	ParallelFor( count, CullGrainSize, [&]( const uint32_t begin, const uint32_t end )
+	{
+		uint32_t localCount = 0;
+		for ( uint32_t first = begin; first < end; first += 4 )
+		{
+			const uint32_t laneCount = Min( 4u, end - first );
+
+			float centers[ 3 ][ 4 ] = {};
+			float extents[ 3 ][ 4 ] = {};
+			uint32_t forced = 0;
+			uint32_t hidden = 0;
+			for ( uint32_t lane = 0; lane < laneCount; ++lane )
+			{
+				const Entity& ent = *entities[ first + lane ];
+				if ( ent.HasFlag( ENT_FLAG_NO_DRAW ) )
+				{
+					hidden |= ( 1u << lane );
+					continue;
+				}
+
+				const AABB& bounds = ent.GetWorldBounds();
+				if ( bounds.IsEmpty() || ent.HasFlag( ENT_FLAG_CAMERA_LOCKED ) )
+				{
+					forced |= ( 1u << lane );
+					continue;
+				}
+
+				for ( uint32_t c = 0; c < 3; ++c )
+				{
+					centers[ c ][ lane ] = 0.5f * ( bounds.min[ c ] + bounds.max[ c ] );
+					extents[ c ][ lane ] = 0.5f * ( bounds.max[ c ] - bounds.min[ c ] );
+				}
+			}
+
+			const uint32_t bits = ( TestBatch( centers, extents, laneCount ) | forced ) & ~hidden;
+			visibility[ first >> 6 ] |= static_cast<uint64_t>( bits ) << ( first & 63 );
+			localCount += LaneCount( bits );
+		}
+		visibleCount += localCount;
+	} );
+	return visibleCount;
+}
+
+
+const ImageBuffer<float>& OcclusionCuller::GetDepthPyramid() const
+{
+	return m_depth;
+}
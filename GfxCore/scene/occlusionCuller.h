@@ -0,0 +1,100 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <vector>
+
+#include "../math/vector.h"
+#include "../math/matrix.h"
+#include "../image/image.h"
+#include "../acceleration/aabb.h"
+#include "rasterizer.h"
+
+class Model;
+class Entity;
+class Camera;
+
+/* === OcclusionCuller - Low resolution software depth buffer with a hierarchical Z pyramid === */
+// Occluders are rasterized depth only with the standard [0, 1] depth range, every mip of the pyramid keeps the
+// farthest depth of the texels below it. Bounds are projected four at a time and tested against the mip where
+// they cover at most 2x2 texels. Occluders should be simple closed meshes that sit inside the visible geometry,
+// coverage is sampled at pixel centers so anything larger than its render mesh can hide visible objects.
+class OcclusionCuller
+{
+public:
+	static const uint32_t DefaultWidth = 256;
+	static const uint32_t DefaultHeight = 128;
+
+	OcclusionCuller();
+
+	void						Init( const uint32_t width = DefaultWidth, const uint32_t height = DefaultHeight );
+	void						SetCullMode( const rasterCullMode_t cullMode );
+
+	// Clears the depth buffer and drops any queued occluders
+	void						Begin( const mat4x4f& viewProjection );
+	void						Begin( const Camera& camera );
+
+	void						AddOccluder( const Model& model, const mat4x4f& modelMatrix );
+	void						AddOccluder( const Entity& entity, const Model& model );
+
+	// Rasterizes the queued occluders and rebuilds the pyramid, must run before any test
+	void						Flush();
+
+	bool						TestBounds( const AABB& worldBounds ) const;
+	uint32_t					TestBounds( const AABB* worldBounds, const uint32_t count, std::vector<uint64_t>& visibility ) const;
+
+	// Bit i of visibility is set when entities[ i ] may be visible, returns the number of visible entities.
+	// Hidden entities are never visible, camera locked entities and entities without bounds always are.
+	uint32_t					CullEntities( const std::vector<Entity*>& entities, std::vector<uint64_t>& visibility ) const;
+
+	const ImageBuffer<float>&	GetDepthPyramid() const;
+
+	static inline bool IsVisible( const std::vector<uint64_t>& visibility, const uint32_t index )
+	{
+		return ( visibility[ index >> 6 ] & ( 1ull << ( index & 63 ) ) ) != 0;
+	}
+
+private:
+	struct triangle_t
+	{
+		float			edge[ 3 ][ 3 ];		// value( x, y ) = a * x + b * y + c at pixel centers
+		float			depth[ 3 ];
+		int32_t			minX;
+		int32_t			minY;
+		int32_t			maxX;
+		int32_t			maxY;
+	};
+
+	void						SetupTriangle( const float clip[ 3 ][ 4 ] );
+	void						RasterizeRows( const uint32_t y0, const uint32_t y1 );
+	void						BuildPyramid();
+	uint32_t					TestBatch( const float centers[ 3 ][ 4 ], const float extents[ 3 ][ 4 ], const uint32_t count ) const;
+	bool						TestRect( const float ndcMinX, const float ndcMinY, const float ndcMaxX, const float ndcMaxY, const float minDepth ) const;
+
+	rasterCullMode_t			m_cullMode;
+	float						m_viewProjection[ 16 ];
+	ImageBuffer<float>			m_depth;			// Mip 0 is the rasterized depth
+	std::vector<triangle_t>		m_triangles;
+};
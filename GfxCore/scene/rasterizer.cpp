@@ -0,0 +1,693 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#include "rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "camera.h"
+#include "entity.h"
+#include "../asset_types/model.h"
+#include "../core/parallel.h"
+#include "../core/simd.h"
+
+static const uint32_t VertexGrainSize = 4096;
+static const uint32_t SetupChunkSize = 2048;
+static const uint32_t BinChunkSize = 4096;
+static const uint32_t ClipPlaneCount = 6;
+static const uint32_t MaxClipVertices = 3 + ClipPlaneCount;
+static const float ClipNearW = 1e-5f;
+
+
+static inline void CopyMatrix( const mat4x4f& m, float out[ 16 ] )
+{
+	for ( uint32_t r = 0; r < 4; ++r ) {
+		for ( uint32_t c = 0; c < 4; ++c ) {
+			out[ r * 4 + c ] = m[ r ][ c ];
+		}
+	}
+}
+
+
+// Signed distance to the clip planes, w > 0, -w <= x <= w, -w <= y <= w and the near depth plane,
+// z >= 0 or w - z >= 0 with reverse-Z. Geometry in front of the near plane would otherwise pass the depth test.
+// The far side is left to the depth test.
+static inline float ClipDistance( const float pos[ 4 ], const uint32_t plane, const bool reverseZ )
+{
+	switch ( plane )
+	{
+		case 0: return pos[ 3 ] - ClipNearW;
+		case 1: return pos[ 3 ] + pos[ 0 ];
+		case 2: return pos[ 3 ] - pos[ 0 ];
+		case 3: return pos[ 3 ] + pos[ 1 ];
+		case 4: return pos[ 3 ] - pos[ 1 ];
+		default: return reverseZ ? ( pos[ 3 ] - pos[ 2 ] ) : pos[ 2 ];
+	}
+}
+
+
+static inline uint32_t ClipOutcode( const float pos[ 4 ], const bool reverseZ )
+{
+	uint32_t code = 0;
+	for ( uint32_t plane = 0; plane < ClipPlaneCount; ++plane ) {
+		code |= ( ClipDistance( pos, plane, reverseZ ) < 0.0f ) ? ( 1u << plane ) : 0u;
+	}
+	return code;
+}
+
+
+Rasterizer::Rasterizer() : m_tilesX( 0 ), m_tilesY( 0 ), m_vertexCount( 0 )
+{
+}
+
+
+void Rasterizer::Init( const uint32_t width, const uint32_t height )
+{
+	m_color.Init( width, height, sizeof( Color ), "_rasterColor" );
+	m_depth.Init( width, height, sizeof( float ), "_rasterDepth" );
+
+	m_tilesX = ( width + TileSize - 1 ) / TileSize;
+	m_tilesY = ( height + TileSize - 1 ) / TileSize;
+
+	Clear( Color() );
+}
+
+
+void Rasterizer::SetSettings( const rasterSettings_t& settings )
+{
+	m_settings = settings;
+}
+
+
+void Rasterizer::Clear( const Color& color )
+{
+	m_color.Clear( color );
+	m_depth.Clear( ( m_settings.depthFunc == RASTER_DEPTH_GREATER ) ? 0.0f : 1.0f );
+}
+
+
+void Rasterizer::DrawSurface( const Surface& surface, const mat4x4f& modelMatrix, const mat4x4f& viewProjection )
+{
+	if ( surface.indices.size() < 3 ) {
+		return;
+	}
+
+	draw_t draw;
+	draw.surface = &surface;
+	draw.firstVertex = m_vertexCount;
+	CopyMatrix( modelMatrix, draw.modelMatrix );
+	CopyMatrix( viewProjection, draw.viewProjection );
+
+	m_draws.push_back( draw );
+	m_vertexCount += static_cast<uint32_t>( surface.vertices.size() );
+}
+
+
+void Rasterizer::DrawModel( const Model& model, const mat4x4f& modelMatrix, const mat4x4f& viewProjection )
+{
+	for ( const Surface& surface : model.surfs ) {
+		DrawSurface( surface, modelMatrix, viewProjection );
+	}
+}
+
+
+void Rasterizer::DrawEntity( const Entity& entity, const Model& model, const mat4x4f& viewProjection )
+{
+	DrawModel( model, entity.GetMatrix(), viewProjection );
+}
+
+
+void Rasterizer::Flush()
+{
+	if ( m_draws.empty() || ( m_tilesX == 0 ) || ( m_tilesY == 0 ) ) {
+		m_draws.clear();
+		m_vertexCount = 0;
+		return;
+	}
+
+	TransformVertices();
+	SetupTriangles();
+	BinTriangles();
+
+	ParallelFor( m_tilesX * m_tilesY, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t tileIndex = begin; tileIndex < end; ++tileIndex ) {
+			RasterizeTile( tileIndex );
+		}
+	} );
+
+	m_draws.clear();
+	m_vertexCount = 0;
+}
+
+
+void Rasterizer::TransformVertices()
+{
+	m_clipVertices.resize( m_vertexCount );
+
+	const vec3f lightDir = m_settings.lightDir;
+	const float ambient = m_settings.ambient;
+
+	for ( const draw_t& draw : m_draws )
+	{
+		const std::vector<vertex_t>& vertices = draw.surface->vertices;
+		clipVertex_t* out = &m_clipVertices[ draw.firstVertex ];
+
+		ParallelFor( static_cast<uint32_t>( vertices.size() ), VertexGrainSize, [&]( const uint32_t begin, const uint32_t end )
+		{
+			const float* m = draw.modelMatrix;
+			const float* vp = draw.viewProjection;
+
+			for ( uint32_t i = begin; i < end; ++i )
+			{
+				const vertex_t& v = vertices[ i ];
+
+				float world[ 4 ];
+				for ( uint32_t r = 0; r < 4; ++r ) {
+					world[ r ] = m[ r * 4 + 0 ] * v.pos[ 0 ] + m[ r * 4 + 1 ] * v.pos[ 1 ] + m[ r * 4 + 2 ] * v.pos[ 2 ] + m[ r * 4 + 3 ];
+				}
+				for ( uint32_t r = 0; r < 4; ++r ) {
+					out[ i ].pos[ r ] = vp[ r * 4 + 0 ] * world[ 0 ] + vp[ r * 4 + 1 ] * world[ 1 ] + vp[ r * 4 + 2 ] * world[ 2 ] + vp[ r * 4 + 3 ] * world[ 3 ];
+				}
+
+				vec3f normal;
+				for ( uint32_t r = 0; r < 3; ++r ) {
+					normal[ r ] = m[ r * 4 + 0 ] * v.normal[ 0 ] + m[ r * 4 + 1 ] * v.normal[ 1 ] + m[ r * 4 + 2 ] * v.normal[ 2 ];
+				}
+				const float lenSq = Dot( normal, normal );
+				const float nDotL = ( lenSq > 0.0f ) ? Max( 0.0f, Dot( normal, lightDir ) / sqrtf( lenSq ) ) : 1.0f;
+				const float light = ambient + ( 1.0f - ambient ) * nDotL;
+
+				out[ i ].color[ 0 ] = v.color[ 0 ] * light;
+				out[ i ].color[ 1 ] = v.color[ 1 ] * light;
+				out[ i ].color[ 2 ] = v.color[ 2 ] * light;
+			}
+		} );
+	}
+}
+
+
+void Rasterizer::SetupTriangle( const clipVertex_t* verts, std::vector<triangle_t>& triangles ) const
+{
+	const float width = static_cast<float>( m_color.GetWidth() );
+	const float height = static_cast<float>( m_color.GetHeight() );
+
+	float x[ 3 ], y[ 3 ], z[ 3 ], invW[ 3 ];
+	for ( uint32_t i = 0; i < 3; ++i )
+	{
+		invW[ i ] = 1.0f / verts[ i ].pos[ 3 ];
+		x[ i ] = ( verts[ i ].pos[ 0 ] * invW[ i ] * 0.5f + 0.5f ) * width;
+		y[ i ] = ( 0.5f - verts[ i ].pos[ 1 ] * invW[ i ] * 0.5f ) * height;
+		z[ i ] = verts[ i ].pos[ 2 ] * invW[ i ];
+	}
+
+	triangle_t tri;
+	for ( uint32_t i = 0; i < 3; ++i )
+	{
+		const uint32_t j = ( i + 1 ) % 3;
+		const uint32_t k = ( i + 2 ) % 3;
+		tri.edge[ i ][ 0 ] = y[ j ] - y[ k ];
+		tri.edge[ i ][ 1 ] = x[ k ] - x[ j ];
+		tri.edge[ i ][ 2 ] = x[ j ] * y[ k ] - x[ k ] * y[ j ];
+	}
+
+	float area = tri.edge[ 0 ][ 0 ] * x[ 0 ] + tri.edge[ 0 ][ 1 ] * y[ 0 ] + tri.edge[ 0 ][ 2 ];
+	if ( ( area == 0.0f ) || !std::isfinite( area ) ) {
+		return;
+	}
+
+	// Screen y points down so counter-clockwise in NDC has negative area here
+	const bool frontFacing = ( area < 0.0f );
+	if ( ( m_settings.cullMode == RASTER_CULL_BACK ) && !frontFacing ) {
+		return;
+	}
+	if ( ( m_settings.cullMode == RASTER_CULL_FRONT ) && frontFacing ) {
+		return;
+	}
+
+	if ( area < 0.0f )
+	{
+		area = -area;
+		for ( uint32_t i = 0; i < 3; ++i ) {
+			for ( uint32_t c = 0; c < 3; ++c ) {
+				tri.edge[ i ][ c ] = -tri.edge[ i ][ c ];
+			}
+		}
+	}
+
+	const float minX = Min( x[ 0 ], Min( x[ 1 ], x[ 2 ] ) );
+	const float maxX = Max( x[ 0 ], Max( x[ 1 ], x[ 2 ] ) );
+	const float minY = Min( y[ 0 ], Min( y[ 1 ], y[ 2 ] ) );
+	const float maxY = Max( y[ 0 ], Max( y[ 1 ], y[ 2 ] ) );
+
+	// Pixels whose centers fall inside the bounds
+	tri.minX = Max( 0, static_cast<int32_t>( ceilf( minX - 0.5f ) ) );
+	tri.minY = Max( 0, static_cast<int32_t>( ceilf( minY - 0.5f ) ) );
+	tri.maxX = Min( static_cast<int32_t>( m_color.GetWidth() ) - 1, static_cast<int32_t>( floorf( maxX - 0.5f ) ) );
+	tri.maxY = Min( static_cast<int32_t>( m_color.GetHeight() ) - 1, static_cast<int32_t>( floorf( maxY - 0.5f ) ) );
+	if ( ( tri.minX > tri.maxX ) || ( tri.minY > tri.maxY ) ) {
+		return;
+	}
+
+	// Barycentric weight i is edge i / area, interpolated attributes become planes of their own
+	const float invArea = 1.0f / area;
+	auto makePlane = [&]( const float v0, const float v1, const float v2, float plane[ 3 ] )
+	{
+		for ( uint32_t c = 0; c < 3; ++c ) {
+			plane[ c ] = ( tri.edge[ 0 ][ c ] * v0 + tri.edge[ 1 ][ c ] * v1 + tri.edge[ 2 ][ c ] * v2 ) * invArea;
+		}
+	};
+
+	makePlane( z[ 0 ], z[ 1 ], z[ 2 ], tri.depth );
+	makePlane( invW[ 0 ], invW[ 1 ], invW[ 2 ], tri.invW );
+	for ( uint32_t c = 0; c < 3; ++c ) {
+		makePlane( verts[ 0 ].color[ c ] * invW[ 0 ], verts[ 1 ].color[ c ] * invW[ 1 ], verts[ 2 ].color[ c ] * invW[ 2 ], tri.color[ c ] );
+	}
+
+	// Bake the half pixel offset in so every plane is evaluated at integer pixel coordinates
+	auto centerPlane = []( float plane[ 3 ] ) {
+		plane[ 2 ] += 0.5f * ( plane[ 0 ] + plane[ 1 ] );
+	};
+
+	for ( uint32_t i = 0; i < 3; ++i ) {
+		centerPlane( tri.edge[ i ] );
+		centerPlane( tri.color[ i ] );
+	}
+	centerPlane( tri.depth );
+	centerPlane( tri.invW );
+
+	triangles.push_back( tri );
+}
+
+
+void Rasterizer::SetupTriangles()
+{
+	m_setupChunks.clear();
+	for ( uint32_t drawIndex = 0; drawIndex < m_draws.size(); ++drawIndex )
+	{
+		const uint32_t triangleCount = static_cast<uint32_t>( m_draws[ drawIndex ].surface->indices.size() / 3 );
+		for ( uint32_t first = 0; first < triangleCount; first += SetupChunkSize )
+		{
+			setupChunk_t chunk;
+			chunk.drawIndex = drawIndex;
+			chunk.firstTriangle = first;
+			chunk.triangleCount = Min( SetupChunkSize, triangleCount - first );
+			m_setupChunks.push_back( chunk );
+		}
+	}
+
+	const uint32_t chunkCount = static_cast<uint32_t>( m_setupChunks.size() );
+	m_chunkTriangles.resize( chunkCount );
+
+	const bool reverseZ = ( m_settings.depthFunc == RASTER_DEPTH_GREATER );
+
+	ParallelFor( chunkCount, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t chunkIndex = begin; chunkIndex < end; ++chunkIndex )
+		{
+			const setupChunk_t& chunk = m_setupChunks[ chunkIndex ];
+			const draw_t& draw = m_draws[ chunk.drawIndex ];
+			const std::vector<uint32_t>& indices = draw.surface->indices;
+			const clipVertex_t* vertices = &m_clipVertices[ draw.firstVertex ];
+			const uint32_t vertexCount = static_cast<uint32_t>( draw.surface->vertices.size() );
+
+			std::vector<triangle_t>& triangles = m_chunkTriangles[ chunkIndex ];
+			triangles.clear();
+			triangles.reserve( chunk.triangleCount );
+
+			for ( uint32_t t = chunk.firstTriangle; t < ( chunk.firstTriangle + chunk.triangleCount ); ++t )
+			{
+				const uint32_t i0 = indices[ t * 3 + 0 ];
+				const uint32_t i1 = indices[ t * 3 + 1 ];
+				const uint32_t i2 = indices[ t * 3 + 2 ];
+				if ( ( i0 >= vertexCount ) || ( i1 >= vertexCount ) || ( i2 >= vertexCount ) ) {
+					continue;
+				}
+
+				clipVertex_t poly[ 2 ][ MaxClipVertices ];
+				poly[ 0 ][ 0 ] = vertices[ i0 ];
+				poly[ 0 ][ 1 ] = vertices[ i1 ];
+				poly[ 0 ][ 2 ] = vertices[ i2 ];
+
+				const uint32_t code0 = ClipOutcode( poly[ 0 ][ 0 ].pos, reverseZ );
+				const uint32_t code1 = ClipOutcode( poly[ 0 ][ 1 ].pos, reverseZ );
+				const uint32_t code2 = ClipOutcode( poly[ 0 ][ 2 ].pos, reverseZ );
+
+				if ( ( code0 & code1 & code2 ) != 0 ) {
+					continue;
+				}
+
+				if ( ( code0 | code1 | code2 ) == 0 )
+				{
+					SetupTriangle( poly[ 0 ], triangles );
+					continue;
+				}
+
+				// Sutherland-Hodgman against only the planes the triangle straddles
+				const uint32_t straddled = code0 | code1 | code2;
+				uint32_t count = 3;
+				uint32_t src = 0;
+				for ( uint32_t plane = 0; ( plane < ClipPlaneCount ) && ( count >= 3 ); ++plane )
+				{
+					if ( ( straddled & ( 1u << plane ) ) == 0 ) {
+						continue;
+					}
+
+					const clipVertex_t* in = poly[ src ];
+					clipVertex_t* out = poly[ src ^ 1 ];
+					uint32_t outCount = 0;
+
+					for ( uint32_t v = 0; v < count; ++v )
+					{
+						const clipVertex_t& a = in[ v ];
+						const clipVertex_t& b = in[ ( v + 1 ) % count ];
+						const float da = ClipDistance( a.pos, plane, reverseZ );
+						const float db = ClipDistance( b.pos, plane, reverseZ );
+
+						if ( da >= 0.0f ) {
+							out[ outCount++ ] = a;
+						}
+						if ( ( da >= 0.0f ) != ( db >= 0.0f ) )
+						{
+							const float s = da / ( da - db );
+							clipVertex_t& mid = out[ outCount++ ];
+							for ( uint32_t c = 0; c < 4; ++c ) {
+								mid.pos[ c ] = a.pos[ c ] + s * ( b.pos[ c ] - a.pos[ c ] );
+							}
+							for ( uint32_t c = 0; c < 3; ++c ) {
+								mid.color[ c ] = a.color[ c ] + s * ( b.color[ c ] - a.color[ c ] );
+							}
+						}
+					}
+
+					count = outCount;
+					src ^= 1;
+				}
+
+				for ( uint32_t v = 1; ( v + 1 ) < count; ++v )
+				{
+					const clipVertex_t fan[ 3 ] = { poly[ src ][ 0 ], poly[ src ][ v ], poly[ src ][ v + 1 ] };
+					SetupTriangle( fan, triangles );
+				}
+			}
+		}
+	} );
+
+	size_t total = 0;
+	for ( const std::vector<triangle_t>& triangles : m_chunkTriangles ) {
+		total += triangles.size();
+	}
+
+	m_triangles.clear();
+	m_triangles.reserve( total );
+	for ( const std::vector<triangle_t>& triangles : m_chunkTriangles ) {
+		m_triangles.insert( m_triangles.end(), triangles.begin(), triangles.end() );
+	}
+}
+
+
+void Rasterizer::BinTriangles()
+{
+	const uint32_t tileCount = m_tilesX * m_tilesY;
+	const uint32_t triangleCount = static_cast<uint32_t>( m_triangles.size() );
+	const uint32_t chunkCount = ( triangleCount + BinChunkSize - 1 ) / BinChunkSize;
+
+	auto forEachTile = [&]( const triangle_t& tri, auto&& visit )
+	{
+		const uint32_t tileX0 = static_cast<uint32_t>( tri.minX ) / TileSize;
+		const uint32_t tileX1 = static_cast<uint32_t>( tri.maxX ) / TileSize;
+		const uint32_t tileY0 = static_cast<uint32_t>( tri.minY ) / TileSize;
+		const uint32_t tileY1 = static_cast<uint32_t>( tri.maxY ) / TileSize;
+		for ( uint32_t ty = tileY0; ty <= tileY1; ++ty ) {
+			for ( uint32_t tx = tileX0; tx <= tileX1; ++tx ) {
+				visit( ty * m_tilesX + tx );
+			}
+		}
+	};
+
+	// Count per chunk so the scatter can run in parallel and still keep submission order inside each tile
+	std::vector<uint32_t> chunkOffsets( chunkCount * tileCount, 0 );
+	ParallelFor( chunkCount, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t chunk = begin; chunk < end; ++chunk )
+		{
+			uint32_t* counts = &chunkOffsets[ chunk * tileCount ];
+			const uint32_t last = Min( triangleCount, ( chunk + 1 ) * BinChunkSize );
+			for ( uint32_t t = chunk * BinChunkSize; t < last; ++t ) {
+				forEachTile( m_triangles[ t ], [&]( const uint32_t tile ) { ++counts[ tile ]; } );
+			}
+		}
+	} );
+
+	m_tileOffsets.resize( tileCount + 1 );
+	uint32_t offset = 0;
+	for ( uint32_t tile = 0; tile < tileCount; ++tile )
+	{
+		m_tileOffsets[ tile ] = offset;
+		for ( uint32_t chunk = 0; chunk < chunkCount; ++chunk )
+		{
+			const uint32_t count = chunkOffsets[ chunk * tileCount + tile ];
+			chunkOffsets[ chunk * tileCount + tile ] = offset;
+			offset += count;
+		}
+	}
+	m_tileOffsets[ tileCount ] = offset;
+	m_tileTriangles.resize( offset );
+
+	ParallelFor( chunkCount, 1, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( uint32_t chunk = begin; chunk < end; ++chunk )
+		{
+			uint32_t* cursor = &chunkOffsets[ chunk * tileCount ];
+			const uint32_t last = Min( triangleCount, ( chunk + 1 ) * BinChunkSize );
+			for ( uint32_t t = chunk * BinChunkSize; t < last; ++t ) {
+				forEachTile( m_triangles[ t ], [&]( const uint32_t tile ) { m_tileTriangles[ cursor[ tile ]++ ] = t; } );
+			}
+		}
+	} );
+}
+
+
+void Rasterizer::RasterizeTile( const uint32_t tileIndex )
+{
+	const int32_t tileX0 = static_cast<int32_t>( ( tileIndex % m_tilesX ) * TileSize );
+	const int32_t tileY0 = static_cast<int32_t>( ( tileIndex / m_tilesX ) * TileSize );
+	const int32_t tileX1 = Min( tileX0 + static_cast<int32_t>( TileSize ), static_cast<int32_t>( m_color.GetWidth() ) ) - 1;
+	const int32_t tileY1 = Min( tileY0 + static_cast<int32_t>( TileSize ), static_cast<int32_t>( m_color.GetHeight() ) ) - 1;
+
+	for ( uint32_t i = m_tileOffsets[ tileIndex ]; i < m_tileOffsets[ tileIndex + 1 ]; ++i )
+	{
+		const triangle_t& tri = m_triangles[ m_tileTriangles[ i ] ];
+
+		const int32_t x0 = Max( tileX0, tri.minX );
+		const int32_t y0 = Max( tileY0, tri.minY );
+		const int32_t x1 = Min( tileX1, tri.maxX );
+		const int32_t y1 = Min( tileY1, tri.maxY );
+
+		// Tiles are block aligned, test each block's corners against the edges to skip or fill it whole
+		const int32_t blockMask = ~static_cast<int32_t>( BlockSize - 1 );
+		for ( int32_t by = ( y0 & blockMask ); by <= y1; by += BlockSize )
+		{
+			const int32_t blockY0 = Max( by, y0 );
+			const int32_t blockY1 = Min( by + static_cast<int32_t>( BlockSize ) - 1, y1 );
+
+			for ( int32_t bx = ( x0 & blockMask ); bx <= x1; bx += BlockSize )
+			{
+				const int32_t blockX0 = Max( bx, x0 );
+				const int32_t blockX1 = Min( bx + static_cast<int32_t>( BlockSize ) - 1, x1 );
+
+				bool rejected = false;
+				bool fullyCovered = true;
+				for ( uint32_t e = 0; e < 3; ++e )
+				{
+					const float* edge = tri.edge[ e ];
+					const float maxX = static_cast<float>( ( edge[ 0 ] > 0.0f ) ? blockX1 : blockX0 );
+					const float maxY = static_cast<float>( ( edge[ 1 ] > 0.0f ) ? blockY1 : blockY0 );
+					const float minX = static_cast<float>( ( edge[ 0 ] > 0.0f ) ? blockX0 : blockX1 );
+					const float minY = static_cast<float>( ( edge[ 1 ] > 0.0f ) ? blockY0 : blockY1 );
+
+					if ( ( edge[ 0 ] * maxX + edge[ 1 ] * maxY + edge[ 2 ] ) < 0.0f ) {
+						rejected = true;
+						break;
+					}
+					fullyCovered = fullyCovered && ( ( edge[ 0 ] * minX + edge[ 1 ] * minY + edge[ 2 ] ) >= 0.0f );
+				}
+
+				if ( !rejected ) {
+					RasterizeBlock( tri, blockX0, blockY0, blockX1, blockY1, fullyCovered );
+				}
+			}
+		}
+	}
+}
+
+
+// Pixels on an edge shared by two triangles pass for both, the depth test keeps that invisible for opaque geometry
+void Rasterizer::RasterizeBlock( const triangle_t& tri, const int32_t x0, const int32_t y0, const int32_t x1, const int32_t y1, const bool fullyCovered )
+{
+	const uint32_t width = m_color.GetWidth();
+	float* depthBase = reinterpret_cast<float*>( m_depth.GetSlice( 0, 0 ).ptr );
+	Color* colorBase = reinterpret_cast<Color*>( m_color.GetSlice( 0, 0 ).ptr );
+	const bool depthGreater = ( m_settings.depthFunc == RASTER_DEPTH_GREATER );
+
+	auto shadePixel = [&]( const float px, const float py, float& depth, Color& color )
+	{
+		const float e0 = tri.edge[ 0 ][ 0 ] * px + tri.edge[ 0 ][ 1 ] * py + tri.edge[ 0 ][ 2 ];
+		const float e1 = tri.edge[ 1 ][ 0 ] * px + tri.edge[ 1 ][ 1 ] * py + tri.edge[ 1 ][ 2 ];
+		const float e2 = tri.edge[ 2 ][ 0 ] * px + tri.edge[ 2 ][ 1 ] * py + tri.edge[ 2 ][ 2 ];
+		if ( !fullyCovered && ( ( e0 < 0.0f ) || ( e1 < 0.0f ) || ( e2 < 0.0f ) ) ) {
+			return;
+		}
+
+		const float z = tri.depth[ 0 ] * px + tri.depth[ 1 ] * py + tri.depth[ 2 ];
+		if ( depthGreater ? !( z > depth ) : !( z < depth ) ) {
+			return;
+		}
+		depth = z;
+
+		const float w = 1.0f / ( tri.invW[ 0 ] * px + tri.invW[ 1 ] * py + tri.invW[ 2 ] );
+		color = Color(	( tri.color[ 0 ][ 0 ] * px + tri.color[ 0 ][ 1 ] * py + tri.color[ 0 ][ 2 ] ) * w,
+						( tri.color[ 1 ][ 0 ] * px + tri.color[ 1 ][ 1 ] * py + tri.color[ 1 ][ 2 ] ) * w,
+						( tri.color[ 2 ][ 0 ] * px + tri.color[ 2 ][ 1 ] * py + tri.color[ 2 ][ 2 ] ) * w,
+						1.0f );
+	};
+
+#if defined( GFX_SIMD_SSE )
+	const __m128 laneOffset = _mm_setr_ps( 0.0f, 1.0f, 2.0f, 3.0f );
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 edgeA0 = _mm_set1_ps( tri.edge[ 0 ][ 0 ] );
+	const __m128 edgeA1 = _mm_set1_ps( tri.edge[ 1 ][ 0 ] );
+	const __m128 edgeA2 = _mm_set1_ps( tri.edge[ 2 ][ 0 ] );
+	const __m128 depthA = _mm_set1_ps( tri.depth[ 0 ] );
+	const __m128 invWA = _mm_set1_ps( tri.invW[ 0 ] );
+	const __m128 colorA0 = _mm_set1_ps( tri.color[ 0 ][ 0 ] );
+	const __m128 colorA1 = _mm_set1_ps( tri.color[ 1 ][ 0 ] );
+	const __m128 colorA2 = _mm_set1_ps( tri.color[ 2 ][ 0 ] );
+#endif
+
+	for ( int32_t y = y0; y <= y1; ++y )
+	{
+		float* depthRow = depthBase + static_cast<size_t>( y ) * width;
+		Color* colorRow = colorBase + static_cast<size_t>( y ) * width;
+		const float py = static_cast<float>( y );
+		int32_t x = x0;
+
+#if defined( GFX_SIMD_SSE )
+		// Row constant part of every plane, only the x term varies across the 4 lanes
+		const __m128 edgeRow0 = _mm_set1_ps( tri.edge[ 0 ][ 1 ] * py + tri.edge[ 0 ][ 2 ] );
+		const __m128 edgeRow1 = _mm_set1_ps( tri.edge[ 1 ][ 1 ] * py + tri.edge[ 1 ][ 2 ] );
+		const __m128 edgeRow2 = _mm_set1_ps( tri.edge[ 2 ][ 1 ] * py + tri.edge[ 2 ][ 2 ] );
+		const __m128 depthRowPlane = _mm_set1_ps( tri.depth[ 1 ] * py + tri.depth[ 2 ] );
+		const __m128 invWRow = _mm_set1_ps( tri.invW[ 1 ] * py + tri.invW[ 2 ] );
+		const __m128 colorRow0 = _mm_set1_ps( tri.color[ 0 ][ 1 ] * py + tri.color[ 0 ][ 2 ] );
+		const __m128 colorRow1 = _mm_set1_ps( tri.color[ 1 ][ 1 ] * py + tri.color[ 1 ][ 2 ] );
+		const __m128 colorRow2 = _mm_set1_ps( tri.color[ 2 ][ 1 ] * py + tri.color[ 2 ][ 2 ] );
+
+		for ( ; ( x + 3 ) <= x1; x += 4 )
+		{
+			const __m128 px = _mm_add_ps( _mm_set1_ps( static_cast<float>( x ) ), laneOffset );
+
+			__m128 mask = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+			if ( !fullyCovered )
+			{
+				const __m128 e0 = _mm_add_ps( _mm_mul_ps( edgeA0, px ), edgeRow0 );
+				const __m128 e1 = _mm_add_ps( _mm_mul_ps( edgeA1, px ), edgeRow1 );
+				const __m128 e2 = _mm_add_ps( _mm_mul_ps( edgeA2, px ), edgeRow2 );
+				mask = _mm_and_ps( _mm_and_ps( _mm_cmpge_ps( e0, zero ), _mm_cmpge_ps( e1, zero ) ), _mm_cmpge_ps( e2, zero ) );
+			}
+
+			const __m128 z = _mm_add_ps( _mm_mul_ps( depthA, px ), depthRowPlane );
+			const __m128 depth = _mm_loadu_ps( depthRow + x );
+			mask = _mm_and_ps( mask, depthGreater ? _mm_cmpgt_ps( z, depth ) : _mm_cmplt_ps( z, depth ) );
+
+			const int32_t bits = _mm_movemask_ps( mask );
+			if ( bits == 0 ) {
+				continue;
+			}
+
+			_mm_storeu_ps( depthRow + x, _mm_or_ps( _mm_and_ps( mask, z ), _mm_andnot_ps( mask, depth ) ) );
+
+			const __m128 w = _mm_div_ps( _mm_set1_ps( 1.0f ), _mm_add_ps( _mm_mul_ps( invWA, px ), invWRow ) );
+			alignas( 16 ) float r[ 4 ];
+			alignas( 16 ) float g[ 4 ];
+			alignas( 16 ) float b[ 4 ];
+			_mm_store_ps( r, _mm_mul_ps( _mm_add_ps( _mm_mul_ps( colorA0, px ), colorRow0 ), w ) );
+			_mm_store_ps( g, _mm_mul_ps( _mm_add_ps( _mm_mul_ps( colorA1, px ), colorRow1 ), w ) );
+			_mm_store_ps( b, _mm_mul_ps( _mm_add_ps( _mm_mul_ps( colorA2, px ), colorRow2 ), w ) );
+
+			for ( uint32_t lane = 0; lane < 4; ++lane )
+			{
+				if ( ( bits & ( 1 << lane ) ) != 0 ) {
+					colorRow[ x + lane ] = Color( r[ lane ], g[ lane ], b[ lane ], 1.0f );
+				}
+			}
+		}
+#endif
+
+		for ( ; x <= x1; ++x ) {
+			shadePixel( static_cast<float>( x ), py, depthRow[ x ], colorRow[ x ] );
+		}
+	}
+}
+
+
+void Rasterizer::Resolve( ImageBuffer<rgba8_t>& image ) const
+{
+	const uint32_t width = m_color.GetWidth();
+	const uint32_t height = m_color.GetHeight();
+
+	if ( ( image.GetWidth() != width ) || ( image.GetHeight() != height ) ) {
+		image.Init( width, height, sizeof( rgba8_t ), "_rasterResolve" );
+	}
+
+	const Color* src = reinterpret_cast<const Color*>( m_color.GetSlice( 0, 0 ).ptr );
+	rgba8_t* dst = reinterpret_cast<rgba8_t*>( image.GetSlice( 0, 0 ).ptr );
+
+	ParallelFor( height, 16, [&]( const uint32_t begin, const uint32_t end )
+	{
+		for ( size_t i = static_cast<size_t>( begin ) * width; i < static_cast<size_t>( end ) * width; ++i ) {
+			dst[ i ] = src[ i ].AsRgba8();
+		}
+	} );
+}
+
+
+const ImageBuffer<Color>& Rasterizer::GetColorBuffer() const
+{
+	return m_color;
+}
+
+
+const ImageBuffer<float>& Rasterizer::GetDepthBuffer() const
+{
+	return m_depth;
+}
+
+
+mat4x4f RasterViewProjection( const Camera& camera, const bool inverseZ )
+{
+	return camera.GetPerspectiveMatrix( inverseZ ).Transpose() * camera.GetViewMatrix().Transpose();
+}
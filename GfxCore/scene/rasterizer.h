@@ -0,0 +1,153 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <vector>
+
+#include "../math/vector.h"
+#include "../math/matrix.h"
+#include "../image/color.h"
+#include "../image/image.h"
+
+class Surface;
+class Model;
+class Entity;
+class Camera;
+
+enum rasterDepthFunc_t : uint32_t
+{
+	RASTER_DEPTH_LESS,		// Depth cleared to 1, standard projection
+	RASTER_DEPTH_GREATER,	// Depth cleared to 0, reverse-Z projection
+};
+
+enum rasterCullMode_t : uint32_t
+{
+	RASTER_CULL_NONE,
+	RASTER_CULL_BACK,		// Front faces are counter-clockwise in NDC
+	RASTER_CULL_FRONT,
+};
+
+struct rasterSettings_t
+{
+	rasterDepthFunc_t	depthFunc;
+	rasterCullMode_t	cullMode;
+	vec3f				lightDir;		// World space direction towards the light
+	float				ambient;		// Lambert term is remapped to [ambient, 1]
+
+	rasterSettings_t() :
+		depthFunc( RASTER_DEPTH_LESS ),
+		cullMode( RASTER_CULL_BACK ),
+		lightDir( vec3f( 0.3f, 0.8f, 0.5f ).Normalize() ),
+		ambient( 0.2f )
+	{}
+};
+
+/* === Rasterizer - Tile binned software triangle rasterizer with a depth buffer === */
+// Draw calls are only recorded, Flush() transforms, clips and bins the triangles into TileSize screen tiles
+// and then shades every tile on its own thread. Output is Gouraud lit vertex color.
+// Matrices use column vectors ( m * v ), use RasterViewProjection() to build one from a Camera.
+class Rasterizer
+{
+public:
+	static const uint32_t TileSize = 64;
+	static const uint32_t BlockSize = 8;
+
+	Rasterizer();
+
+	void						Init( const uint32_t width, const uint32_t height );
+	void						SetSettings( const rasterSettings_t& settings );
+	void						Clear( const Color& color );
+
+	void						DrawSurface( const Surface& surface, const mat4x4f& modelMatrix, const mat4x4f& viewProjection );
+	void						DrawModel( const Model& model, const mat4x4f& modelMatrix, const mat4x4f& viewProjection );
+	void						DrawEntity( const Entity& entity, const Model& model, const mat4x4f& viewProjection );
+	void						Flush();
+
+	void						Resolve( ImageBuffer<rgba8_t>& image ) const;
+
+	const ImageBuffer<Color>&	GetColorBuffer() const;
+	const ImageBuffer<float>&	GetDepthBuffer() const;
+
+private:
+	struct draw_t
+	{
+		const Surface*	surface;
+		float			modelMatrix[ 16 ];
+		float			viewProjection[ 16 ];
+		uint32_t		firstVertex;
+	};
+
+	struct setupChunk_t
+	{
+		uint32_t		drawIndex;
+		uint32_t		firstTriangle;
+		uint32_t		triangleCount;
+	};
+
+	struct clipVertex_t
+	{
+		float			pos[ 4 ];
+		float			color[ 3 ];
+	};
+
+	// Screen space plane equations, value( x, y ) = a * x + b * y + c at pixel centers
+	struct triangle_t
+	{
+		float			edge[ 3 ][ 3 ];
+		float			depth[ 3 ];
+		float			invW[ 3 ];
+		float			color[ 3 ][ 3 ];	// Color / w, divided by the interpolated 1 / w per pixel
+		int32_t			minX;
+		int32_t			minY;
+		int32_t			maxX;
+		int32_t			maxY;
+	};
+
+	void						TransformVertices();
+	void						SetupTriangles();
+	void						BinTriangles();
+	void						RasterizeTile( const uint32_t tileIndex );
+	void						RasterizeBlock( const triangle_t& tri, const int32_t x0, const int32_t y0, const int32_t x1, const int32_t y1, const bool fullyCovered );
+	void						SetupTriangle( const clipVertex_t* verts, std::vector<triangle_t>& triangles ) const;
+
+	rasterSettings_t			m_settings;
+	ImageBuffer<Color>			m_color;
+	ImageBuffer<float>			m_depth;
+	uint32_t					m_tilesX;
+	uint32_t					m_tilesY;
+
+	std::vector<draw_t>			m_draws;
+	uint32_t					m_vertexCount;
+	std::vector<clipVertex_t>	m_clipVertices;
+
+	std::vector<setupChunk_t>	m_setupChunks;
+	std::vector< std::vector<triangle_t> >	m_chunkTriangles;	// Setup output per chunk, clipping can emit several per input
+	std::vector<triangle_t>		m_triangles;
+	std::vector<uint32_t>		m_tileOffsets;				// Prefix sum into m_tileTriangles, tile count + 1 entries
+	std::vector<uint32_t>		m_tileTriangles;
+};
+
+// View projection for the rasterizer's m * v convention, the camera matrices are laid out for GPU upload
+mat4x4f RasterViewProjection( const Camera& camera, const bool inverseZ = false );
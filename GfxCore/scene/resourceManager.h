@@ -97,6 +97,12 @@ public:
 		return static_cast<uint32_t>( imageBuffer.size() - 1 );
 	}
 
+	uint32_t StoreImage( ImageBuffer<Color>&& image )
+	{
+		imageBuffer.push_back( std::move( image ) );
+		return static_cast<uint32_t>( imageBuffer.size() - 1 );
+	}
+
 	bool PushVB( const uint32_t vbIx )
 	{
 		if ( vbIx >= vertexBuffers.size() )
@@ -23,6 +23,7 @@
 
 #include "scene.h"
 
+#include "occlusionCuller.h"
 #include "../primitives/ray.h"
 
 void Scene::CreateEntityBounds( const hdl_t modelHdl, Entity& entity )
@@ -45,13 +46,7 @@ Entity* Scene::GetTracedEntity( const Ray& ray )
 			continue;
 		}
 		float t0, t1;
-		
-		const vec3f min = vec3f( ent->GetMatrix() * vec4f( ent->GetLocalBounds().GetMin(), 1.0f ) );
-		const vec3f max = vec3f( ent->GetMatrix() * vec4f( ent->GetLocalBounds().GetMax(), 1.0f ) );
-
-		const AABB bounds = AABB( min, max );
-
-		if ( bounds.Intersect( ray, t0, t1 ) ) {
+		if ( ent->GetWorldBounds().Intersect( ray, t0, t1 ) ) {
 			if ( t0 < closestT ) {
 				closestT = t0;
 				closestEnt = ent;
@@ -62,6 +57,25 @@ Entity* Scene::GetTracedEntity( const Ray& ray )
 }
 
 
+uint32_t Scene::CullEntities( const Camera& camera, OcclusionCuller& culler, std::vector<uint64_t>& visibility ) const
+{
+	culler.Begin( camera );
+	for ( const Entity* ent : entities )
+	{
+		if ( !ent->HasFlag( ENT_FLAG_OCCLUDER ) || ent->HasFlag( ENT_FLAG_NO_DRAW ) ) {
+			continue;
+		}
+		const Asset<Model>* modelAsset = g_assets.modelLib.Find( ent->modelHdl );
+		if ( modelAsset != nullptr ) {
+			culler.AddOccluder( *ent, modelAsset->Get() );
+		}
+	}
+	culler.Flush();
+
+	return culler.CullEntities( entities, visibility );
+}
+
+
 uint32_t Scene::EntityCount() const
 {
 	return static_cast<uint32_t>( entities.size() );
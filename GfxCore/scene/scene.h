@@ -58,6 +58,7 @@ struct light_t
 };
 
 struct Ray;
+class OcclusionCuller;
 
 extern AssetManager g_assets;
 
@@ -142,6 +143,9 @@ public:
 	void			CreateEntityBounds( const hdl_t modelHdl, Entity& entity );
 	Entity*			GetTracedEntity( const Ray& ray );
 
+	// Draws every ENT_FLAG_OCCLUDER entity into the culler and fills a visibility bit per entity
+	uint32_t		CullEntities( const Camera& camera, OcclusionCuller& culler, std::vector<uint64_t>& visibility ) const;
+
 	uint32_t		EntityCount() const;
 	Entity*			FindEntity( const uint32_t entityIx );
 	const Entity*	FindEntity( const uint32_t entityIx ) const ;
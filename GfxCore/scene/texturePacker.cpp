@@ -0,0 +1,351 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "texturePacker.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../asset_types/texture.h"
+#include "../asset_types/material.h"
+#include "../core/assetLib.h"
+#include "../image/rectPacker.h"
+
+struct packSource_t
+{
+	hdl_t		hdl;
+	Image*		image;
+	uint32_t	width;
+	uint32_t	height;
+};
+
+struct packedTexture_t
+{
+	hdl_t			hdl;
+	textureRemap_t	remap;
+};
+
+struct atlasRect_t
+{
+	uint32_t	source;
+	uint32_t	page;
+	uint32_t	x;
+	uint32_t	y;
+};
+
+using packRemapMap_t = std::unordered_map<uint64_t, packedTexture_t>;
+
+
+static inline uint32_t AlignUp( const uint32_t value, const uint32_t alignment )
+{
+	return ( ( value + alignment - 1 ) / alignment ) * alignment;
+}
+
+
+static inline uint32_t NextPowerOfTwo( const uint32_t value )
+{
+	uint32_t pow2 = 1;
+	while ( pow2 < value ) {
+		pow2 <<= 1;
+	}
+	return pow2;
+}
+
+
+static bool CanPackImage( const Asset<Image>& asset )
+{
+	if ( ( asset.IsLoaded() == false ) || ( asset.CanBake() == false ) || asset.IsDefault() ) {
+		return false;
+	}
+
+	const Image& image = asset.Get();
+	if ( ( image.cpuImage == nullptr ) || ( image.info.type != IMAGE_TYPE_2D ) || ( image.info.layers != 1 ) ) {
+		return false;
+	}
+	return ( image.info.fmt == IMAGE_FMT_RGBA_8 ) || ( image.info.fmt == IMAGE_FMT_RGBA_8_UNORM );
+}
+
+
+static hdl_t AddPackedImage( AssetLib<Image>& images, const char* prefix, const imageInfo_t& info, const Image& source )
+{
+	std::string name;
+	uint32_t index = 0;
+	do {
+		name = std::string( prefix ) + std::to_string( index++ );
+	} while ( images.Exists( name.c_str() ) );
+
+	const hdl_t hdl = images.Add( name.c_str(), Image() );
+
+	Image& image = images.Find( hdl )->Get();
+	image.Create( info );
+	image.cpuImage->Clear();
+	image.usage = source.usage;
+	image.sampler = source.sampler;
+	image.generateMips = false;
+
+	return hdl;
+}
+
+
+// Texels outside the source repeat it, so frac( uv ) in the shader filters across the seam like a wrap sampler
+static void BlitPadded( const Image& source, const slice_t& dst, const uint32_t x, const uint32_t y, const uint32_t gutter )
+{
+	const slice_t src = source.cpuImage->GetSlice( 0, 0 );
+	const rgba8_t* srcTexels = reinterpret_cast<const rgba8_t*>( src.ptr );
+	rgba8_t* dstTexels = reinterpret_cast<rgba8_t*>( dst.ptr );
+
+	const int32_t g = static_cast<int32_t>( gutter );
+	const int32_t w = static_cast<int32_t>( src.width );
+	const int32_t h = static_cast<int32_t>( src.height );
+
+	for ( int32_t py = -g; py < ( h + g ); ++py )
+	{
+		const int32_t sy = ( ( py % h ) + h ) % h;
+		rgba8_t* dstRow = dstTexels + ( y + py + g ) * dst.width + x;
+
+		for ( int32_t px = -g; px < ( w + g ); ++px )
+		{
+			const int32_t sx = ( ( px % w ) + w ) % w;
+			dstRow[ px + g ] = srcTexels[ sy * w + sx ];
+		}
+	}
+}
+
+
+static uint32_t BuildArrays( AssetLib<Image>& images, const std::vector<packSource_t>& sources, const texturePackSettings_t& settings, packRemapMap_t& remaps )
+{
+	uint32_t arrayCount = 0;
+	for ( uint32_t first = 0; first < sources.size(); first += settings.maxArrayLayers )
+	{
+		const uint32_t layers = Min( static_cast<uint32_t>( sources.size() ) - first, settings.maxArrayLayers );
+		const packSource_t& base = sources[ first ];
+
+		imageInfo_t info = base.image->info;
+		info.type = IMAGE_TYPE_2D_ARRAY;
+		info.layers = layers;
+		info.mipLevels = MipCount( base.width, base.height );
+
+		const hdl_t hdl = AddPackedImage( images, "_packed_array", info, *base.image );
+		Image& packed = images.Find( hdl )->Get();
+
+		for ( uint32_t layer = 0; layer < layers; ++layer )
+		{
+			const packSource_t& source = sources[ first + layer ];
+			const slice_t src = source.image->cpuImage->GetSlice( 0, 0 );
+			const slice_t dst = packed.cpuImage->GetSlice( layer, 0 );
+			memcpy( dst.ptr, src.ptr, Min( src.size, dst.size ) );
+
+			packedTexture_t& remap = remaps[ source.hdl.Get() ];
+			remap.hdl = hdl;
+			remap.remap = textureRemap_t();
+			remap.remap.layer = layer;
+		}
+
+		GenerateMipChain( *packed.cpuImage );
+		++arrayCount;
+	}
+	return arrayCount;
+}
+
+
+static uint32_t BuildAtlases( AssetLib<Image>& images, std::vector<packSource_t>& sources, const texturePackSettings_t& settings, packRemapMap_t& remaps )
+{
+	// A mip n texel averages a 2^n block, aligning rects to the coarsest block keeps each one inside a single rect.
+	// Bilinear at that mip reaches half a texel further, which the gutter covers.
+	const uint32_t atlasMips = Max( 1u, settings.atlasMips );
+	const uint32_t alignment = 1u << ( atlasMips - 1 );
+	const uint32_t gutter = Max( 1u, alignment / 2 );
+
+	std::sort( sources.begin(), sources.end(), []( const packSource_t& a, const packSource_t& b ) {
+		return ( a.height != b.height ) ? ( a.height > b.height ) : ( a.width > b.width );
+	} );
+
+	std::vector<SkylinePacker> pages;
+	std::vector<atlasRect_t> rects;
+	rects.reserve( sources.size() );
+
+	for ( uint32_t i = 0; i < sources.size(); ++i )
+	{
+		const uint32_t paddedWidth = AlignUp( sources[ i ].width + 2 * gutter, alignment );
+		const uint32_t paddedHeight = AlignUp( sources[ i ].height + 2 * gutter, alignment );
+
+		atlasRect_t rect = { i, 0, 0, 0 };
+
+		bool placed = false;
+		for ( rect.page = 0; rect.page < pages.size(); ++rect.page )
+		{
+			if ( pages[ rect.page ].Insert( paddedWidth, paddedHeight, rect.x, rect.y ) )
+			{
+				placed = true;
+				break;
+			}
+		}
+
+		if ( placed == false )
+		{
+			pages.push_back( SkylinePacker( settings.atlasSize, settings.atlasSize ) );
+			if ( pages.back().Insert( paddedWidth, paddedHeight, rect.x, rect.y ) == false )
+			{
+				pages.pop_back();
+				continue;
+			}
+			rect.page = static_cast<uint32_t>( pages.size() - 1 );
+		}
+		rects.push_back( rect );
+	}
+
+	std::vector<hdl_t> pageHdls( pages.size() );
+	for ( uint32_t page = 0; page < pages.size(); ++page )
+	{
+		const uint32_t width = settings.atlasSize;
+		const uint32_t height = Min( NextPowerOfTwo( pages[ page ].UsedHeight() ), settings.atlasSize );
+		const packSource_t& base = sources[ rects.front().source ];
+
+		imageInfo_t info = base.image->info;
+		info.width = width;
+		info.height = height;
+		info.layers = 1;
+		info.mipLevels = Min( atlasMips, MipCount( width, height ) );
+
+		pageHdls[ page ] = AddPackedImage( images, "_packed_atlas", info, *base.image );
+		images.Find( pageHdls[ page ] )->Get().sampler.addrMode = SAMPLER_ADDRESS_CLAMP_EDGE;
+	}
+
+	for ( const atlasRect_t& rect : rects )
+	{
+		const packSource_t& source = sources[ rect.source ];
+		Image& packed = images.Find( pageHdls[ rect.page ] )->Get();
+
+		BlitPadded( *source.image, packed.cpuImage->GetSlice( 0, 0 ), rect.x, rect.y, gutter );
+
+		const float width = static_cast<float>( packed.info.width );
+		const float height = static_cast<float>( packed.info.height );
+
+		packedTexture_t& remap = remaps[ source.hdl.Get() ];
+		remap.hdl = pageHdls[ rect.page ];
+		remap.remap.scale = vec2f( source.width / width, source.height / height );
+		remap.remap.bias = vec2f( ( rect.x + gutter ) / width, ( rect.y + gutter ) / height );
+		remap.remap.layer = 0;
+	}
+
+	for ( const hdl_t& hdl : pageHdls ) {
+		GenerateMipChain( *images.Find( hdl )->Get().cpuImage );
+	}
+	return static_cast<uint32_t>( pages.size() );
+}
+
+
+texturePackStats_t PackMaterialTextures( AssetLib<Image>& images, AssetLib<Material>& materials, const texturePackSettings_t& settings )
+{
+	texturePackStats_t stats = {};
+
+	// Only textures a material samples can be remapped
+	std::map<uint64_t, std::vector<packSource_t>> groups;
+	std::unordered_map<uint64_t, bool> visited;
+
+	const uint32_t materialCount = materials.Count();
+	for ( uint32_t i = 0; i < materialCount; ++i )
+	{
+		const Material& material = materials.Find( i )->Get();
+		for ( uint32_t slot = 0; slot < Material::MaxMaterialTextures; ++slot )
+		{
+			const hdl_t hdl = material.GetTexture( slot );
+			if ( ( hdl.IsValid() == false ) || visited[ hdl.Get() ] ) {
+				continue;
+			}
+			visited[ hdl.Get() ] = true;
+
+			Asset<Image>* asset = images.Find( hdl );
+			if ( ( asset == nullptr ) || ( CanPackImage( *asset ) == false ) ) {
+				continue;
+			}
+
+			Image& image = asset->Get();
+
+			packSource_t source;
+			source.hdl = hdl;
+			source.image = &image;
+			source.width = image.info.width;
+			source.height = image.info.height;
+
+			const uint64_t key = ( static_cast<uint64_t>( image.info.fmt ) << 32 ) | image.usage;
+			groups[ key ].push_back( source );
+		}
+	}
+
+	packRemapMap_t remaps;
+	for ( auto& group : groups )
+	{
+		std::map<uint64_t, std::vector<packSource_t>> sizes;
+		for ( const packSource_t& source : group.second ) {
+			sizes[ ( static_cast<uint64_t>( source.width ) << 32 ) | source.height ].push_back( source );
+		}
+
+		std::vector<packSource_t> atlasSources;
+		for ( auto& size : sizes )
+		{
+			std::vector<packSource_t>& sources = size.second;
+			if ( sources.size() >= Max( 2u, settings.minArrayLayers ) )
+			{
+				stats.arrayImages += BuildArrays( images, sources, settings, remaps );
+				continue;
+			}
+
+			for ( const packSource_t& source : sources )
+			{
+				if ( ( source.width <= settings.maxPackedSize ) && ( source.height <= settings.maxPackedSize ) ) {
+					atlasSources.push_back( source );
+				}
+			}
+		}
+
+		if ( atlasSources.size() >= 2 ) {
+			stats.atlasImages += BuildAtlases( images, atlasSources, settings, remaps );
+		}
+	}
+
+	for ( uint32_t i = 0; i < materialCount; ++i )
+	{
+		Material& material = materials.Find( i )->Get();
+		for ( uint32_t slot = 0; slot < Material::MaxMaterialTextures; ++slot )
+		{
+			auto it = remaps.find( material.GetTexture( slot ).Get() );
+			if ( it == remaps.end() ) {
+				continue;
+			}
+			material.AddTexture( slot, it->second.hdl );
+			material.SetTextureRemap( slot, it->second.remap );
+		}
+	}
+
+	for ( auto& remap : remaps ) {
+		images.Find( hdl_t( remap.first ) )->SetBakeable( false );
+	}
+	stats.packedImages = static_cast<uint32_t>( remaps.size() );
+
+	return stats;
+}
@@ -0,0 +1,62 @@
+/*
+* MIT License
+*
+* Copyright( c ) 2023 Thomas Griebel
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this softwareand associated documentation files( the "Software" ), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions :
+*
+* The above copyright noticeand this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+
+template<class T>
+class AssetLib;
+
+class Image;
+class Material;
+
+struct texturePackSettings_t
+{
+	uint32_t	atlasSize;			// Atlas page dimension, the last page is cropped to the rows it uses
+	uint32_t	maxPackedSize;		// Textures up to this size in both dimensions are atlas candidates
+	uint32_t	atlasMips;			// Mips kept on atlas pages. Sets the gutter and alignment so mips don't bleed.
+	uint32_t	minArrayLayers;		// Same-sized groups at least this large become 2D arrays
+	uint32_t	maxArrayLayers;
+
+	texturePackSettings_t() :
+		atlasSize( 2048 ),
+		maxPackedSize( 256 ),
+		atlasMips( 4 ),
+		minArrayLayers( 2 ),
+		maxArrayLayers( 256 )
+	{}
+};
+
+struct texturePackStats_t
+{
+	uint32_t	packedImages;
+	uint32_t	atlasImages;
+	uint32_t	arrayImages;
+};
+
+// Packs the RGBA8 2D images materials reference into 2D arrays ( same size ) and atlas pages ( small leftovers ).
+// Images are grouped by format and usage. Materials are pointed at the packed images with a textureRemap_t and the
+// sources are excluded from the bake.
+texturePackStats_t PackMaterialTextures( AssetLib<Image>& images, AssetLib<Material>& materials, const texturePackSettings_t& settings );